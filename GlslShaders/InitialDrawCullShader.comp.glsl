@@ -33,6 +33,9 @@ layout(std430, binding = 1) readonly buffer TransformBuffer
 
 struct MeshLod
 {
+    vec3 center;
+    float radius;
+
     uint indexCount;
     uint firstIndex;
 
@@ -58,6 +61,14 @@ struct Surface
     uint vertexOffset;
 
     uint materialTag;
+
+    // Not read here, but they are part of the layout of the surfaces
+    uint8_t postPass;
+
+    // The billboard level is only drawn by the Vulkan renderer, it is left out of the LOD selection
+    uint8_t bImpostor;
+    uint impostorVertex;
+    uint impostorMaterialTag;
 };
 
 layout(std430, binding = 2) readonly buffer SurfaceBuffer
@@ -149,14 +160,13 @@ void main()
     uint lodIndex = 0;
     if(int(cullingData.lodEnabled) == 1)
     {
-        // Gets the distance from the camera
-        float distance = max(length(center) - radius, 0);
-        // Create the threshold taking into account the lodTarget and the object's scale
-        float threshold = distance * viewData.lodTarget / transform.scale;
-        // Get the biggest reduction lod whose error is less than the calculated threshold
-        for(uint i = 0; i < surface.lodCount; ++i)
+        // Get the biggest reduction lod whose error, projected from the distance to its own bounding sphere, is under the lod target
+        for(uint i = 1; i < uint(surface.lodCount) - uint(surface.bImpostor); ++i)
         {
-            if(threshold > surface.lod[i].error)
+            vec3 lodCenter = RotateQuat(surface.lod[i].center, transform.orientation) * transform.scale + transform.pos;
+            lodCenter = (viewData.view * vec4(lodCenter, 1)).xyz;
+            float distance = max(length(lodCenter) - surface.lod[i].radius * transform.scale, viewData.zNear);
+            if(surface.lod[i].error * transform.scale / distance < viewData.lodTarget)
                 lodIndex = i;
         }
     }
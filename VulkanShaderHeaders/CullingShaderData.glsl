@@ -1,5 +1,8 @@
 #extension GL_EXT_buffer_reference2 : require
 #extension GL_EXT_shader_explicit_arithmetic_types : require
+#extension GL_KHR_shader_subgroup_basic : require
+#extension GL_KHR_shader_subgroup_ballot : require
+#extension GL_KHR_shader_subgroup_arithmetic : require
 
 #define LOD_ENABLED
 #define OCCLUSION_ENABLED
@@ -13,31 +16,13 @@ layout (push_constant) uniform CullingConstants
     uint8_t lodEnabled;
 
     uint8_t postPass;
-}cullPC;
-
-// 2D Polyhedral Bounds of a Clipped, Perspective-Projected 3D Sphere. Michael Mara, Morgan McGuire. 2013
-// Basically, this will be used to turn each object's bounding spere into an AABB to be used for occlusion culling
-bool projectSphere(vec3 c, float r, float znear, float P00, float P11, out vec4 aabb)
-{
-	if (c.z < r + znear)
-		return false;
-
-	vec3 cr = c * r;
-	float czr2 = c.z * c.z - r * r;
 
-	float vx = sqrt(c.x * c.x + czr2);
-	float minx = (vx * c.x - cr.z) / (vx * c.z + cr.x);
-	float maxx = (vx * c.x + cr.z) / (vx * c.z - cr.x);
+    // If this is 1, visible objects are grouped by surface and LOD into instanced draws
+    uint8_t instancingEnabled;
 
-	float vy = sqrt(c.y * c.y + czr2);
-	float miny = (vy * c.y - cr.z) / (vy * c.z + cr.y);
-	float maxy = (vy * c.y + cr.z) / (vy * c.z - cr.y);
-
-	aabb = vec4(minx * P00, miny * P11, maxx * P00, maxy * P11);
-	aabb = aabb.xwzy * vec4(0.5f, -0.5f, 0.5f, -0.5f) + vec4(0.5f); // clip space -> uv space
-
-	return true;
-}
+    // If this is 1, visible objects get an indirect task command for the task shader, which culls their meshlets
+    uint8_t meshShadingEnabled;
+}cullPC;
 
 // The indirect count buffer holds a single integer that is the draw count for VkCmdDrawIndexedIndirectCount. 
 // Will be incremented when necessary by a compute shader
@@ -46,7 +31,200 @@ layout(set = 0, binding = 9, std430) writeonly buffer IndirectCount
     uint drawCount;
 }indirectCountBuffer;
 
+// The visibility buffer holds one bit for each render object, packed in 32 object words.
+// The bit is set if the object was visible last frame. Only the late culling shader writes to it
 layout(set = 0, binding = 10, std430) buffer VisibilityBuffer
 {
     uint visibilities[];
-}visibilityBuffer;
\ No newline at end of file
+}visibilityBuffer;
+
+// Returns 1 if the object had its visibility bit set by the late culling shader last frame
+uint GetObjectVisibility(uint objectIndex)
+{
+    return (visibilityBuffer.visibilities[objectIndex >> 5] >> (objectIndex & 31)) & 1;
+}
+
+// Called by the late culling shader to write the visibility of each object for next frame.
+// Objects that are not owned by the current pass keep their previous bit. Every invocation needs to reach this function (no early returns),
+// since the bits are gathered with subgroup operations and then written with one atomic per 32 object word.
+// The objects come from the expanded instance list, so a subgroup can touch more than one word.
+// Each iteration takes the word of the first lane that still has a bit to write and combines the bits of every lane in that word.
+// The objects of an instance are usually next to each other, so this only takes a few iterations
+void UpdateObjectVisibility(uint objectIndex, bool bOwned, bool bVisible)
+{
+    uint word = objectIndex >> 5;
+    uint bit = 1 << (objectIndex & 31);
+
+    bool bPending = bOwned;
+    while(subgroupBallot(bPending) != uvec4(0))
+    {
+        if(bPending)
+        {
+            uint currentWord = subgroupBroadcastFirst(word);
+            bool bInWord = word == currentWord;
+
+            uint setMask = subgroupOr(bInWord && bVisible ? bit : 0);
+            uint clearMask = subgroupOr(bInWord && !bVisible ? bit : 0);
+
+            if(subgroupElect())
+            {
+                if(setMask != 0)
+                    atomicOr(visibilityBuffer.visibilities[currentWord], setMask);
+                if(clearMask != 0)
+                    atomicAnd(visibilityBuffer.visibilities[currentWord], ~clearMask);
+            }
+
+            bPending = !bInWord;
+        }
+    }
+}
+
+// Objects only move to a coarser LOD once its projected error is this fraction under the LOD target, 
+// and only move back once it is this fraction over it. Needs to match BLIT_LOD_HYSTERESIS, used by the CPU reference SelectSurfaceLod
+#define LOD_HYSTERESIS 0.1
+
+// The LOD history buffer holds the LOD that each render object was drawn with the last time that it was drawn.
+// Objects are only drawn by one of the culling shaders in a frame, so each byte has one writer
+layout(set = 0, binding = 23, std430) buffer LodHistoryBuffer
+{
+    uint8_t lods[];
+}lodHistoryBuffer;
+
+// Picks the coarsest LOD whose error, projected from the distance to the LOD's own bounding sphere, is under the LOD target.
+// The error is in model units and the target is the size of a pixel at distance 1, scaled by the LOD bias.
+// LODs that are coarser than the previous one need to be under the target by the hysteresis band, the rest are kept 
+// until they are over it by the band, so that objects near a threshold do not flip between LODs every frame.
+// Only called for objects that are drawn, since it also saves the selected LOD for the next frame
+uint SelectLod(uint objectIndex, Surface surface, Transform transform)
+{
+    uint previousLod = uint(lodHistoryBuffer.lods[objectIndex]);
+
+    uint lodIndex = 0;
+    for (uint i = 1; i < surface.lodCount; ++i)
+    {
+        vec3 center = RotateQuat(surface.lod[i].center, transform.orientation) * transform.scale + transform.pos;
+        center = (viewData.view * vec4(center, 1)).xyz;
+        float distance = max(length(center) - surface.lod[i].radius * transform.scale, viewData.zNear);
+        float projectedError = surface.lod[i].error * transform.scale / distance;
+
+        float band = i > previousLod ? 1 - LOD_HYSTERESIS : 1 + LOD_HYSTERESIS;
+        if (projectedError < viewData.lodTarget * band)
+            lodIndex = i;
+    }
+
+    lodHistoryBuffer.lods[objectIndex] = uint8_t(lodIndex);
+    return lodIndex;
+}
+
+// Each mesh instance is one transform with all the surfaces of its mesh. It is culled with a sphere that encloses every surface
+struct MeshInstance
+{
+    vec3 center;
+    float radius;
+
+    uint transformId;
+
+    // Ranges in the instance object buffer
+    uint firstOpaqueObject;
+    uint opaqueObjectCount;
+    uint firstPostPassObject;
+    uint postPassObjectCount;
+};
+
+layout(set = 0, binding = 18, std430) readonly buffer MeshInstanceBuffer
+{
+    MeshInstance instances[];
+}meshInstanceBuffer;
+
+// Render object indices grouped by mesh instance. Opaque objects come first
+layout(set = 0, binding = 19, std430) readonly buffer InstanceObjectBuffer
+{
+    uint objectIds[];
+}instanceObjectBuffer;
+
+// Written by the mesh instance culling shader with the render objects of every instance that passed its test.
+// The first 3 integers are the dispatch indirect command of the render object culling shader that goes over the list
+layout(set = 0, binding = 20, std430) buffer ExpandedObjectBuffer
+{
+    uint groupCountX;
+    uint groupCountY;
+    uint groupCountZ;
+
+    uint objectCount;
+    uint objectIds[];
+}expandedObjectBuffer;
+
+// With instancing enabled, each surface and LOD combination has one bucket, which counts the instances that selected it.
+// The instance offset is set after culling by the bucket compaction shader
+struct InstanceBucket
+{
+    uint instanceCount;
+    uint instanceOffset;
+};
+
+layout(set = 0, binding = 14, std430) buffer InstanceBucketBuffer
+{
+    InstanceBucket buckets[];
+}bucketBuffer;
+
+// Every object that passes culling while instancing is enabled is added to this list, 
+// so that it can be written to its bucket's range of the instance buffer once the offsets are known
+struct VisibleInstance
+{
+    uint objectId;
+    uint bucketId;
+    uint localIndex;
+};
+
+layout(set = 0, binding = 16, std430) buffer VisibleInstanceBuffer
+{
+    VisibleInstance instances[];
+}visibleInstanceBuffer;
+
+// Counts the elements of the visible instance list and the elements of the instance buffer that have been reserved by buckets
+layout(set = 0, binding = 17, std430) buffer InstancingCounters
+{
+    uint visibleCount;
+    uint instanceTotal;
+}instancingCounters;
+
+// Called by the culling shaders instead of creating a draw command, when instancing is enabled
+void AddVisibleInstance(uint objectIndex, uint surfaceId, uint lodIndex)
+{
+    uint bucketId = surfaceId * MAX_LOD_COUNT + lodIndex;
+    uint localIndex = atomicAdd(bucketBuffer.buckets[bucketId].instanceCount, 1);
+
+    uint visibleIndex = atomicAdd(instancingCounters.visibleCount, 1);
+    visibleInstanceBuffer.instances[visibleIndex].objectId = objectIndex;
+    visibleInstanceBuffer.instances[visibleIndex].bucketId = bucketId;
+    visibleInstanceBuffer.instances[visibleIndex].localIndex = localIndex;
+}
+
+// Written by the late culling shaders for every visible object. Each texture gets the largest size in depth pyramid pixels 
+// of the objects that use it. The renderer reads it once the frame is done and streams in the mip levels that this size needs
+layout(set = 0, binding = 21, std430) buffer TextureFeedbackBuffer
+{
+    uint demands[];
+}textureFeedbackBuffer;
+
+// Uses the same projected bounding sphere as occlusion culling. Spheres that cross the near plane ask for the whole screen
+void WriteTextureDemand(uint materialTag, vec3 center, float radius)
+{
+    float pyramidSize = max(viewData.pyramidWidth, viewData.pyramidHeight);
+    float size = pyramidSize;
+    vec4 aabb;
+    if (projectSphere(center, radius, viewData.zNear, viewData.proj0, viewData.proj5, aabb))
+        size = min(max((aabb.z - aabb.x) * viewData.pyramidWidth, (aabb.w - aabb.y) * viewData.pyramidHeight), pyramidSize);
+    uint demand = uint(ceil(size));
+
+    // Tag 0 is the default texture, it is never streamed
+    Material material = materialBuffer.materials[materialTag];
+    if(material.albedoTag != 0)
+        atomicMax(textureFeedbackBuffer.demands[material.albedoTag], demand);
+    if(material.normalTag != 0)
+        atomicMax(textureFeedbackBuffer.demands[material.normalTag], demand);
+    if(material.specularTag != 0)
+        atomicMax(textureFeedbackBuffer.demands[material.specularTag], demand);
+    if(material.emissiveTag != 0)
+        atomicMax(textureFeedbackBuffer.demands[material.emissiveTag], demand);
+}
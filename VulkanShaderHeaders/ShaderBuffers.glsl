@@ -31,6 +31,16 @@ struct Meshlet
     uint dataOffset; // dataOffset..dataOffset+vertexCount-1 stores vertex indices, indices are packed in 4b units after that
     uint8_t vertexCount;
     uint8_t triangleCount;
+
+    // Error and sphere of the group that the cluster was simplified from
+    float error;
+    vec3 lodCenter;
+    float lodRadius;
+
+    // Error and sphere of the group that replaced it, shared by its siblings
+    vec3 parentCenter;
+    float parentRadius;
+    float parentError;
 };
 
 // The single buffer that holds all meshlet data in the scene
@@ -47,6 +57,10 @@ layout(set = 0, binding = 13, std430) readonly buffer MeshletDataBuffer
 // Holds a specific level of detail's index offset and count (as well as the according data for mesh shaders)
 struct MeshLod
 {
+    // Bounding sphere of the vertices that this level of detail uses
+    vec3 center;
+    float radius;
+
     // These allow the compute shader to give the index count and index offset to draw indirect for this specific level of detail
     uint indexCount;
     uint firstIndex;
@@ -57,6 +71,9 @@ struct MeshLod
     float error;
 };
 
+// The maximum amount of level of details for each surface, needs to match BLIT_MAX_MESH_LOD
+#define MAX_LOD_COUNT 8
+
 struct Surface
 {
     // Bounding sphere
@@ -75,6 +92,11 @@ struct Surface
     uint materialTag;
 
     uint8_t postPass;
+
+    // Set when the last level of detail is a billboard. Its 4 corners start at the impostor vertex, relative to the vertex offset
+    uint8_t bImpostor;
+    uint impostorVertex;
+    uint impostorMaterialTag;
 };
 
 layout(set = 0, binding = 2, std430) readonly buffer SurfaceBuffer
@@ -99,10 +121,15 @@ struct IndirectDraw
     uint firstInstance;
 };
 
+// Written by the culling shaders for each visible object when mesh shading is active. 
+// Each task shader workgroup culls 32 meshlets of the selected LOD's meshlet range
 struct IndirectTask
 {
-    uint taskId;
+    uint objectId;
+    uint firstMeshlet;
+    uint meshletCount;
 
+    // Everything needed for vkCmdDrawMeshTasksIndirectCountEXT call
     uint groupCountX;
     uint groupCountY;
     uint groupCountZ;
@@ -120,6 +147,12 @@ struct IndirectTask
     {
         IndirectTask tasks[];
     }indirectTaskBuffer;
+
+    // When instancing is enabled, every bucket writes the object IDs of its instances to a continuous range of this buffer
+    layout(set = 0, binding = 15, std430) writeonly buffer InstanceBuffer
+    {
+        uint objectIds[];
+    }instanceBuffer;
 #else
     // In the graphics pipeline, this needs to be accessed to retrieve the object ID
     layout(set = 0, binding = 7, std430) readonly buffer IndirectDrawBuffer
@@ -131,6 +164,13 @@ struct IndirectTask
     {
         IndirectTask tasks[];
     }indirectTaskBuffer;
+
+    // When instancing is enabled, the vertex shader finds the object of each instance here.
+    // The object ID of the indirect draw holds the first element of the draw's instances
+    layout(set = 0, binding = 15, std430) readonly buffer InstanceBuffer
+    {
+        uint objectIds[];
+    }instanceBuffer;
 #endif
 
 // Every possible draw call has one of these structs
@@ -172,8 +212,14 @@ struct Material
     uint emissiveTag;
 
     uint materialId;
+
+    // MATERIAL_* bits
+    uint flags;
 };
 
+// Needs to match BLIT_MATERIAL_ALPHA_TEST
+#define MATERIAL_ALPHA_TEST 1
+
 layout (set = 0, binding = 6, std430) readonly buffer MaterialBuffer
 {
     Material materials[];
@@ -215,7 +261,31 @@ vec3 RotateQuat(vec3 v, vec4 quat)
 	return v + 2.0 * cross(quat.xyz, cross(quat.xyz, v) + quat.w * v);
 }
 
-// Struct used for mesh shaders
+// 2D Polyhedral Bounds of a Clipped, Perspective-Projected 3D Sphere. Michael Mara, Morgan McGuire. 2013
+// Basically, this will be used to turn each object's bounding spere into an AABB to be used for occlusion culling
+bool projectSphere(vec3 c, float r, float znear, float P00, float P11, out vec4 aabb)
+{
+	if (c.z < r + znear)
+		return false;
+
+	vec3 cr = c * r;
+	float czr2 = c.z * c.z - r * r;
+
+	float vx = sqrt(c.x * c.x + czr2);
+	float minx = (vx * c.x - cr.z) / (vx * c.z + cr.x);
+	float maxx = (vx * c.x + cr.z) / (vx * c.z - cr.x);
+
+	float vy = sqrt(c.y * c.y + czr2);
+	float miny = (vy * c.y - cr.z) / (vy * c.z + cr.y);
+	float maxy = (vy * c.y + cr.z) / (vy * c.z - cr.y);
+
+	aabb = vec4(minx * P00, miny * P11, maxx * P00, maxy * P11);
+	aabb = aabb.xwzy * vec4(0.5f, -0.5f, 0.5f, -0.5f) + vec4(0.5f); // clip space -> uv space
+
+	return true;
+}
+
+// Struct used for mesh shaders. The task shader writes the meshlets that passed culling and the object they belong to
 struct MeshTaskPayload
 {
 	uint drawId;
@@ -13,16 +13,16 @@ layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
 
 void main()
 {
-    // The object index is for the current object's element in the render object
-	uint objectIndex = gl_GlobalInvocationID.x;
-
-    // This is a guard so that the culling shader does not go over the draw count
-    if(cullPC.drawCount <= objectIndex)
+    // This is a guard so that the culling shader does not go over the objects of the instances that passed mesh instance culling
+    if(expandedObjectBuffer.objectCount <= gl_GlobalInvocationID.x)
         return;
 
+    // The object index is for the current object's element in the render object buffer
+	uint objectIndex = expandedObjectBuffer.objectIds[gl_GlobalInvocationID.x];
+
     // This culling shader also returns if the current object was not visible last frame
     #ifdef OCCLUSION_ENABLED
-    if(visibilityBuffer.visibilities[objectIndex] == 0)
+    if(GetObjectVisibility(objectIndex) == 0)
         return;
     #endif
 
@@ -31,10 +31,6 @@ void main()
     Transform transform = transformBuffer.instances[currentObject.meshInstanceId];
     Surface surface = surfaceBuffer.surfaces[currentObject.surfaceId];
 
-    // The initial culling pass does not touch transparent objects
-    if(surface.postPass == 1)
-        return;
-
     // Promotes the bounding sphere's center to model and the view coordinates (frustum culling will be done on view space)
     vec3 center = RotateQuat(surface.center, transform.orientation) * transform.scale + transform.pos;
     center = (viewData.view * vec4(center, 1)).xyz;
@@ -55,41 +51,54 @@ void main()
     // Create draw commands for the objects that passed frustum culling
     if(visible)
     {
-        // With each element that is added to the draw list, increment the count buffer
-        uint drawIndex = atomicAdd(indirectCountBuffer.drawCount, 1);
-
         // The lod index is declared here. if LODs are not enabled the most detailed version of an object will be used by default
         uint lodIndex = 0;
         /*  
-            The LOD index is calculated using a formula where the distance to bounding sphere
-            surface is taken and the minimum error that would result in acceptable
-            screen-space deviation is computed based on camera parameters
+            The LOD index is calculated by projecting the error of each LOD from the distance to its bounding sphere
+            and comparing it to the screen-space deviation allowed by the camera parameters, with hysteresis
         */
         #ifdef LOD_ENABLED
-		float distance = max(length(center) - radius, 0);
-		float threshold = distance * viewData.lodTarget / transform.scale;
-		for (uint i = 1; i < surface.lodCount; ++i)
-			if (surface.lod[i].error < threshold)
-				lodIndex = i;
+		lodIndex = SelectLod(objectIndex, surface, transform);
 		#endif
 
-        // Get the selected LOD
-        MeshLod currentLod = surface.lod[lodIndex];
-
-        // The object index is needed to know which element to access in the per object data buffer
-        indirectDrawBuffer.draws[drawIndex].objectId = objectIndex;
-
-        // Setup the indirect draw commands based on the selected LODs and the vertex offset of the current surface
-        indirectDrawBuffer.draws[drawIndex].indexCount = currentLod.indexCount;
-        indirectDrawBuffer.draws[drawIndex].instanceCount = 1;
-        indirectDrawBuffer.draws[drawIndex].firstIndex = currentLod.firstIndex;
-        indirectDrawBuffer.draws[drawIndex].vertexOffset = surface.vertexOffset;
-        indirectDrawBuffer.draws[drawIndex].firstInstance = 0;
-
-        // Indirect task commands
-        /*bufferAddrs.indirectTaskBuffer.tasks[drawIndex].taskId = currentLod.firstMeshlet;
-        bufferAddrs.indirectTaskBuffer.tasks[drawIndex].groupCountX = (currentLod.meshletCount + 31) / 32;
-        bufferAddrs.indirectTaskBuffer.tasks[drawIndex].groupCountY = 1;
-        bufferAddrs.indirectTaskBuffer.tasks[drawIndex].groupCountZ = 1;*/
+        if(cullPC.instancingEnabled == 1)
+        {
+            // The object is added to the bucket of its surface and LOD. The draw command is created later by the bucket compaction shader
+            AddVisibleInstance(objectIndex, currentObject.surfaceId, lodIndex);
+        }
+        else if(cullPC.meshShadingEnabled == 1)
+        {
+            // With each element that is added to the task list, increment the count buffer
+            uint taskIndex = atomicAdd(indirectCountBuffer.drawCount, 1);
+
+            // Get the selected LOD
+            MeshLod currentLod = surface.lod[lodIndex];
+
+            // The task shader culls the meshlets of the selected LOD, 32 of them for each workgroup
+            indirectTaskBuffer.tasks[taskIndex].objectId = objectIndex;
+            indirectTaskBuffer.tasks[taskIndex].firstMeshlet = currentLod.firstMeshlet;
+            indirectTaskBuffer.tasks[taskIndex].meshletCount = currentLod.meshletCount;
+            indirectTaskBuffer.tasks[taskIndex].groupCountX = (currentLod.meshletCount + 31) / 32;
+            indirectTaskBuffer.tasks[taskIndex].groupCountY = 1;
+            indirectTaskBuffer.tasks[taskIndex].groupCountZ = 1;
+        }
+        else
+        {
+            // With each element that is added to the draw list, increment the count buffer
+            uint drawIndex = atomicAdd(indirectCountBuffer.drawCount, 1);
+
+            // Get the selected LOD
+            MeshLod currentLod = surface.lod[lodIndex];
+
+            // The object index is needed to know which element to access in the per object data buffer
+            indirectDrawBuffer.draws[drawIndex].objectId = objectIndex;
+
+            // Setup the indirect draw commands based on the selected LODs and the vertex offset of the current surface
+            indirectDrawBuffer.draws[drawIndex].indexCount = currentLod.indexCount;
+            indirectDrawBuffer.draws[drawIndex].instanceCount = 1;
+            indirectDrawBuffer.draws[drawIndex].firstIndex = currentLod.firstIndex;
+            indirectDrawBuffer.draws[drawIndex].vertexOffset = surface.vertexOffset;
+            indirectDrawBuffer.draws[drawIndex].firstInstance = 0;
+        }
     } 
 }
\ No newline at end of file
@@ -0,0 +1,70 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+#extension GL_KHR_shader_subgroup_arithmetic : require
+
+#define COMPUTE_PIPELINE
+
+#include "../VulkanShaderHeaders/ShaderBuffers.glsl"
+#include "../VulkanShaderHeaders/CullingShaderData.glsl"
+
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+// Holds the instance total of each subgroup in the workgroup, and then their exclusive prefix sum
+shared uint subgroupOffsets[64];
+// The first element of the instance buffer that was reserved for the whole workgroup
+shared uint workgroupInstanceBase;
+
+// Dispatched after a culling shader when instancing is enabled. The draw count of the push constant is the bucket count.
+// Each invocation gives one bucket its range of the instance buffer, using a prefix sum over the bucket instance counts,
+// and creates a single instanced draw command for it if any object selected it
+void main()
+{
+    uint bucketId = gl_GlobalInvocationID.x;
+
+    // Invocations past the bucket count still need to take part in the prefix sum, so they add nothing
+    uint instanceCount = bucketId < cullPC.drawCount ? bucketBuffer.buckets[bucketId].instanceCount : 0;
+
+    // Exclusive prefix sum inside the subgroup
+    uint subgroupOffset = subgroupExclusiveAdd(instanceCount);
+    uint subgroupTotal = subgroupAdd(instanceCount);
+    if(subgroupElect())
+        subgroupOffsets[gl_SubgroupID] = subgroupTotal;
+    barrier();
+
+    // The first invocation scans the subgroup totals and reserves a continuous range of the instance buffer for the workgroup
+    if(gl_LocalInvocationIndex == 0)
+    {
+        uint workgroupTotal = 0;
+        for(uint i = 0; i < gl_NumSubgroups; ++i)
+        {
+            uint total = subgroupOffsets[i];
+            subgroupOffsets[i] = workgroupTotal;
+            workgroupTotal += total;
+        }
+        workgroupInstanceBase = atomicAdd(instancingCounters.instanceTotal, workgroupTotal);
+    }
+    barrier();
+
+    // Empty buckets do not create a draw command
+    if(instanceCount == 0)
+        return;
+
+    uint instanceOffset = workgroupInstanceBase + subgroupOffsets[gl_SubgroupID] + subgroupOffset;
+    bucketBuffer.buckets[bucketId].instanceOffset = instanceOffset;
+
+    // The bucket ID is the surface ID times the LOD count plus the LOD index
+    Surface surface = surfaceBuffer.surfaces[bucketId / MAX_LOD_COUNT];
+    MeshLod currentLod = surface.lod[bucketId % MAX_LOD_COUNT];
+
+    uint drawIndex = atomicAdd(indirectCountBuffer.drawCount, 1);
+
+    // The object ID of an instanced draw is the first element of its range in the instance buffer
+    indirectDrawBuffer.draws[drawIndex].objectId = instanceOffset;
+
+    indirectDrawBuffer.draws[drawIndex].indexCount = currentLod.indexCount;
+    indirectDrawBuffer.draws[drawIndex].instanceCount = instanceCount;
+    indirectDrawBuffer.draws[drawIndex].firstIndex = currentLod.firstIndex;
+    indirectDrawBuffer.draws[drawIndex].vertexOffset = surface.vertexOffset;
+    indirectDrawBuffer.draws[drawIndex].firstInstance = 0;
+}
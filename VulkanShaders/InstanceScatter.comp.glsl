@@ -0,0 +1,26 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+
+#define COMPUTE_PIPELINE
+
+#include "../VulkanShaderHeaders/ShaderBuffers.glsl"
+#include "../VulkanShaderHeaders/CullingShaderData.glsl"
+
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+// Dispatched after the bucket compaction shader. 
+// Writes each visible object to its slot in the instance buffer, now that every bucket knows its offset
+void main()
+{
+    uint visibleIndex = gl_GlobalInvocationID.x;
+
+    // The dispatch is sized for the draw count, but only the objects that passed culling were added to the list
+    if(visibleIndex >= instancingCounters.visibleCount)
+        return;
+
+    VisibleInstance instance = visibleInstanceBuffer.instances[visibleIndex];
+    uint instanceOffset = bucketBuffer.buckets[instance.bucketId].instanceOffset;
+
+    instanceBuffer.objectIds[instanceOffset + instance.localIndex] = instance.objectId;
+}
@@ -15,96 +15,119 @@ layout (set = 0, binding = 3) uniform sampler2D depthPyramid;
 
 void main()
 {
-    uint objectIndex = gl_GlobalInvocationID.x;
-
-    // This a guard so that the compute shader does not go over the draw count
-    if(cullPC.drawCount <= objectIndex)
-        return;
-
-    // Access the object's data
-    RenderObject object = objectBuffer.objects[objectIndex];
-    Transform transform = transformBuffer.instances[object.meshInstanceId];
-    Surface surface = surfaceBuffer.surfaces[object.surfaceId];
-
-    // If the late culling shader does not match the pass of the current surface it exits
-    if(surface.postPass != cullPC.postPass)
-        return;
-    
-    // Promotes the bounding sphere's center to model and the view coordinates (frustum culling will be done on view space)
-    vec3 center = RotateQuat(surface.center, transform.orientation) * transform.scale + transform.pos;
-    center = (viewData.view * vec4(center, 1)).xyz;
-
-    // The bounding sphere's radius only needs to be multiplied by the object's scale
-	float radius = surface.radius * transform.scale;
-
-    // Check that the bounding sphere is inside the view frustum(frustum culling)
-	bool visible = true;
-    // the left/top/right/bottom plane culling utilizes frustum symmetry to cull against two planes at the same time
-    // Formula taken from Arseny Kapoulkine's Niagara renderer https://github.com/zeux/niagara
-    // It is also referenced in VKguide's GPU driven rendering articles https://vkguide.dev/docs/gpudriven/compute_culling/
-    visible = visible && center.z * viewData.frustumLeft - abs(center.x) * viewData.frustumRight > -radius;
-	visible = visible && center.z * viewData.frustumBottom - abs(center.y) * viewData.frustumTop > -radius;
-	// the near/far plane culling uses camera space Z directly
-	visible = visible && center.z + radius > viewData.zNear && center.z - radius < viewData.zFar;
-
-    // Later draw culling also does occlusion culling on objects that passed the frustum culling test above
-    if (visible && uint(cullPC.occlusionEnabled) == 1)
-	{
-		vec4 aabb;
-		if (projectSphere(center, radius, viewData.zNear, viewData.proj0, viewData.proj5, aabb))
-		{
-			float width = (aabb.z - aabb.x) * viewData.pyramidWidth;
-			float height = (aabb.w - aabb.y) * viewData.pyramidHeight;
-
-            // Find the mip map level that will match the screen size of the sphere
-			float level = floor(log2(max(width, height)));
-
-			float depth = textureLod(depthPyramid, (aabb.xy + aabb.zw) * 0.5, level).x;
-
-			float depthSphere = viewData.zNear / (center.z - radius);
-
-			visible = visible && depthSphere > depth;
-		}
-	}
-
-    // The late culling shader creates draw commands for the objects that passed late culling and were not tagged as visible last frame
-    // It handles transparent objects a little bit differently as this is the only shader that will cull them
-    if(visible && (visibilityBuffer.visibilities[objectIndex] == 0 || cullPC.postPass != 0))
+    // The mesh instance culling shader expanded the instances that passed its test to their render objects.
+    // This dispatch only goes over that list, the post pass dispatch gets the post pass objects of each instance
+    // The visibility bits are written with subgroup operations, so invocations cannot exit early.
+    // Instead, invocations over the expanded object count are not owned by this dispatch
+    bool bOwned = gl_GlobalInvocationID.x < expandedObjectBuffer.objectCount;
+    uint objectIndex = bOwned ? expandedObjectBuffer.objectIds[gl_GlobalInvocationID.x] : 0;
+    bool visible = false;
+    if(bOwned)
     {
-        // With each element that is added to the draw list, increment the count buffer
-        uint drawIndex = atomicAdd(indirectCountBuffer.drawCount, 1);
-
-        // The lod index is declared here. if LODs are not enabled the most detailed version of an object will be used by default
-        uint lodIndex = 0;
-        /*  
-            The LOD index is calculated using a formula where the distance to bounding sphere
-            surface is taken and the minimum error that would result in acceptable
-            screen-space deviation is computed based on camera parameters
-        */
-        if (cullPC.lodEnabled == 1)
-		{
-			float distance = max(length(center) - radius, 0);
-			float threshold = distance * viewData.lodTarget / transform.scale;
-			for (uint i = 1; i < surface.lodCount; ++i)
-				if (surface.lod[i].error < threshold)
-					lodIndex = i;
-		}
-
-        // Get the selected LOD
-        MeshLod currentLod = surface.lod[lodIndex];
-
-        // The object index is needed to know which element to access in the per object data buffer
-        indirectDrawBuffer.draws[drawIndex].objectId = objectIndex;
-
-        // Setup the indirect draw commands based on the selected LODs and the vertex offset of the current surface
-        indirectDrawBuffer.draws[drawIndex].indexCount = currentLod.indexCount;
-        indirectDrawBuffer.draws[drawIndex].instanceCount = 1;
-        indirectDrawBuffer.draws[drawIndex].firstIndex = currentLod.firstIndex;
-        indirectDrawBuffer.draws[drawIndex].vertexOffset = surface.vertexOffset;
-        indirectDrawBuffer.draws[drawIndex].firstInstance = 0;
+        // Access the object's data
+        RenderObject object = objectBuffer.objects[objectIndex];
+        Transform transform = transformBuffer.instances[object.meshInstanceId];
+        Surface surface = surfaceBuffer.surfaces[object.surfaceId];
+
+        // Promotes the bounding sphere's center to model and the view coordinates (frustum culling will be done on view space)
+        vec3 center = RotateQuat(surface.center, transform.orientation) * transform.scale + transform.pos;
+        center = (viewData.view * vec4(center, 1)).xyz;
+
+        // The bounding sphere's radius only needs to be multiplied by the object's scale
+        float radius = surface.radius * transform.scale;
+
+        // Check that the bounding sphere is inside the view frustum(frustum culling)
+        visible = true;
+        // the left/top/right/bottom plane culling utilizes frustum symmetry to cull against two planes at the same time
+        // Formula taken from Arseny Kapoulkine's Niagara renderer https://github.com/zeux/niagara
+        // It is also referenced in VKguide's GPU driven rendering articles https://vkguide.dev/docs/gpudriven/compute_culling/
+        visible = visible && center.z * viewData.frustumLeft - abs(center.x) * viewData.frustumRight > -radius;
+        visible = visible && center.z * viewData.frustumBottom - abs(center.y) * viewData.frustumTop > -radius;
+        // the near/far plane culling uses camera space Z directly
+        visible = visible && center.z + radius > viewData.zNear && center.z - radius < viewData.zFar;
+
+        // Later draw culling also does occlusion culling on objects that passed the frustum culling test above
+        if (visible && uint(cullPC.occlusionEnabled) == 1)
+        {
+            vec4 aabb;
+            if (projectSphere(center, radius, viewData.zNear, viewData.proj0, viewData.proj5, aabb))
+            {
+                float width = (aabb.z - aabb.x) * viewData.pyramidWidth;
+                float height = (aabb.w - aabb.y) * viewData.pyramidHeight;
+
+                // Find the mip map level that will match the screen size of the sphere
+                float level = floor(log2(max(width, height)));
+
+                float depth = textureLod(depthPyramid, (aabb.xy + aabb.zw) * 0.5, level).x;
+
+                float depthSphere = viewData.zNear / (center.z - radius);
+
+                visible = visible && depthSphere > depth;
+            }
+        }
+
+        // Every visible object tells texture streaming how big its textures are on screen, including the ones drawn by the first pass
+        if(visible)
+            WriteTextureDemand(surface.materialTag, center, radius);
+
+        // The late culling shader creates draw commands for the objects that passed late culling and were not tagged as visible last frame
+        // It handles transparent objects a little bit differently as this is the only shader that will cull them
+        if(visible && (GetObjectVisibility(objectIndex) == 0 || cullPC.postPass != 0))
+        {
+            // The lod index is declared here. if LODs are not enabled the most detailed version of an object will be used by default
+            uint lodIndex = 0;
+            /*  
+                The LOD index is calculated by projecting the error of each LOD from the distance to its bounding sphere
+                and comparing it to the screen-space deviation allowed by the camera parameters, with hysteresis
+            */
+            if (cullPC.lodEnabled == 1)
+                lodIndex = SelectLod(objectIndex, surface, transform);
+
+            if(cullPC.instancingEnabled == 1)
+            {
+                // The object is added to the bucket of its surface and LOD. The draw command is created later by the bucket compaction shader
+                AddVisibleInstance(objectIndex, object.surfaceId, lodIndex);
+            }
+            else if(cullPC.meshShadingEnabled == 1)
+            {
+                // With each element that is added to the task list, increment the count buffer
+                uint taskIndex = atomicAdd(indirectCountBuffer.drawCount, 1);
+
+                // Get the selected LOD
+                MeshLod currentLod = surface.lod[lodIndex];
+
+                // The task shader culls the meshlets of the selected LOD, 32 of them for each workgroup
+                indirectTaskBuffer.tasks[taskIndex].objectId = objectIndex;
+                indirectTaskBuffer.tasks[taskIndex].firstMeshlet = currentLod.firstMeshlet;
+                indirectTaskBuffer.tasks[taskIndex].meshletCount = currentLod.meshletCount;
+                indirectTaskBuffer.tasks[taskIndex].groupCountX = (currentLod.meshletCount + 31) / 32;
+                indirectTaskBuffer.tasks[taskIndex].groupCountY = 1;
+                indirectTaskBuffer.tasks[taskIndex].groupCountZ = 1;
+            }
+            else
+            {
+                // With each element that is added to the draw list, increment the count buffer
+                uint drawIndex = atomicAdd(indirectCountBuffer.drawCount, 1);
+
+                // Get the selected LOD
+                MeshLod currentLod = surface.lod[lodIndex];
+
+                // The object index is needed to know which element to access in the per object data buffer
+                indirectDrawBuffer.draws[drawIndex].objectId = objectIndex;
+
+                // Setup the indirect draw commands based on the selected LODs and the vertex offset of the current surface
+                indirectDrawBuffer.draws[drawIndex].indexCount = currentLod.indexCount;
+                indirectDrawBuffer.draws[drawIndex].instanceCount = 1;
+                indirectDrawBuffer.draws[drawIndex].firstIndex = currentLod.firstIndex;
+                indirectDrawBuffer.draws[drawIndex].vertexOffset = surface.vertexOffset;
+                indirectDrawBuffer.draws[drawIndex].firstInstance = 0;
+            }
+        }
     }
 
-    // Any object that passed both occlusion and frustum culling, will have its visibility set to 1 for next frame
-    // That means that the early culling shader will perform furstum culling on them
-    visibilityBuffer.visibilities[objectIndex] = visible ? 1 : 0;
+    // Any object that passed both occlusion and frustum culling, will have its visibility bit set for next frame
+    // That means that the early culling shader will perform furstum culling on them.
+    // Post pass objects are never tested by the early culling shader, so their visibility is not needed
+    if(cullPC.postPass == 0)
+        UpdateObjectVisibility(objectIndex, bOwned, visible);
 }
\ No newline at end of file
@@ -8,6 +8,10 @@
 // Specialization constant. Its value changes for the post pass pipeline. This should theoritically allow for gpu compiler optimizations
 layout (constant_id = 0) const uint POST_PASS = 0;
 
+// Set when some surface has a billboard level of detail. Its material is alpha tested in the opaque pass too, 
+// the other opaque pipelines keep early depth testing without the discard
+layout (constant_id = 1) const uint IMPOSTORS = 0;
+
 layout(location = 0) in vec2 uv;
 layout(location = 1) in vec3 normal;
 layout(location = 2) in vec4 tangent;
@@ -17,9 +21,29 @@ layout(location = 4) in vec3 modelPos;
 // The texture binding is only needed in the fragment shader
 layout(set = 1, binding = 0) uniform sampler2D textures[];
 
+// The lowest mip level that each texture can be sampled at. It is raised when streamed levels are added to a texture 
+// and lowered over the next frames, so that the new detail fades in
+layout(set = 0, binding = 22, std430) readonly buffer TextureLodBuffer
+{
+    float minLods[];
+}textureLodBuffer;
+
 // The color that will be calculated for the current fragment
 layout (location = 0) out vec4 outColor;
 
+// Textures that are fading in streamed levels are sampled no lower than their minimum LOD. 
+// The branch only depends on the material, so the derivatives of the quad are still valid
+vec4 SampleTexture(uint textureTag, vec2 uv)
+{
+    float minLod = textureLodBuffer.minLods[textureTag];
+    if(minLod > 0)
+    {
+        float lod = max(textureQueryLod(textures[nonuniformEXT(textureTag)], uv).x, minLod);
+        return textureLod(textures[nonuniformEXT(textureTag)], uv, lod);
+    }
+    return texture(textures[nonuniformEXT(textureTag)], uv);
+}
+
 void main()
 {
     // Get the material from the material buffer based on the material tag that was passed from the vertex shader
@@ -27,15 +51,19 @@ void main()
 
     vec4 albedoMap = vec4(0.5f, 0.5f, 0.5f, 1);
     if(material.albedoTag != 0)
-        albedoMap = texture(textures[nonuniformEXT(material.albedoTag)], uv);
+        albedoMap = SampleTexture(material.albedoTag, uv);
     
     vec3 normalMap = vec3(0, 0, 1);
+    // Only x and y are read, so that baked BC5 normal maps work the same as RGB ones. z is rebuilt from them
     if(material.normalTag != 0)
-        normalMap = texture(textures[nonuniformEXT(material.normalTag)], uv).rgb * 2 - 1;
+    {
+        vec2 nxy = SampleTexture(material.normalTag, uv).rg * 2 - 1;
+        normalMap = vec3(nxy, sqrt(max(1 - dot(nxy, nxy), 0)));
+    }
 
     vec3 emissiveMap = vec3(0.0);
     if(material.emissiveTag != 0)
-        emissiveMap = texture(textures[nonuniformEXT(material.emissiveTag)], uv).rgb;
+        emissiveMap = SampleTexture(material.emissiveTag, uv).rgb;
 
     vec3 bitangent = cross(normal, tangent.xyz) * tangent.w;
 	vec3 nrm = normalize(normalMap.r * tangent.xyz + normalMap.g * bitangent + normalMap.b * normal);
@@ -45,6 +73,6 @@ void main()
     //outColor = vec4(normal, 1);
 
     
-    if(POST_PASS != 0 && albedoMap.a < 0.5)
+    if((POST_PASS != 0 || (IMPOSTORS != 0 && (material.flags & MATERIAL_ALPHA_TEST) != 0)) && albedoMap.a < 0.5)
         discard;
 }
\ No newline at end of file
@@ -7,6 +7,12 @@
 
 #include "../VulkanShaderHeaders/ShaderBuffers.glsl"
 
+// If this is 1, the culling shaders created instanced draws and objects are found through the instance buffer
+layout(push_constant) uniform GraphicsConstants
+{
+    uint instancingEnabled;
+}graphicsPC;
+
 // All the values needed by the fragment shader
 layout(location = 0) out vec2 outUv;
 layout(location = 1) out vec3 outNormal;
@@ -14,15 +20,83 @@ layout(location = 2) out vec4 outTangent;
 layout(location = 3) out uint outMaterialTag;
 layout(location = 4) out vec3 outModel;
 
+// Frames on each side of the impostor atlas, needs to match BLIT_IMPOSTOR_GRID
+#define IMPOSTOR_GRID 8
+
+// Octahedral map of the sphere, with y as the pole
+vec2 OctahedralEncode(vec3 direction)
+{
+    direction /= abs(direction.x) + abs(direction.y) + abs(direction.z);
+    vec2 encoded = direction.xz;
+    if(direction.y < 0)
+        encoded = (1 - abs(encoded.yx)) * vec2(encoded.x >= 0 ? 1 : -1, encoded.y >= 0 ? 1 : -1);
+    return encoded;
+}
+
+vec3 OctahedralDecode(vec2 encoded)
+{
+    vec3 direction = vec3(encoded.x, 1 - abs(encoded.x) - abs(encoded.y), encoded.y);
+    if(direction.y < 0)
+        direction.xz = (1 - abs(direction.zx)) * vec2(direction.x >= 0 ? 1 : -1, direction.z >= 0 ? 1 : -1);
+    return normalize(direction);
+}
+
+// The frame looks at the surface from the direction. Needs to match GetImpostorFrameAxes in the impostor baker
+void GetImpostorAxes(vec3 direction, out vec3 right, out vec3 up)
+{
+    vec3 reference = abs(direction.y) > 0.999 ? vec3(0, 0, 1) : vec3(0, 1, 0);
+    right = normalize(cross(reference, direction));
+    up = cross(direction, right);
+}
+
+// Places the billboard corner in front of the frame that was baked from the direction closest to the camera
+void DrawImpostorCorner(Vertex corner, Surface surface, Transform transform)
+{
+    vec4 inverseOrientation = vec4(-transform.orientation.xyz, transform.orientation.w);
+    vec3 camera = RotateQuat((viewData.position - transform.pos) / transform.scale, inverseOrientation);
+    vec3 viewDirection = camera - surface.center;
+    viewDirection = dot(viewDirection, viewDirection) > 0 ? normalize(viewDirection) : vec3(0, 1, 0);
+
+    vec2 cell = clamp(floor((OctahedralEncode(viewDirection) * 0.5 + 0.5) * IMPOSTOR_GRID), vec2(0), vec2(IMPOSTOR_GRID - 1));
+    vec3 direction = OctahedralDecode((cell + 0.5) / IMPOSTOR_GRID * 2 - 1);
+    vec3 right;
+    vec3 up;
+    GetImpostorAxes(direction, right, up);
+
+    vec3 position = surface.center + (right * corner.position.x + up * corner.position.y) * surface.radius;
+    vec3 modelPosition = RotateQuat(position, transform.orientation) * transform.scale + transform.pos;
+    gl_Position = viewData.projectionView * vec4(modelPosition, 1.0);
+    outModel = modelPosition;
+
+    // The rows of each frame were baked from the top of the frame down
+    outUv = (cell + vec2(0.5 + corner.position.x * 0.5, 0.5 - corner.position.y * 0.5)) / IMPOSTOR_GRID;
+
+    // The baked normals are in the space of the frame, the fragment shader rotates them with the axes of the billboard
+    outNormal = RotateQuat(direction, transform.orientation);
+    outTangent = vec4(RotateQuat(right, transform.orientation), 1);
+    outMaterialTag = surface.impostorMaterialTag;
+}
+
 void main()
 {
     // Access the current vertex
     Vertex vertex = vertexBuffer.vertices[gl_VertexIndex];
 
     // Access the current object data
-    RenderObject object = objectBuffer.objects[indirectDrawBuffer.draws[gl_DrawIDARB].objectId];
+    uint objectId = graphicsPC.instancingEnabled == 1 ? 
+    instanceBuffer.objectIds[indirectDrawBuffer.draws[gl_DrawIDARB].objectId + gl_InstanceIndex] : 
+    indirectDrawBuffer.draws[gl_DrawIDARB].objectId;
+    RenderObject object = objectBuffer.objects[objectId];
     Transform transform = transformBuffer.instances[object.meshInstanceId];
 
+    // Only the billboard level of detail indexes the vertices after the impostor vertex
+    Surface surface = surfaceBuffer.surfaces[object.surfaceId];
+    if(surface.bImpostor != 0 && uint(gl_VertexIndex) - surface.vertexOffset >= surface.impostorVertex)
+    {
+        DrawImpostorCorner(vertex, surface, transform);
+        return;
+    }
+
     // Calculate the model position by using the current transform data(the model position will be passed to the fragment shader and for gl_position)
     vec3 modelPosition = RotateQuat(vertex.position, transform.orientation) * transform.scale + transform.pos;
     // Calculate final gl_position by projecting model position to clip coordinates
@@ -31,7 +105,7 @@ void main()
     // Create a vec2 from the uvMap halfFloats to be passed to the fragment shader
     outUv = vec2(float(vertex.uvX), float(vertex.uvY));
 
-    outMaterialTag = surfaceBuffer.surfaces[object.surfaceId].materialTag;
+    outMaterialTag = surface.materialTag;
     
     // Unpack surface normals
     vec3 normal = vec3(vertex.normalX, vertex.normalY, vertex.normalZ) / 127.0 - 1.0;
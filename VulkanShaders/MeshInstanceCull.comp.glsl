@@ -0,0 +1,61 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+
+#define COMPUTE_PIPELINE
+
+#include "../VulkanShaderHeaders/ShaderBuffers.glsl"
+#include "../VulkanShaderHeaders/CullingShaderData.glsl"
+
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+// Dispatched before every render object culling shader. It frustum culls each mesh instance with the sphere of all its surfaces,
+// and expands the instances that pass to their render objects, so that the render object culling shader only tests those
+void main()
+{
+    uint instanceIndex = gl_GlobalInvocationID.x;
+
+    // The draw count of this dispatch is the mesh instance count
+    if(cullPC.drawCount <= instanceIndex)
+        return;
+
+    // The opaque passes and the post pass go over different render objects of the same instance
+    MeshInstance instance = meshInstanceBuffer.instances[instanceIndex];
+    uint firstObject = cullPC.postPass == 0 ? instance.firstOpaqueObject : instance.firstPostPassObject;
+    uint objectCount = cullPC.postPass == 0 ? instance.opaqueObjectCount : instance.postPassObjectCount;
+    if(objectCount == 0)
+        return;
+
+    Transform transform = transformBuffer.instances[instance.transformId];
+
+    // The instance sphere is in model space like the surface spheres, so it is moved to view space the same way
+    vec3 center = RotateQuat(instance.center, transform.orientation) * transform.scale + transform.pos;
+    center = (viewData.view * vec4(center, 1)).xyz;
+    float radius = instance.radius * transform.scale;
+
+    // Same frustum test as the render object culling shaders
+    bool visible = true;
+    visible = visible && center.z * viewData.frustumLeft - abs(center.x) * viewData.frustumRight > -radius;
+    visible = visible && center.z * viewData.frustumBottom - abs(center.y) * viewData.frustumTop > -radius;
+    visible = visible && center.z + radius > viewData.zNear && center.z - radius < viewData.zFar;
+
+    if(visible)
+    {
+        // Reserves a range of the expanded list for the instance's objects and grows the dispatch of the render object culling shader to cover it
+        uint expandedOffset = atomicAdd(expandedObjectBuffer.objectCount, objectCount);
+        for(uint i = 0; i < objectCount; ++i)
+            expandedObjectBuffer.objectIds[expandedOffset + i] = instanceObjectBuffer.objectIds[firstObject + i];
+
+        atomicMax(expandedObjectBuffer.groupCountX, (expandedOffset + objectCount + 63) / 64);
+    }
+    // The render objects of a culled instance are never tested, so they are marked as not visible here instead.
+    // Both opaque passes see the same frustum, so clearing them before the initial pass does not change what it draws
+    else if(cullPC.postPass == 0)
+    {
+        for(uint i = 0; i < objectCount; ++i)
+        {
+            uint objectIndex = instanceObjectBuffer.objectIds[firstObject + i];
+            atomicAnd(visibilityBuffer.visibilities[objectIndex >> 5], ~(1 << (objectIndex & 31)));
+        }
+    }
+}
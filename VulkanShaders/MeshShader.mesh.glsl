@@ -4,21 +4,27 @@
 #extension GL_EXT_mesh_shader : require
 #extension GL_ARB_shader_draw_parameters : require
 
+#define GRAPHICS_PIPELINE
+
 layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
 layout(triangles, max_vertices = 64, max_primitives = 124) out;
 
 #include "../VulkanShaderHeaders/ShaderBuffers.glsl"
 
+// All the values needed by the fragment shader, same as the vertex shader outputs
 layout(location = 0) out vec2 outUv[];
 layout(location = 1) out vec3 outNormal[];
-layout(location = 2) out uint outMaterialTag[];
-layout(location = 3) out vec3 outModel[];
+layout(location = 2) out vec4 outTangent[];
+layout(location = 3) out flat uint outMaterialTag[];
+layout(location = 4) out vec3 outModel[];
 
 taskPayloadSharedEXT MeshTaskPayload payload;
 
 void main()
 {
     uint threadId = gl_LocalInvocationID.x;
+
+    // The task shader wrote the meshlets that passed culling at the start of the payload
 	uint meshletId = payload.meshletIndices[gl_WorkGroupID.x];
 
     // Access the current object data
@@ -30,6 +36,8 @@ void main()
     uint vertexCount = uint(meshletBuffer.meshlets[meshletId].vertexCount);
 	uint triangleCount = uint(meshletBuffer.meshlets[meshletId].triangleCount);
 
+    SetMeshOutputsEXT(vertexCount, triangleCount);
+
     uint dataOffset = meshletBuffer.meshlets[meshletId].dataOffset;
 	uint vertexOffset = dataOffset;
 	uint indexOffset = dataOffset + vertexCount;
@@ -39,22 +47,28 @@ void main()
         uint vertexIndex = meshletDataBuffer.data[vertexOffset + i] + currentSurface.vertexOffset;
         Vertex currentVertex = vertexBuffer.vertices[vertexIndex];
 
-        vec3 position = currentVertex.position;
-        vec3 n = vec3(currentVertex.normalX, currentVertex.normalY, currentVertex.normalZ);
-		vec3 normal = RotateQuat(n, currentInstance.orientation);
-		vec2 uv = vec2(currentVertex.uvX, currentVertex.uvY);
+        // Same as the vertex shader
+        vec3 modelPosition = RotateQuat(currentVertex.position, currentInstance.orientation) * currentInstance.scale + currentInstance.pos;
+        gl_MeshVerticesEXT[i].gl_Position = viewData.projectionView * vec4(modelPosition, 1);
+
+        outUv[i] = vec2(float(currentVertex.uvX), float(currentVertex.uvY));
 
-        gl_MeshVerticesEXT[i].gl_Position = viewData.projectionView * 
-        vec4(RotateQuat(position, currentInstance.orientation) * currentInstance.scale + currentInstance.pos, 1);
+        vec3 normal = vec3(currentVertex.normalX, currentVertex.normalY, currentVertex.normalZ) / 127.0 - 1.0;
+        outNormal[i] = RotateQuat(normal, currentInstance.orientation);
 
-        outNormal[i] = normal;
+        vec4 tangent = vec4(currentVertex.tangentX, currentVertex.tangentY, currentVertex.tangentZ, currentVertex.tangentW) / 127.0 - 1.0;
+        tangent.xyz = RotateQuat(tangent.xyz, currentInstance.orientation);
+        outTangent[i] = tangent;
+
+        outMaterialTag[i] = currentSurface.materialTag;
+
+        outModel[i] = modelPosition;
     }
 
+    // Each triangle is packed in one integer by GenerateClusters, with its 3 local vertex indices in the 3 low bytes
     for(uint i = threadId; i < triangleCount; i += 64)
     {
         uint triangle = meshletDataBuffer.data[indexOffset + i];
         gl_PrimitiveTriangleIndicesEXT[i] = uvec3((triangle >> 16) & 0xff, (triangle >> 8) & 0xff, triangle & 0xff);
     }
-
-    SetMeshOutputsEXT(vertexCount, triangleCount);
-}
\ No newline at end of file
+}
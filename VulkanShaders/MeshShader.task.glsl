@@ -4,30 +4,130 @@
 #extension GL_GOOGLE_include_directive: require
 #extension GL_ARB_shader_draw_parameters : require
 
+#define GRAPHICS_PIPELINE
+
 layout (local_size_x = 32, local_size_y = 1, local_size_z = 1) in;
 
 #include "../VulkanShaderHeaders/ShaderBuffers.glsl"
 
+// Same push constant as the vertex shader. The task shader reads the culling flags
+layout(push_constant) uniform GraphicsConstants
+{
+    uint instancingEnabled;
+
+    // Only set after the depth pyramid has been generated for this frame
+    uint occlusionEnabled;
+
+    // Transparent objects can show their back faces, so their meshlets are not cone culled
+    uint postPass;
+
+    // Clusters are selected from the hierarchy by their projected error. When it is 0, only the clusters of the full surface are drawn
+    uint lodEnabled;
+}graphicsPC;
+
+layout (set = 0, binding = 3) uniform sampler2D depthPyramid;
+
 taskPayloadSharedEXT MeshTaskPayload payload;
 
-bool coneCull(vec4 cone, vec3 view)
+// Counts the meshlets of the workgroup that passed culling, each one is written to the payload at the index it got from this
+shared uint visibleMeshletCount;
+
+// Returns true if every triangle of the meshlet is facing away from the camera. The meshlet is in view space, so the camera is at the origin
+bool coneCull(vec3 center, float radius, vec3 coneAxis, float coneCutoff)
+{
+	return dot(center, coneAxis) >= coneCutoff * length(center) + radius;
+}
+
+// Projects the error from the distance to the sphere, the same way as the LOD selection of the culling shaders
+bool IsErrorUnderTarget(vec3 center, float radius, float error, Transform transform, float target)
 {
-	return dot(cone.xyz, view) > cone.w;
+    center = RotateQuat(center, transform.orientation) * transform.scale + transform.pos;
+    center = (viewData.view * vec4(center, 1)).xyz;
+    float distance = max(length(center) - radius * transform.scale, viewData.zNear);
+    return error * transform.scale / distance <= target;
 }
 
 void main()
 {
     uint threadIndex = gl_LocalInvocationID.x;
-	uint meshletGroupIndex = gl_WorkGroupID.x;
 
-	uint drawId = indirectDrawBuffer.draws[gl_DrawIDARB].objectId;
-    RenderObject currentObject = objectBuffer.objects[drawId];
-	Transform meshDraw = transformBuffer.instances[currentObject.meshInstanceId];
-    Surface currentSurface = surfaceBuffer.surfaces[currentObject.surfaceId];
+    // The task command was written by the culling shader, it holds the object and the meshlet range of its selected LOD
+    IndirectTask task = indirectTaskBuffer.tasks[gl_DrawIDARB];
+    uint localMeshletIndex = gl_WorkGroupID.x * 32 + threadIndex;
+    uint meshletIndex = task.firstMeshlet + localMeshletIndex;
+
+    RenderObject object = objectBuffer.objects[task.objectId];
+    Transform transform = transformBuffer.instances[object.meshInstanceId];
+
+    if(threadIndex == 0)
+        visibleMeshletCount = 0;
+    barrier();
+
+    // The last workgroup of an object can have threads past its meshlet count
+    bool visible = localMeshletIndex < task.meshletCount;
+    if(visible)
+    {
+        Meshlet meshlet = meshletBuffer.meshlets[meshletIndex];
 
-    uint meshletIndex = meshletGroupIndex * 32 + threadIndex + indirectTaskBuffer.tasks[gl_DrawIDARB].taskId;
+        // A cluster of the hierarchy is drawn when its error is under the target and the error of the group that replaced it is not.
+        // Siblings have the same parent error and sphere, and errors grow toward the roots, so the clusters make one cut without cracks.
+        // Without LODs the target is 0 and only the clusters of the full surface pass. Roots and meshlets outside a hierarchy have 
+        // the largest float as their parent error, so they are never replaced
+        float lodTarget = graphicsPC.lodEnabled == 1 ? viewData.lodTarget : 0;
+        visible = IsErrorUnderTarget(meshlet.lodCenter, meshlet.lodRadius, meshlet.error, transform, lodTarget) && 
+            !IsErrorUnderTarget(meshlet.parentCenter, meshlet.parentRadius, meshlet.parentError, transform, lodTarget);
 
-    payload.drawId = drawId;
-    payload.meshletIndices[threadIndex] = meshletIndex;
-    EmitMeshTasksEXT(32, 1, 1);
-}
\ No newline at end of file
+        // The meshlet bounding sphere is promoted to view space the same way as the surface bounding sphere in the culling shaders
+        vec3 center = RotateQuat(meshlet.center, transform.orientation) * transform.scale + transform.pos;
+        center = (viewData.view * vec4(center, 1)).xyz;
+        float radius = meshlet.radius * transform.scale;
+
+        // Same frustum culling test as the culling shaders
+        visible = visible && center.z * viewData.frustumLeft - abs(center.x) * viewData.frustumRight > -radius;
+        visible = visible && center.z * viewData.frustumBottom - abs(center.y) * viewData.frustumTop > -radius;
+        visible = visible && center.z + radius > viewData.zNear && center.z - radius < viewData.zFar;
+
+        // The cone axis is rotated with the object and then moved to view space
+        if(visible && graphicsPC.postPass == 0)
+        {
+            vec3 coneAxis = vec3(int(meshlet.cone_axis[0]) / 127.0, int(meshlet.cone_axis[1]) / 127.0, int(meshlet.cone_axis[2]) / 127.0);
+            coneAxis = mat3(viewData.view) * RotateQuat(coneAxis, transform.orientation);
+            float coneCutoff = int(meshlet.cone_cutoff) / 127.0;
+
+            visible = !coneCull(center, radius, coneAxis, coneCutoff);
+        }
+
+        // Same occlusion culling test as the late culling shader, but for the meshlet's sphere
+        if(visible && graphicsPC.occlusionEnabled == 1)
+        {
+            vec4 aabb;
+            if (projectSphere(center, radius, viewData.zNear, viewData.proj0, viewData.proj5, aabb))
+            {
+                float width = (aabb.z - aabb.x) * viewData.pyramidWidth;
+                float height = (aabb.w - aabb.y) * viewData.pyramidHeight;
+
+                float level = floor(log2(max(width, height)));
+
+                float depth = textureLod(depthPyramid, (aabb.xy + aabb.zw) * 0.5, level).x;
+
+                float depthSphere = viewData.zNear / (center.z - radius);
+
+                visible = depthSphere > depth;
+            }
+        }
+    }
+
+    // The meshlets that passed are compacted at the start of the payload, so that only they get a mesh shader workgroup
+    if(visible)
+    {
+        uint payloadIndex = atomicAdd(visibleMeshletCount, 1);
+        payload.meshletIndices[payloadIndex] = meshletIndex;
+    }
+
+    if(threadIndex == 0)
+        payload.drawId = task.objectId;
+
+    barrier();
+
+    EmitMeshTasksEXT(visibleMeshletCount, 1, 1);
+}
@@ -28,18 +28,24 @@ namespace BlitzenGL
     uint8_t OpenglRenderer::UploadTexture(BlitzenEngine::DDS_HEADER& header, BlitzenEngine::DDS_HEADER_DXT10& header10, 
     const char* filepath) 
     {
-        if(m_textureCount >= BLIT_MAX_TEXTURE_COUNT)
+        if(m_textures.GetSize() >= BLIT_MAX_TEXTURE_COUNT)
             return 0;
         
-        BlitCL::StoragePointer<uint8_t, BlitzenCore::AllocationType::SmartPointer> store(128 * 1024 * 1024);
+        // The headers give the exact size of the image data, so the storage is not bigger than it needs to be
+        BlitzenEngine::DDSTextureProbe probe;
+        probe.filepath = filepath;
+        if(!BlitzenEngine::ProbeDDSImage(probe, BlitzenEngine::RendererToLoadDDS::Opengl))
+            return 0;
+        header = probe.header;
+        header10 = probe.header10;
 
-        // This is a consequence of having a shared Load image function with Vulkan
-        unsigned int placeholder = 0;
-        if(BlitzenEngine::LoadDDSImage(filepath, header, header10, placeholder, BlitzenEngine::RendererToLoadDDS::Opengl, store.Data()))
+        BlitCL::StoragePointer<uint8_t, BlitzenCore::AllocationType::SmartPointer> store(probe.imageSize);
+        if(BlitzenEngine::ReadDDSImageData(probe, store.Data()))
         {
             // Create and bind the texture
-            glGenTextures(1, &m_textures[m_textureCount]);
-            glBindTexture(GL_TEXTURE_2D, m_textures[m_textureCount]);
+            GlTexture texture;
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
 
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -51,8 +57,7 @@ namespace BlitzenGL
             header.dwHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, store.Data());
             glGenerateMipmap(GL_TEXTURE_2D);
 
-            // Increment the texture count and generate mipmaps
-            m_textureCount++;
+            m_textures.PushBack(texture);
             return 1;
         }
         else
@@ -83,7 +88,7 @@ namespace BlitzenGL
         // Creates the indirect draw buffer. It will be as big as the draw count. It will initially be empty but it will be filled by the culling shaders
         glGenBuffers(1, &m_indirectDrawBuffer);
         glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectDrawBuffer);
-        glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(IndirectDrawCommand) * pResources->renderObjectCount, nullptr,  GL_STATIC_DRAW);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(IndirectDrawCommand) * pResources->renders.GetSize(), nullptr,  GL_STATIC_DRAW);
         glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
         // Binds the indirect draw buffer as an SSBO, so that it can be accessed by the culling shaders
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_indirectDrawBuffer);
@@ -110,14 +115,16 @@ namespace BlitzenGL
         // Creates the render object buffer as a storage buffer and passes it to binding 3
         glGenBuffers(1, &m_renderObjectBuffer);
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_renderObjectBuffer);
-        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(BlitzenEngine::RenderObject) * pResources->renderObjectCount, pResources->renders, GL_STATIC_READ);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(BlitzenEngine::RenderObject) * pResources->renders.GetSize(), pResources->renders.Data(), GL_STATIC_READ);
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_renderObjectBuffer);
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
         // Creates the material buffer as a storage buffer and passes it binding 4
         glGenBuffers(1, &m_materialBuffer);
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_materialBuffer);
-        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(BlitzenEngine::Material) * pResources->materialCount, pResources->materials, GL_STATIC_READ);
+        BlitCL::DynamicArray<BlitzenEngine::Material> materials(pResources->materials.GetSize());
+        pResources->materials.CopyTo(materials.Data());
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(BlitzenEngine::Material) * materials.GetSize(), materials.Data(), GL_STATIC_READ);
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, m_materialBuffer);
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
@@ -100,9 +100,7 @@ namespace BlitzenGL
         // Holds all the render objects that will be retrieved in the shaders to access the surface and transform data for each object
         GlBuffer m_renderObjectBuffer;
 
-        GlTexture m_textures[BLIT_MAX_TEXTURE_COUNT];
-
-        uint32_t m_textureCount = 0;
+        BlitCL::DynamicArray<GlTexture> m_textures;
     };
 
     uint8_t CompileShader(GlShader& shader, GLenum shaderType, const char* filepath);
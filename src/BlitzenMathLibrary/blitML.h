@@ -34,9 +34,11 @@ namespace BlitML
     inline float Tan(float x) {return tanf(x);}
     inline float Acos(float x) {return acosf(x);}
     inline float Sqrt(float x) {return sqrtf(x);}
+    inline float Exp2(float x) {return exp2f(x);}
     inline float Abs(float x) {return fabsf(x);}
     inline float Max(float x, float y) { return (x > y) ? x : y; }
     inline uint32_t Max(uint32_t x, uint32_t y) { return (x > y) ? x : y; }
+    inline float Min(float x, float y) { return (x < y) ? x : y; }
 
     inline uint8_t IsPowerOf2(uint64_t value) { return (value != 0) && ((value & (value - 1)) == 0); }
 
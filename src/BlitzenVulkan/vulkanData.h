@@ -11,6 +11,8 @@
 #include "Renderer/blitRenderingResources.h"
 #include "Game/blitObject.h"
 
+#include <atomic>
+
 // My math library seems to be fine now but I am keeping this to compare values when needed
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
@@ -47,7 +49,7 @@
 #endif
 
 #ifdef  BLIT_VK_MESH_EXT
-    #define BLITZEN_VULKAN_MESH_SHADER              1 // Mesh shaders do not work at the moment, do not activate them
+    #define BLITZEN_VULKAN_MESH_SHADER              1 // Meshlets are generated and the mesh shading pipelines are created if the device supports them
 #else
     #define BLITZEN_VULKAN_MESH_SHADER              0 
 #endif
@@ -55,12 +57,34 @@
 
 #define BLITZEN_VULKAN_ENABLED_EXTENSION_COUNT     2 + BLITZEN_VULKAN_VALIDATION_LAYERS
 
+// The average GPU frame time is logged after this many frames
+#define BLITZEN_VULKAN_GPU_TIME_LOG_INTERVAL        256
+
+// Bulk texture uploads are split in batches that fit this much staging memory. A single bigger texture gets a pool of its own size
+#define BLITZEN_VULKAN_TEXTURE_STAGING_POOL_SIZE    (64ull * 1024 * 1024)
+// Texture data in the staging pool starts at multiples of this, the biggest compressed block size
+#define BLITZEN_VULKAN_TEXTURE_STAGING_ALIGNMENT    16
+
+// Texture levels up to this size are uploaded when the texture is loaded. The levels above them are streamed in once the surfaces 
+// that use the texture are big enough on screen
+#define BLITZEN_VULKAN_TEXTURE_MIP_TAIL_SIZE        128
+// Video memory that the streamed levels can take. The textures that were not seen for the longest go back to their mip tail first
+#define BLITZEN_VULKAN_TEXTURE_STREAMING_BUDGET     (512ull * 1024 * 1024)
+// Textures whose levels are being read at the same time. The reads that finished are uploaded together at the start of a frame
+#define BLITZEN_VULKAN_TEXTURE_STREAMING_MAX_READS  8
+// How much the minimum LOD of a texture drops each frame after levels were added to it, so that the new detail fades in
+#define BLITZEN_VULKAN_TEXTURE_LOD_FADE_STEP        0.125f
+
 namespace BlitzenVulkan
 {
     struct VulkanStats
     {
         uint8_t hasDiscreteGPU = 0;// If a discrete GPU is found, it will be chosen
         uint8_t meshShaderSupport = 0;
+
+        // The GPU frame time is measured with timestamps when supported. The period is the nanoseconds per timestamp tick
+        uint8_t timestampSupport = 0;
+        float timestampPeriod = 1.f;
     };
 
     // Holds the command struct for a call to vkCmdDrawIndexedIndirectCount, as well as a draw Id to access the correct RenderObject
@@ -70,13 +94,47 @@ namespace BlitzenVulkan
         VkDrawIndexedIndirectCommand drawIndirect;// 5 32bit integers
     };
 
-    // Holds the command structu for a call to vkCmdDrawMeshTasksIndirectCountExt, as well as a task Id to access the correct task
+    // Holds the command struct for a call to vkCmdDrawMeshTasksIndirectCountEXT, as well as the object and the meshlet range of its LOD.
+    // Each task shader workgroup culls 32 meshlets of the range
     struct IndirectTaskData
     {
-        uint32_t taskId;
+        uint32_t objectId;
+        uint32_t firstMeshlet;
+        uint32_t meshletCount;
         VkDrawMeshTasksIndirectCommandEXT drawIndirectTasks;// 3 32bit integers
     };
 
+    // When instancing is enabled, there is one of these for each surface and LOD combination.
+    // It counts the visible objects that selected it and holds the offset of their range in the instance buffer
+    struct InstanceBucket
+    {
+        uint32_t instanceCount;
+        uint32_t instanceOffset;
+    };
+
+    // An object that passed culling while instancing is enabled, waiting to be written to its bucket's range of the instance buffer
+    struct VisibleInstance
+    {
+        uint32_t objectId;
+        uint32_t bucketId;
+        uint32_t localIndex;
+    };
+
+    // Counters used by the instancing shaders, the visible instance list size and the instance buffer elements that have been reserved
+    struct InstancingCounters
+    {
+        uint32_t visibleCount;
+        uint32_t instanceTotal;
+    };
+
+    // The start of the expanded object buffer. The render object culling shader is dispatched indirectly with the command,
+    // and it goes over the object count elements that are written after this header by the mesh instance culling shader
+    struct ExpandedObjectHeader
+    {
+        VkDispatchIndirectCommand dispatchCommand;
+        uint32_t objectCount;
+    };
+
     // This is the way Vulkan image resoureces are represented by the Blitzen VulkanRenderer
     struct AllocatedImage
     {
@@ -114,8 +172,43 @@ namespace BlitzenVulkan
 
         uint8_t bPostPass;
 
-        inline DrawCullShaderPushConstant(uint32_t dc, uint8_t bPP, uint8_t bOC = 1, uint8_t bLod = 1)
-        :drawCount{dc}, bPostPass{bPP}, bOcclusionCulling{bOC}, bLOD{bLod} {}
+        uint8_t bInstancing;
+
+        // Visible objects get an indirect task command instead of an indirect draw command
+        uint8_t bMeshShading;
+
+        inline DrawCullShaderPushConstant(uint32_t dc, uint8_t bPP, uint8_t bOC = 1, uint8_t bLod = 1, uint8_t bInst = 0, uint8_t bMesh = 0)
+        :drawCount{dc}, bPostPass{bPP}, bOcclusionCulling{bOC}, bLOD{bLod}, bInstancing{bInst}, bMeshShading{bMesh} {}
+    };
+
+    // Pushed to the graphics pipelines. The vertex shader reads the instancing flag and the task shader reads the rest
+    struct GraphicsShaderPushConstant
+    {
+        uint32_t bInstancing;
+
+        // The task shader tests meshlets against the depth pyramid, only after it has been generated for this frame
+        uint32_t bOcclusionCulling;
+
+        // Meshlet cone culling is skipped for transparent objects, since their back faces can be seen
+        uint32_t bPostPass;
+
+        // The task shader selects the clusters of the hierarchy by their projected error. Without it only the full surface is drawn
+        uint32_t bLOD;
+    };
+
+    // An array that the renderer holds a copy of, with the ranges that changed since the last frame.
+    // Packed data holds the elements of each range one after the other instead of the whole array, 
+    // for data that the engine only keeps for the frame it is added (streamed geometry).
+    // Moves are copies inside the buffer (compaction of the geometry heaps), done before the ranges are uploaded
+    struct BufferUpdate
+    {
+        void* pData = nullptr;
+        BlitzenEngine::BufferUpdateRange* pRanges = nullptr;
+        uint32_t rangeCount = 0;
+        uint8_t bPacked = 0;
+
+        BlitzenEngine::BufferMoveRange* pMoves = nullptr;
+        uint32_t moveCount = 0;
     };
 
     // The data needed for Vulkan to draw the frame, passed to draw frame function
@@ -128,8 +221,35 @@ namespace BlitzenVulkan
         uint8_t bOcclusionCulling;
         uint8_t bLOD;
 
-        inline DrawContext(void* pCam, uint32_t dc, uint8_t bOC = 1, uint8_t bLod = 1) 
-        : pCamera(pCam), drawCount(dc), bOcclusionCulling{bOC}, bLOD{bLod} {}
+        // Groups visible objects with the same surface and LOD into a single instanced draw. Ignored when mesh shaders are used
+        uint8_t bInstancing;
+
+        // Draws with the task and mesh shaders instead of the vertex shader. Ignored if the device does not support them
+        uint8_t bMeshShading;
+
+        // Render objects and mesh instances can be added and removed at runtime, so their counts can change every frame
+        uint32_t opaqueObjectCount = 0;
+        uint32_t meshInstanceCount = 0;
+
+        // Surfaces are added when scenes are streamed in, the instance buckets follow their count
+        uint32_t surfaceCount = 0;
+
+        // The parts of the scene that changed since the last frame
+        BufferUpdate transformUpdate;
+        BufferUpdate renderObjectUpdate;
+        BufferUpdate meshInstanceUpdate;
+        BufferUpdate instanceObjectUpdate;
+
+        // Geometry and materials of streamed scenes, appended after what the buffers already hold
+        BufferUpdate vertexUpdate;
+        BufferUpdate indexUpdate;
+        BufferUpdate meshletUpdate;
+        BufferUpdate meshletDataUpdate;
+        BufferUpdate surfaceUpdate;
+        BufferUpdate materialUpdate;
+
+        inline DrawContext(void* pCam, uint32_t dc, uint8_t bOC = 1, uint8_t bLod = 1, uint8_t bInst = 0, uint8_t bMesh = 0) 
+        : pCamera(pCam), drawCount(dc), bOcclusionCulling{bOC}, bLOD{bLod}, bInstancing{bInst}, bMeshShading{bMesh} {}
     };
 
     // This struct will be passed to the GPU as uniform descriptor and will give shaders access to the global storage buffers
@@ -166,7 +286,7 @@ namespace BlitzenVulkan
         // It is accessed by the culling compute shaders to be setup before drawing
         VkDeviceAddress indirectCountBufferAddress;
 
-        // Holds the address of the buffer that holds an integer for the previous frame visibility of every object in the scene. 
+        // Holds the address of the buffer that holds a bit for the previous frame visibility of every object in the scene. 
         // Accessed by the culling compute shaders
         VkDeviceAddress visibilityBufferAddress;
     };
@@ -178,6 +298,63 @@ namespace BlitzenVulkan
         VkSampler sampler;
     };
 
+    enum class TextureMipReadState : uint8_t
+    {
+        Idle = 0,
+        Reading = 1,
+        Done = 2,
+        Failed = 3
+    };
+
+    // A texture that was loaded with its mip tail only. The image holds the levels from the resident level to the last one, 
+    // so its first level is the resident level of the file
+    struct StreamedTextureMips
+    {
+        uint32_t textureTag;
+        std::string filepath;
+
+        // Where the first level of the file starts and its extent
+        size_t imageOffset;
+        VkExtent3D extent;
+        VkFormat format;
+
+        uint32_t mipLevels;
+        uint32_t tailLevel;
+        uint32_t residentLevel;
+
+        // The first level that can be streamed in. Raised when a read fails, so that the file is not read again every frame
+        uint32_t topLevel = 0;
+
+        // The level that the biggest object that used the texture last needed, and the frame it was seen at
+        uint32_t desiredLevel;
+        uint32_t lastUsedFrame = 0;
+
+        // The levels from the requested level to the resident level, read on the texture IO threads
+        BlitzenPlatform::AsyncFile file;
+        uint8_t* pReadData = nullptr;
+        size_t readSize = 0;
+        uint32_t requestedLevel;
+        std::atomic<TextureMipReadState> readState{TextureMipReadState::Idle};
+    };
+
+    // A write to the texture descriptor table that waits until the frames that might still read the slot are done.
+    // When a texture is unloaded, the write points its slot back to the first texture and its image and tag are given back with it.
+    // Updates without an image view write nothing, they only destroy the retired image (the old images of streamed textures)
+    struct TextureDescriptorUpdate
+    {
+        uint32_t textureTag;
+        VkImageView imageView;
+        VkSampler sampler;
+
+        // Written by the first frame with this number or a later one, once its fence is signaled
+        uint64_t readyFrame;
+
+        VkImage retiredImage = VK_NULL_HANDLE;
+        VkImageView retiredImageView = VK_NULL_HANDLE;
+        VmaAllocation retiredAllocation = VK_NULL_HANDLE;
+        uint8_t bReleaseTag = 0;
+    };
+
 }
 
 
@@ -378,9 +378,9 @@ namespace BlitzenVulkan
             features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
             // Add Vulkan 1.3 features to the pNext chain
             features12.pNext = &features13;
-            VkPhysicalDeviceMeshShaderFeaturesNV featuresMesh{};
-            featuresMesh.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_NV;
-            // Add Nvidia mesh shader features to the pNext chain
+            VkPhysicalDeviceMeshShaderFeaturesEXT featuresMesh{};
+            featuresMesh.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+            // Add mesh shader features to the pNext chain
             features13.pNext = &featuresMesh;
             vkGetPhysicalDeviceFeatures2(pdv, &features2);
 
@@ -391,6 +391,8 @@ namespace BlitzenVulkan
             !features12.storageBuffer8BitAccess || !features12.shaderFloat16 || !features12.drawIndirectCount ||
             !features12.samplerFilterMinmax || !features12.shaderInt8 || !features12.shaderSampledImageArrayNonUniformIndexing ||
             !features12.uniformAndStorageBuffer8BitAccess || !features12.storagePushConstant8 ||
+            !features12.descriptorBindingSampledImageUpdateAfterBind || !features12.descriptorBindingPartiallyBound ||
+            !features12.descriptorBindingUpdateUnusedWhilePending ||
             !features13.synchronization2 || !features13.dynamicRendering || !features13.maintenance4)
             {
                 physicalDevices.RemoveAtIndex(i);
@@ -428,6 +430,23 @@ namespace BlitzenVulkan
                 continue;
             }
 
+            // The culling shaders pack the visibility of each object in a bitfield, which is written with subgroup ballot operations.
+            // The instance bucket compaction shader also uses subgroup arithmetic for its prefix sum
+            VkPhysicalDeviceSubgroupProperties subgroupProps{};
+            subgroupProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+            VkPhysicalDeviceProperties2 props2{};
+            props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            props2.pNext = &subgroupProps;
+            vkGetPhysicalDeviceProperties2(pdv, &props2);
+            if(!(subgroupProps.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) || 
+            !(subgroupProps.supportedOperations & VK_SUBGROUP_FEATURE_BALLOT_BIT) || 
+            !(subgroupProps.supportedOperations & VK_SUBGROUP_FEATURE_ARITHMETIC_BIT))
+            {
+                physicalDevices.RemoveAtIndex(i);
+                --i;
+                continue;
+            }
+
             //Retrieve queue families from device
             uint32_t queueFamilyPropertyCount = 0;
             vkGetPhysicalDeviceQueueFamilyProperties2(pdv, &queueFamilyPropertyCount, nullptr);
@@ -506,6 +525,13 @@ namespace BlitzenVulkan
         else
             BLIT_INFO("Discrete GPU found")
 
+        // The timestamp period is needed to read the GPU frame time. If the device cannot write timestamps on graphics and compute queues,
+        // the frame time is simply never logged
+        VkPhysicalDeviceProperties chosenProps{};
+        vkGetPhysicalDeviceProperties(initHandles.chosenGpu, &chosenProps);
+        stats.timestampPeriod = chosenProps.limits.timestampPeriod;
+        stats.timestampSupport = chosenProps.limits.timestampComputeAndGraphics;
+
         // If the function has reached this point, it means it found a physical device
         return 1;
     }
@@ -589,6 +615,11 @@ namespace BlitzenVulkan
         // Allows shaders to use array with undefined size for descriptors, needed for textures
         vulkan12Features.runtimeDescriptorArray = true;
 
+        // The texture descriptor table is written while it is bound, for the slots that the frames in flight do not sample
+        vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = true;
+        vulkan12Features.descriptorBindingUpdateUnusedWhilePending = true;
+        vulkan12Features.descriptorBindingPartiallyBound = true;
+
         // Allows the use of float16_t type in the shaders
         vulkan12Features.shaderFloat16 = true;
 
@@ -626,7 +657,7 @@ namespace BlitzenVulkan
         vulkan13Features.maintenance4 = true;
 
         VkPhysicalDeviceMeshShaderFeaturesEXT vulkanFeaturesMesh{};
-        vulkanFeaturesMesh.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_NV;
+        vulkanFeaturesMesh.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
         #if BLITZEN_VULKAN_MESH_SHADER
             if(stats.meshShaderSupport)
             {
@@ -961,6 +992,8 @@ namespace BlitzenVulkan
             VkResult commandBufferResult = vkAllocateCommandBuffers(m_device, &commandBuffersInfo, &(frameTools.commandBuffer));
             if(commandBufferResult != VK_SUCCESS)
                 return 0;
+            if(vkAllocateCommandBuffers(m_device, &commandBuffersInfo, &(frameTools.textureStreamingCommandBuffer)) != VK_SUCCESS)
+                return 0;
 
             // Creates the fence that stops the CPU from acquiring a new swapchain image before the GPU is done with the previous frame
             VkResult fenceResult = vkCreateFence(m_device, &fenceInfo, m_pCustomAllocator, &(frameTools.inFlightFence));
@@ -976,8 +1009,27 @@ namespace BlitzenVulkan
             VkResult presentSemaphoreResult = vkCreateSemaphore(m_device, &semaphoresInfo, m_pCustomAllocator, &(frameTools.readyToPresentSemaphore));
             if(presentSemaphoreResult != VK_SUCCESS)
                 return 0;
+
+            // Creates the query pool that holds the timestamps written at the start and the end of the frame
+            if(m_stats.timestampSupport)
+            {
+                VkQueryPoolCreateInfo queryPoolInfo{};
+                queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+                queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+                queryPoolInfo.queryCount = 2;
+                VkResult queryPoolResult = vkCreateQueryPool(m_device, &queryPoolInfo, m_pCustomAllocator, &(frameTools.timestampQueryPool));
+                if(queryPoolResult != VK_SUCCESS)
+                    return 0;
+            }
         }
 
+        // Streamed textures are recorded to their own command buffer, which is not tied to a frame in flight
+        if(vkCreateCommandPool(m_device, &commandPoolsInfo, m_pCustomAllocator, &m_textureUploadCommandPool) != VK_SUCCESS)
+            return 0;
+        commandBuffersInfo.commandPool = m_textureUploadCommandPool;
+        if(vkAllocateCommandBuffers(m_device, &commandBuffersInfo, &m_textureUploadCommandBuffer) != VK_SUCCESS)
+            return 0;
+
         return 1;
     }
 
@@ -987,6 +1039,21 @@ namespace BlitzenVulkan
         // Wait for the device to finish its work before destroying resources
         vkDeviceWaitIdle(m_device);
 
+        // The texture reads write to the streaming state, so they need to be done before it is freed
+        ShutdownTextureStreaming();
+
+        // Images of unloaded textures that were still waiting for the frames in flight
+        for(size_t i = 0; i < m_textureDescriptorUpdates.GetSize(); ++i)
+        {
+            TextureDescriptorUpdate& update = m_textureDescriptorUpdates[i];
+            if(update.retiredImage != VK_NULL_HANDLE)
+            {
+                vmaDestroyImage(m_allocator, update.retiredImage, update.retiredAllocation);
+                vkDestroyImageView(m_device, update.retiredImageView, nullptr);
+            }
+        }
+        vkDestroyCommandPool(m_device, m_textureUploadCommandPool, m_pCustomAllocator);
+
         vkDestroySampler(m_device, m_placeholderSampler, m_pCustomAllocator);
 
         // Destroys the resources used for the texture descriptors
@@ -998,9 +1065,17 @@ namespace BlitzenVulkan
         vkDestroyPipeline(m_device, m_lateDrawCullPipeline, m_pCustomAllocator);
         vkDestroyPipelineLayout(m_device, m_drawCullPipelineLayout, m_pCustomAllocator);
         vkDestroyPipeline(m_device, m_initialDrawCullPipeline, m_pCustomAllocator);
+        vkDestroyPipeline(m_device, m_instanceBucketCompactionPipeline, m_pCustomAllocator);
+        vkDestroyPipeline(m_device, m_instanceScatterPipeline, m_pCustomAllocator);
+        vkDestroyPipeline(m_device, m_meshInstanceCullPipeline, m_pCustomAllocator);
 
         vkDestroyPipeline(m_device, m_opaqueGeometryPipeline, m_pCustomAllocator);
         vkDestroyPipeline(m_device, m_postPassGeometryPipeline, m_pCustomAllocator);
+        if(m_stats.meshShaderSupport)
+        {
+            vkDestroyPipeline(m_device, m_opaqueMeshShaderPipeline, m_pCustomAllocator);
+            vkDestroyPipeline(m_device, m_postPassMeshShaderPipeline, m_pCustomAllocator);
+        }
         vkDestroyPipelineLayout(m_device, m_opaqueGeometryPipelineLayout, m_pCustomAllocator);
 
         vkDestroyPipeline(m_device, m_depthPyramidGenerationPipeline, m_pCustomAllocator);
@@ -1019,10 +1094,15 @@ namespace BlitzenVulkan
             VarBuffers& varBuffers = m_varBuffers[i];
 
             vkDestroyCommandPool(m_device, frameTools.mainCommandPool, m_pCustomAllocator);
+            if(frameTools.mipStaging.buffer != VK_NULL_HANDLE)
+                vmaDestroyBuffer(m_allocator, frameTools.mipStaging.buffer, frameTools.mipStaging.allocation);
 
             vkDestroyFence(m_device, frameTools.inFlightFence, m_pCustomAllocator);
             vkDestroySemaphore(m_device, frameTools.imageAcquiredSemaphore, m_pCustomAllocator);
             vkDestroySemaphore(m_device, frameTools.readyToPresentSemaphore, m_pCustomAllocator);
+
+            if(m_stats.timestampSupport)
+                vkDestroyQueryPool(m_device, frameTools.timestampQueryPool, m_pCustomAllocator);
         }
 
         vkDestroySwapchainKHR(m_device, m_initHandles.swapchain, m_pCustomAllocator);
@@ -9,24 +9,16 @@ namespace BlitzenVulkan
     uint8_t CreateShaderProgram(const VkDevice& device, const char* filepath, VkShaderStageFlagBits shaderStage, const char* entryPointName, 
     VkShaderModule& shaderModule, VkPipelineShaderStageCreateInfo& pipelineShaderStage, VkSpecializationInfo* pSpecializationInfo /*=nullptr*/)
     {
-        // Tries to open the file with the provided path
-        BlitzenPlatform::FileHandle handle;
-        if(!handle.Open(filepath, BlitzenPlatform::FileModes::Read, 1))
+        // Maps the shader code instead of copying it, the view is page aligned so it can be passed to Vulkan as is
+        BlitzenPlatform::MappedFile file;
+        if(!file.Open(filepath, BlitzenPlatform::MappedFileAccess::Sequential))
             return 0;
-        
-        // Reads the shader code in byte format
-        size_t filesize = 0;
-        BlitCL::StoragePointer<uint8_t, BlitzenCore::AllocationType::String> pBytes;
-        if(!BlitzenPlatform::FilesystemReadAllBytes(handle, pBytes, &filesize))
-        {
-            return 0;
-        }
 
         //Wraps the code in a shader module object
         VkShaderModuleCreateInfo shaderModuleInfo{};
         shaderModuleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        shaderModuleInfo.codeSize = static_cast<uint32_t>(filesize);
-        shaderModuleInfo.pCode = reinterpret_cast<uint32_t*>(pBytes.Data());
+        shaderModuleInfo.codeSize = file.GetSize();
+        shaderModuleInfo.pCode = reinterpret_cast<const uint32_t*>(file.Data());
         VkResult res = vkCreateShaderModule(device, &shaderModuleInfo, nullptr, &shaderModule);
         if(res != VK_SUCCESS)
             return 0;
@@ -203,12 +195,17 @@ namespace BlitzenVulkan
     }
 
     VkDescriptorSetLayout CreateDescriptorSetLayout(VkDevice device, uint32_t bindingCount, VkDescriptorSetLayoutBinding* pBindings, 
-    VkDescriptorSetLayoutCreateFlags flags /* = 0 */)
+    VkDescriptorSetLayoutCreateFlags flags /* = 0 */, const VkDescriptorBindingFlags* pBindingFlags /* = nullptr */)
     {
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+        bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        bindingFlagsInfo.bindingCount = bindingCount;
+        bindingFlagsInfo.pBindingFlags = pBindingFlags;
+
         VkDescriptorSetLayoutCreateInfo info{};
         info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
         info.flags = flags;
-        info.pNext = nullptr;
+        info.pNext = pBindingFlags ? &bindingFlagsInfo : nullptr;
         info.bindingCount = bindingCount;
         info.pBindings = pBindings;
 
@@ -229,7 +226,7 @@ namespace BlitzenVulkan
 
 
 
-    uint8_t VulkanRenderer::SetupMainGraphicsPipeline()
+    uint8_t VulkanRenderer::SetupMainGraphicsPipeline(uint8_t bImpostors)
     {
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -246,57 +243,35 @@ namespace BlitzenVulkan
         dynamicRenderingInfo.depthAttachmentFormat = VK_FORMAT_D32_SFLOAT;
         pipelineInfo.pNext = &dynamicRenderingInfo;
 
-        // Loading the vertex shader code (or mesh shading shader if mesh shading is used)
+        // Loading the vertex shader code. The vertex shader pipelines are always created, even if the mesh shading ones are as well
         VkShaderModule vertexShaderModule;
         VkPipelineShaderStageCreateInfo shaderStages[3] = {};
-        // Create the mesh shader program for vertex shader if mesh shaders are requested and supported
-        if(m_stats.meshShaderSupport)
-        {
-            if(!CreateShaderProgram(m_device, "VulkanShaders/MeshShader.mesh.glsl.spv", VK_SHADER_STAGE_MESH_BIT_EXT, "main", vertexShaderModule, 
-            shaderStages[0]))
-                return 0;
-        }
-        // Create the vertex shader program for vertex processing if mesh shaders were not requested or not supported
-        else
-        {
-            if(!CreateShaderProgram(m_device, "VulkanShaders/MainObjectShader.vert.glsl.spv", VK_SHADER_STAGE_VERTEX_BIT, "main", vertexShaderModule,
-            shaderStages[0]))
-                return 0;
-        }
+        if(!CreateShaderProgram(m_device, "VulkanShaders/MainObjectShader.vert.glsl.spv", VK_SHADER_STAGE_VERTEX_BIT, "main", vertexShaderModule,
+        shaderStages[0]))
+            return 0;
 
-        //Loading the fragment shader
+        // Loading the fragment shader. The alpha test of impostor materials is only compiled in when there are impostors
+        VkSpecializationMapEntry impostorSpecializationMapEntry{};
+        impostorSpecializationMapEntry.constantID = 1;
+        impostorSpecializationMapEntry.offset = 0;
+        impostorSpecializationMapEntry.size = sizeof(uint32_t);
+        VkSpecializationInfo impostorSpecialization{};
+        impostorSpecialization.dataSize = sizeof(uint32_t);
+        impostorSpecialization.mapEntryCount = 1;
+        impostorSpecialization.pMapEntries = &impostorSpecializationMapEntry;
+        uint32_t impostors = 1;
+        impostorSpecialization.pData = &impostors;
         VkShaderModule fragShaderModule;
         if(!CreateShaderProgram(m_device, "VulkanShaders/MainObjectShader.frag.glsl.spv", VK_SHADER_STAGE_FRAGMENT_BIT, "main", fragShaderModule, 
-        shaderStages[1]))
+        shaderStages[1], bImpostors ? &impostorSpecialization : nullptr))
         {
             // Destroy the already create shader modules and return 0
             vkDestroyShaderModule(m_device, vertexShaderModule, m_pCustomAllocator);
             return 0;
         }
 
-        // Loading the task shader if mesh shaders are requested and supported
-        VkShaderModule taskShaderModule;
-        if(m_stats.meshShaderSupport)
-        {
-            if(!CreateShaderProgram(m_device, "VulkanShaders/MeshShader.task.glsl.spv", VK_SHADER_STAGE_TASK_BIT_EXT, "main", taskShaderModule, 
-            shaderStages[2]))
-            {
-                // Destroy the already create shader modules and return 0
-                vkDestroyShaderModule(m_device, vertexShaderModule, m_pCustomAllocator);
-                vkDestroyShaderModule(m_device, fragShaderModule, m_pCustomAllocator);
-                return 0;
-            }
-        }
-
-        // If the pipeline is going to use mesh shaders, the task shader needs to also be supported, so there will be 3 shader stages
-        if(m_stats.meshShaderSupport)
-        {
-            pipelineInfo.stageCount = 3;
-        }
-        else
-        {
-            pipelineInfo.stageCount = 2;
-        }
+        // The vertex shader pipelines have 2 shader stages
+        pipelineInfo.stageCount = 2;
         pipelineInfo.pStages = shaderStages;
 
         // Setting up triangle primitive assembly
@@ -364,21 +339,56 @@ namespace BlitzenVulkan
         uint32_t postPass = 1;
         postPassSpecialization.pData = &postPass;
         VkShaderModule postPassFragShaderModule;
+        VkPipelineShaderStageCreateInfo postPassFragStage{};
         if(!CreateShaderProgram(m_device, "VulkanShaders/MainObjectShader.frag.glsl.spv", VK_SHADER_STAGE_FRAGMENT_BIT, "main", 
-        postPassFragShaderModule, shaderStages[1], &postPassSpecialization))
+        postPassFragShaderModule, postPassFragStage, &postPassSpecialization))
             return 0;
+        VkPipelineShaderStageCreateInfo opaqueFragStage = shaderStages[1];
+        shaderStages[1] = postPassFragStage;
 
         pipelineCreateFinalResult = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, 
         &m_postPassGeometryPipeline);
         if(pipelineCreateFinalResult != VK_SUCCESS)
             return 0;
 
+        // The mesh shading pipelines replace the vertex shader with the mesh shader and add the task shader that culls meshlets.
+        // Everything else is the same, so that the two paths can be switched at runtime and compared
+        VkShaderModule meshShaderModule = VK_NULL_HANDLE;
+        VkShaderModule taskShaderModule = VK_NULL_HANDLE;
+        if(m_stats.meshShaderSupport)
+        {
+            if(!CreateShaderProgram(m_device, "VulkanShaders/MeshShader.mesh.glsl.spv", VK_SHADER_STAGE_MESH_BIT_EXT, "main", meshShaderModule, 
+            shaderStages[0]))
+                return 0;
+            if(!CreateShaderProgram(m_device, "VulkanShaders/MeshShader.task.glsl.spv", VK_SHADER_STAGE_TASK_BIT_EXT, "main", taskShaderModule, 
+            shaderStages[2]))
+                return 0;
+
+            // Mesh shading pipelines have no vertex input or input assembly state
+            pipelineInfo.stageCount = 3;
+            pipelineInfo.pVertexInputState = nullptr;
+            pipelineInfo.pInputAssemblyState = nullptr;
+
+            shaderStages[1] = opaqueFragStage;
+            pipelineCreateFinalResult = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, m_pCustomAllocator, 
+            &m_opaqueMeshShaderPipeline);
+            if(pipelineCreateFinalResult != VK_SUCCESS)
+                return 0;
+
+            shaderStages[1] = postPassFragStage;
+            pipelineCreateFinalResult = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, m_pCustomAllocator, 
+            &m_postPassMeshShaderPipeline);
+            if(pipelineCreateFinalResult != VK_SUCCESS)
+                return 0;
+        }
+
         // Destroy the shader modules after pipeline has been created
         vkDestroyShaderModule(m_device, vertexShaderModule, m_pCustomAllocator);
         vkDestroyShaderModule(m_device, fragShaderModule, m_pCustomAllocator);
         vkDestroyShaderModule(m_device, postPassFragShaderModule, m_pCustomAllocator);
         if(m_stats.meshShaderSupport)
         {
+            vkDestroyShaderModule(m_device, meshShaderModule, m_pCustomAllocator);
             vkDestroyShaderModule(m_device, taskShaderModule, m_pCustomAllocator);
         }
 
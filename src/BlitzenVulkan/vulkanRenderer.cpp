@@ -49,6 +49,17 @@ namespace BlitzenVulkan
             WriteBufferDescriptorSets(buffers.viewDataBuffer.descriptorWrite, buffers.viewDataBuffer.bufferInfo, 
             buffers.viewDataBuffer.descriptorType, buffers.viewDataBuffer.descriptorBinding, 
             buffers.viewDataBuffer.buffer.buffer);
+
+            // The texture feedback is read on the CPU after the frame, so it is kept in memory that is cached for reading.
+            // It has one element for each slot of the texture descriptor array, all of them zero until a culling shader writes to them
+            VkDeviceSize feedbackSize = sizeof(uint32_t) * m_textureDescriptorCapacity;
+            if(!SetupPushDescriptorBuffer(m_allocator, VMA_MEMORY_USAGE_GPU_TO_CPU, buffers.textureFeedbackBuffer, 
+            feedbackSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
+                return 0;
+            buffers.textureFeedbackBuffer.pData = reinterpret_cast<uint32_t*>(
+            buffers.textureFeedbackBuffer.buffer.allocationInfo.pMappedData);
+            BlitzenCore::BlitZeroMemory(buffers.textureFeedbackBuffer.pData, feedbackSize);
+            vmaFlushAllocation(m_allocator, buffers.textureFeedbackBuffer.buffer.allocation, 0, VK_WHOLE_SIZE);
         }
 
         return 1;
@@ -69,72 +80,51 @@ namespace BlitzenVulkan
         // Binding used for meshlet indices
         VkDescriptorSetLayoutBinding meshletDataBinding{};
 
-        // If mesh shaders are used the bindings needs to be accessed by mesh shaders, otherwise they will be accessed by vertex shader stage
-        if(m_stats.meshShaderSupport)
-        {
-            CreateDescriptorSetLayoutBinding(viewDataLayoutBinding, m_varBuffers[0].viewDataBuffer.descriptorBinding, 
-            1, m_varBuffers[0].viewDataBuffer.descriptorType, 
-            VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT);
-
-            CreateDescriptorSetLayoutBinding(vertexBufferBinding, m_currentStaticBuffers.vertexBuffer.descriptorBinding, 
-            1, m_currentStaticBuffers.vertexBuffer.descriptorType, 
-            VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_TASK_BIT_EXT);
-
-            CreateDescriptorSetLayoutBinding(indirectTaskBufferBinding, m_currentStaticBuffers.indirectTaskBuffer.descriptorBinding, 
-            1, m_currentStaticBuffers.indirectTaskBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_MESH_BIT_EXT);
-            
-            CreateDescriptorSetLayoutBinding(surfaceBufferBinding, m_currentStaticBuffers.surfaceBuffer.descriptorBinding, 
-            1, m_currentStaticBuffers.surfaceBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_MESH_BIT_EXT);
-
-            CreateDescriptorSetLayoutBinding(meshletBufferBinding, m_currentStaticBuffers.meshletBuffer.descriptorBinding, 
-            1, m_currentStaticBuffers.meshletBuffer.descriptorType, 
-            VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_MESH_BIT_EXT);
-
-            CreateDescriptorSetLayoutBinding(meshletDataBinding, m_currentStaticBuffers.meshletDataBuffer.descriptorBinding, 
-            1, m_currentStaticBuffers.meshletDataBuffer.descriptorType, 
-            VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_TASK_BIT_EXT);
-        }
-        else
-        {
-            CreateDescriptorSetLayoutBinding(viewDataLayoutBinding, m_varBuffers[0].viewDataBuffer.descriptorBinding,
-            1, m_varBuffers[0].viewDataBuffer.descriptorType, 
-            VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT);
+        // If mesh shaders are supported, the bindings also need to be accessed by the task and mesh shaders. 
+        // The vertex shader stage keeps its access, since the vertex shader pipelines are always created
+        VkShaderStageFlags taskStage = m_stats.meshShaderSupport ? VK_SHADER_STAGE_TASK_BIT_EXT : 0;
+        VkShaderStageFlags meshStage = m_stats.meshShaderSupport ? VK_SHADER_STAGE_MESH_BIT_EXT : 0;
 
-            CreateDescriptorSetLayoutBinding(vertexBufferBinding, m_currentStaticBuffers.vertexBuffer.descriptorBinding, 1, 
-            m_currentStaticBuffers.vertexBuffer.descriptorType, VK_SHADER_STAGE_VERTEX_BIT);
+        CreateDescriptorSetLayoutBinding(viewDataLayoutBinding, m_varBuffers[0].viewDataBuffer.descriptorBinding,
+        1, m_varBuffers[0].viewDataBuffer.descriptorType, 
+        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT | taskStage | meshStage);
 
-            // This is never used if mesh shading is not supported, this is simply a placeholder
-            CreateDescriptorSetLayoutBinding(indirectTaskBufferBinding, m_currentStaticBuffers.indirectTaskBuffer.descriptorBinding, 
-            1, m_currentStaticBuffers.indirectTaskBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT);
+        CreateDescriptorSetLayoutBinding(vertexBufferBinding, m_currentStaticBuffers.vertexBuffer.descriptorBinding, 1, 
+        m_currentStaticBuffers.vertexBuffer.descriptorType, VK_SHADER_STAGE_VERTEX_BIT | meshStage);
 
-            CreateDescriptorSetLayoutBinding(surfaceBufferBinding, m_currentStaticBuffers.surfaceBuffer.descriptorBinding, 
-            1, m_currentStaticBuffers.surfaceBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT);
+        // Written by the culling shaders and read by the task shader. This is never used if mesh shading is not supported
+        CreateDescriptorSetLayoutBinding(indirectTaskBufferBinding, m_currentStaticBuffers.indirectTaskBuffer.descriptorBinding, 
+        1, m_currentStaticBuffers.indirectTaskBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT | taskStage);
 
-            CreateDescriptorSetLayoutBinding(meshletBufferBinding, m_currentStaticBuffers.meshletBuffer.descriptorBinding, 
-            1, m_currentStaticBuffers.meshletBuffer.descriptorType, 
-            VK_SHADER_STAGE_COMPUTE_BIT);
+        CreateDescriptorSetLayoutBinding(surfaceBufferBinding, m_currentStaticBuffers.surfaceBuffer.descriptorBinding, 
+        1, m_currentStaticBuffers.surfaceBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT | meshStage);
 
-            CreateDescriptorSetLayoutBinding(meshletDataBinding, m_currentStaticBuffers.meshletDataBuffer.descriptorBinding, 
-            1, m_currentStaticBuffers.meshletDataBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT);
-        }
+        CreateDescriptorSetLayoutBinding(meshletBufferBinding, m_currentStaticBuffers.meshletBuffer.descriptorBinding, 
+        1, m_currentStaticBuffers.meshletBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT | taskStage | meshStage);
 
-        // Sets the binding for the depth image
+        CreateDescriptorSetLayoutBinding(meshletDataBinding, m_currentStaticBuffers.meshletDataBuffer.descriptorBinding, 
+        1, m_currentStaticBuffers.meshletDataBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT | meshStage);
+
+        // Sets the binding for the depth image. The task shader also reads it to do occlusion culling on meshlets
         VkDescriptorSetLayoutBinding depthImageBinding{};
         CreateDescriptorSetLayoutBinding(depthImageBinding, 3, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 
-        VK_SHADER_STAGE_COMPUTE_BIT);
+        VK_SHADER_STAGE_COMPUTE_BIT | taskStage);
 
         // Sets the binding for the render object buffer
         VkDescriptorSetLayoutBinding renderObjectBufferBinding{};
         CreateDescriptorSetLayoutBinding(renderObjectBufferBinding, m_currentStaticBuffers.renderObjectBuffer.descriptorBinding, 
-        1, m_currentStaticBuffers.renderObjectBuffer.descriptorType, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT);
+        1, m_currentStaticBuffers.renderObjectBuffer.descriptorType, 
+        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT | taskStage | meshStage);
 
         VkDescriptorSetLayoutBinding transformBufferBinding{};
         CreateDescriptorSetLayoutBinding(transformBufferBinding, m_currentStaticBuffers.transformBuffer.descriptorBinding, 
-        1, m_currentStaticBuffers.renderObjectBuffer.descriptorType, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT);
+        1, m_currentStaticBuffers.renderObjectBuffer.descriptorType, 
+        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT | taskStage | meshStage);
 
+        // The late culling shaders read the materials to find the textures of visible objects
         VkDescriptorSetLayoutBinding materialBufferBinding{};
         CreateDescriptorSetLayoutBinding(materialBufferBinding, m_currentStaticBuffers.materialBuffer.descriptorBinding, 
-        1, m_currentStaticBuffers.materialBuffer.descriptorType, VK_SHADER_STAGE_FRAGMENT_BIT);
+        1, m_currentStaticBuffers.materialBuffer.descriptorType, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT);
 
         VkDescriptorSetLayoutBinding indirectDrawBufferBinding{};
         CreateDescriptorSetLayoutBinding(indirectDrawBufferBinding, m_currentStaticBuffers.indirectDrawBuffer.descriptorBinding,
@@ -147,22 +137,70 @@ namespace BlitzenVulkan
         VkDescriptorSetLayoutBinding visibilityBufferBinding{};
         CreateDescriptorSetLayoutBinding(visibilityBufferBinding, m_currentStaticBuffers.visibilityBuffer.descriptorBinding, 
         1, m_currentStaticBuffers.visibilityBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT);
+
+        VkDescriptorSetLayoutBinding lodHistoryBufferBinding{};
+        CreateDescriptorSetLayoutBinding(lodHistoryBufferBinding, m_currentStaticBuffers.lodHistoryBuffer.descriptorBinding, 
+        1, m_currentStaticBuffers.lodHistoryBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT);
+
+        // Bindings used by the instancing shaders. Only the instance buffer is accessed by the vertex shader
+        VkDescriptorSetLayoutBinding instanceBucketBufferBinding{};
+        CreateDescriptorSetLayoutBinding(instanceBucketBufferBinding, m_currentStaticBuffers.instanceBucketBuffer.descriptorBinding, 
+        1, m_currentStaticBuffers.instanceBucketBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT);
+
+        VkDescriptorSetLayoutBinding instanceBufferBinding{};
+        CreateDescriptorSetLayoutBinding(instanceBufferBinding, m_currentStaticBuffers.instanceBuffer.descriptorBinding, 
+        1, m_currentStaticBuffers.instanceBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT);
+
+        VkDescriptorSetLayoutBinding visibleInstanceBufferBinding{};
+        CreateDescriptorSetLayoutBinding(visibleInstanceBufferBinding, m_currentStaticBuffers.visibleInstanceBuffer.descriptorBinding, 
+        1, m_currentStaticBuffers.visibleInstanceBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT);
+
+        VkDescriptorSetLayoutBinding instancingCounterBufferBinding{};
+        CreateDescriptorSetLayoutBinding(instancingCounterBufferBinding, m_currentStaticBuffers.instancingCounterBuffer.descriptorBinding, 
+        1, m_currentStaticBuffers.instancingCounterBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT);
+
+        // Bindings used by the mesh instance culling shader and the render object culling shaders that go over its output
+        VkDescriptorSetLayoutBinding meshInstanceBufferBinding{};
+        CreateDescriptorSetLayoutBinding(meshInstanceBufferBinding, m_currentStaticBuffers.meshInstanceBuffer.descriptorBinding, 
+        1, m_currentStaticBuffers.meshInstanceBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT);
+
+        VkDescriptorSetLayoutBinding instanceObjectBufferBinding{};
+        CreateDescriptorSetLayoutBinding(instanceObjectBufferBinding, m_currentStaticBuffers.instanceObjectBuffer.descriptorBinding, 
+        1, m_currentStaticBuffers.instanceObjectBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT);
+
+        VkDescriptorSetLayoutBinding expandedObjectBufferBinding{};
+        CreateDescriptorSetLayoutBinding(expandedObjectBufferBinding, m_currentStaticBuffers.expandedObjectBuffer.descriptorBinding, 
+        1, m_currentStaticBuffers.expandedObjectBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT);
+
+        // Bindings used by texture streaming. The culling shaders write the feedback and the fragment shader reads the minimum LODs
+        VkDescriptorSetLayoutBinding textureFeedbackBufferBinding{};
+        CreateDescriptorSetLayoutBinding(textureFeedbackBufferBinding, m_varBuffers[0].textureFeedbackBuffer.descriptorBinding, 
+        1, m_varBuffers[0].textureFeedbackBuffer.descriptorType, VK_SHADER_STAGE_COMPUTE_BIT);
+
+        VkDescriptorSetLayoutBinding textureLodBufferBinding{};
+        CreateDescriptorSetLayoutBinding(textureLodBufferBinding, m_currentStaticBuffers.textureLodBuffer.descriptorBinding, 
+        1, m_currentStaticBuffers.textureLodBuffer.descriptorType, VK_SHADER_STAGE_FRAGMENT_BIT);
         
         // All bindings combined to create the global shader data descriptor set layout
-        VkDescriptorSetLayoutBinding shaderDataBindings[13] = {viewDataLayoutBinding, vertexBufferBinding, 
+        VkDescriptorSetLayoutBinding shaderDataBindings[23] = {viewDataLayoutBinding, vertexBufferBinding, 
         depthImageBinding, renderObjectBufferBinding, transformBufferBinding, materialBufferBinding, 
         indirectDrawBufferBinding, indirectTaskBufferBinding, indirectDrawCountBinding, visibilityBufferBinding, 
-        surfaceBufferBinding, meshletBufferBinding, meshletDataBinding};
-        m_pushDescriptorBufferLayout = CreateDescriptorSetLayout(m_device, 13, shaderDataBindings, 
+        surfaceBufferBinding, meshletBufferBinding, meshletDataBinding, instanceBucketBufferBinding, instanceBufferBinding, 
+        visibleInstanceBufferBinding, instancingCounterBufferBinding, meshInstanceBufferBinding, instanceObjectBufferBinding, 
+        expandedObjectBufferBinding, textureFeedbackBufferBinding, textureLodBufferBinding, lodHistoryBufferBinding};
+        m_pushDescriptorBufferLayout = CreateDescriptorSetLayout(m_device, BLIT_ARRAY_SIZE(shaderDataBindings), shaderDataBindings, 
         VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR);
         if(m_pushDescriptorBufferLayout == VK_NULL_HANDLE)
             return 0;
 
-        // Descriptor set layout for textures
+        // Descriptor set layout for textures. Slots are written while the set is bound, when textures are streamed in and out
         VkDescriptorSetLayoutBinding texturesLayoutBinding{};
-        CreateDescriptorSetLayoutBinding(texturesLayoutBinding, 0, static_cast<uint32_t>(textureCount), 
+        CreateDescriptorSetLayoutBinding(texturesLayoutBinding, 0, m_textureDescriptorCapacity, 
         VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
-        m_textureDescriptorSetlayout = CreateDescriptorSetLayout(m_device, 1, &texturesLayoutBinding);
+        VkDescriptorBindingFlags texturesBindingFlags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | 
+        VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+        m_textureDescriptorSetlayout = CreateDescriptorSetLayout(m_device, 1, &texturesLayoutBinding, 
+        VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT, &texturesBindingFlags);
         if(m_textureDescriptorSetlayout == VK_NULL_HANDLE)
             return 0;
 
@@ -182,8 +220,12 @@ namespace BlitzenVulkan
             return 0;
 
         // The graphics pipeline will use 2 layouts, the one for push desciptors and the constant one for textures
+        // The vertex shader also needs a push constant that tells it if the draws are instanced, 
+        // and the task shader needs one that tells it which meshlet culling tests it should do
         VkDescriptorSetLayout layouts[2] = { m_pushDescriptorBufferLayout, m_textureDescriptorSetlayout };
-        if(!CreatePipelineLayout(m_device, &m_opaqueGeometryPipelineLayout, 2, layouts, 0, nullptr))
+        VkPushConstantRange graphicsPushConstant{};
+        CreatePushConstantRange(graphicsPushConstant, VK_SHADER_STAGE_VERTEX_BIT | taskStage, sizeof(GraphicsShaderPushConstant));
+        if(!CreatePipelineLayout(m_device, &m_opaqueGeometryPipelineLayout, 2, layouts, 1, &graphicsPushConstant))
             return 0;
 
         // The layout for culling shaders uses the push descriptor layout but accesses more bindings for culling data and the depth pyramid
@@ -205,6 +247,10 @@ namespace BlitzenVulkan
 
     void VulkanRenderer::UploadTexture(BlitzenEngine::TextureStats& newTexture, VkFormat format)
     {
+        if(textureCount >= BLIT_MAX_TEXTURE_COUNT)
+            return;
+        loadedTextures.Resize(textureCount + 1);
+
         CreateTextureImage(reinterpret_cast<void*>(newTexture.pTextureData), m_device, m_allocator, 
         loadedTextures[textureCount].image, 
         {(uint32_t)newTexture.textureWidth, (uint32_t)newTexture.textureHeight, 1}, format, 
@@ -218,48 +264,292 @@ namespace BlitzenVulkan
     uint8_t VulkanRenderer::UploadDDSTexture(BlitzenEngine::DDS_HEADER& header, BlitzenEngine::DDS_HEADER_DXT10& header10, 
     void* pData, const char* filepath) 
     {
-        // Create a big buffer to hold the texture data temporarily. It will pass it later
-        // This buffer has a random big size, this is because I need to create it before I can get the size needed for the texture image
-        BlitzenVulkan::AllocatedBuffer stagingBuffer;
-        if(!CreateBuffer(m_allocator, stagingBuffer, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-        VMA_MEMORY_USAGE_CPU_TO_GPU, 128 * 1024 * 1024, VMA_ALLOCATION_CREATE_MAPPED_BIT))
+        BlitzenEngine::DDSTextureProbe texture;
+        texture.filepath = filepath;
+        UploadDDSTextures(&texture, 1);
+
+        header = texture.header;
+        header10 = texture.header10;
+        return texture.bLoaded;
+    }
+
+    // Space that image data takes in the staging pool, so that the next image starts at a whole block
+    static VkDeviceSize GetTextureStagingSize(size_t imageSize)
+    {
+        return (imageSize + BLITZEN_VULKAN_TEXTURE_STAGING_ALIGNMENT - 1) & ~VkDeviceSize(BLITZEN_VULKAN_TEXTURE_STAGING_ALIGNMENT - 1);
+    }
+
+    // Only the mip tail of a texture is uploaded when it is loaded. Gives the part of the file's image data that it takes
+    static void GetMipTailRange(const BlitzenEngine::DDSTextureProbe& texture, uint32_t& tailLevel, size_t& offset, size_t& size)
+    {
+        VkExtent3D extent{texture.header.dwWidth, texture.header.dwHeight, 1};
+        VkFormat format = static_cast<VkFormat>(texture.format);
+        tailLevel = GetTextureMipTailLevel(extent, texture.header.dwMipMapCount);
+        offset = static_cast<size_t>(GetBlockCompressedMipSize(extent, format, 0, tailLevel));
+        size = static_cast<size_t>(GetBlockCompressedMipSize(extent, format, tailLevel, texture.header.dwMipMapCount - tailLevel));
+    }
+
+    uint8_t VulkanRenderer::UploadDDSTextures(BlitzenEngine::DDSTextureProbe* pTextures, uint32_t textureCount)
+    {
+        // Only the headers are read here, the sizes tell how much staging memory the whole set needs
+        VkDeviceSize totalSize = 0;
+        VkDeviceSize largestSize = 0;
+        for(uint32_t i = 0; i < textureCount; ++i)
+        {
+            BlitzenEngine::DDSTextureProbe& texture = pTextures[i];
+            texture.bLoaded = 0;
+            if(!BlitzenEngine::ProbeDDSImage(texture, BlitzenEngine::RendererToLoadDDS::Vulkan))
+            {
+                BLIT_ERROR("Failed to load texture image: %s", texture.filepath)
+                texture.imageSize = 0;
+                continue;
+            }
+
+            uint32_t tailLevel;
+            size_t tailOffset;
+            size_t tailSize;
+            GetMipTailRange(texture, tailLevel, tailOffset, tailSize);
+            VkDeviceSize size = GetTextureStagingSize(tailSize);
+            totalSize += size;
+            largestSize = size > largestSize ? size : largestSize;
+        }
+        if(!totalSize)
+            return 0;
+
+        // Everything goes through one batch when it fits the pool size. Otherwise each batch fills the pool
+        VkDeviceSize poolSize = totalSize < BLITZEN_VULKAN_TEXTURE_STAGING_POOL_SIZE ? totalSize : BLITZEN_VULKAN_TEXTURE_STAGING_POOL_SIZE;
+        poolSize = largestSize > poolSize ? largestSize : poolSize;
+        if(!ReserveTextureStaging(poolSize))
         {
             BLIT_ERROR("Failed to create staging buffer for texture data copy")
             return 0;
         }
-        pData = stagingBuffer.allocationInfo.pMappedData;
 
-        // Calls the function to initialize header, header10 for DDS, get the data of the image and the image format
-        unsigned int format = VK_FORMAT_UNDEFINED;
-        if(!BlitzenEngine::LoadDDSImage(filepath, header, header10, format, BlitzenEngine::RendererToLoadDDS::Vulkan, pData))
+        VkCommandBuffer commandBuffer = m_frameToolsList[0].commandBuffer;
+        uint8_t* pStaging = reinterpret_cast<uint8_t*>(m_textureStagingPool.allocationInfo.pMappedData);
+        uint32_t batchStart = 0;
+        while(batchStart < textureCount)
+        {
+            BeginCommandBuffer(commandBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+            VkDeviceSize stagingOffset = 0;
+            uint32_t batchEnd = batchStart;
+            for(; batchEnd < textureCount; ++batchEnd)
+            {
+                BlitzenEngine::DDSTextureProbe& texture = pTextures[batchEnd];
+                if(!texture.imageSize)
+                    continue;
+                if(this->textureCount >= BLIT_MAX_TEXTURE_COUNT)
+                {
+                    BLIT_ERROR("Max texture count: ( %i ) reached!", BLIT_MAX_TEXTURE_COUNT)
+                    continue;
+                }
+
+                uint32_t tailLevel;
+                size_t tailOffset;
+                size_t tailSize;
+                GetMipTailRange(texture, tailLevel, tailOffset, tailSize);
+                VkDeviceSize size = GetTextureStagingSize(tailSize);
+                if(stagingOffset + size > m_textureStagingCapacity)
+                    break;
+
+                // The mip tail goes from the file straight to its part of the staging pool
+                BlitzenEngine::DDSTextureProbe tail = texture;
+                tail.imageOffset += tailOffset;
+                tail.imageSize = tailSize;
+                if(!BlitzenEngine::ReadDDSImageData(tail, pStaging + stagingOffset))
+                {
+                    BLIT_ERROR("Failed to load texture image: %s", texture.filepath)
+                    continue;
+                }
+
+                // If this fails, the new element is reused by the next texture.
+                // The image of a streamed texture is also copied from when its levels change
+                loadedTextures.Resize(this->textureCount + 1);
+                TextureData& textureData = loadedTextures[this->textureCount];
+                uint32_t tailWidth = texture.header.dwWidth >> tailLevel;
+                uint32_t tailHeight = texture.header.dwHeight >> tailLevel;
+                VkExtent3D extent{tailWidth ? tailWidth : 1, tailHeight ? tailHeight : 1, 1};
+                VkFormat format = static_cast<VkFormat>(texture.format);
+                uint32_t mipLevels = texture.header.dwMipMapCount - tailLevel;
+                if(!CreateImage(m_device, m_allocator, textureData.image, extent, format, 
+                VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | (tailLevel ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0), 
+                static_cast<uint8_t>(mipLevels)))
+                {
+                    BLIT_ERROR("Failed to load Vulkan texture image: %s", texture.filepath)
+                    continue;
+                }
+                RecordTextureImageCopy(commandBuffer, m_textureStagingPool.buffer, stagingOffset, textureData.image.image, extent, 
+                format, mipLevels);
+                textureData.sampler = m_placeholderSampler;
+
+                if(tailLevel)
+                    RegisterStreamedTexture(static_cast<uint32_t>(this->textureCount), texture, tailLevel);
+
+                this->textureCount++;
+                texture.bLoaded = 1;
+                stagingOffset += size;
+            }
+
+            // The pool is written again by the next batch, so this one needs to be done with it
+            SubmitCommandBuffer(m_graphicsQueue.handle, commandBuffer);
+            vkQueueWaitIdle(m_graphicsQueue.handle);
+            batchStart = batchEnd;
+        }
+
+        return 1;
+    }
+
+    uint8_t VulkanRenderer::ReserveTextureStaging(VkDeviceSize size)
+    {
+        if(m_textureStagingCapacity >= size)
+            return 1;
+
+        ReleaseTextureStaging();
+        if(!CreateBuffer(m_allocator, m_textureStagingPool, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
+        VMA_MEMORY_USAGE_CPU_TO_GPU, size, VMA_ALLOCATION_CREATE_MAPPED_BIT))
+            return 0;
+
+        m_textureStagingCapacity = size;
+        return 1;
+    }
+
+    void VulkanRenderer::ReleaseTextureStaging()
+    {
+        if(m_textureStagingPool.buffer == VK_NULL_HANDLE)
+            return;
+
+        vmaDestroyBuffer(m_allocator, m_textureStagingPool.buffer, m_textureStagingPool.allocation);
+        m_textureStagingPool.buffer = VK_NULL_HANDLE;
+        m_textureStagingCapacity = 0;
+    }
+
+    uint8_t VulkanRenderer::UploadStreamedTexture(uint32_t textureTag, BlitzenEngine::DDS_HEADER& header, unsigned int format, 
+    void* pData, size_t dataSize)
+    {
+        if(textureTag >= m_textureDescriptorCapacity)
+        {
+            BLIT_ERROR("Texture tag ( %i ) is outside the texture descriptor array", textureTag)
+            return 0;
+        }
+
+        // The streamer knows the exact size of the data, the staging pool only grows if no earlier texture was as big
+        if(!ReserveTextureStaging(dataSize))
         {
-            BLIT_ERROR("Failed to load texture image")
+            BLIT_ERROR("Failed to create staging buffer for streamed texture data")
             return 0;
         }
-        
-        // Casts the placeholder format to a VkFormat
-        VkFormat vkFormat = static_cast<VkFormat>(format);
+        BlitzenCore::BlitMemCopy(m_textureStagingPool.allocationInfo.pMappedData, pData, dataSize);
 
-        // Creates the texture image for Vulkan. This function also copies the data of the staging buffer to the image
-        if(!CreateTextureImage(stagingBuffer, m_device, m_allocator, loadedTextures[textureCount].image, 
-        {header.dwWidth, header.dwHeight, 1}, vkFormat, VK_IMAGE_USAGE_SAMPLED_BIT, 
-        m_frameToolsList[0].commandBuffer, m_graphicsQueue.handle, header.dwMipMapCount))
+        if(loadedTextures.GetSize() <= textureTag)
+            loadedTextures.Resize(textureTag + 1);
+        if(!CreateTextureImage(m_textureStagingPool, m_device, m_allocator, loadedTextures[textureTag].image, 
+        {header.dwWidth, header.dwHeight, 1}, static_cast<VkFormat>(format), VK_IMAGE_USAGE_SAMPLED_BIT, 
+        m_textureUploadCommandBuffer, m_graphicsQueue.handle, header.dwMipMapCount))
         {
-            BLIT_ERROR("Failed to load Vulkan texture image")
+            BLIT_ERROR("Failed to create streamed texture image")
             return 0;
         }
-        
-        // Add the global sampler at the element in the array that was just porcessed
-        loadedTextures[textureCount].sampler = m_placeholderSampler;
+        loadedTextures[textureTag].sampler = m_placeholderSampler;
+        textureCount = textureCount > textureTag + 1 ? textureCount : textureTag + 1;
 
-        textureCount++;
+        // The slot was given back after the frames that sampled its last image were done, so it is written with the next frame
+        TextureDescriptorUpdate update{};
+        update.textureTag = textureTag;
+        update.imageView = loadedTextures[textureTag].image.imageView;
+        update.sampler = loadedTextures[textureTag].sampler;
+        update.readyFrame = m_frameNumber;
+        m_textureDescriptorUpdates.PushBack(update);
 
         return 1;
     }
 
 
+    void VulkanRenderer::ReleaseStreamedTextures(const uint32_t* pTags, uint32_t count)
+    {
+        // The frames that were recorded before this one might still sample the images, 
+        // so the slots are pointed back to the first texture once they are done. The first texture is never streamed
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t tag = pTags[i];
+            TextureDescriptorUpdate update{};
+            update.textureTag = tag;
+            update.imageView = loadedTextures[0].image.imageView;
+            update.sampler = loadedTextures[0].sampler;
+            update.readyFrame = m_frameNumber + BLITZEN_VULKAN_MAX_FRAMES_IN_FLIGHT;
+            update.bReleaseTag = 1;
+
+            // The image is destroyed with the write, a texture whose chunk never arrived has none
+            if(tag < loadedTextures.GetSize())
+            {
+                AllocatedImage& image = loadedTextures[tag].image;
+                update.retiredImage = image.image;
+                update.retiredImageView = image.imageView;
+                update.retiredAllocation = image.allocation;
+                image.image = VK_NULL_HANDLE;
+                image.imageView = VK_NULL_HANDLE;
+            }
+            m_textureDescriptorUpdates.PushBack(update);
+        }
+    }
+
+    void VulkanRenderer::FlushTextureDescriptorUpdates()
+    {
+        if(!m_textureDescriptorUpdates.GetSize())
+            return;
+
+        // The updates that are ready are written together. The rest keep their order, so that a slot's writes are never swapped
+        BlitCL::DynamicArray<VkDescriptorImageInfo> imageInfos(m_textureDescriptorUpdates.GetSize());
+        BlitCL::DynamicArray<VkWriteDescriptorSet> writes(m_textureDescriptorUpdates.GetSize());
+        uint32_t writeCount = 0;
+        for(size_t i = 0; i < m_textureDescriptorUpdates.GetSize(); ++i)
+        {
+            TextureDescriptorUpdate& update = m_textureDescriptorUpdates[i];
+            if(update.readyFrame > m_frameNumber || update.imageView == VK_NULL_HANDLE)
+                continue;
+
+            imageInfos[writeCount].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageInfos[writeCount].imageView = update.imageView;
+            imageInfos[writeCount].sampler = update.sampler;
+            writes[writeCount] = {};
+            WriteImageDescriptorSets(writes[writeCount], &imageInfos[writeCount], VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 
+            m_textureDescriptorSet, 1, 0, update.textureTag);
+            writeCount++;
+        }
+        if(writeCount)
+            vkUpdateDescriptorSets(m_device, writeCount, writes.Data(), 0, nullptr);
+
+        // Nothing points to the images of the written releases anymore, and their tags can be given to new textures
+        size_t keptCount = 0;
+        for(size_t i = 0; i < m_textureDescriptorUpdates.GetSize(); ++i)
+        {
+            TextureDescriptorUpdate& update = m_textureDescriptorUpdates[i];
+            if(update.readyFrame > m_frameNumber)
+            {
+                m_textureDescriptorUpdates[keptCount++] = update;
+                continue;
+            }
+
+            if(update.retiredImage != VK_NULL_HANDLE)
+            {
+                vmaDestroyImage(m_allocator, update.retiredImage, update.retiredAllocation);
+                vkDestroyImageView(m_device, update.retiredImageView, nullptr);
+            }
+            if(update.bReleaseTag && m_pTextureSlots)
+                m_pTextureSlots->Free(update.textureTag);
+        }
+        m_textureDescriptorUpdates.Downsize(keptCount);
+    }
+
     uint8_t VulkanRenderer::SetupForRendering(BlitzenEngine::RenderingResources* pResources, float& pyramidWidth, float& pyramidHeight)
     {
+        // The texture descriptor table has a slot for every tag that a texture can get, whether it is loaded now or streamed in later
+        m_textureDescriptorCapacity = BlitML::Max(static_cast<uint32_t>(textureCount), static_cast<uint32_t>(BLIT_MAX_TEXTURE_COUNT));
+        m_pTextureSlots = &pResources->textureSlots;
+
+        // The textures of the loaded scenes are done with the staging pool. Streamed textures create it again at their own size
+        ReleaseTextureStaging();
+
         // Creates all know descriptor layouts for all known pipelines
         if(!CreateDescriptorLayouts())
         {
@@ -274,10 +564,18 @@ namespace BlitzenVulkan
             return 0;
         }
 
+        // The opaque passes can draw up to this many objects and the post pass can draw the rest
+        m_opaqueRenderObjectCount = pResources->opaqueRenderObjectCount;
+
         // Upload static data to gpu (though some of these might not be static in the future)
-        if(!UploadDataToGPU(pResources->vertices, pResources->indices, pResources->renders, pResources->renderObjectCount,
-        pResources->materials, pResources->materialCount, pResources->meshlets, pResources->meshletData, 
-        pResources->surfaces, pResources->transforms))
+        // The materials are kept in chunks on the CPU, the material buffer needs them in one block
+        BlitCL::DynamicArray<BlitzenEngine::Material> materials(pResources->materials.GetSize());
+        pResources->materials.CopyTo(materials.Data());
+
+        if(!UploadDataToGPU(pResources->vertices, pResources->indices, pResources->renders.Data(), pResources->renders.GetSize(),
+        materials.Data(), materials.GetSize(), pResources->meshlets, pResources->meshletData, 
+        pResources->surfaces, pResources->transforms, pResources->meshInstances, pResources->instanceObjects, 
+        pResources->capacities))
         {
             BLIT_ERROR("Failed to upload data to the GPU")
             return 0;
@@ -303,6 +601,15 @@ namespace BlitzenVulkan
         }
         #endif
         
+        // Creates the pipeline for the mesh instance culling shader, which will be dispatched before each render object culling shader.
+        // It frustum culls whole instances and writes the render objects of the ones that passed to the expanded object buffer
+        if(!CreateComputeShaderProgram(m_device, "VulkanShaders/MeshInstanceCull.comp.glsl.spv", VK_SHADER_STAGE_COMPUTE_BIT, "main", 
+        m_drawCullPipelineLayout, &m_meshInstanceCullPipeline))
+        {
+            BLIT_ERROR("Failed to create MeshInstanceCull.comp shader program")
+            return 0;
+        }
+        
         // Creates pipeline for the depth pyramid generation shader which will be dispatched before the late culling compute shader
         if(!CreateComputeShaderProgram(m_device, "VulkanShaders/DepthPyramidGeneration.comp.glsl.spv", VK_SHADER_STAGE_COMPUTE_BIT, "main", 
         m_depthPyramidGenerationPipelineLayout, &m_depthPyramidGenerationPipeline))
@@ -330,9 +637,27 @@ namespace BlitzenVulkan
             return 0;
         }
         #endif
+
+        // Creates the pipelines for the shaders that turn the instance buckets into instanced draws when instancing is enabled.
+        // The bucket compaction shader creates the draw commands and the scatter shader fills the instance buffer
+        if(!CreateComputeShaderProgram(m_device, "VulkanShaders/InstanceBucketCompaction.comp.glsl.spv", VK_SHADER_STAGE_COMPUTE_BIT, "main", 
+        m_drawCullPipelineLayout, &m_instanceBucketCompactionPipeline))
+        {
+            BLIT_ERROR("Failed to create InstanceBucketCompaction.comp shader program")
+            return 0;
+        }
+        if(!CreateComputeShaderProgram(m_device, "VulkanShaders/InstanceScatter.comp.glsl.spv", VK_SHADER_STAGE_COMPUTE_BIT, "main", 
+        m_drawCullPipelineLayout, &m_instanceScatterPipeline))
+        {
+            BLIT_ERROR("Failed to create InstanceScatter.comp shader program")
+            return 0;
+        }
         
         // Create the graphics pipeline object 
-        if(!SetupMainGraphicsPipeline())
+        uint8_t bImpostors = 0;
+        for(size_t i = 0; i < pResources->surfaces.GetSize() && !bImpostors; ++i)
+            bImpostors = pResources->surfaces[i].bImpostor;
+        if(!SetupMainGraphicsPipeline(bImpostors))
         {
             BLIT_ERROR("Failed to create the primary graphics pipeline object")
             return 0;
@@ -350,6 +675,15 @@ namespace BlitzenVulkan
         pushDescriptorWritesGraphics[4] = m_currentStaticBuffers.materialBuffer.descriptorWrite; 
         pushDescriptorWritesGraphics[5] = m_currentStaticBuffers.indirectDrawBuffer.descriptorWrite;
         pushDescriptorWritesGraphics[6] = m_currentStaticBuffers.surfaceBuffer.descriptorWrite;
+        pushDescriptorWritesGraphics[7] = m_currentStaticBuffers.instanceBuffer.descriptorWrite;
+        pushDescriptorWritesGraphics[8] = m_currentStaticBuffers.textureLodBuffer.descriptorWrite;
+        if(m_stats.meshShaderSupport)
+        {
+            pushDescriptorWritesGraphics[9] = m_currentStaticBuffers.meshletBuffer.descriptorWrite;
+            pushDescriptorWritesGraphics[10] = m_currentStaticBuffers.meshletDataBuffer.descriptorWrite;
+            pushDescriptorWritesGraphics[11] = m_currentStaticBuffers.indirectTaskBuffer.descriptorWrite;
+        }
+        pushDescriptorWritesGraphics[12] = {};// The depth pyramid write is always last, since it changes when the window is resized
 
         pushDescriptorWritesCompute[0] = {};// This will be where the global shader data write will be, but this one is not always static
         pushDescriptorWritesCompute[1] = m_currentStaticBuffers.renderObjectBuffer.descriptorWrite; 
@@ -358,7 +692,25 @@ namespace BlitzenVulkan
         pushDescriptorWritesCompute[4] = m_currentStaticBuffers.indirectCountBuffer.descriptorWrite; 
         pushDescriptorWritesCompute[5] = m_currentStaticBuffers.visibilityBuffer.descriptorWrite; 
         pushDescriptorWritesCompute[6] = m_currentStaticBuffers.surfaceBuffer.descriptorWrite; 
-        pushDescriptorWritesCompute[7] = {};
+        pushDescriptorWritesCompute[7] = m_currentStaticBuffers.instanceBucketBuffer.descriptorWrite;
+        pushDescriptorWritesCompute[8] = m_currentStaticBuffers.instanceBuffer.descriptorWrite;
+        pushDescriptorWritesCompute[9] = m_currentStaticBuffers.visibleInstanceBuffer.descriptorWrite;
+        pushDescriptorWritesCompute[10] = m_currentStaticBuffers.instancingCounterBuffer.descriptorWrite;
+        pushDescriptorWritesCompute[11] = m_currentStaticBuffers.meshInstanceBuffer.descriptorWrite;
+        pushDescriptorWritesCompute[12] = m_currentStaticBuffers.instanceObjectBuffer.descriptorWrite;
+        pushDescriptorWritesCompute[13] = m_currentStaticBuffers.expandedObjectBuffer.descriptorWrite;
+        pushDescriptorWritesCompute[14] = m_currentStaticBuffers.indirectTaskBuffer.descriptorWrite;
+        pushDescriptorWritesCompute[15] = m_currentStaticBuffers.materialBuffer.descriptorWrite;
+        pushDescriptorWritesCompute[16] = {};// The texture feedback write changes with the frame, like the global shader data write
+        pushDescriptorWritesCompute[17] = m_currentStaticBuffers.lodHistoryBuffer.descriptorWrite;
+        pushDescriptorWritesCompute[18] = {};// The depth pyramid write is always last, since only the late culling shader pushes it
+
+        // The textures that were loaded with their mip tail only read the rest of their levels through their own IO queue
+        if(m_streamedTextures.GetSize() && !m_textureIO.Init(BLITZEN_VULKAN_TEXTURE_STREAMING_MAX_READS))
+        {
+            BLIT_ERROR("Failed to start the texture streaming IO queue")
+            return 0;
+        }
 
         return 1;
     }
@@ -366,8 +718,14 @@ namespace BlitzenVulkan
     uint8_t VulkanRenderer::UploadDataToGPU(BlitCL::DynamicArray<BlitzenEngine::Vertex>& vertices, BlitCL::DynamicArray<uint32_t>& indices, 
     BlitzenEngine::RenderObject* pRenderObjects, size_t renderObjectCount, BlitzenEngine::Material* pMaterials, size_t materialCount, 
     BlitCL::DynamicArray<BlitzenEngine::Meshlet>& meshlets, BlitCL::DynamicArray<uint32_t>& meshletData, 
-    BlitCL::DynamicArray<BlitzenEngine::PrimitiveSurface>& surfaces, BlitCL::DynamicArray<BlitzenEngine::MeshTransform>& transforms)
+    BlitCL::DynamicArray<BlitzenEngine::PrimitiveSurface>& surfaces, BlitCL::DynamicArray<BlitzenEngine::MeshTransform>& transforms, 
+    BlitCL::DynamicArray<BlitzenEngine::MeshInstance>& meshInstances, BlitCL::DynamicArray<uint32_t>& instanceObjects, 
+    BlitzenEngine::BufferCapacities& capacities)
     {
+        uint32_t renderObjectCapacity = capacities.renderObjects;
+        uint32_t meshInstanceCapacity = capacities.meshInstances;
+        uint32_t instanceObjectCapacity = capacities.instanceObjects;
+
         // Creates a storage buffer that will hold the vertices
         VkDeviceSize vertexBufferSize = sizeof(BlitzenEngine::Vertex) * vertices.GetSize();
         // Fails if there are no vertices
@@ -375,9 +733,12 @@ namespace BlitzenVulkan
             return 0;
         // Creates a staging buffer to hold the vertex data and pass it to the vertex buffer later
         AllocatedBuffer stagingVertexBuffer;
-        // Initializes the push descritpor buffer struct that holds the vertex buffer
+        // Initializes the push descritpor buffer struct that holds the vertex buffer.
+        // The geometry buffers have space for the geometry of scenes that are streamed in after setup, 
+        // and copy from themselves when their allocations are compacted
         if(!SetupPushDescriptorBuffer(m_device, m_allocator, m_currentStaticBuffers.vertexBuffer, stagingVertexBuffer, 
-        vertexBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, vertices.Data()))
+        vertexBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, vertices.Data(), 
+        sizeof(BlitzenEngine::Vertex) * capacities.vertices))
             return 0;
 
         // Creates an index buffer that will hold all the loaded indices
@@ -388,7 +749,8 @@ namespace BlitzenVulkan
         // Creates a staging buffer to hold the index data and pass it to the index buffer later
         AllocatedBuffer stagingIndexBuffer;
         CreateStorageBufferWithStagingBuffer(m_allocator, m_device, indices.Data(), m_currentStaticBuffers.indexBuffer, 
-        stagingIndexBuffer, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, indexBufferSize);
+        stagingIndexBuffer, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
+        indexBufferSize, 0, sizeof(uint32_t) * capacities.indices);
         // Checks if the above function failed
         if(m_currentStaticBuffers.indexBuffer.buffer == VK_NULL_HANDLE)
             return 0;
@@ -399,8 +761,10 @@ namespace BlitzenVulkan
             return 0;
         // Creates a staging buffer to hold the render object data and pass it to the render object buffer later
         AllocatedBuffer renderObjectStagingBuffer;
+        // The buffers that hold something for every render object have space for the ones that can be added at runtime
         if(!SetupPushDescriptorBuffer(m_device, m_allocator, m_currentStaticBuffers.renderObjectBuffer, renderObjectStagingBuffer, 
-        renderObjectBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, pRenderObjects))
+        renderObjectBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, pRenderObjects, 
+        sizeof(BlitzenEngine::RenderObject) * renderObjectCapacity))
             return 0;
 
         // Creates an SSBO that will hold all the mesh surfaces / primitives that were loaded to the scene
@@ -411,7 +775,8 @@ namespace BlitzenVulkan
         AllocatedBuffer surfaceStagingBuffer;
         // Initializes the push descriptor buffer that holds the surface buffer
         if(!SetupPushDescriptorBuffer(m_device, m_allocator, m_currentStaticBuffers.surfaceBuffer, surfaceStagingBuffer, 
-        surfaceBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, surfaces.Data()))
+        surfaceBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, surfaces.Data(), 
+        sizeof(BlitzenEngine::PrimitiveSurface) * capacities.surfaces))
             return 0;
 
         // Creates an SSBO that will hold all the materials that were loaded for the scene
@@ -422,21 +787,24 @@ namespace BlitzenVulkan
         AllocatedBuffer materialStagingBuffer; 
         // Initializes the push descriptor buffer that holds the material buffer
         if(!SetupPushDescriptorBuffer(m_device, m_allocator, m_currentStaticBuffers.materialBuffer, materialStagingBuffer, 
-        materialBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, pMaterials))
+        materialBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, pMaterials, 
+        sizeof(BlitzenEngine::Material) * capacities.materials))
             return 0;
 
         // Create an SSBO that will hold all the object transforms that were loaded for the scene
         VkDeviceSize transformBufferSize = sizeof(BlitzenEngine::MeshTransform) * transforms.GetSize();
         if(transformBufferSize == 0)
             return 0;
-        // Creates a staging buffer that will hold the transform data and pass it to the transform buffer later
+        // Creates a staging buffer that will hold the transform data and pass it to the transform buffer later.
+        // Every mesh instance has its own transform, so the buffer has space for the instances that can be added at runtime
         AllocatedBuffer transformStagingBuffer; 
         if(!SetupPushDescriptorBuffer(m_device, m_allocator, m_currentStaticBuffers.transformBuffer, transformStagingBuffer, 
-        transformBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, transforms.Data()))
+        transformBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, transforms.Data(), 
+        sizeof(BlitzenEngine::MeshTransform) * meshInstanceCapacity))
             return 0;
 
         // Creates the buffer that will hold the indirect draw commands. It is set as an SSBO as well so that it can be written by the culling shaders
-        VkDeviceSize indirectDrawBufferSize = sizeof(IndirectDrawData) * renderObjectCount;
+        VkDeviceSize indirectDrawBufferSize = sizeof(IndirectDrawData) * renderObjectCapacity;
         if(indirectDrawBufferSize == 0)
             return 0;
         // Initializes the push descriptor buffer that holds the indirect draw buffer
@@ -445,27 +813,27 @@ namespace BlitzenVulkan
             return 0;
 
         
+        // The indirect task buffer is always created, since the culling shaders have a branch that writes to it.
+        // It is only written when mesh shading is active
+        VkDeviceSize indirectTaskBufferSize = sizeof(IndirectTaskData) * renderObjectCapacity;
+        if(!SetupPushDescriptorBuffer(m_allocator, VMA_MEMORY_USAGE_GPU_ONLY, m_currentStaticBuffers.indirectTaskBuffer, 
+        indirectTaskBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT))
+            return 0;
+
         // Create the buffers for cluster if they are needed
-        VkDeviceSize indirectTaskBufferSize = sizeof(IndirectTaskData) * renderObjectCount;
         VkDeviceSize meshletBufferSize = sizeof(BlitzenEngine::Meshlet) * meshlets.GetSize();
         AllocatedBuffer meshletStagingBuffer;
         VkDeviceSize meshletDataBufferSize = sizeof(uint32_t) * meshletData.GetSize();
         AllocatedBuffer meshletDataStagingBuffer;
         if(m_stats.meshShaderSupport)
         {
-            if(indirectTaskBufferSize == 0)
-                return 0;
-            // Initializes the push descriptor buffer that holds the indirect task buffer
-            if(!SetupPushDescriptorBuffer(m_allocator, VMA_MEMORY_USAGE_GPU_ONLY, m_currentStaticBuffers.indirectTaskBuffer, 
-            indirectTaskBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT))
-                return 0;
-
             // Creates an SSBO that will hold all clusters / meshlets that were loaded for the scene
             if(meshletBufferSize == 0)
                 return 0;
             // Initializes the push descriptor buffer that holds the meshlet buffer
             if(!SetupPushDescriptorBuffer(m_device, m_allocator, m_currentStaticBuffers.meshletBuffer, meshletStagingBuffer, 
-            meshletBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, meshlets.Data()))
+            meshletBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
+            meshlets.Data(), sizeof(BlitzenEngine::Meshlet) * capacities.meshlets))
                 return 0;
 
             // Creates an SSBO that will hold all the meshlet indices to the index buffer
@@ -473,7 +841,8 @@ namespace BlitzenVulkan
                 return 0;
             // Initializes the push descriptor buffer that holds the meshlet data buffer
             if(!SetupPushDescriptorBuffer(m_device, m_allocator, m_currentStaticBuffers.meshletDataBuffer, meshletDataStagingBuffer, 
-            meshletDataBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, meshletData.Data()))
+            meshletDataBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, meshletData.Data(), 
+            sizeof(uint32_t) * capacities.meshletData))
                 return 0;
         }
 
@@ -482,14 +851,75 @@ namespace BlitzenVulkan
         sizeof(uint32_t), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
             return 0;
 
-        // Creates an SSBO that will hold one integer for each object indicating if they were visible or not on the previous frame
-        VkDeviceSize visibilityBufferSize = sizeof(uint32_t) * renderObjectCount;
+        // Creates an SSBO that will hold one bit for each object indicating if they were visible or not on the previous frame.
+        // The bits are packed in 32 object words, so the size is rounded up to the next word
+        VkDeviceSize visibilityBufferSize = sizeof(uint32_t) * ((renderObjectCapacity + 31) / 32);
         if(visibilityBufferSize == 0)
             return 0;
         if(!SetupPushDescriptorBuffer(m_allocator, VMA_MEMORY_USAGE_GPU_ONLY, m_currentStaticBuffers.visibilityBuffer, 
         visibilityBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
                 return 0;
 
+        // Creates an SSBO that will hold the LOD that each object was drawn with, one byte per object. 
+        // The size is rounded up to a word, since buffers are filled in words
+        VkDeviceSize lodHistoryBufferSize = sizeof(uint32_t) * ((renderObjectCapacity + 3) / 4);
+        if(!SetupPushDescriptorBuffer(m_allocator, VMA_MEMORY_USAGE_GPU_ONLY, m_currentStaticBuffers.lodHistoryBuffer, 
+        lodHistoryBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
+            return 0;
+
+        // Creates the buffers used when instancing is enabled. There is one instance bucket for each surface and LOD combination
+        m_instanceBucketCount = static_cast<uint32_t>(surfaces.GetSize() * BLIT_MAX_MESH_LOD);
+        if(!SetupPushDescriptorBuffer(m_allocator, VMA_MEMORY_USAGE_GPU_ONLY, m_currentStaticBuffers.instanceBucketBuffer, 
+        sizeof(InstanceBucket) * capacities.surfaces * BLIT_MAX_MESH_LOD, 
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
+            return 0;
+        // Every visible object can be an instance, so the instance buffer and the visible instance list are as big as the render objects
+        if(!SetupPushDescriptorBuffer(m_allocator, VMA_MEMORY_USAGE_GPU_ONLY, m_currentStaticBuffers.instanceBuffer, 
+        sizeof(uint32_t) * renderObjectCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
+            return 0;
+        if(!SetupPushDescriptorBuffer(m_allocator, VMA_MEMORY_USAGE_GPU_ONLY, m_currentStaticBuffers.visibleInstanceBuffer, 
+        sizeof(VisibleInstance) * renderObjectCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
+            return 0;
+        if(!SetupPushDescriptorBuffer(m_allocator, VMA_MEMORY_USAGE_GPU_ONLY, m_currentStaticBuffers.instancingCounterBuffer, 
+        sizeof(InstancingCounters), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
+            return 0;
+
+        // Creates an SSBO that will hold every mesh instance, which is culled before its render objects
+        m_meshInstanceCount = static_cast<uint32_t>(meshInstances.GetSize());
+        VkDeviceSize meshInstanceBufferSize = sizeof(BlitzenEngine::MeshInstance) * meshInstances.GetSize();
+        if(meshInstanceBufferSize == 0)
+            return 0;
+        AllocatedBuffer meshInstanceStagingBuffer;
+        if(!SetupPushDescriptorBuffer(m_device, m_allocator, m_currentStaticBuffers.meshInstanceBuffer, meshInstanceStagingBuffer, 
+        meshInstanceBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, meshInstances.Data(), 
+        sizeof(BlitzenEngine::MeshInstance) * meshInstanceCapacity))
+            return 0;
+
+        // Creates an SSBO that will hold the render object indices of each mesh instance
+        VkDeviceSize instanceObjectBufferSize = sizeof(uint32_t) * instanceObjects.GetSize();
+        if(instanceObjectBufferSize == 0)
+            return 0;
+        AllocatedBuffer instanceObjectStagingBuffer;
+        if(!SetupPushDescriptorBuffer(m_device, m_allocator, m_currentStaticBuffers.instanceObjectBuffer, instanceObjectStagingBuffer, 
+        instanceObjectBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, instanceObjects.Data(), 
+        sizeof(uint32_t) * instanceObjectCapacity))
+            return 0;
+
+        // The expanded object buffer starts with the indirect dispatch command and the object count, followed by up to every render object
+        if(!SetupPushDescriptorBuffer(m_allocator, VMA_MEMORY_USAGE_GPU_ONLY, m_currentStaticBuffers.expandedObjectBuffer, 
+        sizeof(ExpandedObjectHeader) + sizeof(uint32_t) * renderObjectCapacity, 
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT))
+            return 0;
+
+        // Creates an SSBO that will hold the minimum LOD of every slot of the texture descriptor array. 
+        // It is only written when streamed levels are added to a texture, through the CPU copy
+        VkDeviceSize textureLodBufferSize = sizeof(float) * m_textureDescriptorCapacity;
+        if(!SetupPushDescriptorBuffer(m_allocator, VMA_MEMORY_USAGE_GPU_ONLY, m_currentStaticBuffers.textureLodBuffer, 
+        textureLodBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
+            return 0;
+        m_textureMinLods.Resize(m_textureDescriptorCapacity);
+        BlitzenCore::BlitZeroMemory(m_textureMinLods.Data(), textureLodBufferSize);
+
         VkCommandBuffer& commandBuffer = m_frameToolsList[0].commandBuffer;
 
         // Start recording the transfer commands
@@ -524,6 +954,14 @@ namespace BlitzenVulkan
         CopyBufferToBuffer(commandBuffer, transformStagingBuffer.buffer,
         m_currentStaticBuffers.transformBuffer.buffer.buffer, transformBufferSize, 
         0, 0);
+
+        // Copies the mesh instances and their render object indices
+        CopyBufferToBuffer(commandBuffer, meshInstanceStagingBuffer.buffer, 
+        m_currentStaticBuffers.meshInstanceBuffer.buffer.buffer, meshInstanceBufferSize, 
+        0, 0);
+        CopyBufferToBuffer(commandBuffer, instanceObjectStagingBuffer.buffer, 
+        m_currentStaticBuffers.instanceObjectBuffer.buffer.buffer, instanceObjectBufferSize, 
+        0, 0);
         
         if(m_stats.meshShaderSupport)
         {
@@ -537,8 +975,14 @@ namespace BlitzenVulkan
             0, 0);
         }
 
-        // The visibility buffer will start the 1st frame with only zeroes(nothing will be drawn on the first frame but that is fine)
+        // The visibility buffer will start the 1st frame with every bit cleared(nothing will be drawn on the first frame but that is fine)
         vkCmdFillBuffer(commandBuffer, m_currentStaticBuffers.visibilityBuffer.buffer.buffer, 0, visibilityBufferSize, 0);
+
+        // Every object starts with LOD 0 as its previous LOD, so the first selection only moves away from it with the hysteresis band
+        vkCmdFillBuffer(commandBuffer, m_currentStaticBuffers.lodHistoryBuffer.buffer.buffer, 0, lodHistoryBufferSize, 0);
+
+        // Every texture starts with no minimum LOD
+        vkCmdFillBuffer(commandBuffer, m_currentStaticBuffers.textureLodBuffer.buffer.buffer, 0, textureLodBufferSize, 0);
         
         // Submit the commands and wait for the queue to finish
         SubmitCommandBuffer(m_graphicsQueue.handle, commandBuffer);
@@ -548,14 +992,14 @@ namespace BlitzenVulkan
         if(textureCount == 0)
             return 0;
 
-        // The descriptor will have multiple descriptors of combined image sampler type. The count is derived from the amount of textures loaded
+        // The descriptor will have multiple descriptors of combined image sampler type, one for each slot of the table
         VkDescriptorPoolSize poolSize{};
         poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        poolSize.descriptorCount = static_cast<uint32_t>(textureCount);
+        poolSize.descriptorCount = m_textureDescriptorCapacity;
 
-        // Creates the descriptor pool for the textures
+        // Creates the descriptor pool for the textures. The set's layout is update after bind, so the pool needs to be as well
         m_textureDescriptorPool = CreateDescriptorPool(m_device, 1, &poolSize, 
-        1);
+        1, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
         if(m_textureDescriptorPool == VK_NULL_HANDLE)
             return 0;
  
@@ -564,13 +1008,15 @@ namespace BlitzenVulkan
         1, &m_textureDescriptorSet))
             return 0;
 
-        // Create image infos for every texture to be passed to the VkWriteDescriptorSet
-        BlitCL::DynamicArray<VkDescriptorImageInfo> imageInfos(textureCount);
+        // Create image infos for every texture to be passed to the VkWriteDescriptorSet. 
+        // Slots that have no texture yet use the first one, until a streamed texture takes them
+        BlitCL::DynamicArray<VkDescriptorImageInfo> imageInfos(m_textureDescriptorCapacity);
         for(size_t i = 0; i < imageInfos.GetSize(); ++i)
         {
+            TextureData& texture = i < textureCount ? loadedTextures[i] : loadedTextures[0];
             imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imageInfos[i].imageView = loadedTextures[i].image.imageView;
-            imageInfos[i].sampler = loadedTextures[i].sampler;
+            imageInfos[i].imageView = texture.image.imageView;
+            imageInfos[i].sampler = texture.sampler;
         }
 
         // Update every descriptor set so that it is available at draw time
@@ -609,11 +1055,21 @@ namespace BlitzenVulkan
         // Specifies the descriptor writes that are not static again
         pushDescriptorWritesGraphics[0] = vBuffers.viewDataBuffer.descriptorWrite;
         pushDescriptorWritesCompute[0] = vBuffers.viewDataBuffer.descriptorWrite;
+        pushDescriptorWritesCompute[16] = vBuffers.textureFeedbackBuffer.descriptorWrite;
         
         // Waits for the fence in the current frame tools struct to be signaled and resets it for next time when it gets signalled
         vkWaitForFences(m_device, 1, &(fTools.inFlightFence), VK_TRUE, 1000000000);
         VK_CHECK(vkResetFences(m_device, 1, &(fTools.inFlightFence)))
 
+        // The GPU is done with the last frame that used these frame tools, so its timestamps can be read
+        ReadFrameTimestamps(fTools);
+
+        // The same goes for the texture sizes that its culling shaders asked for
+        UpdateTextureStreaming(vBuffers);
+
+        // And for the texture slots that the frames before it sampled
+        FlushTextureDescriptorUpdates();
+
         // Write the data to the buffer pointers
         #ifdef NDEBUG
         *(vBuffers.viewDataBuffer.pData) = pCamera->viewData;
@@ -624,6 +1080,23 @@ namespace BlitzenVulkan
             *(vBuffers.viewDataBuffer.pData) = pCamera->viewData;
         #endif
         
+        // Objects can be added and removed at runtime, so the counts are given every frame
+        m_opaqueRenderObjectCount = context.opaqueObjectCount;
+        m_meshInstanceCount = context.meshInstanceCount;
+        m_instanceBucketCount = context.surfaceCount * BLIT_MAX_MESH_LOD;
+
+        // Opaque objects are placed before transparent objects, so the draw count is split in two ranges
+        uint32_t opaqueDrawCount = context.drawCount < m_opaqueRenderObjectCount ? context.drawCount : m_opaqueRenderObjectCount;
+        uint32_t postPassDrawCount = context.drawCount - opaqueDrawCount;
+
+        // The task and mesh shader pipelines are used if they were requested and the device supports them
+        uint8_t bMeshShading = context.bMeshShading && m_stats.meshShaderSupport;
+        VkPipeline opaquePipeline = bMeshShading ? m_opaqueMeshShaderPipeline : m_opaqueGeometryPipeline;
+        VkPipeline postPassPipeline = bMeshShading ? m_postPassMeshShaderPipeline : m_postPassGeometryPipeline;
+
+        // Instanced draws are only created for the vertex shader path
+        uint8_t bInstancing = context.bInstancing && !bMeshShading;
+
         // Asks for the next image in the swapchain to use for presentation, and saves it in swapchainIdx
         uint32_t swapchainIdx;
         vkAcquireNextImageKHR(m_device, m_initHandles.swapchain, 1000000000, fTools.imageAcquiredSemaphore, VK_NULL_HANDLE, &swapchainIdx);
@@ -631,10 +1104,22 @@ namespace BlitzenVulkan
         // The command buffer recording begin here (stops when submit is called)
         BeginCommandBuffer(fTools.commandBuffer, 0);
 
+        // The GPU frame time is the time between the timestamps at the start and the end of the command buffer
+        if(m_stats.timestampSupport)
+        {
+            vkCmdResetQueryPool(fTools.commandBuffer, fTools.timestampQueryPool, 0, 2);
+            vkCmdWriteTimestamp2(fTools.commandBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, fTools.timestampQueryPool, 0);
+        }
+
+        // Transforms and objects that were changed since the last frame are copied to their buffers before anything reads them
+        RecordBufferUpdates(fTools.commandBuffer, vBuffers, context);
+        RecordRenderObjectStateResets(fTools.commandBuffer, context.renderObjectUpdate);
+        RecordTextureLodUpdates(fTools.commandBuffer);
+
         // Dispatch the culling shader for the intial pass. This will perform frustum culling and LOD selection for objects that were visible last frame
         DispatchRenderObjectCullingComputeShader(fTools.commandBuffer, m_initialDrawCullPipeline, 
-        BLIT_ARRAY_SIZE(pushDescriptorWritesCompute), pushDescriptorWritesCompute, context.drawCount, 0, 0, 
-        context.bOcclusionCulling, context.bLOD);
+        BLIT_ARRAY_SIZE(pushDescriptorWritesCompute), pushDescriptorWritesCompute, opaqueDrawCount, 0, 0, 
+        context.bOcclusionCulling, context.bLOD, bInstancing, bMeshShading);
 
         // The viewport and scissor are dynamic, so they should be set here
         DefineViewportAndScissor(fTools.commandBuffer, m_drawExtent);
@@ -659,7 +1144,8 @@ namespace BlitzenVulkan
         PipelineBarrier(fTools.commandBuffer, 0, nullptr, 0, nullptr, 2, renderingAttachmentDefinitionBarriers);
 
         // Draw the objects based on the indirect draw buffer and indirect count buffer that were written by the culling shader
-        DrawGeometry(fTools.commandBuffer, pushDescriptorWritesGraphics, context.drawCount, 0, m_opaqueGeometryPipeline);
+        DrawGeometry(fTools.commandBuffer, pushDescriptorWritesGraphics, opaqueDrawCount, 0, opaquePipeline, bInstancing, bMeshShading, 
+        0, 0, context.bLOD);
 
         // Ends the inital render pass 
         vkCmdEndRendering(fTools.commandBuffer);
@@ -670,22 +1156,25 @@ namespace BlitzenVulkan
         // Dispatches the late culling compute shader which does frustum culling, occlusion culling and LOD selection on everything
         // It only draws the objects that were not visible last frame and updates the visibility buffer for all objects
         DispatchRenderObjectCullingComputeShader(fTools.commandBuffer, m_lateDrawCullPipeline, 
-        BLIT_ARRAY_SIZE(pushDescriptorWritesCompute), pushDescriptorWritesCompute, context.drawCount, 1, 0, 
-        context.bOcclusionCulling, context.bLOD);
+        BLIT_ARRAY_SIZE(pushDescriptorWritesCompute), pushDescriptorWritesCompute, opaqueDrawCount, 1, 0, 
+        context.bOcclusionCulling, context.bLOD, bInstancing, bMeshShading);
 
-        // Draw the objects based on the indirect draw buffer and indirect count buffer that were written by the culling shader
-        DrawGeometry(fTools.commandBuffer, pushDescriptorWritesGraphics, context.drawCount, 1, m_opaqueGeometryPipeline);
+        // Draw the objects based on the indirect draw buffer and indirect count buffer that were written by the culling shader.
+        // With mesh shading, the task shader can now also test meshlets against the depth pyramid
+        DrawGeometry(fTools.commandBuffer, pushDescriptorWritesGraphics, opaqueDrawCount, 1, opaquePipeline, bInstancing, 
+        bMeshShading, context.bOcclusionCulling, 0, context.bLOD);
 
         // End of late render pass
         vkCmdEndRendering(fTools.commandBuffer);
 
-        // Dispatches one more culling pass for transparent objects (this is not ideal and a better solution will be found)
+        // Dispatches one more culling pass for transparent objects. It only goes over the post pass objects of each mesh instance
         DispatchRenderObjectCullingComputeShader(fTools.commandBuffer, m_lateDrawCullPipeline, 
-        BLIT_ARRAY_SIZE(pushDescriptorWritesCompute), pushDescriptorWritesCompute, context.drawCount, 1, 1, 
-        context.bOcclusionCulling, context.bLOD);
+        BLIT_ARRAY_SIZE(pushDescriptorWritesCompute), pushDescriptorWritesCompute, postPassDrawCount, 1, 1, 
+        context.bOcclusionCulling, context.bLOD, bInstancing, bMeshShading);
 
         // Draw the transparent objects
-        DrawGeometry(fTools.commandBuffer, pushDescriptorWritesGraphics, context.drawCount, 1, m_postPassGeometryPipeline);
+        DrawGeometry(fTools.commandBuffer, pushDescriptorWritesGraphics, postPassDrawCount, 1, postPassPipeline, bInstancing, 
+        bMeshShading, context.bOcclusionCulling, 1, context.bLOD);
         
         // Stop rendering
         vkCmdEndRendering(fTools.commandBuffer);
@@ -733,6 +1222,20 @@ namespace BlitzenVulkan
         0, VK_REMAINING_MIP_LEVELS);
         PipelineBarrier(fTools.commandBuffer, 0, nullptr, 0, nullptr, 1, &presentImageBarrier);
 
+        // The texture feedback is read on the CPU once the fence is signaled
+        VkBufferMemoryBarrier2 textureFeedbackReadBarrier{};
+        BufferMemoryBarrier(vBuffers.textureFeedbackBuffer.buffer.buffer, textureFeedbackReadBarrier, 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, 
+        VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT, 0, VK_WHOLE_SIZE);
+        PipelineBarrier(fTools.commandBuffer, 0, nullptr, 1, &textureFeedbackReadBarrier, 0, nullptr);
+
+        if(m_stats.timestampSupport)
+        {
+            vkCmdWriteTimestamp2(fTools.commandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, fTools.timestampQueryPool, 1);
+            fTools.bTimestampsWritten = 1;
+            fTools.bMeshShadingFrame = bMeshShading;
+        }
+
         // All commands have ben recorded, the command buffer is submitted
         SubmitCommandBuffer(m_graphicsQueue.handle, fTools.commandBuffer, 1, fTools.imageAcquiredSemaphore, VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, 
         1, fTools.readyToPresentSemaphore, VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, fTools.inFlightFence);
@@ -749,11 +1252,280 @@ namespace BlitzenVulkan
 
         // Change the current frame to the next frame, important when using double buffering
         m_currentFrame = (m_currentFrame + 1) % BLITZEN_VULKAN_MAX_FRAMES_IN_FLIGHT;
+        m_frameNumber++;
+    }
+
+    void VulkanRenderer::RecordBufferUpdates(VkCommandBuffer commandBuffer, VarBuffers& vBuffers, DrawContext& context)
+    {
+        // The arrays that the engine can change at runtime, with the buffer that holds each one and its element size
+        BufferUpdate* pUpdates[10] = {&context.transformUpdate, &context.renderObjectUpdate, 
+        &context.meshInstanceUpdate, &context.instanceObjectUpdate, &context.vertexUpdate, &context.indexUpdate, 
+        &context.meshletUpdate, &context.meshletDataUpdate, &context.surfaceUpdate, &context.materialUpdate};
+        VkBuffer dstBuffers[10] = {m_currentStaticBuffers.transformBuffer.buffer.buffer, m_currentStaticBuffers.renderObjectBuffer.buffer.buffer, 
+        m_currentStaticBuffers.meshInstanceBuffer.buffer.buffer, m_currentStaticBuffers.instanceObjectBuffer.buffer.buffer, 
+        m_currentStaticBuffers.vertexBuffer.buffer.buffer, m_currentStaticBuffers.indexBuffer.buffer, 
+        m_currentStaticBuffers.meshletBuffer.buffer.buffer, m_currentStaticBuffers.meshletDataBuffer.buffer.buffer, 
+        m_currentStaticBuffers.surfaceBuffer.buffer.buffer, m_currentStaticBuffers.materialBuffer.buffer.buffer};
+        VkDeviceSize elementSizes[10] = {sizeof(BlitzenEngine::MeshTransform), sizeof(BlitzenEngine::RenderObject), 
+        sizeof(BlitzenEngine::MeshInstance), sizeof(uint32_t), sizeof(BlitzenEngine::Vertex), sizeof(uint32_t), 
+        sizeof(BlitzenEngine::Meshlet), sizeof(uint32_t), sizeof(BlitzenEngine::PrimitiveSurface), sizeof(BlitzenEngine::Material)};
+
+        // The meshlet buffers are only created when the device supports mesh shaders
+        BufferUpdate noUpdate{};
+        for(uint32_t i = 0; i < BLIT_ARRAY_SIZE(pUpdates); ++i)
+        {
+            if(dstBuffers[i] == VK_NULL_HANDLE)
+                pUpdates[i] = &noUpdate;
+        }
+
+        VkDeviceSize uploadSize = 0;
+        uint32_t regionCount = 0;
+        uint32_t moveCount = 0;
+        for(uint32_t i = 0; i < BLIT_ARRAY_SIZE(pUpdates); ++i)
+        {
+            for(uint32_t j = 0; j < pUpdates[i]->rangeCount; ++j)
+                uploadSize += elementSizes[i] * pUpdates[i]->pRanges[j].elementCount;
+            regionCount += pUpdates[i]->rangeCount + pUpdates[i]->moveCount;
+            moveCount += pUpdates[i]->moveCount;
+        }
+        if(!uploadSize && !moveCount)
+            return;
+
+        // Each frame in flight has its own upload buffer, so that the previous frame can still be copying from its own.
+        // It is only created once something changes, static scenes never need it. It grows when a frame has more to upload than it can hold
+        uint8_t bUpload = uploadSize != 0;
+        if(bUpload && vBuffers.uploadBufferSize < uploadSize)
+        {
+            if(vBuffers.uploadBuffer.buffer != VK_NULL_HANDLE)
+            {
+                vmaDestroyBuffer(m_allocator, vBuffers.uploadBuffer.buffer, vBuffers.uploadBuffer.allocation);
+                vBuffers.uploadBuffer.buffer = VK_NULL_HANDLE;
+                vBuffers.uploadBufferSize = 0;
+            }
+
+            if(!CreateBuffer(m_allocator, vBuffers.uploadBuffer, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, 
+            uploadSize * 2, VMA_ALLOCATION_CREATE_MAPPED_BIT))
+            {
+                // The moves are still done, the engine has already moved its offsets
+                BLIT_ERROR("Failed to create the upload buffer, scene changes will not be shown")
+                vBuffers.uploadBuffer.buffer = VK_NULL_HANDLE;
+                bUpload = 0;
+                if(!moveCount)
+                    return;
+            }
+            else
+            {
+                vBuffers.pUploadData = vBuffers.uploadBuffer.allocation->GetMappedData();
+                vBuffers.uploadBufferSize = uploadSize * 2;
+            }
+        }
+
+        if(m_bufferCopyRegions.GetSize() < regionCount)
+            m_bufferCopyRegions.Resize(regionCount);
+
+        // Materials are read by the fragment shader and indices by the input assembler
+        VkPipelineStageFlags2 readStages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | 
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT;
+        if(m_stats.meshShaderSupport)
+            readStages |= VK_PIPELINE_STAGE_2_TASK_SHADER_BIT_EXT | VK_PIPELINE_STAGE_2_MESH_SHADER_BIT_EXT;
+        VkAccessFlags2 readAccess = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT;
+
+        uint8_t bChanged[BLIT_ARRAY_SIZE(pUpdates)] = {};
+        for(uint32_t i = 0; i < BLIT_ARRAY_SIZE(pUpdates); ++i)
+            bChanged[i] = (bUpload && pUpdates[i]->rangeCount) || pUpdates[i]->moveCount;
+
+        // The previous frame's shaders should be done reading the buffers before they are overwritten. 
+        // Moves also read what earlier frames copied to the buffers
+        VkBufferMemoryBarrier2 waitBeforeCopying[BLIT_ARRAY_SIZE(pUpdates)] = {};
+        uint32_t barrierCount = 0;
+        for(uint32_t i = 0; i < BLIT_ARRAY_SIZE(pUpdates); ++i)
+        {
+            if(!bChanged[i])
+                continue;
+            BufferMemoryBarrier(dstBuffers[i], waitBeforeCopying[barrierCount++], readStages | VK_PIPELINE_STAGE_2_TRANSFER_BIT, 
+            readAccess | VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT, 
+            VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT, 0, VK_WHOLE_SIZE);
+        }
+        PipelineBarrier(commandBuffer, 0, nullptr, barrierCount, waitBeforeCopying, 0, nullptr);
+
+        // Compacted allocations are copied inside their buffer. The regions of a buffer never overlap, 
+        // since the heaps only free the moved-from space on the next frame
+        uint32_t firstRegion = 0;
+        if(moveCount)
+        {
+            VkBufferMemoryBarrier2 waitForMoves[BLIT_ARRAY_SIZE(pUpdates)] = {};
+            barrierCount = 0;
+            for(uint32_t i = 0; i < BLIT_ARRAY_SIZE(pUpdates); ++i)
+            {
+                BufferUpdate& update = *pUpdates[i];
+                if(!update.moveCount)
+                    continue;
+
+                for(uint32_t j = 0; j < update.moveCount; ++j)
+                {
+                    VkBufferCopy& region = m_bufferCopyRegions[firstRegion + j];
+                    region.srcOffset = elementSizes[i] * update.pMoves[j].srcElement;
+                    region.dstOffset = elementSizes[i] * update.pMoves[j].dstElement;
+                    region.size = elementSizes[i] * update.pMoves[j].elementCount;
+                }
+                vkCmdCopyBuffer(commandBuffer, dstBuffers[i], dstBuffers[i], update.moveCount, m_bufferCopyRegions.Data() + firstRegion);
+                firstRegion += update.moveCount;
+
+                // The ranges that are uploaded after the moves can be written to the moved elements
+                if(bUpload && update.rangeCount)
+                    BufferMemoryBarrier(dstBuffers[i], waitForMoves[barrierCount++], VK_PIPELINE_STAGE_2_TRANSFER_BIT, 
+                    VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, 0, VK_WHOLE_SIZE);
+            }
+            if(barrierCount)
+                PipelineBarrier(commandBuffer, 0, nullptr, barrierCount, waitForMoves, 0, nullptr);
+        }
+
+        // The changed ranges of every array are packed in the upload buffer, and each array gets one copy command with a region per range
+        VkDeviceSize uploadOffset = 0;
+        for(uint32_t i = 0; bUpload && i < BLIT_ARRAY_SIZE(pUpdates); ++i)
+        {
+            BufferUpdate& update = *pUpdates[i];
+            if(!update.rangeCount)
+                continue;
+
+            VkDeviceSize packedOffset = 0;
+            for(uint32_t j = 0; j < update.rangeCount; ++j)
+            {
+                BlitzenEngine::BufferUpdateRange& range = update.pRanges[j];
+                VkDeviceSize rangeSize = elementSizes[i] * range.elementCount;
+
+                VkDeviceSize dataOffset = update.bPacked ? packedOffset : elementSizes[i] * range.firstElement;
+                BlitzenCore::BlitMemCopy(reinterpret_cast<uint8_t*>(vBuffers.pUploadData) + uploadOffset, 
+                reinterpret_cast<uint8_t*>(update.pData) + dataOffset, rangeSize);
+                packedOffset += rangeSize;
+
+                VkBufferCopy& region = m_bufferCopyRegions[firstRegion + j];
+                region.srcOffset = uploadOffset;
+                region.dstOffset = elementSizes[i] * range.firstElement;
+                region.size = rangeSize;
+
+                uploadOffset += rangeSize;
+            }
+
+            vkCmdCopyBuffer(commandBuffer, vBuffers.uploadBuffer.buffer, dstBuffers[i], update.rangeCount, 
+            m_bufferCopyRegions.Data() + firstRegion);
+            firstRegion += update.rangeCount;
+        }
+
+        // The culling shaders and the graphics pipelines wait for the copies
+        VkBufferMemoryBarrier2 waitForCopies[BLIT_ARRAY_SIZE(pUpdates)] = {};
+        barrierCount = 0;
+        for(uint32_t i = 0; i < BLIT_ARRAY_SIZE(pUpdates); ++i)
+        {
+            if(!bChanged[i])
+                continue;
+            BufferMemoryBarrier(dstBuffers[i], waitForCopies[barrierCount++], VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, 
+            readStages, readAccess, 0, VK_WHOLE_SIZE);
+        }
+        PipelineBarrier(commandBuffer, 0, nullptr, barrierCount, waitForCopies, 0, nullptr);
+    }
+
+    void VulkanRenderer::RecordRenderObjectStateResets(VkCommandBuffer commandBuffer, BufferUpdate& renderObjectUpdate)
+    {
+        if(!renderObjectUpdate.rangeCount)
+            return;
+
+        VkBuffer visibilityBuffer = m_currentStaticBuffers.visibilityBuffer.buffer.buffer;
+        VkBuffer lodHistoryBuffer = m_currentStaticBuffers.lodHistoryBuffer.buffer.buffer;
+
+        // The culling shaders of the previous frames need to be done with both buffers
+        VkBufferMemoryBarrier2 waitBeforeClearing[2] = {};
+        BufferMemoryBarrier(visibilityBuffer, waitBeforeClearing[0], VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, 
+        VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT, 
+        VK_ACCESS_2_TRANSFER_WRITE_BIT, 0, VK_WHOLE_SIZE);
+        BufferMemoryBarrier(lodHistoryBuffer, waitBeforeClearing[1], VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, 
+        VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT, 
+        VK_ACCESS_2_TRANSFER_WRITE_BIT, 0, VK_WHOLE_SIZE);
+        PipelineBarrier(commandBuffer, 0, nullptr, BLIT_ARRAY_SIZE(waitBeforeClearing), waitBeforeClearing, 0, nullptr);
+
+        // Fills work on whole words, so the ranges are widened to 32 objects for the visibility bits and 4 objects for the LOD history.
+        // The neighbours that are cleared with them are only tested by the late pass and restart their LOD hysteresis for one frame.
+        // The ranges are sorted, widened ranges that touch are merged so that no word is filled twice
+        uint32_t visibilityBegin = 0, visibilityEnd = 0;
+        uint32_t historyBegin = 0, historyEnd = 0;
+        for(uint32_t i = 0; i <= renderObjectUpdate.rangeCount; ++i)
+        {
+            uint8_t bLast = i == renderObjectUpdate.rangeCount;
+            uint32_t first = bLast ? UINT32_MAX : renderObjectUpdate.pRanges[i].firstElement;
+            uint32_t end = bLast ? UINT32_MAX : first + renderObjectUpdate.pRanges[i].elementCount;
+
+            uint32_t wordBegin = first / 32;
+            uint32_t wordEnd = bLast ? UINT32_MAX : (end + 31) / 32;
+            if(bLast || wordBegin > visibilityEnd)
+            {
+                if(visibilityEnd > visibilityBegin)
+                    vkCmdFillBuffer(commandBuffer, visibilityBuffer, sizeof(uint32_t) * visibilityBegin, 
+                    sizeof(uint32_t) * (visibilityEnd - visibilityBegin), 0);
+                visibilityBegin = wordBegin;
+            }
+            visibilityEnd = wordEnd;
+
+            wordBegin = first / 4;
+            wordEnd = bLast ? UINT32_MAX : (end + 3) / 4;
+            if(bLast || wordBegin > historyEnd)
+            {
+                if(historyEnd > historyBegin)
+                    vkCmdFillBuffer(commandBuffer, lodHistoryBuffer, sizeof(uint32_t) * historyBegin, 
+                    sizeof(uint32_t) * (historyEnd - historyBegin), 0);
+                historyBegin = wordBegin;
+            }
+            historyEnd = wordEnd;
+        }
+
+        VkBufferMemoryBarrier2 waitForClears[2] = {};
+        BufferMemoryBarrier(visibilityBuffer, waitForClears[0], VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, 
+        0, VK_WHOLE_SIZE);
+        BufferMemoryBarrier(lodHistoryBuffer, waitForClears[1], VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, 
+        0, VK_WHOLE_SIZE);
+        PipelineBarrier(commandBuffer, 0, nullptr, BLIT_ARRAY_SIZE(waitForClears), waitForClears, 0, nullptr);
+    }
+
+    void VulkanRenderer::ReadFrameTimestamps(FrameTools& fTools)
+    {
+        if(!fTools.bTimestampsWritten)
+            return;
+
+        // The in flight fence was waited on, so the results are already available
+        uint64_t timestamps[2] = {};
+        if(vkGetQueryPoolResults(m_device, fTools.timestampQueryPool, 0, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), 
+        VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+            return;
+
+        // Switching between the vertex and mesh shading paths restarts the average, so that their frames are never mixed
+        if(fTools.bMeshShadingFrame != m_bTimedMeshShading)
+        {
+            m_bTimedMeshShading = fTools.bMeshShadingFrame;
+            m_gpuFrameTimeSum = 0.0;
+            m_gpuFrameTimeCount = 0;
+        }
+
+        double frameTime = double(timestamps[1] - timestamps[0]) * double(m_stats.timestampPeriod) * 1e-6;
+        m_lastGpuFrameTime = frameTime;
+        m_gpuFrameTimeTotals[fTools.bMeshShadingFrame != 0] += frameTime;
+        ++m_gpuFrameTimeTotalCounts[fTools.bMeshShadingFrame != 0];
+
+        m_gpuFrameTimeSum += frameTime;
+        ++m_gpuFrameTimeCount;
+        if(m_gpuFrameTimeCount == BLITZEN_VULKAN_GPU_TIME_LOG_INTERVAL)
+        {
+            BLIT_INFO("GPU frame time (%s): %f ms", m_bTimedMeshShading ? "mesh shading" : "vertex shader", 
+            m_gpuFrameTimeSum / m_gpuFrameTimeCount)
+            m_gpuFrameTimeSum = 0.0;
+            m_gpuFrameTimeCount = 0;
+        }
     }
 
     void VulkanRenderer::DispatchRenderObjectCullingComputeShader(VkCommandBuffer commandBuffer, VkPipeline pipeline,
     uint32_t descriptorWriteCount, VkWriteDescriptorSet* pDescriptorWrites, uint32_t drawCount, 
-    uint8_t lateCulling /*=0*/, uint8_t postPass /*=0*/, uint8_t bOcclusionEnabled /*=1*/, uint8_t bLODs /*=1*/)
+    uint8_t lateCulling /*=0*/, uint8_t postPass /*=0*/, uint8_t bOcclusionEnabled /*=1*/, uint8_t bLODs /*=1*/, uint8_t bInstancing /*=0*/, 
+    uint8_t bMeshShading /*=0*/)
     {
         // If this is after the first render pass, the shader will also need the depth pyramid image sampler to do occlusion culling
         if(lateCulling)
@@ -779,7 +1551,37 @@ namespace BlitzenVulkan
         // Initialize the indirect count buffer as zero
         vkCmdFillBuffer(commandBuffer, m_currentStaticBuffers.indirectCountBuffer.buffer.buffer, 0, sizeof(uint32_t), 0);
 
-        VkBufferMemoryBarrier2 waitBeforeDispatchingShaders[3] = {};
+        // The previous render object culling shader needs to be done with the expanded object list and its dispatch command, 
+        // before the header is reset. The object count starts from zero and so does the group count, until the mesh instance culling shader grows it
+        VkBufferMemoryBarrier2 waitBeforeResettingExpandedObjects{};
+        BufferMemoryBarrier(m_currentStaticBuffers.expandedObjectBuffer.buffer.buffer, waitBeforeResettingExpandedObjects, 
+        VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, 
+        VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT, 
+        VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, 0, VK_WHOLE_SIZE);
+        PipelineBarrier(commandBuffer, 0, nullptr, 1, &waitBeforeResettingExpandedObjects, 0, nullptr);
+        ExpandedObjectHeader expandedObjectHeader{{0, 1, 1}, 0};
+        vkCmdUpdateBuffer(commandBuffer, m_currentStaticBuffers.expandedObjectBuffer.buffer.buffer, 0, 
+        sizeof(ExpandedObjectHeader), &expandedObjectHeader);
+
+        // When instancing is enabled, the bucket instance counts and the instancing counters also need to start from zero
+        if(bInstancing)
+        {
+            // Wait for the previous instancing shaders to be done with the buckets and the counters before zeroing them
+            VkBufferMemoryBarrier2 waitBeforeZeroingInstancingBuffers[2] = {};
+            BufferMemoryBarrier(m_currentStaticBuffers.instanceBucketBuffer.buffer.buffer, waitBeforeZeroingInstancingBuffers[0], 
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, 
+            VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, 0, VK_WHOLE_SIZE);
+            BufferMemoryBarrier(m_currentStaticBuffers.instancingCounterBuffer.buffer.buffer, waitBeforeZeroingInstancingBuffers[1], 
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, 
+            VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, 0, VK_WHOLE_SIZE);
+            PipelineBarrier(commandBuffer, 0, nullptr, BLIT_ARRAY_SIZE(waitBeforeZeroingInstancingBuffers), 
+            waitBeforeZeroingInstancingBuffers, 0, nullptr);
+
+            vkCmdFillBuffer(commandBuffer, m_currentStaticBuffers.instanceBucketBuffer.buffer.buffer, 0, VK_WHOLE_SIZE, 0);
+            vkCmdFillBuffer(commandBuffer, m_currentStaticBuffers.instancingCounterBuffer.buffer.buffer, 0, VK_WHOLE_SIZE, 0);
+        }
+
+        VkBufferMemoryBarrier2 waitBeforeDispatchingShaders[8] = {};
         // Before dispatching the compute shader, it needs to wait for the transfer command above to Zero out the indirect count buffer
         BufferMemoryBarrier(m_currentStaticBuffers.indirectCountBuffer.buffer.buffer, waitBeforeDispatchingShaders[0], 
         VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, 
@@ -800,34 +1602,99 @@ namespace BlitzenVulkan
         VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, 
         0, VK_WHOLE_SIZE);
 
+        // The mesh instance culling shader needs to wait for the expanded object header to be reset
+        BufferMemoryBarrier(m_currentStaticBuffers.expandedObjectBuffer.buffer.buffer, waitBeforeDispatchingShaders[3], 
+        VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, 
+        0, VK_WHOLE_SIZE);
+
+        // The LOD history is read and written by the culling shaders like the visibility buffer
+        BufferMemoryBarrier(m_currentStaticBuffers.lodHistoryBuffer.buffer.buffer, waitBeforeDispatchingShaders[4], 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, 
+        0, VK_WHOLE_SIZE);
+
+        // With instancing, the culling shader also needs to wait for the buckets and counters to be zeroed
+        uint32_t waitBeforeDispatchingShadersCount = 5;
+        if(bInstancing)
+        {
+            BufferMemoryBarrier(m_currentStaticBuffers.instanceBucketBuffer.buffer.buffer, waitBeforeDispatchingShaders[5], 
+            VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, 
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, 
+            0, VK_WHOLE_SIZE);
+            BufferMemoryBarrier(m_currentStaticBuffers.instancingCounterBuffer.buffer.buffer, waitBeforeDispatchingShaders[6], 
+            VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, 
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, 
+            0, VK_WHOLE_SIZE);
+            waitBeforeDispatchingShadersCount = 7;
+        }
+        // With mesh shading, the previous task shader needs to be done with the indirect task buffer before it is written again
+        else if(bMeshShading)
+        {
+            BufferMemoryBarrier(m_currentStaticBuffers.indirectTaskBuffer.buffer.buffer, waitBeforeDispatchingShaders[5], 
+            VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_TASK_SHADER_BIT_EXT, 
+            VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT, 
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, 0, VK_WHOLE_SIZE);
+            waitBeforeDispatchingShadersCount = 6;
+        }
+
         // The late culling shader needs to wait for the 2 barriers above but it also needs to wait for the depth pyramid to be generated
         if(lateCulling)
         {
-            // Stops the culling shader from reading for the depth pyramid before it is complete
+            // Stops the culling shader from reading for the depth pyramid before it is complete.
+            // With mesh shading, the task shader of the next render pass also reads it
             VkImageMemoryBarrier2 waitForDepthPyramidGeneration{};
             ImageMemoryBarrier(m_depthPyramid.image, waitForDepthPyramidGeneration, 
             VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, 
-            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, 
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | (bMeshShading ? VK_PIPELINE_STAGE_2_TASK_SHADER_BIT_EXT : 0), 
+            VK_ACCESS_2_SHADER_READ_BIT, 
             VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, 
             VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS);
             // Adds the 2 barriers above and the image memory barrier
-            PipelineBarrier(commandBuffer, 0, nullptr, 3, waitBeforeDispatchingShaders, 1, &waitForDepthPyramidGeneration);
+            PipelineBarrier(commandBuffer, 0, nullptr, waitBeforeDispatchingShadersCount, waitBeforeDispatchingShaders, 
+            1, &waitForDepthPyramidGeneration);
         }
         // If this is the initial culling stage, simply adds the 2 barriers
         else
         {
-            PipelineBarrier(commandBuffer, 0, nullptr, 3, waitBeforeDispatchingShaders, 0, nullptr);
+            PipelineBarrier(commandBuffer, 0, nullptr, waitBeforeDispatchingShadersCount, waitBeforeDispatchingShaders, 0, nullptr);
         }
 
+        // The mesh instance culling shader goes over every instance, so the draw count of its push constant is the instance count
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_meshInstanceCullPipeline);
+        DrawCullShaderPushConstant instancePc{m_meshInstanceCount, postPass};
+        vkCmdPushConstants(commandBuffer, m_drawCullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, 
+        sizeof(DrawCullShaderPushConstant), &instancePc);
+        vkCmdDispatch(commandBuffer, (m_meshInstanceCount / 64) + 1, 1, 1);
+
+        // The render object culling shader reads the expanded objects and is dispatched with the command that was written with them.
+        // It also needs the visibility bits that were cleared for the objects of culled instances
+        VkBufferMemoryBarrier2 waitForMeshInstanceCulling[2] = {};
+        BufferMemoryBarrier(m_currentStaticBuffers.expandedObjectBuffer.buffer.buffer, waitForMeshInstanceCulling[0], 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, 
+        VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, 
+        VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT, 0, VK_WHOLE_SIZE);
+        BufferMemoryBarrier(m_currentStaticBuffers.visibilityBuffer.buffer.buffer, waitForMeshInstanceCulling[1], 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, 
+        0, VK_WHOLE_SIZE);
+        PipelineBarrier(commandBuffer, 0, nullptr, BLIT_ARRAY_SIZE(waitForMeshInstanceCulling), waitForMeshInstanceCulling, 0, nullptr);
+
         // Binds the shader's pipeline
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
         // Pass the push constant value
-        DrawCullShaderPushConstant pc{drawCount, postPass, bOcclusionEnabled, bLODs};
+        DrawCullShaderPushConstant pc{drawCount, postPass, bOcclusionEnabled, bLODs, bInstancing, bMeshShading};
         vkCmdPushConstants(commandBuffer, m_drawCullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, 
         sizeof(DrawCullShaderPushConstant), &pc);
-        vkCmdDispatch(commandBuffer, (drawCount / 64) + 1, 1, 1);
+        vkCmdDispatchIndirect(commandBuffer, m_currentStaticBuffers.expandedObjectBuffer.buffer.buffer, 
+        offsetof(ExpandedObjectHeader, dispatchCommand));
 
-        VkBufferMemoryBarrier2 waitForCullingShader[3] = {};
+        // With instancing, the culling shader only filled the buckets, the draw commands are created by the instancing shaders
+        if(bInstancing)
+            DispatchInstanceBucketCompaction(commandBuffer, drawCount);
+
+        VkBufferMemoryBarrier2 waitForCullingShader[5] = {};
+        uint32_t waitForCullingShaderCount = 4;
         // Wait for the culling shader to write the indirect count buffer before reading in draw indirect stage
         BufferMemoryBarrier(m_currentStaticBuffers.indirectCountBuffer.buffer.buffer, waitForCullingShader[0], 
         VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, 
@@ -846,13 +1713,79 @@ namespace BlitzenVulkan
         VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, 
         VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, 
         0, VK_WHOLE_SIZE);
+
+        // Same for the LOD history
+        BufferMemoryBarrier(m_currentStaticBuffers.lodHistoryBuffer.buffer.buffer, waitForCullingShader[3], 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, 
+        0, VK_WHOLE_SIZE);
+
+        // The vertex shader needs to wait for the scatter shader to write the instance buffer
+        if(bInstancing)
+        {
+            BufferMemoryBarrier(m_currentStaticBuffers.instanceBuffer.buffer.buffer, waitForCullingShader[4], 
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, 
+            VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, 0, VK_WHOLE_SIZE);
+            waitForCullingShaderCount = 5;
+        }
+        // The draw indirect stage reads the task commands and the task shader reads the object and its meshlet range
+        else if(bMeshShading)
+        {
+            BufferMemoryBarrier(m_currentStaticBuffers.indirectTaskBuffer.buffer.buffer, waitForCullingShader[4], 
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, 
+            VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_TASK_SHADER_BIT_EXT, 
+            VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT, 0, VK_WHOLE_SIZE);
+            waitForCullingShaderCount = 5;
+        }
         
         // Add the above barriers
+        PipelineBarrier(commandBuffer, 0, nullptr, waitForCullingShaderCount, waitForCullingShader, 0, nullptr);
+    }
+
+    void VulkanRenderer::DispatchInstanceBucketCompaction(VkCommandBuffer commandBuffer, uint32_t drawCount)
+    {
+        // Wait for the culling shader to fill the buckets and the visible instance list
+        VkBufferMemoryBarrier2 waitForCullingShader[3] = {};
+        BufferMemoryBarrier(m_currentStaticBuffers.instanceBucketBuffer.buffer.buffer, waitForCullingShader[0], 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, 0, VK_WHOLE_SIZE);
+        BufferMemoryBarrier(m_currentStaticBuffers.visibleInstanceBuffer.buffer.buffer, waitForCullingShader[1], 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, 0, VK_WHOLE_SIZE);
+        BufferMemoryBarrier(m_currentStaticBuffers.instancingCounterBuffer.buffer.buffer, waitForCullingShader[2], 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, 0, VK_WHOLE_SIZE);
         PipelineBarrier(commandBuffer, 0, nullptr, BLIT_ARRAY_SIZE(waitForCullingShader), waitForCullingShader, 0, nullptr);
+
+        // The bucket compaction shader goes over every bucket, so the draw count of its push constant is the bucket count.
+        // The culling pipeline layout is shared, so the descriptors pushed for the culling shader are still valid
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_instanceBucketCompactionPipeline);
+        DrawCullShaderPushConstant compactionPc{m_instanceBucketCount, 0};
+        vkCmdPushConstants(commandBuffer, m_drawCullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, 
+        sizeof(DrawCullShaderPushConstant), &compactionPc);
+        vkCmdDispatch(commandBuffer, (m_instanceBucketCount / 64) + 1, 1, 1);
+
+        // The scatter shader needs the bucket offsets. It also needs the previous draw to be done with the instance buffer
+        VkBufferMemoryBarrier2 waitForCompactionShader[2] = {};
+        BufferMemoryBarrier(m_currentStaticBuffers.instanceBucketBuffer.buffer.buffer, waitForCompactionShader[0], 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, 0, VK_WHOLE_SIZE);
+        BufferMemoryBarrier(m_currentStaticBuffers.instanceBuffer.buffer.buffer, waitForCompactionShader[1], 
+        VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, 0, VK_WHOLE_SIZE);
+        PipelineBarrier(commandBuffer, 0, nullptr, BLIT_ARRAY_SIZE(waitForCompactionShader), waitForCompactionShader, 0, nullptr);
+
+        // The scatter shader is dispatched for the draw count, since the amount of visible objects is only known by the GPU
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_instanceScatterPipeline);
+        DrawCullShaderPushConstant scatterPc{drawCount, 0};
+        vkCmdPushConstants(commandBuffer, m_drawCullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, 
+        sizeof(DrawCullShaderPushConstant), &scatterPc);
+        vkCmdDispatch(commandBuffer, (drawCount / 64) + 1, 1, 1);
     }
 
     void VulkanRenderer::DrawGeometry(VkCommandBuffer commandBuffer, VkWriteDescriptorSet* pDescriptorWrites, uint32_t drawCount, 
-    uint8_t latePass, VkPipeline pipeline)
+    uint8_t latePass, VkPipeline pipeline, uint8_t bInstancing /*=0*/, uint8_t bMeshShading /*=0*/, uint8_t bOcclusion /*=0*/, 
+    uint8_t postPass /*=0*/, uint8_t bLOD /*=0*/)
     {
         // Creates info for the color attachment 
         VkRenderingAttachmentInfo colorAttachmentInfo{};
@@ -868,9 +1801,28 @@ namespace BlitzenVulkan
         BeginRendering(commandBuffer, m_drawExtent, {0, 0}, 1, &colorAttachmentInfo, 
         &depthAttachmentInfo, nullptr);
 
+        // The mesh shading pipelines also need the meshlets, the task commands and the depth pyramid.
+        // The pyramid is only sampled after it has been generated this frame, so the initial pass can push it as well
+        uint32_t graphicsWriteCount = BLIT_ARRAY_SIZE(pushDescriptorWritesGraphics) - 4;
+        VkDescriptorImageInfo depthPyramidImageInfo{};
+        if(bMeshShading)
+        {
+            WriteImageDescriptorSets(pDescriptorWrites[graphicsWriteCount + 3], depthPyramidImageInfo, 
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_NULL_HANDLE, 3, VK_IMAGE_LAYOUT_GENERAL, 
+            m_depthPyramid.imageView, m_depthAttachmentSampler);
+            graphicsWriteCount = BLIT_ARRAY_SIZE(pushDescriptorWritesGraphics);
+        }
+
         // Pushes all uniform buffer descriptors but the culling data one to the graphics pipelines
         PushDescriptors(m_initHandles.instance, commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, 
-        m_opaqueGeometryPipelineLayout, 0, 7, pDescriptorWrites);
+        m_opaqueGeometryPipelineLayout, 0, graphicsWriteCount, pDescriptorWrites);
+
+        // Tells the vertex shader if it should find objects through the instance buffer, 
+        // and the task shader which meshlet culling tests it should do and if it should select clusters by their error
+        GraphicsShaderPushConstant graphicsPc{bInstancing, uint32_t(latePass && bOcclusion), postPass, bLOD};
+        vkCmdPushConstants(commandBuffer, m_opaqueGeometryPipelineLayout, 
+        VK_SHADER_STAGE_VERTEX_BIT | (m_stats.meshShaderSupport ? VK_SHADER_STAGE_TASK_BIT_EXT : 0), 0, 
+        sizeof(GraphicsShaderPushConstant), &graphicsPc);
 
         // Bind the texture descriptor set. This one was allocated and written to in the UploadDataToGPU function
         vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_opaqueGeometryPipelineLayout, 1,
@@ -881,7 +1833,7 @@ namespace BlitzenVulkan
         vkCmdBindIndexBuffer(commandBuffer, m_currentStaticBuffers.indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
 
         // Use draw indirect to draw the objects(mesh shading or vertex shader)
-        if(m_stats.meshShaderSupport)
+        if(bMeshShading)
         {
             DrawMeshTasks(m_initHandles.instance, commandBuffer, m_currentStaticBuffers.indirectTaskBuffer.buffer.buffer, 
             offsetof(IndirectTaskData, drawIndirectTasks), m_currentStaticBuffers.indirectCountBuffer.buffer.buffer, 0,
@@ -905,9 +1857,10 @@ namespace BlitzenVulkan
         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_DEPTH_BIT, 
         0, VK_REMAINING_MIP_LEVELS);
 
-        // The depth pyramid image needs to transition to general layout after the culling compute shader has read it
+        // The depth pyramid image needs to transition to general layout after the culling compute shader (or the task shader) has read it
         ImageMemoryBarrier(m_depthPyramid.image, depthTransitionBarriers[1], 
-        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, 
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | (m_stats.meshShaderSupport ? VK_PIPELINE_STAGE_2_TASK_SHADER_BIT_EXT : 0), 
+        VK_ACCESS_2_SHADER_READ_BIT, 
         VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, 
         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 
         VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS);
@@ -55,6 +55,18 @@ namespace BlitzenVulkan
         VkFence inFlightFence;
         VkSemaphore imageAcquiredSemaphore;
         VkSemaphore readyToPresentSemaphore;        
+
+        // Streamed texture levels are copied to their new images by this command buffer, submitted ahead of the frame's.
+        // The staging buffer holds the levels that were read for it. Both are free again once the frame's fence is signaled
+        VkCommandBuffer textureStreamingCommandBuffer;
+        AllocatedBuffer mipStaging;
+        VkDeviceSize mipStagingCapacity = 0;
+
+        // Timestamps written at the start and the end of the frame's command buffer. Read after the in flight fence is signaled.
+        // The path that drew the frame is saved with them, so that the frame time is logged with the right name
+        VkQueryPool timestampQueryPool = VK_NULL_HANDLE;
+        uint8_t bTimestampsWritten = 0;
+        uint8_t bMeshShadingFrame = 0;
     };
 
     // Holds a buffer that is bound to a descriptor binding using push descriptors
@@ -82,6 +94,16 @@ namespace BlitzenVulkan
         // The global view data buffer is a uniform buffer that will be part of the push descriptor layout at binding 0
         // It will hold view data like the view matrix or frustum planes data
         PushDescriptorBuffer<BlitzenEngine::CameraViewData> viewDataBuffer{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER};
+
+        // The texture feedback buffer is a storage buffer that will be part of the push descriptor layout at binding 21
+        // It will hold the size on screen that each texture is needed at, written by the late culling shaders and read back after the frame
+        PushDescriptorBuffer<uint32_t> textureFeedbackBuffer{21, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+
+        // Persistently mapped buffer that holds the data that changed this frame, until it is copied to the static buffers.
+        // Created the first time something is updated
+        AllocatedBuffer uploadBuffer;
+        void* pUploadData = nullptr;
+        VkDeviceSize uploadBufferSize = 0;
     };
 
     // Holds data for buffers that will be loaded once and will be used for every object
@@ -130,8 +152,44 @@ namespace BlitzenVulkan
         PushDescriptorBuffer<void> indirectCountBuffer{9, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
 
         // The visibility buffer is a storage buffer thta will be part of the push descriptor layout at binding 10
-        // It will hold either 1 or 0 for each object based on if they were visible last frame or not
+        // It will hold one bit for each object based on if they were visible last frame or not, packed in 32 object words
         PushDescriptorBuffer<void> visibilityBuffer{10, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};  
+
+        // The instance bucket buffer is a storage buffer that will be part of the push descriptor layout at binding 14
+        // It will hold the instance count and instance offset of every surface and LOD combination, when instancing is enabled
+        PushDescriptorBuffer<void> instanceBucketBuffer{14, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+
+        // The instance buffer is a storage buffer that will be part of the push descriptor layout at binding 15
+        // It will hold the object IDs of each instanced draw in a continuous range, accessed by the vertex shader
+        PushDescriptorBuffer<void> instanceBuffer{15, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+
+        // The visible instance buffer is a storage buffer that will be part of the push descriptor layout at binding 16
+        // It will hold every object that passed culling with its bucket, until the instance buffer offsets are known
+        PushDescriptorBuffer<void> visibleInstanceBuffer{16, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+
+        // The instancing counter buffer is a storage buffer that will be part of the push descriptor layout at binding 17
+        // It will hold the size of the visible instance list and the amount of reserved instance buffer elements
+        PushDescriptorBuffer<void> instancingCounterBuffer{17, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+
+        // The mesh instance buffer is a storage buffer that will be part of the push descriptor layout at binding 18
+        // It will hold the bounding sphere, transform and render object ranges of every mesh instance
+        PushDescriptorBuffer<void> meshInstanceBuffer{18, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+
+        // The instance object buffer is a storage buffer that will be part of the push descriptor layout at binding 19
+        // It will hold the render object indices of every mesh instance, grouped by instance
+        PushDescriptorBuffer<void> instanceObjectBuffer{19, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+
+        // The expanded object buffer is a storage buffer that will be part of the push descriptor layout at binding 20
+        // It will hold the render objects of the mesh instances that passed culling and the indirect dispatch command that goes over them
+        PushDescriptorBuffer<void> expandedObjectBuffer{20, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+
+        // The texture LOD buffer is a storage buffer that will be part of the push descriptor layout at binding 22
+        // It will hold the minimum LOD that each texture is sampled at by the fragment shader, while streamed levels fade in
+        PushDescriptorBuffer<void> textureLodBuffer{22, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+
+        // The LOD history buffer is a storage buffer that will be part of the push descriptor layout at binding 23
+        // It will hold one byte for each object with the LOD that the culling shaders selected for it on the last frame that it was drawn
+        PushDescriptorBuffer<void> lodHistoryBuffer{23, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
     };
 
     class VulkanRenderer
@@ -146,10 +204,27 @@ namespace BlitzenVulkan
         // Prototype function for textures, used with stb_image. Might want to remove this, since Blitzen works with DDS textures now
         void UploadTexture(BlitzenEngine::TextureStats& newTexture, VkFormat format);
 
-        // Function for DDS texture loading
+        // Function for DDS texture loading. The data pointer is not used, the image data is read straight to the staging pool
         uint8_t UploadDDSTexture(BlitzenEngine::DDS_HEADER& header, BlitzenEngine::DDS_HEADER_DXT10& header10, 
         void* pData, const char* filepath);
 
+        // Probes every texture first, so that the staging memory for all of them is planned before any image data is read.
+        // The data is then read straight to the staging pool and the copies of a whole batch are submitted together.
+        // The textures that were uploaded are marked as loaded and get the next texture tags, in order
+        uint8_t UploadDDSTextures(BlitzenEngine::DDSTextureProbe* pTextures, uint32_t textureCount);
+
+        // Frees the staging pool. The next texture upload creates it again, at the size it needs
+        void ReleaseTextureStaging();
+
+        // Uploads a texture that was read by the scene streamer after the renderer was set up. Its slot of the texture descriptor table 
+        // points to it from the next frame. The data is the DDS image data that was loaded for Vulkan
+        uint8_t UploadStreamedTexture(uint32_t textureTag, BlitzenEngine::DDS_HEADER& header, unsigned int format, 
+        void* pData, size_t dataSize);
+
+        // Points the slots of streamed textures that were unloaded back to the first texture. Their images are destroyed 
+        // and their tags are given back to the texture slots once the frames in flight are done with them
+        void ReleaseStreamedTextures(const uint32_t* pTags, uint32_t count);
+
         // Called each frame to draw the scene that is requested by the engine
         void DrawFrame(DrawContext& context);
 
@@ -187,19 +262,43 @@ namespace BlitzenVulkan
         BlitCL::DynamicArray<BlitzenEngine::Meshlet>& meshlets, 
         BlitCL::DynamicArray<uint32_t>& meshletData,
         BlitCL::DynamicArray<BlitzenEngine::PrimitiveSurface>& surfaces, 
-        BlitCL::DynamicArray<BlitzenEngine::MeshTransform>& transforms);
+        BlitCL::DynamicArray<BlitzenEngine::MeshTransform>& transforms, 
+        BlitCL::DynamicArray<BlitzenEngine::MeshInstance>& meshInstances, 
+        BlitCL::DynamicArray<uint32_t>& instanceObjects, 
+        BlitzenEngine::BufferCapacities& capacities);
 
         // Since the way the graphics pipelines work is fixed and there are only 2 of them, the code is collected in this fixed function
-        uint8_t SetupMainGraphicsPipeline();
+        // The opaque fragment shader alpha tests impostor materials when some surface has a billboard LOD
+        uint8_t SetupMainGraphicsPipeline(uint8_t bImpostors);
 
-        // Dispatches the compute shader that will perform culling and LOD selection and will write to the indirect draw buffer.
+        // Dispatches the mesh instance culling shader and then the compute shader that will perform culling and LOD selection 
+        // on the render objects of the instances that passed, and will write to the indirect draw buffer.
+        // The draw count is the most render objects that the pass can have
         void DispatchRenderObjectCullingComputeShader(VkCommandBuffer commandBuffer, VkPipeline pipeline, 
-        uint32_t descriptorWriteCount, VkWriteDescriptorSet* pDescriptorWrites, uint32_t drawCount,
-        uint8_t lateCulling = 0, uint8_t postPass = 0, uint8_t bOcclusionEnabled = 1, uint8_t bLODs = 1);
+        uint32_t descriptorWriteCount, VkWriteDescriptorSet* pDescriptorWrites, uint32_t drawCount, 
+        uint8_t lateCulling = 0, uint8_t postPass = 0, uint8_t bOcclusionEnabled = 1, uint8_t bLODs = 1, uint8_t bInstancing = 0, 
+        uint8_t bMeshShading = 0);
 
-        // Handles draw calls using draw indirect commands that should already be set by culling compute shaders
+        // Called after a culling shader when instancing is enabled. 
+        // Gives each instance bucket its range of the instance buffer, creates the instanced draw commands and fills the instance buffer
+        void DispatchInstanceBucketCompaction(VkCommandBuffer commandBuffer, uint32_t drawCount);
+
+        // Handles draw calls using draw indirect commands that should already be set by culling compute shaders.
+        // With mesh shading the task shader also culls meshlets, and tests them against the depth pyramid if occlusion is set
         void DrawGeometry(VkCommandBuffer commandBuffer, VkWriteDescriptorSet* pDescriptorWrites, uint32_t drawCount, 
-        uint8_t latePass, VkPipeline pipeline);
+        uint8_t latePass, VkPipeline pipeline, uint8_t bInstancing = 0, uint8_t bMeshShading = 0, uint8_t bOcclusion = 0, 
+        uint8_t postPass = 0, uint8_t bLOD = 0);
+
+        // Copies the transform, render object and mesh instance ranges that changed since the last frame through the frame's upload buffer,
+        // along with the geometry and materials of streamed scenes. Recorded before the initial culling pass
+        void RecordBufferUpdates(VkCommandBuffer commandBuffer, VarBuffers& vBuffers, DrawContext& context);
+
+        // Render objects are moved when others are added or removed, but the visibility bits and LOD history are kept by index.
+        // Clears both for the render object ranges of the update, so that no object inherits the state of the one that was there before
+        void RecordRenderObjectStateResets(VkCommandBuffer commandBuffer, BufferUpdate& renderObjectUpdate);
+
+        // Reads the timestamps of the frame that last used these frame tools and logs the average GPU frame time every few frames
+        void ReadFrameTimestamps(FrameTools& fTools);
 
         // For occlusion culling to be possible a depth pyramid needs to be generated based on the depth attachment
         void GenerateDepthPyramid(VkCommandBuffer commandBuffer);
@@ -207,6 +306,31 @@ namespace BlitzenVulkan
         // Recreates the swapchain when necessary (and other handles that are involved with the window, like the depth pyramid)
         void RecreateSwapchain(uint32_t windowWidth, uint32_t windowHeight);
 
+        // Makes sure that the staging pool holds at least the size. It is only grown, all of its previous uploads need to be done
+        uint8_t ReserveTextureStaging(VkDeviceSize size);
+
+        // Called once the frame's fence is signaled. Writes the texture descriptors that no frame in flight can read anymore, 
+        // with a single update, and frees what the unloaded textures left
+        void FlushTextureDescriptorUpdates();
+
+        // Texture streaming, implemented in vulkanTextureStreaming.cpp
+        // Keeps what is needed to read the levels above the mip tail of a texture that was loaded without them
+        void RegisterStreamedTexture(uint32_t textureTag, const BlitzenEngine::DDSTextureProbe& probe, uint32_t tailLevel);
+
+        // Called once the frame's fence is signaled. Reads the texture sizes that the culling shaders wrote for that frame, 
+        // uploads the levels that finished reading, gives memory back when over the budget and starts reading the levels that are now needed
+        void UpdateTextureStreaming(VarBuffers& vBuffers);
+
+        // Recreates the images of the textures with the new resident levels. The levels that both images have are copied from the old one
+        // Recorded on the frame's texture streaming command buffer. The old images are retired once the frames in flight are done with them
+        void CommitTextureMips(FrameTools& fTools, StreamedTextureMips** ppTextures, uint32_t* pNewLevels, uint32_t textureCount);
+
+        // Copies the minimum LODs that changed since the last frame to the texture LOD buffer
+        void RecordTextureLodUpdates(VkCommandBuffer commandBuffer);
+
+        // Waits for the texture reads and frees the streaming state
+        void ShutdownTextureStreaming();
+
     public:
 
         // Static function that allows access to vulkan renderer at any scope
@@ -214,13 +338,27 @@ namespace BlitzenVulkan
 
         inline VulkanStats GetStats() const {return m_stats;}
 
-        // Array of structs that represent the way textures will be pushed to the GPU
-        TextureData loadedTextures[BLIT_MAX_TEXTURE_COUNT];
+        // The sum of the GPU frame times of every frame that was drawn with one of the paths, and how many there were. 
+        // Frames are read after their fence, so the last frames in flight are not counted yet
+        inline void GetGpuFrameTimeTotal(uint8_t bMeshShading, double& totalTime, uint64_t& frameCount) const {
+            totalTime = m_gpuFrameTimeTotals[bMeshShading != 0];
+            frameCount = m_gpuFrameTimeTotalCounts[bMeshShading != 0];
+        }
+
+        // The GPU time of the last frame that was read in milliseconds, or 0 if the device has no timestamp queries
+        inline double GetLastGpuFrameTime() const { return m_lastGpuFrameTime; }
+
+        // Array of structs that represent the way textures will be pushed to the GPU. Grows in chunks as textures are loaded
+        BlitCL::ChunkedArray<TextureData, BLIT_TEXTURE_CHUNK_SIZE> loadedTextures;
         size_t textureCount = 0;
 
         // Used to allocate vulkan resources like buffers and images
         VmaAllocator m_allocator;
 
+        // Mapped staging memory that texture image data is read to, shared by every texture upload
+        AllocatedBuffer m_textureStagingPool;
+        VkDeviceSize m_textureStagingCapacity = 0;
+
         // Handle to the logical device
         VkDevice m_device;
 
@@ -271,8 +409,9 @@ namespace BlitzenVulkan
         */
         VkDescriptorSetLayout m_pushDescriptorBufferLayout;
 
-        VkWriteDescriptorSet pushDescriptorWritesGraphics[7];
-        VkWriteDescriptorSet pushDescriptorWritesCompute[8];
+        // The last 4 writes are only pushed for the mesh shading pipelines (meshlets, meshlet data, indirect tasks, depth pyramid)
+        VkWriteDescriptorSet pushDescriptorWritesGraphics[13];
+        VkWriteDescriptorSet pushDescriptorWritesCompute[19];
 
         /*
             Descriptor set layout for depth pyramid construction. 
@@ -293,6 +432,10 @@ namespace BlitzenVulkan
         VkDescriptorPool m_textureDescriptorPool;
         VkDescriptorSet m_textureDescriptorSet;
 
+        // The texture descriptor table has a slot for every texture tag, up to the max texture count. It is update after bind 
+        // and partially bound, so slots can be written while the set is bound, as long as the frames in flight do not read them
+        uint32_t m_textureDescriptorCapacity = 0;
+
     /*
         Pipelines section
     */
@@ -303,6 +446,10 @@ namespace BlitzenVulkan
         VkPipeline m_postPassGeometryPipeline;
         VkPipelineLayout m_opaqueGeometryPipelineLayout;
 
+        // Same as the above but with the task and mesh shaders instead of the vertex shader. Only created if mesh shaders are supported
+        VkPipeline m_opaqueMeshShaderPipeline;
+        VkPipeline m_postPassMeshShaderPipeline;
+
         // These are compute pipelines that hold the shaders that will perform culling operations on render object level
         // @InitialDrawCull
         // The initial culling shader will do frustum culling tests on the objects that were visible last frame
@@ -314,6 +461,18 @@ namespace BlitzenVulkan
         VkPipeline m_lateDrawCullPipeline;
         VkPipelineLayout m_drawCullPipelineLayout;
 
+        // Dispatched before each of the above with the culling pipeline layout. 
+        // Culls whole mesh instances and writes the render objects of the ones that passed for the render object culling shader
+        VkPipeline m_meshInstanceCullPipeline;
+
+        // These compute pipelines are dispatched after a culling shader when instancing is enabled. They use the culling pipeline layout
+        // @InstanceBucketCompaction
+        // Gives each instance bucket its range of the instance buffer with a prefix sum and creates one instanced draw for each bucket
+        // @InstanceScatter
+        // Writes the objects that passed culling to their bucket's range of the instance buffer
+        VkPipeline m_instanceBucketCompactionPipeline;
+        VkPipeline m_instanceScatterPipeline;
+
         // The depth pyramid generation pipeline will hold a helper compute shader for the late culling pipeline.
         // It will generate the depth pyramid from the 1st pass' depth buffer. It will then be used for occlusion culling 
         VkPipeline m_depthPyramidGenerationPipeline;
@@ -332,11 +491,68 @@ namespace BlitzenVulkan
         // Used to access the right frame tools depending on which ones are already being used
         size_t m_currentFrame = 0;
 
+        // Counts every frame that was drawn. The frames before this one minus the frames in flight are done on the GPU
+        uint64_t m_frameNumber = 0;
+
         // Holds stats that give information about how the vulkanRenderer is operating
         VulkanStats m_stats;
 
+        // Render objects are sorted so that opaque objects come first. 
+        // The opaque passes cull the objects before this count and the post pass culls the ones after it
+        uint32_t m_opaqueRenderObjectCount = 0;
+
+        // One instance bucket for each surface and LOD combination
+        uint32_t m_instanceBucketCount = 0;
+
+        // The mesh instance culling shader has one invocation for each mesh instance
+        uint32_t m_meshInstanceCount = 0;
+
+        // The copy regions of the runtime buffer updates are kept around so that they are not allocated every frame
+        BlitCL::DynamicArray<VkBufferCopy> m_bufferCopyRegions;
+
+        // GPU frame times are summed over a few frames and logged together, to compare the vertex and mesh shading paths
+        double m_gpuFrameTimeSum = 0.0;
+        uint32_t m_gpuFrameTimeCount = 0;
+        uint8_t m_bTimedMeshShading = 0;
+
+        // Every GPU frame time that was read, summed for the vertex [0] and mesh shading [1] paths
+        double m_gpuFrameTimeTotals[2] = {};
+        uint64_t m_gpuFrameTimeTotalCounts[2] = {};
+
+        // The GPU time of the last frame that was read, in milliseconds. Stays 0 without timestamp queries
+        double m_lastGpuFrameTime = 0.0;
+
         // I do not need a sampler for each texture and there is a limit for each device, so I'll need to create only a few samlplers
         VkSampler m_placeholderSampler;
+
+        // Textures that were loaded with their mip tail only. The state is allocated once, since the IO threads write to it
+        BlitCL::DynamicArray<StreamedTextureMips*> m_streamedTextures;
+        BlitzenPlatform::AsyncIO m_textureIO;
+        uint32_t m_textureReadCount = 0;
+
+        // Bytes of the levels above the mip tails that are resident or being read, 
+        // and the bytes that the last frame could not read because of the budget
+        VkDeviceSize m_streamedMipBytes = 0;
+        VkDeviceSize m_pendingMipBytes = 0;
+        VkDeviceSize m_mipBudgetShortfall = 0;
+
+        // CPU copy of the texture LOD buffer. The range that changed is uploaded with the next frame
+        BlitCL::DynamicArray<float> m_textureMinLods;
+        uint32_t m_textureLodDirtyBegin = UINT32_MAX;
+        uint32_t m_textureLodDirtyEnd = 0;
+
+        // Counts the frames, to know which textures were not used for the longest
+        uint32_t m_textureStreamingFrame = 0;
+
+        // The texture descriptor writes that wait for the frames in flight. Kept in the order they were asked for
+        BlitCL::DynamicArray<TextureDescriptorUpdate> m_textureDescriptorUpdates;
+
+        // Where the tags of unloaded textures are given back to. Taken from the rendering resources at setup
+        BlitzenEngine::TextureSlotAllocator* m_pTextureSlots = nullptr;
+
+        // Streamed textures are uploaded with their own command buffer, so that they do not wait for the frames in flight
+        VkCommandPool m_textureUploadCommandPool = VK_NULL_HANDLE;
+        VkCommandBuffer m_textureUploadCommandBuffer = VK_NULL_HANDLE;
     };
 
 
@@ -383,19 +599,20 @@ namespace BlitzenVulkan
     uint8_t CreateBuffer(VmaAllocator allocator, AllocatedBuffer& buffer, VkBufferUsageFlags bufferUsage, 
     VmaMemoryUsage memoryUsage, VkDeviceSize bufferSize, VmaAllocationCreateFlags allocationFlags);
 
-    // Create a gpu only storage buffer and a staging buffer to hold its data. Returns the address of the storage buffer if the caller requests it
+    // Create a gpu only storage buffer and a staging buffer to hold its data. Returns the address of the storage buffer if the caller requests it.
+    // If the storage capacity is bigger than the size, the storage buffer gets the capacity and the staging buffer only the size
     VkDeviceAddress CreateStorageBufferWithStagingBuffer(VmaAllocator allocator, VkDevice device, 
     void* pData, AllocatedBuffer& storageBuffer, AllocatedBuffer& stagingBuffer, 
-    VkBufferUsageFlags usage, VkDeviceSize size, uint8_t getBufferDeviceAddress = 0);
+    VkBufferUsageFlags usage, VkDeviceSize size, uint8_t getBufferDeviceAddress = 0, VkDeviceSize storageCapacity = 0);
 
     template <typename T = void>
     uint8_t SetupPushDescriptorBuffer(VkDevice device, VmaAllocator allocator, 
     PushDescriptorBuffer<T>& pushBuffer, AllocatedBuffer& stagingBuffer, 
-    VkDeviceSize bufferSize, VkBufferUsageFlags usage, void* pData)
+    VkDeviceSize bufferSize, VkBufferUsageFlags usage, void* pData, VkDeviceSize bufferCapacity = 0)
     {
         // Creates the storage buffer and the staging buffer that will hold its data
         CreateStorageBufferWithStagingBuffer(allocator, device, pData, pushBuffer.buffer, 
-        stagingBuffer, usage, bufferSize);
+        stagingBuffer, usage, bufferSize, 0, bufferCapacity);
         // Checks if the above function failed
         if(pushBuffer.buffer.buffer == VK_NULL_HANDLE)
             return 0;
@@ -436,9 +653,28 @@ namespace BlitzenVulkan
     VkFormat format, VkImageUsageFlags usage, VkCommandBuffer commandBuffer, VkQueue queue, uint8_t mipLevels = 1);
 
     // This function is similar to the above but it gives its own buffer and mip levels are required. 
-    // The buffer should already hold the texture data in pMappedData
+    // The buffer should already hold the texture data in pMappedData, starting at the offset
     uint8_t CreateTextureImage(AllocatedBuffer& buffer, VkDevice device, VmaAllocator allocator, AllocatedImage& image, 
-    VkExtent3D extent, VkFormat format, VkImageUsageFlags usage, VkCommandBuffer commandBuffer, VkQueue queue, uint8_t mipLevels);
+    VkExtent3D extent, VkFormat format, VkImageUsageFlags usage, VkCommandBuffer commandBuffer, VkQueue queue, uint8_t mipLevels, 
+    VkDeviceSize bufferOffset = 0);
+
+    // Creates one copy region for each mip level of a block compressed image, whose levels are packed in a buffer from the offset
+    void CreateBlockCompressedCopyRegions(VkBufferImageCopy2* pRegions, VkExtent3D extent, VkFormat format, uint32_t mipLevels, 
+    VkDeviceSize bufferOffset);
+
+    // Bytes of each 4x4 block of a block compressed format
+    uint32_t GetBlockCompressedBlockSize(VkFormat format);
+
+    // Bytes of the levels from the first level, of a block compressed image whose levels are packed one after the other
+    VkDeviceSize GetBlockCompressedMipSize(VkExtent3D extent, VkFormat format, uint32_t firstLevel, uint32_t levelCount);
+
+    // The first level of a texture that is not bigger than the mip tail size. The levels before it are streamed
+    uint32_t GetTextureMipTailLevel(VkExtent3D extent, uint32_t mipLevels);
+
+    // Records the layout transitions and the copy of a block compressed image from a buffer, so that many textures can share one submission.
+    // The image needs to have been created with the transfer dst usage
+    void RecordTextureImageCopy(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize bufferOffset, VkImage image, 
+    VkExtent3D extent, VkFormat format, uint32_t mipLevels);
 
     // Placeholder sampler creation function. Used for the default sampler used by all textures so far. 
     // TODO: Replace this with a general purpose function
@@ -473,7 +709,8 @@ namespace BlitzenVulkan
     uint32_t bufferImageHeight, uint32_t bufferRowLength);
 
     // Creates a descriptor pool for descriptor sets whose memory should be managed by one and are not push descriptors (managed by command buffer)
-    VkDescriptorPool CreateDescriptorPool(VkDevice device, uint32_t poolSizeCount, VkDescriptorPoolSize* pPoolSizes, uint32_t maxSets);
+    VkDescriptorPool CreateDescriptorPool(VkDevice device, uint32_t poolSizeCount, VkDescriptorPoolSize* pPoolSizes, uint32_t maxSets, 
+    VkDescriptorPoolCreateFlags flags = 0);
 
     // Allocates one or more descriptor sets whose memory will be managed by a descriptor pool
     uint8_t AllocateDescriptorSets(VkDevice device, VkDescriptorPool pool, VkDescriptorSetLayout* pLayouts, 
@@ -572,9 +809,10 @@ namespace BlitzenVulkan
     void CreateDescriptorSetLayoutBinding(VkDescriptorSetLayoutBinding& bindingInfo, uint32_t binding, uint32_t descriptorCount, 
     VkDescriptorType descriptorType, VkShaderStageFlags shaderStage, VkSampler* pImmutableSamplers = nullptr);
 
-    //Helper function for pipeline layout creation, takes care of a single descriptor set layout creation
+    //Helper function for pipeline layout creation, takes care of a single descriptor set layout creation. 
+    // The binding flags are optional, if they are passed there is one for each binding
     VkDescriptorSetLayout CreateDescriptorSetLayout(VkDevice device, uint32_t bindingCount, VkDescriptorSetLayoutBinding* pBindings, 
-    VkDescriptorSetLayoutCreateFlags flags = 0);
+    VkDescriptorSetLayoutCreateFlags flags = 0, const VkDescriptorBindingFlags* pBindingFlags = nullptr);
 
     //Helper function for pipeline layout creation, takes care of a single push constant creation
     void CreatePushConstantRange(VkPushConstantRange& pushConstant, VkShaderStageFlags shaderStage, uint32_t size, uint32_t offset = 0);
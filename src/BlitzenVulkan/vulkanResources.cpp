@@ -40,15 +40,15 @@ namespace BlitzenVulkan
 
     VkDeviceAddress CreateStorageBufferWithStagingBuffer(VmaAllocator allocator, VkDevice device, 
     void* pData, AllocatedBuffer& storageBuffer, AllocatedBuffer& stagingBuffer, 
-    VkBufferUsageFlags usage, VkDeviceSize size, uint8_t getBufferDeviceAddress /*=0*/)
+    VkBufferUsageFlags usage, VkDeviceSize size, uint8_t getBufferDeviceAddress /*=0*/, VkDeviceSize storageCapacity /*=0*/)
     {
         // The function needs to return a device address but it is relevant only if the user requested it
         // I don't know why I wrote it like this but it doesn't really matter
         VkDeviceAddress res = {};
 
-        // Creates the storage buffer
+        // Creates the storage buffer. It can be bigger than its data, if more is going to be copied to it later
         if(!CreateBuffer(allocator, storageBuffer, usage, VMA_MEMORY_USAGE_GPU_ONLY, 
-        size, VMA_ALLOCATION_CREATE_MAPPED_BIT))
+        storageCapacity > size ? storageCapacity : size, VMA_ALLOCATION_CREATE_MAPPED_BIT))
         {
             // The way this function lets the user know that it failed is by initializing the storage buffer to null
             storageBuffer.buffer = VK_NULL_HANDLE;
@@ -188,56 +188,89 @@ namespace BlitzenVulkan
     }
 
     uint8_t CreateTextureImage(AllocatedBuffer& buffer, VkDevice device, VmaAllocator allocator, AllocatedImage& image, 
-    VkExtent3D extent, VkFormat format, VkImageUsageFlags usage, VkCommandBuffer commandBuffer, VkQueue queue, uint8_t mipLevels)
+    VkExtent3D extent, VkFormat format, VkImageUsageFlags usage, VkCommandBuffer commandBuffer, VkQueue queue, uint8_t mipLevels, 
+    VkDeviceSize bufferOffset /*=0*/)
     {
         // Create an image for the texture data to be copied into. 
         // Adds the VK_IMAGE_USAGE_TRANSFER_DST_BIT, so that it can accept the data transfer from the buffer
         if(!CreateImage(device, allocator, image, extent, format, usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT, mipLevels))
             return 0;
 
-        // Get the initial offset for the first mip level to be copied
-        uint32_t bufferOffset = 0;
-        uint32_t mipWidth = extent.width;
-        uint32_t mipHeight = extent.height;
+        BeginCommandBuffer(commandBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+        RecordTextureImageCopy(commandBuffer, buffer.buffer, bufferOffset, image.image, extent, format, mipLevels);
+
+        SubmitCommandBuffer(queue, commandBuffer);
+        vkQueueWaitIdle(queue);
+
+        return 1;
+    }
 
-        uint32_t blockSize = (format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK || format == VK_FORMAT_BC4_SNORM_BLOCK 
+    uint32_t GetBlockCompressedBlockSize(VkFormat format)
+    {
+        return (format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK || format == VK_FORMAT_BC4_SNORM_BLOCK 
 		|| format == VK_FORMAT_BC4_UNORM_BLOCK) ? 8 : 16;
+    }
 
-        // Create an array that will hold the copy regions for all mip levels
-        BlitCL::DynamicArray<VkBufferImageCopy2> copyRegions(mipLevels);
+    VkDeviceSize GetBlockCompressedMipSize(VkExtent3D extent, VkFormat format, uint32_t firstLevel, uint32_t levelCount)
+    {
+        uint32_t mipWidth = extent.width >> firstLevel;
+        uint32_t mipHeight = extent.height >> firstLevel;
+        mipWidth = mipWidth ? mipWidth : 1;
+        mipHeight = mipHeight ? mipHeight : 1;
+
+        VkDeviceSize blockSize = GetBlockCompressedBlockSize(format);
+        VkDeviceSize size = 0;
+        for(uint32_t i = 0; i < levelCount; ++i)
+        {
+            size += ((mipWidth + 3) / 4) * ((mipHeight + 3) / 4) * blockSize;
+		    mipWidth = mipWidth > 1 ? mipWidth / 2 : 1;
+		    mipHeight = mipHeight > 1 ? mipHeight / 2 : 1;
+        }
+        return size;
+    }
 
-        // Create the copy regions
-        for(uint8_t i = 0; i < mipLevels; ++i)
+    void CreateBlockCompressedCopyRegions(VkBufferImageCopy2* pRegions, VkExtent3D extent, VkFormat format, uint32_t mipLevels, 
+    VkDeviceSize bufferOffset)
+    {
+        uint32_t mipWidth = extent.width;
+        uint32_t mipHeight = extent.height;
+
+        uint32_t blockSize = GetBlockCompressedBlockSize(format);
+
+        // The levels are packed one after the other, each one a grid of 4x4 blocks
+        for(uint32_t i = 0; i < mipLevels; ++i)
         {
-            CreateCopyBufferToImageRegion(copyRegions[i], {mipWidth, mipHeight, 1}, {0, 0, 0}, VK_IMAGE_ASPECT_COLOR_BIT, 
+            CreateCopyBufferToImageRegion(pRegions[i], {mipWidth, mipHeight, 1}, {0, 0, 0}, VK_IMAGE_ASPECT_COLOR_BIT, 
             i, 0, 1, bufferOffset, 0, 0);
 
             bufferOffset += ((mipWidth + 3) / 4) * ((mipHeight + 3) / 4) * blockSize;
 		    mipWidth = mipWidth > 1 ? mipWidth / 2 : 1;
 		    mipHeight = mipHeight > 1 ? mipHeight / 2 : 1;
         }
+    }
 
-        BeginCommandBuffer(commandBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    void RecordTextureImageCopy(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize bufferOffset, VkImage image, 
+    VkExtent3D extent, VkFormat format, uint32_t mipLevels)
+    {
+        // Create an array that will hold the copy regions for all mip levels
+        BlitCL::DynamicArray<VkBufferImageCopy2> copyRegions(mipLevels);
+        CreateBlockCompressedCopyRegions(copyRegions.Data(), extent, format, mipLevels, bufferOffset);
 
         // Create an image barrier for transiton to transfer dst optimal layout
         VkImageMemoryBarrier2 transitionToTransferDSToptimal{};
-        ImageMemoryBarrier(image.image, transitionToTransferDSToptimal, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, 
+        ImageMemoryBarrier(image, transitionToTransferDSToptimal, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, 
         VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS);
         PipelineBarrier(commandBuffer, 0, nullptr, 0, nullptr, 1, &transitionToTransferDSToptimal);
 
-        CopyBufferToImage(commandBuffer, buffer.buffer, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels, copyRegions.Data());
+        CopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels, copyRegions.Data());
 
         VkImageMemoryBarrier2 transitionImageToShaderReadOptimal{};
-        ImageMemoryBarrier(image.image, transitionImageToShaderReadOptimal, VK_PIPELINE_STAGE_2_COPY_BIT, 
+        ImageMemoryBarrier(image, transitionImageToShaderReadOptimal, VK_PIPELINE_STAGE_2_COPY_BIT, 
         VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, 
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS);
         PipelineBarrier(commandBuffer, 0, nullptr, 0, nullptr, 1, &transitionImageToShaderReadOptimal);
-
-        SubmitCommandBuffer(queue, commandBuffer);
-        vkQueueWaitIdle(queue);
-
-        return 1;
     }
 
     uint8_t CreateTextureSampler(VkDevice device, VkSampler& sampler, VkSamplerMipmapMode mipmapMode)
@@ -491,11 +524,12 @@ namespace BlitzenVulkan
         }
     }
 
-    VkDescriptorPool CreateDescriptorPool(VkDevice device, uint32_t poolSizeCount, VkDescriptorPoolSize* pPoolSizes, uint32_t maxSets)
+    VkDescriptorPool CreateDescriptorPool(VkDevice device, uint32_t poolSizeCount, VkDescriptorPoolSize* pPoolSizes, uint32_t maxSets, 
+    VkDescriptorPoolCreateFlags flags /*=0*/)
     {
         VkDescriptorPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        poolInfo.flags = 0;// Hardcoded, there is no use case for descriptor pool flags for now
+        poolInfo.flags = flags;
         poolInfo.pNext = nullptr;
         poolInfo.maxSets = maxSets;
         poolInfo.poolSizeCount = poolSizeCount;
@@ -0,0 +1,446 @@
+#include "vulkanRenderer.h"
+
+#include <cstring>
+
+namespace BlitzenVulkan
+{
+    uint32_t GetTextureMipTailLevel(VkExtent3D extent, uint32_t mipLevels)
+    {
+        uint32_t level = 0;
+        while(level + 1 < mipLevels && ((extent.width >> level) > BLITZEN_VULKAN_TEXTURE_MIP_TAIL_SIZE ||
+        (extent.height >> level) > BLITZEN_VULKAN_TEXTURE_MIP_TAIL_SIZE))
+            ++level;
+        return level;
+    }
+
+    static VkExtent3D GetMipExtent(VkExtent3D extent, uint32_t level)
+    {
+        uint32_t width = extent.width >> level;
+        uint32_t height = extent.height >> level;
+        return {width ? width : 1, height ? height : 1, 1};
+    }
+
+    // Bytes of the levels above the mip tail that the texture holds when its first level is the given one
+    static VkDeviceSize GetStreamedMipBytes(StreamedTextureMips& texture, uint32_t level)
+    {
+        return GetBlockCompressedMipSize(texture.extent, texture.format, level, texture.tailLevel - level);
+    }
+
+    static void MarkTextureLodDirty(uint32_t textureTag, uint32_t& dirtyBegin, uint32_t& dirtyEnd)
+    {
+        dirtyBegin = textureTag < dirtyBegin ? textureTag : dirtyBegin;
+        dirtyEnd = textureTag + 1 > dirtyEnd ? textureTag + 1 : dirtyEnd;
+    }
+
+    // Called on a texture IO thread. The main thread picks the levels up at the start of the next frame
+    static void OnTextureMipsRead(void* pUserData, uint8_t bSuccess, size_t bytesRead)
+    {
+        StreamedTextureMips* pTexture = reinterpret_cast<StreamedTextureMips*>(pUserData);
+        pTexture->readState.store(bSuccess && bytesRead == pTexture->readSize ? TextureMipReadState::Done : TextureMipReadState::Failed,
+        std::memory_order_release);
+    }
+
+    // Frees what the texture's read needed. Returns the bytes that it had reserved from the budget
+    static size_t ReleaseTextureRead(StreamedTextureMips& texture)
+    {
+        size_t readSize = texture.readSize;
+        texture.file.Close();
+        if(texture.pReadData)
+            BlitzenCore::BlitFree<uint8_t>(BlitzenCore::AllocationType::Renderer, texture.pReadData, readSize);
+        texture.pReadData = nullptr;
+        texture.readSize = 0;
+        texture.readState.store(TextureMipReadState::Idle, std::memory_order_relaxed);
+        return readSize;
+    }
+
+    // Copies whole levels between two images of the same texture. The extent is the one of the first level that is copied
+    static void RecordMipCopy(VkCommandBuffer commandBuffer, VkImage srcImage, uint32_t srcLevel, VkImage dstImage, uint32_t dstLevel,
+    uint32_t levelCount, VkExtent3D extent)
+    {
+        BlitCL::DynamicArray<VkImageCopy2> regions(levelCount);
+        for(uint32_t i = 0; i < levelCount; ++i)
+        {
+            VkImageCopy2& region = regions[i];
+            region = {};
+            region.sType = VK_STRUCTURE_TYPE_IMAGE_COPY_2;
+            region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, srcLevel + i, 0, 1};
+            region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, dstLevel + i, 0, 1};
+            region.extent = extent;
+
+            extent.width = extent.width > 1 ? extent.width / 2 : 1;
+            extent.height = extent.height > 1 ? extent.height / 2 : 1;
+        }
+
+        VkCopyImageInfo2 copyInfo{};
+        copyInfo.sType = VK_STRUCTURE_TYPE_COPY_IMAGE_INFO_2;
+        copyInfo.srcImage = srcImage;
+        copyInfo.srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        copyInfo.dstImage = dstImage;
+        copyInfo.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        copyInfo.regionCount = levelCount;
+        copyInfo.pRegions = regions.Data();
+        vkCmdCopyImage2(commandBuffer, &copyInfo);
+    }
+
+    void VulkanRenderer::RegisterStreamedTexture(uint32_t textureTag, const BlitzenEngine::DDSTextureProbe& probe, uint32_t tailLevel)
+    {
+        StreamedTextureMips* pTexture = BlitzenCore::BlitConstructAlloc<StreamedTextureMips>(BlitzenCore::AllocationType::Renderer);
+        pTexture->textureTag = textureTag;
+        pTexture->filepath = probe.filepath;
+        pTexture->imageOffset = probe.imageOffset;
+        pTexture->extent = {probe.header.dwWidth, probe.header.dwHeight, 1};
+        pTexture->format = static_cast<VkFormat>(probe.format);
+        pTexture->mipLevels = probe.header.dwMipMapCount;
+        pTexture->tailLevel = tailLevel;
+        pTexture->residentLevel = tailLevel;
+        pTexture->desiredLevel = tailLevel;
+        pTexture->requestedLevel = tailLevel;
+        m_streamedTextures.PushBack(pTexture);
+    }
+
+    void VulkanRenderer::UpdateTextureStreaming(VarBuffers& vBuffers)
+    {
+        if(!m_streamedTextures.GetSize())
+            return;
+        m_textureStreamingFrame++;
+
+        // The culling shaders measure objects in depth pyramid pixels, which are fewer than the pixels that the textures are drawn to
+        float pixelScale = static_cast<float>(m_drawExtent.width) / static_cast<float>(m_depthPyramidExtent.width);
+        uint32_t* pDemands = vBuffers.textureFeedbackBuffer.pData;
+        vmaInvalidateAllocation(m_allocator, vBuffers.textureFeedbackBuffer.buffer.allocation, 0, VK_WHOLE_SIZE);
+        for(size_t i = 0; i < m_streamedTextures.GetSize(); ++i)
+        {
+            StreamedTextureMips* pTexture = m_streamedTextures[i];
+            uint32_t demand = pDemands[pTexture->textureTag];
+            if(!demand)
+                continue;
+
+            // The smallest level that still has a texel for every pixel of the biggest object that uses the texture
+            uint32_t pixels = static_cast<uint32_t>(static_cast<float>(demand) * pixelScale);
+            uint32_t maxDimension = BlitML::Max(pTexture->extent.width, pTexture->extent.height);
+            uint32_t level = pTexture->topLevel;
+            while(level < pTexture->tailLevel && (maxDimension >> (level + 1)) >= pixels)
+                ++level;
+            pTexture->desiredLevel = level;
+            pTexture->lastUsedFrame = m_textureStreamingFrame;
+        }
+
+        // The culling shaders only ever raise the values, so the buffer is cleared for the next frame that uses it
+        BlitzenCore::BlitZeroMemory(pDemands, sizeof(uint32_t) * m_textureDescriptorCapacity);
+        vmaFlushAllocation(m_allocator, vBuffers.textureFeedbackBuffer.buffer.allocation, 0, VK_WHOLE_SIZE);
+
+        // Levels that were added before keep fading in
+        for(size_t i = 0; i < m_streamedTextures.GetSize(); ++i)
+        {
+            uint32_t tag = m_streamedTextures[i]->textureTag;
+            if(m_textureMinLods[tag] > 0.f)
+            {
+                m_textureMinLods[tag] = BlitML::Max(m_textureMinLods[tag] - BLITZEN_VULKAN_TEXTURE_LOD_FADE_STEP, 0.f);
+                MarkTextureLodDirty(tag, m_textureLodDirtyBegin, m_textureLodDirtyEnd);
+            }
+        }
+
+        // Every read can finish in the same frame, and as many textures can give their levels back for the budget
+        StreamedTextureMips* pCommits[BLITZEN_VULKAN_TEXTURE_STREAMING_MAX_READS * 2];
+        uint32_t newLevels[BLITZEN_VULKAN_TEXTURE_STREAMING_MAX_READS * 2];
+        uint32_t commitCount = 0;
+        for(size_t i = 0; i < m_streamedTextures.GetSize(); ++i)
+        {
+            StreamedTextureMips* pTexture = m_streamedTextures[i];
+            TextureMipReadState state = pTexture->readState.load(std::memory_order_acquire);
+            if(state == TextureMipReadState::Done)
+            {
+                pCommits[commitCount] = pTexture;
+                newLevels[commitCount++] = pTexture->requestedLevel;
+            }
+            else if(state == TextureMipReadState::Failed)
+            {
+                BLIT_ERROR("Failed to read the mip levels of texture: %s", pTexture->filepath.c_str())
+                m_pendingMipBytes -= ReleaseTextureRead(*pTexture);
+                m_textureReadCount--;
+                pTexture->topLevel = pTexture->residentLevel;
+            }
+        }
+
+        // Over the budget, the textures that were not seen for the longest go back to their mip tail.
+        // The ones that were seen this frame only give back the levels that they do not need anymore
+        VkDeviceSize neededBytes = m_streamedMipBytes + m_pendingMipBytes + m_mipBudgetShortfall;
+        m_mipBudgetShortfall = 0;
+        while(neededBytes > BLITZEN_VULKAN_TEXTURE_STREAMING_BUDGET && commitCount < BLIT_ARRAY_SIZE(pCommits))
+        {
+            StreamedTextureMips* pOldest = nullptr;
+            uint32_t oldestLevel = 0;
+            for(size_t i = 0; i < m_streamedTextures.GetSize(); ++i)
+            {
+                StreamedTextureMips* pTexture = m_streamedTextures[i];
+                if(pTexture->readState.load(std::memory_order_acquire) != TextureMipReadState::Idle)
+                    continue;
+
+                uint32_t level = pTexture->lastUsedFrame == m_textureStreamingFrame ? pTexture->desiredLevel : pTexture->tailLevel;
+                if(level <= pTexture->residentLevel)
+                    continue;
+
+                uint8_t bCommitted = 0;
+                for(uint32_t j = 0; j < commitCount; ++j)
+                    bCommitted = bCommitted || pCommits[j] == pTexture;
+                if(bCommitted)
+                    continue;
+
+                if(!pOldest || pTexture->lastUsedFrame < pOldest->lastUsedFrame)
+                {
+                    pOldest = pTexture;
+                    oldestLevel = level;
+                }
+            }
+            if(!pOldest)
+                break;
+
+            neededBytes -= GetStreamedMipBytes(*pOldest, pOldest->residentLevel) - GetStreamedMipBytes(*pOldest, oldestLevel);
+            pCommits[commitCount] = pOldest;
+            newLevels[commitCount++] = oldestLevel;
+        }
+
+        if(commitCount)
+            CommitTextureMips(m_frameToolsList[m_currentFrame], pCommits, newLevels, commitCount);
+
+        // Starts reading the levels that the textures seen this frame are missing.
+        // A texture's missing levels are next to each other in the file, so each one needs a single read
+        BlitzenPlatform::AsyncReadRequest requests[BLITZEN_VULKAN_TEXTURE_STREAMING_MAX_READS];
+        uint32_t requestCount = 0;
+        for(size_t i = 0; i < m_streamedTextures.GetSize() && m_textureReadCount + requestCount < BLITZEN_VULKAN_TEXTURE_STREAMING_MAX_READS; ++i)
+        {
+            StreamedTextureMips* pTexture = m_streamedTextures[i];
+            if(pTexture->lastUsedFrame != m_textureStreamingFrame || pTexture->desiredLevel >= pTexture->residentLevel ||
+            pTexture->readState.load(std::memory_order_acquire) != TextureMipReadState::Idle)
+                continue;
+
+            size_t offset = pTexture->imageOffset + static_cast<size_t>(
+            GetBlockCompressedMipSize(pTexture->extent, pTexture->format, 0, pTexture->desiredLevel));
+            size_t size = static_cast<size_t>(GetBlockCompressedMipSize(pTexture->extent, pTexture->format, pTexture->desiredLevel,
+            pTexture->residentLevel - pTexture->desiredLevel));
+
+            // Textures that do not fit wait for the next frame to make room for them
+            if(m_streamedMipBytes + m_pendingMipBytes + size > BLITZEN_VULKAN_TEXTURE_STREAMING_BUDGET)
+            {
+                m_mipBudgetShortfall += size;
+                continue;
+            }
+
+            if(!pTexture->file.Open(pTexture->filepath.c_str()))
+            {
+                BLIT_ERROR("Failed to open texture for streaming: %s", pTexture->filepath.c_str())
+                pTexture->topLevel = pTexture->residentLevel;
+                continue;
+            }
+
+            pTexture->pReadData = BlitzenCore::BlitAlloc<uint8_t>(BlitzenCore::AllocationType::Renderer, size);
+            pTexture->readSize = size;
+            pTexture->requestedLevel = pTexture->desiredLevel;
+            pTexture->readState.store(TextureMipReadState::Reading, std::memory_order_relaxed);
+            requests[requestCount++] = {&pTexture->file, offset, size, pTexture->pReadData, OnTextureMipsRead, pTexture};
+            m_pendingMipBytes += size;
+        }
+        if(!requestCount)
+            return;
+
+        if(!m_textureIO.SubmitReads(requests, requestCount))
+        {
+            BLIT_ERROR("Failed to submit texture level reads")
+            for(uint32_t i = 0; i < requestCount; ++i)
+                m_pendingMipBytes -= ReleaseTextureRead(*reinterpret_cast<StreamedTextureMips*>(requests[i].pUserData));
+            return;
+        }
+        m_textureReadCount += requestCount;
+    }
+
+    void VulkanRenderer::CommitTextureMips(FrameTools& fTools, StreamedTextureMips** ppTextures, uint32_t* pNewLevels, 
+    uint32_t textureCount)
+    {
+        // The levels that were read go to the frame's staging buffer one after the other. 
+        // Its last copies were done once the frame's fence was signaled, so it can be written again
+        VkDeviceSize stagingSize = 0;
+        for(uint32_t i = 0; i < textureCount; ++i)
+        {
+            if(pNewLevels[i] < ppTextures[i]->residentLevel)
+                stagingSize += (ppTextures[i]->readSize + BLITZEN_VULKAN_TEXTURE_STAGING_ALIGNMENT - 1) &
+                ~VkDeviceSize(BLITZEN_VULKAN_TEXTURE_STAGING_ALIGNMENT - 1);
+        }
+        uint8_t* pStaging = nullptr;
+        if(stagingSize && fTools.mipStagingCapacity < stagingSize)
+        {
+            if(fTools.mipStaging.buffer != VK_NULL_HANDLE)
+                vmaDestroyBuffer(m_allocator, fTools.mipStaging.buffer, fTools.mipStaging.allocation);
+            fTools.mipStaging.buffer = VK_NULL_HANDLE;
+            fTools.mipStagingCapacity = 0;
+            if(CreateBuffer(m_allocator, fTools.mipStaging, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, 
+            stagingSize, VMA_ALLOCATION_CREATE_MAPPED_BIT))
+                fTools.mipStagingCapacity = stagingSize;
+            else
+                BLIT_ERROR("Failed to create staging buffer for streamed texture levels")
+        }
+        if(stagingSize && fTools.mipStagingCapacity)
+            pStaging = reinterpret_cast<uint8_t*>(fTools.mipStaging.allocationInfo.pMappedData);
+
+        VkCommandBuffer commandBuffer = fTools.textureStreamingCommandBuffer;
+        BeginCommandBuffer(commandBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+        AllocatedImage newImages[BLITZEN_VULKAN_TEXTURE_STREAMING_MAX_READS * 2];
+        VkDeviceSize stagingOffset = 0;
+        for(uint32_t i = 0; i < textureCount; ++i)
+        {
+            StreamedTextureMips& texture = *ppTextures[i];
+            uint32_t newLevel = pNewLevels[i];
+            uint8_t bStreamIn = newLevel < texture.residentLevel;
+            newImages[i].image = VK_NULL_HANDLE;
+            if(bStreamIn && !pStaging)
+                continue;
+
+            VkExtent3D extent = GetMipExtent(texture.extent, newLevel);
+            if(!CreateImage(m_device, m_allocator, newImages[i], extent, texture.format,
+            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            static_cast<uint8_t>(texture.mipLevels - newLevel)))
+            {
+                BLIT_ERROR("Failed to create image for streamed texture: %s", texture.filepath.c_str())
+                newImages[i].image = VK_NULL_HANDLE;
+                continue;
+            }
+            AllocatedImage& oldImage = loadedTextures[texture.textureTag].image;
+
+            // The frames that were submitted before this still sample the old image. The barrier waits for their fragment shaders,
+            // instead of the whole device, before the image changes layout for the copy
+            VkImageMemoryBarrier2 copyBarriers[2] = {};
+            ImageMemoryBarrier(newImages[i].image, copyBarriers[0], VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+            VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS);
+            ImageMemoryBarrier(oldImage.image, copyBarriers[1], VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_NONE,
+            VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS);
+            PipelineBarrier(commandBuffer, 0, nullptr, 0, nullptr, 2, copyBarriers);
+
+            // The levels that both images have are copied on the GPU, only the new ones come from the staging buffer
+            uint32_t firstSharedLevel = newLevel > texture.residentLevel ? newLevel : texture.residentLevel;
+            RecordMipCopy(commandBuffer, oldImage.image, firstSharedLevel - texture.residentLevel, newImages[i].image,
+            firstSharedLevel - newLevel, texture.mipLevels - firstSharedLevel, GetMipExtent(texture.extent, firstSharedLevel));
+
+            if(bStreamIn)
+            {
+                memcpy(pStaging + stagingOffset, texture.pReadData, texture.readSize);
+                uint32_t readLevelCount = texture.residentLevel - newLevel;
+                BlitCL::DynamicArray<VkBufferImageCopy2> copyRegions(readLevelCount);
+                CreateBlockCompressedCopyRegions(copyRegions.Data(), extent, texture.format, readLevelCount, stagingOffset);
+                CopyBufferToImage(commandBuffer, fTools.mipStaging.buffer, newImages[i].image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                readLevelCount, copyRegions.Data());
+                stagingOffset += (texture.readSize + BLITZEN_VULKAN_TEXTURE_STAGING_ALIGNMENT - 1) &
+                ~VkDeviceSize(BLITZEN_VULKAN_TEXTURE_STAGING_ALIGNMENT - 1);
+            }
+
+            // The new image is sampled from this frame on. The old one goes back to the layout that the frames before expect
+            VkImageMemoryBarrier2 shaderReadBarriers[2] = {};
+            ImageMemoryBarrier(newImages[i].image, shaderReadBarriers[0], VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS);
+            ImageMemoryBarrier(oldImage.image, shaderReadBarriers[1], VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_NONE,
+            VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS);
+            PipelineBarrier(commandBuffer, 0, nullptr, 0, nullptr, 2, shaderReadBarriers);
+        }
+
+        // Submitted ahead of the frame's command buffer on the same queue, so the barriers order the copies before its draws.
+        // The frame's fence covers this submission as well
+        SubmitCommandBuffer(m_graphicsQueue.handle, commandBuffer);
+
+        for(uint32_t i = 0; i < textureCount; ++i)
+        {
+            StreamedTextureMips& texture = *ppTextures[i];
+            uint32_t newLevel = pNewLevels[i];
+            if(newLevel < texture.residentLevel)
+            {
+                m_pendingMipBytes -= ReleaseTextureRead(texture);
+                m_textureReadCount--;
+            }
+            if(newImages[i].image == VK_NULL_HANDLE)
+                continue;
+
+            // The new image takes the old one's place in the texture data. The slot points to it from this frame on, 
+            // and the old image is destroyed once the frames that were recorded with it are done
+            TextureData& textureData = loadedTextures[texture.textureTag];
+            TextureDescriptorUpdate retire{};
+            retire.textureTag = texture.textureTag;
+            retire.imageView = VK_NULL_HANDLE;
+            retire.readyFrame = m_frameNumber + BLITZEN_VULKAN_MAX_FRAMES_IN_FLIGHT;
+            retire.retiredImage = textureData.image.image;
+            retire.retiredImageView = textureData.image.imageView;
+            retire.retiredAllocation = textureData.image.allocation;
+
+            textureData.image.image = newImages[i].image;
+            textureData.image.imageView = newImages[i].imageView;
+            textureData.image.allocation = newImages[i].allocation;
+            textureData.image.extent = newImages[i].extent;
+            newImages[i].image = VK_NULL_HANDLE;
+            newImages[i].imageView = VK_NULL_HANDLE;
+
+            TextureDescriptorUpdate update{};
+            update.textureTag = texture.textureTag;
+            update.imageView = textureData.image.imageView;
+            update.sampler = textureData.sampler;
+            update.readyFrame = m_frameNumber;
+            m_textureDescriptorUpdates.PushBack(update);
+            m_textureDescriptorUpdates.PushBack(retire);
+
+            m_streamedMipBytes = m_streamedMipBytes - GetStreamedMipBytes(texture, texture.residentLevel) +
+            GetStreamedMipBytes(texture, newLevel);
+
+            // The minimum LOD keeps pointing to the level that was sampled before, so added levels start hidden and fade in
+            float& minLod = m_textureMinLods[texture.textureTag];
+            minLod = BlitML::Max(minLod + static_cast<float>(texture.residentLevel) - static_cast<float>(newLevel), 0.f);
+            MarkTextureLodDirty(texture.textureTag, m_textureLodDirtyBegin, m_textureLodDirtyEnd);
+            texture.residentLevel = newLevel;
+        }
+    }
+
+    void VulkanRenderer::RecordTextureLodUpdates(VkCommandBuffer commandBuffer)
+    {
+        if(m_textureLodDirtyBegin >= m_textureLodDirtyEnd)
+            return;
+
+        VkBuffer buffer = m_currentStaticBuffers.textureLodBuffer.buffer.buffer;
+        VkDeviceSize offset = sizeof(float) * m_textureLodDirtyBegin;
+        VkDeviceSize size = sizeof(float) * (m_textureLodDirtyEnd - m_textureLodDirtyBegin);
+
+        // The fragment shaders of the previous frames need to be done with the range
+        VkBufferMemoryBarrier2 waitBeforeUpdate{};
+        BufferMemoryBarrier(buffer, waitBeforeUpdate, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+        VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, offset, size);
+        PipelineBarrier(commandBuffer, 0, nullptr, 1, &waitBeforeUpdate, 0, nullptr);
+
+        // Each update can write up to 65536 bytes
+        uint8_t* pMinLods = reinterpret_cast<uint8_t*>(m_textureMinLods.Data());
+        for(VkDeviceSize updated = 0; updated < size; updated += 65536)
+        {
+            VkDeviceSize updateSize = size - updated < 65536 ? size - updated : 65536;
+            vkCmdUpdateBuffer(commandBuffer, buffer, offset + updated, updateSize, pMinLods + offset + updated);
+        }
+
+        VkBufferMemoryBarrier2 waitBeforeSampling{};
+        BufferMemoryBarrier(buffer, waitBeforeSampling, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, offset, size);
+        PipelineBarrier(commandBuffer, 0, nullptr, 1, &waitBeforeSampling, 0, nullptr);
+
+        m_textureLodDirtyBegin = UINT32_MAX;
+        m_textureLodDirtyEnd = 0;
+    }
+
+    void VulkanRenderer::ShutdownTextureStreaming()
+    {
+        m_textureIO.Shutdown();
+
+        for(size_t i = 0; i < m_streamedTextures.GetSize(); ++i)
+        {
+            ReleaseTextureRead(*m_streamedTextures[i]);
+            BlitzenCore::BlitDestroyAlloc(BlitzenCore::AllocationType::Renderer, m_streamedTextures[i]);
+        }
+        m_streamedTextures.Clear();
+        m_textureReadCount = 0;
+        m_pendingMipBytes = 0;
+    }
+}
@@ -0,0 +1,141 @@
+/*
+    Offline asset cooker. Processes the gltf scenes of a few directories ahead of time, so that the engine copies their meshes
+    from the asset cache instead of building them at every boot, and bakes their textures.
+    Usage: BlitzenCook [--force] [--no-meshlets] [--threads count] <scene directory or file>...
+*/
+
+#include "Renderer/blitSceneCook.h"
+#include "Core/blitzenCore.h"
+
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace BlitzenEngine
+{
+    struct CookJob
+    {
+        char path[BLIT_COOK_MAX_PATH_LENGTH];
+        CookStats stats;
+    };
+
+    struct CookQueue
+    {
+        BlitCL::DynamicArray<CookJob> jobs;
+        std::atomic<uint32_t> nextJob{0};
+
+        uint8_t bMeshlets = 1;
+        uint8_t bForce = 0;
+    };
+
+    static void AddCookJob(const char* path, void* pUserData)
+    {
+        CookQueue* pQueue = reinterpret_cast<CookQueue*>(pUserData);
+
+        const char* extension = strrchr(path, '.');
+        if(!extension || (strcmp(extension, ".gltf") && strcmp(extension, ".glb")))
+            return;
+        if(strlen(path) >= BLIT_COOK_MAX_PATH_LENGTH)
+        {
+            BLIT_WARN("Scene path is too long to cook: %s", path)
+            return;
+        }
+
+        pQueue->jobs.Resize(pQueue->jobs.GetSize() + 1);
+        CookJob& job = pQueue->jobs.Back();
+        job = {};
+        memcpy(job.path, path, strlen(path) + 1);
+    }
+
+    // Each thread takes the next scene until there are none left
+    static void CookScenes(CookQueue* pQueue)
+    {
+        for(;;)
+        {
+            uint32_t jobIndex = pQueue->nextJob.fetch_add(1, std::memory_order_relaxed);
+            if(jobIndex >= pQueue->jobs.GetSize())
+                return;
+
+            CookJob& job = pQueue->jobs[jobIndex];
+            CookGltfScene(job.path, pQueue->bMeshlets, pQueue->bForce, job.stats);
+        }
+    }
+
+    static int RunCooker(int argc, char* argv[])
+    {
+        CookQueue queue;
+        uint32_t threadCount = std::thread::hardware_concurrency();
+        for(int i = 1; i < argc; ++i)
+        {
+            if(!strcmp(argv[i], "--force"))
+                queue.bForce = 1;
+            else if(!strcmp(argv[i], "--no-meshlets"))
+                queue.bMeshlets = 0;
+            else if(!strcmp(argv[i], "--threads") && i + 1 < argc)
+                threadCount = static_cast<uint32_t>(atoi(argv[++i]));
+            else if(!BlitzenPlatform::ListDirectoryFiles(argv[i], AddCookJob, &queue))
+                AddCookJob(argv[i], &queue);
+        }
+
+        if(!queue.jobs.GetSize())
+        {
+            printf("Usage: BlitzenCook [--force] [--no-meshlets] [--threads count] <scene directory or file>...\n");
+            return 1;
+        }
+
+        threadCount = threadCount ? threadCount : 1;
+        threadCount = threadCount > BLIT_COOK_MAX_THREADS ? BLIT_COOK_MAX_THREADS : threadCount;
+        threadCount = threadCount > queue.jobs.GetSize() ? static_cast<uint32_t>(queue.jobs.GetSize()) : threadCount;
+        printf("Cooking %u scenes on %u threads\n", static_cast<uint32_t>(queue.jobs.GetSize()), threadCount);
+
+        std::thread threads[BLIT_COOK_MAX_THREADS];
+        for(uint32_t i = 1; i < threadCount; ++i)
+            threads[i] = std::thread(CookScenes, &queue);
+        CookScenes(&queue);
+        for(uint32_t i = 1; i < threadCount; ++i)
+            threads[i].join();
+
+        // Printed once every scene is done, in the order they were found
+        CookStats total;
+        uint32_t cookedCount = 0;
+        uint32_t failedCount = 0;
+        for(size_t i = 0; i < queue.jobs.GetSize(); ++i)
+        {
+            CookJob& job = queue.jobs[i];
+            CookStats& stats = job.stats;
+            const char* status = stats.bFailed ? "failed" : stats.bCooked ? "cooked" : "current";
+            printf("%-8s %9.1f ms %10.2f MB -> %10.2f MB  meshes %u surfaces %u vertices %zu indices %zu meshlets %zu textures %u  %s\n",
+            status, stats.seconds * 1000.0, stats.sourceBytes / (1024.0 * 1024.0), stats.cookedBytes / (1024.0 * 1024.0),
+            stats.meshCount, stats.surfaceCount, stats.vertexCount, stats.indexCount, stats.meshletCount, stats.textureCount, job.path);
+            printf("%-8s acmr %.3f -> %.3f  atvr %.3f -> %.3f  overdraw %.3f -> %.3f  triangles %u\n", "", stats.quality.acmrBefore,
+            stats.quality.acmrAfter, stats.quality.atvrBefore, stats.quality.atvrAfter, stats.quality.overdrawBefore, 
+            stats.quality.overdrawAfter, stats.quality.triangleCount);
+
+            cookedCount += stats.bCooked;
+            failedCount += stats.bFailed;
+            total.seconds += stats.seconds;
+            total.sourceBytes += stats.sourceBytes;
+            total.cookedBytes += stats.cookedBytes;
+        }
+
+        printf("%u cooked, %u current, %u failed. %.1f ms of cooking, %.2f MB of sources, %.2f MB cooked\n", cookedCount,
+        static_cast<uint32_t>(queue.jobs.GetSize()) - cookedCount - failedCount, failedCount, total.seconds * 1000.0,
+        total.sourceBytes / (1024.0 * 1024.0), total.cookedBytes / (1024.0 * 1024.0));
+
+        return failedCount ? 1 : 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // Memory management is initialized here, like in the engine. The arrays of the cooker need to be freed before it shuts down
+    BlitzenCore::MemoryManagerState blitzenMemory;
+    BlitzenCore::InitLogging();
+
+    int result = BlitzenEngine::RunCooker(argc, argv);
+
+    BlitzenCore::ShutdownLogging();
+    return result;
+}
@@ -10,6 +10,8 @@
 #define BLIT_MOUSE_MOVED_EXPECTED_EVENTS  10
 #define BLIT_MOUSE_WHEEL_EXPECTED_EVENTS  10
 #define BLIT_WINDOW_RESIZE_EXPECTED_EVENTS  10
+#define BLIT_SCENE_STREAMING_PROGRESS_EXPECTED_EVENTS   10
+#define BLIT_SCENE_STREAMING_CANCEL_EXPECTED_EVENTS     10
 
 namespace BlitzenCore
 {
@@ -44,7 +46,12 @@ namespace BlitzenCore
         MouseMoved = 5,
         MouseWheel = 6,
         WindowResize = 7,
-        MaxTypes = 8
+        // Fired by the renderer after it commits streamed scene chunks. 
+        // ui32[0] and ui32[1] are the committed and the known chunk count, ui32[2] and ui32[3] the finished and the queued scene count
+        SceneStreamingProgress = 8,
+        // Stops the scene streamer. What has been committed stays in the scene
+        SceneStreamingCancel = 9,
+        MaxTypes = 10
     };
 
     typedef uint8_t (*pfnOnEvent)(BlitEventType type, void* pSender, void* pListener, EventContext data);
@@ -70,7 +77,9 @@ namespace BlitzenCore
             BLIT_MOUSE_BUTTON_RELEASED_EXPECTED_EVENTS,
             BLIT_MOUSE_MOVED_EXPECTED_EVENTS,
             BLIT_MOUSE_WHEEL_EXPECTED_EVENTS, 
-            BLIT_WINDOW_RESIZE_EXPECTED_EVENTS
+            BLIT_WINDOW_RESIZE_EXPECTED_EVENTS, 
+            BLIT_SCENE_STREAMING_PROGRESS_EXPECTED_EVENTS, 
+            BLIT_SCENE_STREAMING_CANCEL_EXPECTED_EVENTS
         };
 
         EventSystemState();
@@ -217,6 +217,19 @@ namespace BlitCL
             }
         }
 
+        // Unlike Clear, this gives the allocation back. The array can still be used after, it will allocate again when it grows
+        void ReleaseMemory()
+        {
+            if(m_capacity > 0)
+            {
+                delete [] m_pBlock;
+                BlitzenCore::LogFree(BlitzenCore::AllocationType::DynamicArray, m_capacity * sizeof(T));
+            }
+            m_pBlock = nullptr;
+            m_size = 0;
+            m_capacity = 0;
+        }
+
         ~DynamicArray()
         {
             if(m_capacity > 0)
@@ -396,7 +409,207 @@ namespace BlitCL
         }
     };
 
-    
+
+
+    // Stable reference to an element of a slot map. The generation tells if the slot was freed and reused since the handle was given
+    struct SlotHandle
+    {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+    };
+
+    /*-------------------------------------------------------------------------------------------------
+        Generational slot map. The elements are kept packed in a dense array, so that it can be uploaded
+        or iterated directly, while handles go through a slot that always knows the element's dense index.
+        Insertion appends to the dense array and removal moves the last element in the hole, both O(1).
+        Elements can also be swapped, for users that need the dense array to be partitioned
+    ---------------------------------------------------------------------------------------------------*/
+    template<typename T>
+    class SlotMap
+    {
+    public:
+
+        SlotHandle Insert(const T& value)
+        {
+            // Freed slots are reused before new ones are created, their generation was increased when they were freed
+            uint32_t slot;
+            if(m_freeSlots.GetSize())
+            {
+                slot = m_freeSlots.Back();
+                m_freeSlots.Downsize(m_freeSlots.GetSize() - 1);
+            }
+            else
+            {
+                slot = static_cast<uint32_t>(m_slotToDense.GetSize());
+                m_slotToDense.PushBack(0);
+                m_generations.PushBack(0);
+            }
+
+            m_slotToDense[slot] = static_cast<uint32_t>(m_dense.GetSize());
+            m_dense.PushBack(value);
+            m_denseToSlot.PushBack(slot);
+
+            return {slot, m_generations[slot]};
+        }
+
+        inline uint8_t IsValid(SlotHandle handle) { 
+            return handle.index < m_generations.GetSize() && m_generations[handle.index] == handle.generation; 
+        }
+
+        // Returns null if the handle's element was removed
+        inline T* Get(SlotHandle handle) { return IsValid(handle) ? &m_dense[m_slotToDense[handle.index]] : nullptr; }
+
+        inline size_t GetDenseIndex(SlotHandle handle) { BLIT_ASSERT(IsValid(handle)) return m_slotToDense[handle.index]; }
+
+        inline SlotHandle GetHandle(size_t denseIndex) { 
+            uint32_t slot = m_denseToSlot[denseIndex];
+            return {slot, m_generations[slot]}; 
+        }
+
+        // Swaps two elements of the dense array. Their handles stay valid
+        void SwapDense(size_t first, size_t second)
+        {
+            if(first == second)
+                return;
+
+            T temp = m_dense[first];
+            m_dense[first] = m_dense[second];
+            m_dense[second] = temp;
+
+            uint32_t firstSlot = m_denseToSlot[first];
+            m_denseToSlot[first] = m_denseToSlot[second];
+            m_denseToSlot[second] = firstSlot;
+
+            m_slotToDense[m_denseToSlot[first]] = static_cast<uint32_t>(first);
+            m_slotToDense[m_denseToSlot[second]] = static_cast<uint32_t>(second);
+        }
+
+        // Moves the element at each dense index to the new index at the same place in the array, which has to hold every dense index once.
+        // Handles stay valid
+        void ReorderDense(const uint32_t* pNewDenseIndices)
+        {
+            size_t size = m_dense.GetSize();
+            DynamicArray<T> dense(size);
+            DynamicArray<uint32_t> denseToSlot(size);
+            for(size_t i = 0; i < size; ++i)
+            {
+                dense[pNewDenseIndices[i]] = m_dense[i];
+                denseToSlot[pNewDenseIndices[i]] = m_denseToSlot[i];
+                m_slotToDense[m_denseToSlot[i]] = pNewDenseIndices[i];
+            }
+
+            for(size_t i = 0; i < size; ++i)
+            {
+                m_dense[i] = dense[i];
+                m_denseToSlot[i] = denseToSlot[i];
+            }
+        }
+
+        // Moves the last element to the removed element's place. If the element is already last, nothing else moves
+        void Remove(SlotHandle handle)
+        {
+            if(!IsValid(handle))
+                return;
+
+            size_t last = m_dense.GetSize() - 1;
+            SwapDense(m_slotToDense[handle.index], last);
+
+            m_dense.Downsize(last);
+            m_denseToSlot.Downsize(last);
+
+            // Handles that still point to the slot become invalid
+            m_generations[handle.index]++;
+            m_freeSlots.PushBack(handle.index);
+        }
+
+        inline T& operator [] (size_t denseIndex) { return m_dense[denseIndex]; }
+
+        inline T* Data() { return m_dense.Data(); }
+
+        inline size_t GetSize() { return m_dense.GetSize(); }
+
+    private:
+
+        // The elements, packed
+        DynamicArray<T> m_dense;
+        // The slot of each dense element, so that it can be updated when the element moves
+        DynamicArray<uint32_t> m_denseToSlot;
+
+        // The dense index and the generation of each slot
+        DynamicArray<uint32_t> m_slotToDense;
+        DynamicArray<uint32_t> m_generations;
+
+        DynamicArray<uint32_t> m_freeSlots;
+    };
+
+    /*-------------------------------------------------------------------------------------------------
+        Growable array that allocates its elements in fixed size chunks, only when they are needed.
+        Elements never move after they are created, so pointers to them stay valid while the array grows.
+        The chunks are constructed with new, so types with destructors are cleaned up properly
+    ---------------------------------------------------------------------------------------------------*/
+    template<typename T, size_t ChunkSize>
+    class ChunkedArray
+    {
+    public:
+
+        ChunkedArray()
+        {
+            static_assert(ChunkSize > 0);
+        }
+
+        // Only grows, the elements past the previous size are default constructed
+        void Resize(size_t newSize)
+        {
+            while(m_chunks.GetSize() * ChunkSize < newSize)
+                m_chunks.PushBack(BlitzenCore::BlitConstructAlloc<T, BlitzenCore::AllocationType::DynamicArray>(ChunkSize));
+
+            if(newSize > m_size)
+                m_size = newSize;
+        }
+
+        void PushBack(const T& newElement)
+        {
+            Resize(m_size + 1);
+            (*this)[m_size - 1] = newElement;
+        }
+
+        inline T& operator [] (size_t index) {
+            BLIT_ASSERT(index < m_size)
+            return m_chunks[index / ChunkSize][index % ChunkSize];
+        }
+
+        inline T& Back() { BLIT_ASSERT(m_size) return (*this)[m_size - 1]; }
+
+        inline size_t GetSize() { return m_size; }
+
+        // Copies the elements to a continuous block, for users that need to upload the whole array at once
+        void CopyTo(T* pDst)
+        {
+            for(size_t i = 0; i < m_chunks.GetSize() && i * ChunkSize < m_size; ++i)
+            {
+                size_t count = m_size - i * ChunkSize < ChunkSize ? m_size - i * ChunkSize : ChunkSize;
+                for(size_t j = 0; j < count; ++j)
+                    pDst[i * ChunkSize + j] = m_chunks[i][j];
+            }
+        }
+
+        ~ChunkedArray()
+        {
+            for(size_t i = 0; i < m_chunks.GetSize(); ++i)
+            {
+                delete [] m_chunks[i];
+                BlitzenCore::LogFree(BlitzenCore::AllocationType::DynamicArray, ChunkSize * sizeof(T));
+            }
+        }
+
+    private:
+
+        DynamicArray<T*> m_chunks;
+
+        size_t m_size = 0;
+    };
+
+
 
     template<typename T, // The type of pointer stored
     BlitzenCore::AllocationType A = BlitzenCore::AllocationType::SmartPointer, // The allocation type that the allocator should keep track of
@@ -3,6 +3,8 @@
 #include "Core/blitLogger.h"
 #include "BlitzenVulkan/vulkanRenderer.h"
 
+#include <atomic>
+
 namespace BlitzenCore
 {
     // The linear allocator allocates a big amount of memory on boot and places everything it allocates there
@@ -14,13 +16,14 @@ namespace BlitzenCore
         size_t blockSize;
     };
 
-    // This is used to log every allocation and check if there are any memory leaks in the end
+    // This is used to log every allocation and check if there are any memory leaks in the end.
+    // The counters are atomic, since the scene streaming workers allocate on their own threads
     struct MemoryManagerState
     {
-        size_t totalAllocated = 0;
+        std::atomic<size_t> totalAllocated{0};
 
         // Keeps track of how much memory has been allocated for each type of allocation
-        size_t typeAllocations[static_cast<size_t>(AllocationType::MaxTypes)];
+        std::atomic<size_t> typeAllocations[static_cast<size_t>(AllocationType::MaxTypes)];
 
         LinearAllocator linearAlloc;
 
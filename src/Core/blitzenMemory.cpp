@@ -1,6 +1,8 @@
 #include "blitMemory.h"
 #include "Platform/platform.h"
-#include "Engine/blitzenEngine.h"
+#ifndef BLITZEN_COOK
+    #include "Engine/blitzenEngine.h"
+#endif
 #include "Core/blitzenCore.h"
 
 #define GET_BLITZEN_MEMORY_MANAGER_STATE() BlitzenCore::MemoryManagerState::GetManager();
@@ -64,12 +66,14 @@ namespace BlitzenCore
 
     MemoryManagerState::~MemoryManagerState()
     {
-        // Memory management should not shut down before the Engine
+        // Memory management should not shut down before the Engine. The offline tools run without one
+        #ifndef BLITZEN_COOK
         if (BlitzenEngine::Engine::GetEngineInstancePointer())
         {
             BLIT_ERROR("Blitzen is still active, memory management cannot be shutdown")
             return;
         }
+        #endif
 
         MemoryManagerState* pState = GET_BLITZEN_MEMORY_MANAGER_STATE();
 
@@ -89,15 +93,15 @@ namespace BlitzenCore
             Unallocated String memory: %i \n \
             Unallocated Engine memory: %i \n \
             Uncallocated Renderer memory: %i \n", \
-            pState->totalAllocated, 
-            pState->typeAllocations[1], 
-            pState->typeAllocations[2], 
-            pState->typeAllocations[3], 
-            pState->typeAllocations[4], 
-            pState->typeAllocations[5], 
-            pState->typeAllocations[6], 
-            pState->typeAllocations[7],
-            pState->typeAllocations[8])
+            pState->totalAllocated.load(), 
+            pState->typeAllocations[1].load(), 
+            pState->typeAllocations[2].load(), 
+            pState->typeAllocations[3].load(), 
+            pState->typeAllocations[4].load(), 
+            pState->typeAllocations[5].load(), 
+            pState->typeAllocations[6].load(), 
+            pState->typeAllocations[7].load(),
+            pState->typeAllocations[8].load())
         }
     }
 
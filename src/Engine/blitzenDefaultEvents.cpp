@@ -99,6 +99,23 @@ namespace BlitzenEngine
                     RenderingSystem::GetRenderingSystem()->SetActiveAPI(ActiveRenderer::Vulkan);
                     break;
                 }
+                case BlitzenCore::BlitKey::__F7:
+                {
+                    ChangeInstancingEnabledState();
+                    break;
+                }
+                case BlitzenCore::BlitKey::__F8:
+                {
+                    ChangeMeshShadingEnabledState();
+                    break;
+                }
+                case BlitzenCore::BlitKey::__F9:
+                {
+                    // Stops loading the scenes that are still being streamed
+                    BlitzenCore::EventContext context{};
+                    BlitzenCore::FireEvent(BlitzenCore::BlitEventType::SceneStreamingCancel, nullptr, context);
+                    break;
+                }
                 default:
                 {
                     BLIT_DBLOG("Key pressed %i", key)
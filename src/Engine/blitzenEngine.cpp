@@ -6,6 +6,7 @@
 #include "Engine/blitzenEngine.h"
 #include "Platform/platform.h"
 #include "Renderer/blitRenderer.h"
+#include "Renderer/blitWorldPartition.h"
 #include "Core/blitzenCore.h"
 #include "Game/blitCamera.h"
 
@@ -96,21 +97,41 @@ namespace BlitzenEngine
         #endif
 
 
-        // Loads the gltf files that were specified as command line arguments
+        // The gltf files that were specified as command line arguments are streamed in on worker threads after the first frame
         if(argc != 1)
         {
             for(uint32_t i = 1; i < argc; ++i)
             {
-                LoadGltfScene(pResources.Data(), argv[i], renderer->IsVulkanAvailable(), renderer->IsOpenglAvailable());
+                renderer->StreamScene(argv[i]);
             }
         }
 
+        // Flies the camera over a grid of world partition cells, that are streamed in and out around it
+        #ifdef BLITZEN_WORLD_PARTITION_BENCHMARK
+            WorldPartition worldPartition;
+            worldPartition.Init(renderer.Data());
+            WorldFlythroughBenchmark worldBenchmark;
+            worldBenchmark.Init(worldPartition, BLIT_WORLD_BENCHMARK_SCENE);
+        #endif
+
         // Set the draw count to the render object count   
-        drawCount = pResources.Data()->renderObjectCount;
+        drawCount = static_cast<uint32_t>(pResources.Data()->renders.GetSize());
+
+        // Puts nearby transforms and their render objects next to each other, so that culling reads them together
+        SortRenderObjectsSpatially(pResources.Data());
+
+        // Groups the render objects of each transform, so that culling can test the whole instance before its surfaces
+        BuildMeshInstances(pResources.Data());
 
         // Pass the resources and pointers to any of the renderers that might be used for rendering
         BLIT_ASSERT(renderer->SetupRequestedRenderersForDrawing(pResources.Data(), drawCount, mainCamera));/* I use an assertion here
         but it could be handled some other way as well */
+
+        // Times the vertex shader and mesh shading paths from the starting camera, then closes the engine
+        #ifdef BLITZEN_MESH_SHADING_BENCHMARK
+            MeshShadingBenchmark meshShadingBenchmark;
+            meshShadingBenchmark.Init(renderer.Data(), mainCamera);
+        #endif
         
         // Start the clock
         m_clockStartTime = BlitzenPlatform::PlatformGetAbsoluteTime();
@@ -135,9 +156,31 @@ namespace BlitzenEngine
                 // Update the previous elapsed time to the current elapsed time
                 previousTime = m_clockElapsedTime;
 
+                #ifdef BLITZEN_WORLD_PARTITION_BENCHMARK
+                    if(!worldBenchmark.Update(mainCamera, worldPartition, m_deltaTime))
+                        RequestShutdown();
+                #endif
+
+                #ifdef BLITZEN_MESH_SHADING_BENCHMARK
+                    if(!meshShadingBenchmark.Update(renderer.Data(), mainCamera))
+                        RequestShutdown();
+                #endif
+
                 // With delta time retrieved, call update camera to make any necessary changes to the scene based on its transform
                 UpdateCamera(mainCamera, (float)m_deltaTime);
 
+                // The benchmarks keep the LOD bias fixed, since the controller would give each path or run different LODs
+                #if BLIT_LOD_BIAS_CONTROLLER && !defined(BLITZEN_MESH_SHADING_BENCHMARK) && !defined(BLITZEN_WORLD_PARTITION_BENCHMARK)
+                    UpdateLodBias(mainCamera, (float)m_deltaTime, renderer->GetGpuFrameTime());
+                #endif
+
+                // Game objects can be added or removed through the rendering system, so the draw count is refreshed every frame
+                drawCount = static_cast<uint32_t>(pResources.Data()->renders.GetSize());
+
+                #ifdef BLITZEN_WORLD_PARTITION_BENCHMARK
+                    worldPartition.Update(mainCamera.viewData.position);
+                #endif
+
                 // Draw the frame!!!!
                 renderer->DrawFrame(mainCamera, drawCount);
 
@@ -148,6 +191,10 @@ namespace BlitzenEngine
             }
         }
 
+        #ifdef BLITZEN_WORLD_PARTITION_BENCHMARK
+            worldPartition.Clear();
+        #endif
+
         // Shutdown the renderers before the engine is shutdown
         renderer->ShutdownRenderers();
 
@@ -8,6 +8,19 @@
 #define BLIT_MAIN_CAMERA_ID          0
 #define BLIT_DETATCHED_CAMERA_ID     1
 
+// The LOD bias multiplies the screen space error that LOD selection accepts by 2 to its power, so a bias of 1 accepts twice the error
+#define BLIT_LOD_BIAS_MIN                   0.f
+#define BLIT_LOD_BIAS_MAX                   3.f
+
+// When this is 1, the engine drives the LOD bias of the main camera from the GPU frame time. The bias goes up while the average 
+// GPU time is over the target and back down once it is under the target by the margin, so that it does not oscillate around it.
+// The wall clock frame time is not used, since with vsync it sits at the refresh interval whatever the GPU load
+#define BLIT_LOD_BIAS_CONTROLLER            1
+#define BLIT_LOD_BIAS_TARGET_FRAME_TIME     (1.f / 60.f)
+#define BLIT_LOD_BIAS_FRAME_TIME_MARGIN     0.85f
+// How much the bias can move in one second
+#define BLIT_LOD_BIAS_RATE                  1.f
+
 namespace BlitzenEngine
 {
     // This is struct that is needed for camera movement logic and window size stats
@@ -69,16 +82,26 @@ namespace BlitzenEngine
         float pyramidWidth;
         float pyramidHeight;
 
-        // Used to adapt the lod threshold to screen / view settings
+        // Used to adapt the lod threshold to screen / view settings. This is the size of a pixel at distance 1, scaled by the LOD bias
         float lodTarget;
     };
 
+    // State of the frame time controller that drives the LOD bias
+    struct LodBiasData
+    {
+        float bias = 0.f;
+
+        float averageGpuFrameTime = 0.f;
+    };
+
     // Temporary camera struct, I am going to make it more robust in the future
     struct Camera
     {
         CameraViewData viewData;
 
         CameraTransformData transformData;
+
+        LodBiasData lodBias;
     };
 
     // Gives some default values to a new camera so that it does not spawn with a random transform
@@ -95,6 +118,12 @@ namespace BlitzenEngine
     // Values that have to do with projection are also updated
     void UpdateProjection(Camera& camera, float fov, float windowWidth, float windowHeight, float zNear);
 
+    // Clamps the bias to the LOD bias range and updates the LOD target, which depends on it
+    void SetLodBias(Camera& camera, float bias);
+
+    // Moves the LOD bias towards keeping the frame time under BLIT_LOD_BIAS_TARGET_FRAME_TIME. Called once per frame
+    void UpdateLodBias(Camera& camera, float deltaTime, float gpuFrameTime);
+
     class CameraSystem
     {
     public:
@@ -2,6 +2,13 @@
 
 namespace BlitzenEngine
 {
+    // The LOD target depends on the projection, the window height and the LOD bias
+    static void UpdateLodTarget(Camera& camera)
+    {
+        camera.viewData.lodTarget = (2 / camera.viewData.proj5) * (1.f / float(camera.transformData.windowHeight)) * 
+        BlitML::Exp2(camera.lodBias.bias);
+    }
+
     void SetupCamera(Camera& camera, float fov, float windowWidth, float windowHeight, float zNear, 
     BlitML::vec3 initialCameraPosition, float drawDistance, 
     float initialYawRotation /*=0*/, float initialPitchRotation /*=0*/)
@@ -57,7 +64,7 @@ namespace BlitzenEngine
         camera.viewData.proj0 = camera.transformData.projectionMatrix[0];
         camera.viewData.proj5 = camera.transformData.projectionMatrix[5];
 
-        camera.viewData.lodTarget = (2 / camera.viewData.proj5) * (1.f / float(camera.transformData.windowHeight));
+        UpdateLodTarget(camera);
     }
 
     // This will move from here once I add a camera system
@@ -134,12 +141,37 @@ namespace BlitzenEngine
         camera.viewData.proj5 = camera.transformData.projectionMatrix[5];
     
         // Updates the lod target threshold multiplier, as it is also dependent on projection
-        camera.viewData.lodTarget = (2 / camera.viewData.proj5) * (1.f / float(camera.transformData.windowHeight));
+        UpdateLodTarget(camera);
 
         // Updates the zNear (zFar is static and is actually the set draw distance)
         camera.viewData.zNear = zNear;
     }
 
+    void SetLodBias(Camera& camera, float bias)
+    {
+        camera.lodBias.bias = BlitML::Min(BlitML::Max(bias, BLIT_LOD_BIAS_MIN), BLIT_LOD_BIAS_MAX);
+        UpdateLodTarget(camera);
+    }
+
+    void UpdateLodBias(Camera& camera, float deltaTime, float gpuFrameTime)
+    {
+        // Nothing to go by without GPU timestamps, the bias stays where it is
+        if(gpuFrameTime <= 0.f)
+            return;
+
+        // Averaged over the last few frames, so that a single slow frame does not move the bias
+        LodBiasData& lodBias = camera.lodBias;
+        lodBias.averageGpuFrameTime = lodBias.averageGpuFrameTime == 0.f ? gpuFrameTime : 
+        lodBias.averageGpuFrameTime * 0.9f + gpuFrameTime * 0.1f;
+
+        // Long stalls (loading, window moves) are not allowed to push the bias all the way in one frame
+        float step = BLIT_LOD_BIAS_RATE * BlitML::Min(deltaTime, 0.1f);
+        if(lodBias.averageGpuFrameTime > BLIT_LOD_BIAS_TARGET_FRAME_TIME)
+            SetLodBias(camera, lodBias.bias + step);
+        else if(lodBias.averageGpuFrameTime < BLIT_LOD_BIAS_TARGET_FRAME_TIME * BLIT_LOD_BIAS_FRAME_TIME_MARGIN)
+            SetLodBias(camera, lodBias.bias - step);
+    }
+
     // Must Declare the static variable
     CameraSystem* CameraSystem::m_sThis;
 
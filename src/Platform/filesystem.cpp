@@ -1,12 +1,37 @@
 // Temporary, probably need to turn this into platform specific code in the future
 #include <stdio.h>
 #include <string.h>
+#include <string>
 #include <sys/stat.h>
 
 #include "Core/blitLogger.h"
 #include "filesystem.h"
 #include "Core/blitMemory.h"
 
+#if _MSC_VER
+    #include <windows.h>
+#else
+    #include <errno.h>
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+
+    // The kernel queue is used through its system calls, so only the kernel header is needed
+    #if defined(__linux__) && __has_include(<linux/io_uring.h>)
+        #include <linux/io_uring.h>
+        #define BLIT_ASYNC_IO_URING
+    #endif
+#endif
+
+// User data of the entry that wakes the completion thread to stop it
+#define BLIT_ASYNC_IO_WAKE_ENTRY                UINT64_MAX
+
+// Most bytes that one queue entry reads, since its length is 32 bits. Larger reads are done in pieces of this size, one after the other.
+// A multiple of the direct alignment, so that the pieces of a direct read stay aligned
+#define BLIT_ASYNC_IO_MAX_ENTRY_SIZE            0x40000000ull
+
 namespace BlitzenPlatform
 {
     uint8_t FilepathExists(const char* path)
@@ -20,6 +45,110 @@ namespace BlitzenPlatform
         #endif
     }
 
+    uint8_t GetFileWriteTime(const char* path, uint64_t& writeTime)
+    {
+        uint64_t size;
+        return GetFileInfo(path, size, writeTime);
+    }
+
+    uint8_t GetFileInfo(const char* path, uint64_t& size, uint64_t& writeTime)
+    {
+        #if _MSC_VER
+            struct _stat64 buffer;
+            if(_stat64(path, &buffer) != 0)
+                return 0;
+        #else
+            struct stat buffer;
+            if(stat(path, &buffer) != 0)
+                return 0;
+        #endif
+        size = static_cast<uint64_t>(buffer.st_size);
+        writeTime = static_cast<uint64_t>(buffer.st_mtime);
+        return 1;
+    }
+
+    uint8_t CreateDirectories(const char* path)
+    {
+        // Each parent is created on the way to the full path. Directories that exist already are skipped
+        char directory[1024];
+        size_t length = strlen(path);
+        if(!length || length >= sizeof(directory))
+            return 0;
+        memcpy(directory, path, length + 1);
+
+        for(size_t i = 1; i <= length; ++i)
+        {
+            if(i < length && directory[i] != '/' && directory[i] != '\\')
+                continue;
+
+            char separator = directory[i];
+            directory[i] = 0;
+            if(!FilepathExists(directory))
+            {
+                #if _MSC_VER
+                    if(!CreateDirectoryA(directory, nullptr) && GetLastError() != ERROR_ALREADY_EXISTS)
+                        return 0;
+                #else
+                    if(mkdir(directory, 0755) != 0 && errno != EEXIST)
+                        return 0;
+                #endif
+            }
+            directory[i] = separator;
+        }
+
+        return 1;
+    }
+
+    uint8_t ListDirectoryFiles(const char* path, DirectoryFileCallback callback, void* pUserData)
+    {
+        std::string directory = path;
+        if(!directory.empty() && directory.back() != '/' && directory.back() != '\\')
+            directory += '/';
+
+        #if _MSC_VER
+            WIN32_FIND_DATAA entry;
+            HANDLE find = FindFirstFileA((directory + "*").c_str(), &entry);
+            if(find == INVALID_HANDLE_VALUE)
+                return 0;
+
+            do
+            {
+                if(!strcmp(entry.cFileName, ".") || !strcmp(entry.cFileName, ".."))
+                    continue;
+
+                std::string entryPath = directory + entry.cFileName;
+                if(entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                    ListDirectoryFiles(entryPath.c_str(), callback, pUserData);
+                else
+                    callback(entryPath.c_str(), pUserData);
+            } while(FindNextFileA(find, &entry));
+            FindClose(find);
+        #else
+            DIR* pDirectory = opendir(directory.c_str());
+            if(!pDirectory)
+                return 0;
+
+            while(dirent* pEntry = readdir(pDirectory))
+            {
+                if(!strcmp(pEntry->d_name, ".") || !strcmp(pEntry->d_name, ".."))
+                    continue;
+
+                // Some filesystems do not give the type of the entry, it is looked up then
+                std::string entryPath = directory + pEntry->d_name;
+                struct stat buffer;
+                uint8_t bDirectory = pEntry->d_type == DT_DIR || 
+                (pEntry->d_type == DT_UNKNOWN && stat(entryPath.c_str(), &buffer) == 0 && S_ISDIR(buffer.st_mode));
+                if(bDirectory)
+                    ListDirectoryFiles(entryPath.c_str(), callback, pUserData);
+                else
+                    callback(entryPath.c_str(), pUserData);
+            }
+            closedir(pDirectory);
+        #endif
+
+        return 1;
+    }
+
     uint8_t FileHandle::Open(const char* path, FileModes mode, uint8_t binary)
     {
         // If the handle already has a valid handle, it asserts
@@ -147,7 +276,6 @@ namespace BlitzenPlatform
             {
                 return 0;
             }
-            fflush(reinterpret_cast<FILE*>(handle.pHandle));
             return 1;
         }
         return 0;
@@ -193,4 +321,636 @@ namespace BlitzenPlatform
         }
         return 0;
     }
+
+
+
+    uint8_t MappedFile::Open(const char* path, MappedFileAccess access)
+    {
+        BLIT_ASSERT(m_pData == nullptr)
+
+        #if _MSC_VER
+            DWORD flags = FILE_ATTRIBUTE_NORMAL | (access == MappedFileAccess::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : 
+            access == MappedFileAccess::Random ? FILE_FLAG_RANDOM_ACCESS : 0);
+            HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+            if(file == INVALID_HANDLE_VALUE)
+            {
+                BLIT_ERROR("Error opening file: '%s'", path)
+                return 0;
+            }
+
+            LARGE_INTEGER size;
+            if(!GetFileSizeEx(file, &size) || !size.QuadPart)
+            {
+                CloseHandle(file);
+                BLIT_ERROR("Error mapping empty file: '%s'", path)
+                return 0;
+            }
+
+            // The mapping keeps the file open, so its handle can be closed right away
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            CloseHandle(file);
+            if(!mapping)
+            {
+                BLIT_ERROR("Error mapping file: '%s'", path)
+                return 0;
+            }
+
+            void* pView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if(!pView)
+            {
+                CloseHandle(mapping);
+                BLIT_ERROR("Error mapping file: '%s'", path)
+                return 0;
+            }
+            m_pMapping = mapping;
+            m_size = static_cast<size_t>(size.QuadPart);
+        #else
+            int fd = open(path, O_RDONLY);
+            if(fd < 0)
+            {
+                BLIT_ERROR("Error opening file: '%s'", path)
+                return 0;
+            }
+
+            struct stat info;
+            if(fstat(fd, &info) != 0 || !info.st_size)
+            {
+                close(fd);
+                BLIT_ERROR("Error mapping empty file: '%s'", path)
+                return 0;
+            }
+
+            // The mapping keeps the file open, so its descriptor can be closed right away
+            size_t size = static_cast<size_t>(info.st_size);
+            void* pView = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if(pView == MAP_FAILED)
+            {
+                BLIT_ERROR("Error mapping file: '%s'", path)
+                return 0;
+            }
+
+            int advice = access == MappedFileAccess::Sequential ? MADV_SEQUENTIAL : 
+            access == MappedFileAccess::WillNeed ? MADV_WILLNEED : MADV_NORMAL;
+            madvise(pView, size, advice);
+            m_size = size;
+        #endif
+
+        m_pData = pView;
+        return 1;
+    }
+
+    void MappedFile::Close()
+    {
+        if(!m_pData)
+            return;
+
+        #if _MSC_VER
+            UnmapViewOfFile(m_pData);
+            CloseHandle(reinterpret_cast<HANDLE>(m_pMapping));
+            m_pMapping = nullptr;
+        #else
+            munmap(m_pData, m_size);
+        #endif
+        m_pData = nullptr;
+        m_size = 0;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+    uint8_t AsyncFile::Open(const char* path, uint8_t bDirect)
+    {
+        BLIT_ASSERT(handle == -1)
+
+        #if _MSC_VER
+            DWORD flags = FILE_ATTRIBUTE_NORMAL | (bDirect ? FILE_FLAG_NO_BUFFERING : 0);
+            HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+            if(file == INVALID_HANDLE_VALUE)
+            {
+                BLIT_ERROR("Error opening file: '%s'", path)
+                return 0;
+            }
+
+            LARGE_INTEGER size;
+            if(!GetFileSizeEx(file, &size))
+            {
+                CloseHandle(file);
+                BLIT_ERROR("Error reading the size of file: '%s'", path)
+                return 0;
+            }
+            handle = reinterpret_cast<intptr_t>(file);
+            m_size = static_cast<size_t>(size.QuadPart);
+        #else
+            int flags = O_RDONLY;
+            #ifdef O_DIRECT
+                if(bDirect)
+                    flags |= O_DIRECT;
+            #endif
+            int fd = open(path, flags);
+            if(fd < 0)
+            {
+                BLIT_ERROR("Error opening file: '%s'", path)
+                return 0;
+            }
+
+            struct stat info;
+            if(fstat(fd, &info) != 0)
+            {
+                close(fd);
+                BLIT_ERROR("Error reading the size of file: '%s'", path)
+                return 0;
+            }
+            handle = fd;
+            m_size = static_cast<size_t>(info.st_size);
+        #endif
+
+        m_bDirect = bDirect;
+        return 1;
+    }
+
+    void AsyncFile::Close()
+    {
+        if(handle == -1)
+            return;
+
+        #if _MSC_VER
+            CloseHandle(reinterpret_cast<HANDLE>(handle));
+        #else
+            close(static_cast<int>(handle));
+        #endif
+        handle = -1;
+        m_size = 0;
+    }
+
+    AsyncFile::~AsyncFile()
+    {
+        Close();
+    }
+
+    // Blocking read at an offset, used by the fallback threads. Several threads can read the same file at once
+    static int64_t ReadFileAt(AsyncFile* pFile, uint64_t offset, size_t size, void* pBuffer)
+    {
+        uint8_t* pBytes = reinterpret_cast<uint8_t*>(pBuffer);
+        size_t bytesRead = 0;
+        while(bytesRead < size)
+        {
+            #if _MSC_VER
+                OVERLAPPED overlapped = {};
+                uint64_t position = offset + bytesRead;
+                overlapped.Offset = static_cast<DWORD>(position);
+                overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+
+                size_t left = size - bytesRead;
+                DWORD toRead = left > 0x40000000 ? 0x40000000 : static_cast<DWORD>(left);
+                DWORD result = 0;
+                if(!ReadFile(reinterpret_cast<HANDLE>(pFile->handle), pBytes + bytesRead, toRead, &result, &overlapped))
+                {
+                    if(GetLastError() == ERROR_HANDLE_EOF)
+                        break;
+                    return -1;
+                }
+            #else
+                ssize_t result = pread(static_cast<int>(pFile->handle), pBytes + bytesRead, size - bytesRead,
+                static_cast<off_t>(offset + bytesRead));
+                if(result < 0)
+                {
+                    if(errno == EINTR)
+                        continue;
+                    return -1;
+                }
+            #endif
+
+            // End of the file
+            if(result == 0)
+                break;
+            bytesRead += static_cast<size_t>(result);
+        }
+        return static_cast<int64_t>(bytesRead);
+    }
+
+    uint8_t AsyncIO::Init(uint32_t queueDepth)
+    {
+        BLIT_ASSERT(!m_bInitialized)
+        m_bShutdown = 0;
+
+        if(InitKernelQueue(queueDepth))
+        {
+            m_threads[0] = std::thread(&AsyncIO::CompletionLoop, this);
+            m_threadCount = 1;
+        }
+        else
+        {
+            uint32_t coreCount = std::thread::hardware_concurrency();
+            m_threadCount = coreCount ? coreCount : 1;
+            m_threadCount = m_threadCount > BLIT_ASYNC_IO_FALLBACK_THREAD_COUNT ? BLIT_ASYNC_IO_FALLBACK_THREAD_COUNT : m_threadCount;
+            for(uint32_t i = 0; i < m_threadCount; ++i)
+                m_threads[i] = std::thread(&AsyncIO::WorkerLoop, this);
+            BLIT_INFO("Async IO: kernel queue not available, reading on %u threads", m_threadCount)
+        }
+
+        m_bInitialized = 1;
+        return 1;
+    }
+
+    uint8_t AsyncIO::SubmitReads(const AsyncReadRequest* pRequests, uint32_t requestCount)
+    {
+        if(!m_bInitialized)
+        {
+            BLIT_ERROR("Async IO: reads submitted before Init")
+            return 0;
+        }
+
+        for(uint32_t i = 0; i < requestCount; ++i)
+        {
+            const AsyncReadRequest& request = pRequests[i];
+            if(!request.pFile || request.pFile->handle == -1 || !request.pBuffer || !request.callback)
+            {
+                BLIT_ERROR("Async IO: invalid read request")
+                return 0;
+            }
+
+            // Direct reads skip the OS cache and go straight to the buffer, which the device can only do in whole sectors
+            if(request.pFile->IsDirect() && (request.offset % BLIT_ASYNC_IO_DIRECT_ALIGNMENT ||
+            request.size % BLIT_ASYNC_IO_DIRECT_ALIGNMENT || reinterpret_cast<uintptr_t>(request.pBuffer) % BLIT_ASYNC_IO_DIRECT_ALIGNMENT))
+            {
+                BLIT_ERROR("Async IO: direct reads need their offset, size and buffer aligned to %u bytes", BLIT_ASYNC_IO_DIRECT_ALIGNMENT)
+                return 0;
+            }
+        }
+
+        // Reads that the kernel would not take are called back as failed, after the lock is released
+        BlitCL::DynamicArray<AsyncReadRequest> failedReads;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for(uint32_t i = 0; i < requestCount; ++i)
+                m_waitingReads.PushBack(pRequests[i]);
+            m_pendingCount += requestCount;
+
+            if(UsesKernelQueue())
+                SubmitWaitingReads(failedReads);
+        }
+        if(!UsesKernelQueue())
+            m_signal.notify_all();
+        for(size_t i = 0; i < failedReads.GetSize(); ++i)
+            CompleteRead(failedReads[i], -1);
+
+        return 1;
+    }
+
+    uint32_t AsyncIO::GetPendingCount()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_pendingCount;
+    }
+
+    void AsyncIO::WaitAll()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idleSignal.wait(lock, [this](){ return m_pendingCount == 0; });
+    }
+
+    void AsyncIO::CompleteRead(const AsyncReadRequest& request, int64_t result)
+    {
+        request.callback(request.pUserData, result >= 0, result >= 0 ? static_cast<size_t>(result) : 0);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingCount--;
+        if(!m_pendingCount)
+            m_idleSignal.notify_all();
+    }
+
+    void AsyncIO::WorkerLoop()
+    {
+        while(1)
+        {
+            AsyncReadRequest request;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_signal.wait(lock, [this](){ return m_bShutdown || m_nextWaitingRead < m_waitingReads.GetSize(); });
+                if(m_nextWaitingRead == m_waitingReads.GetSize())
+                    return;
+
+                request = m_waitingReads[m_nextWaitingRead++];
+                if(m_nextWaitingRead == m_waitingReads.GetSize())
+                {
+                    m_waitingReads.Downsize(0);
+                    m_nextWaitingRead = 0;
+                }
+            }
+
+            CompleteRead(request, ReadFileAt(request.pFile, request.offset, request.size, request.pBuffer));
+        }
+    }
+
+    void AsyncIO::Shutdown()
+    {
+        if(!m_bInitialized)
+            return;
+
+        WaitAll();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bShutdown = 1;
+
+            #if defined(BLIT_ASYNC_IO_URING)
+                // The completion thread sleeps in the kernel, an entry that completes at once wakes it
+                if(UsesKernelQueue())
+                {
+                    uint32_t tail = *m_pSqTail;
+                    uint32_t index = tail & m_sqMask;
+                    io_uring_sqe* pEntry = reinterpret_cast<io_uring_sqe*>(m_pSubmissionEntries) + index;
+                    memset(pEntry, 0, sizeof(io_uring_sqe));
+                    pEntry->opcode = IORING_OP_NOP;
+                    pEntry->user_data = BLIT_ASYNC_IO_WAKE_ENTRY;
+                    m_pSqArray[index] = index;
+                    __atomic_store_n(m_pSqTail, tail + 1, __ATOMIC_RELEASE);
+                    syscall(__NR_io_uring_enter, m_ringFd, 1, 0, 0, nullptr, 0);
+                }
+            #endif
+        }
+        m_signal.notify_all();
+
+        for(uint32_t i = 0; i < m_threadCount; ++i)
+            m_threads[i].join();
+        m_threadCount = 0;
+
+        ReleaseKernelQueue();
+        m_waitingReads.Downsize(0);
+        m_nextWaitingRead = 0;
+        m_bInitialized = 0;
+    }
+
+    AsyncIO::~AsyncIO()
+    {
+        Shutdown();
+    }
+
+    #if defined(BLIT_ASYNC_IO_URING)
+
+        uint8_t AsyncIO::InitKernelQueue(uint32_t queueDepth)
+        {
+            io_uring_params params = {};
+            int fd = static_cast<int>(syscall(__NR_io_uring_setup, queueDepth, &params));
+            if(fd < 0)
+                return 0;
+            m_ringFd = fd;
+
+            // Plain read entries came with the same kernel version as this feature
+            #ifdef IORING_FEAT_RW_CUR_POS
+                if(!(params.features & IORING_FEAT_RW_CUR_POS))
+            #endif
+            {
+                ReleaseKernelQueue();
+                return 0;
+            }
+
+            m_submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+            m_completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+            // Newer kernels map both rings with one call
+            uint8_t bSingleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if(bSingleMap && m_completionRingSize > m_submissionRingSize)
+                m_submissionRingSize = m_completionRingSize;
+
+            void* pSubmissionRing = mmap(nullptr, m_submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, 
+            fd, IORING_OFF_SQ_RING);
+            if(pSubmissionRing == MAP_FAILED)
+            {
+                ReleaseKernelQueue();
+                return 0;
+            }
+            m_pSubmissionRing = pSubmissionRing;
+
+            if(bSingleMap)
+            {
+                m_pCompletionRing = m_pSubmissionRing;
+                m_completionRingSize = 0;
+            }
+            else
+            {
+                void* pCompletionRing = mmap(nullptr, m_completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, 
+                fd, IORING_OFF_CQ_RING);
+                if(pCompletionRing == MAP_FAILED)
+                {
+                    m_completionRingSize = 0;
+                    ReleaseKernelQueue();
+                    return 0;
+                }
+                m_pCompletionRing = pCompletionRing;
+            }
+
+            m_submissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+            void* pEntries = mmap(nullptr, m_submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, 
+            fd, IORING_OFF_SQES);
+            if(pEntries == MAP_FAILED)
+            {
+                m_submissionEntriesSize = 0;
+                ReleaseKernelQueue();
+                return 0;
+            }
+            m_pSubmissionEntries = pEntries;
+
+            uint8_t* pSq = reinterpret_cast<uint8_t*>(m_pSubmissionRing);
+            m_pSqHead = reinterpret_cast<uint32_t*>(pSq + params.sq_off.head);
+            m_pSqTail = reinterpret_cast<uint32_t*>(pSq + params.sq_off.tail);
+            m_pSqArray = reinterpret_cast<uint32_t*>(pSq + params.sq_off.array);
+            m_sqMask = *reinterpret_cast<uint32_t*>(pSq + params.sq_off.ring_mask);
+
+            uint8_t* pCq = reinterpret_cast<uint8_t*>(m_pCompletionRing);
+            m_pCqHead = reinterpret_cast<uint32_t*>(pCq + params.cq_off.head);
+            m_pCqTail = reinterpret_cast<uint32_t*>(pCq + params.cq_off.tail);
+            m_pCqes = pCq + params.cq_off.cqes;
+            m_cqMask = *reinterpret_cast<uint32_t*>(pCq + params.cq_off.ring_mask);
+
+            // No more reads are in flight than the submission queue holds, so the completion queue (twice as big) never overflows
+            m_queueDepth = params.sq_entries;
+            m_slots.Resize(m_queueDepth);
+            m_slotBytesRead.Resize(m_queueDepth);
+            m_freeSlots.Resize(m_queueDepth);
+            for(uint32_t i = 0; i < m_queueDepth; ++i)
+                m_freeSlots[i] = m_queueDepth - 1 - i;
+
+            BLIT_INFO("Async IO: io_uring queue with %u entries", m_queueDepth)
+            return 1;
+        }
+
+        void AsyncIO::ReleaseKernelQueue()
+        {
+            if(m_pSubmissionEntries)
+                munmap(m_pSubmissionEntries, m_submissionEntriesSize);
+            if(m_pCompletionRing && m_completionRingSize)
+                munmap(m_pCompletionRing, m_completionRingSize);
+            if(m_pSubmissionRing)
+                munmap(m_pSubmissionRing, m_submissionRingSize);
+            if(m_ringFd >= 0)
+                close(m_ringFd);
+
+            m_pSubmissionEntries = nullptr;
+            m_pCompletionRing = nullptr;
+            m_pSubmissionRing = nullptr;
+            m_ringFd = -1;
+            m_slots.Downsize(0);
+            m_slotBytesRead.Downsize(0);
+            m_freeSlots.Downsize(0);
+            m_continuedSlots.Downsize(0);
+        }
+
+        // Writes the entry that reads the rest of the slot's request, at most one piece of it
+        void AsyncIO::QueueSlotRead(uint32_t slot, uint32_t tail)
+        {
+            AsyncReadRequest& request = m_slots[slot];
+            size_t bytesRead = m_slotBytesRead[slot];
+            size_t left = request.size - bytesRead;
+
+            uint32_t index = tail & m_sqMask;
+            io_uring_sqe* pEntry = reinterpret_cast<io_uring_sqe*>(m_pSubmissionEntries) + index;
+            memset(pEntry, 0, sizeof(io_uring_sqe));
+            pEntry->opcode = IORING_OP_READ;
+            pEntry->fd = static_cast<int>(request.pFile->handle);
+            pEntry->addr = reinterpret_cast<uint64_t>(request.pBuffer) + bytesRead;
+            pEntry->len = static_cast<uint32_t>(left > BLIT_ASYNC_IO_MAX_ENTRY_SIZE ? BLIT_ASYNC_IO_MAX_ENTRY_SIZE : left);
+            pEntry->off = request.offset + bytesRead;
+            pEntry->user_data = slot;
+            m_pSqArray[index] = index;
+        }
+
+        void AsyncIO::SubmitWaitingReads(BlitCL::DynamicArray<AsyncReadRequest>& failedReads)
+        {
+            // Only this thread writes the tail, the kernel moves the head as it takes the entries
+            uint32_t tail = *m_pSqTail;
+            m_batchSlots.Downsize(0);
+
+            // Reads that came back short continue first, they already hold their slots
+            for(size_t i = 0; i < m_continuedSlots.GetSize(); ++i)
+            {
+                QueueSlotRead(m_continuedSlots[i], tail++);
+                m_batchSlots.PushBack(m_continuedSlots[i]);
+            }
+            m_continuedSlots.Downsize(0);
+
+            while(m_nextWaitingRead < m_waitingReads.GetSize() && m_freeSlots.GetSize())
+            {
+                uint32_t slot = m_freeSlots.Back();
+                m_freeSlots.Downsize(m_freeSlots.GetSize() - 1);
+
+                m_slots[slot] = m_waitingReads[m_nextWaitingRead++];
+                m_slotBytesRead[slot] = 0;
+                QueueSlotRead(slot, tail++);
+                m_batchSlots.PushBack(slot);
+            }
+
+            if(m_nextWaitingRead == m_waitingReads.GetSize())
+            {
+                m_waitingReads.Downsize(0);
+                m_nextWaitingRead = 0;
+            }
+
+            uint32_t entryCount = static_cast<uint32_t>(m_batchSlots.GetSize());
+            if(!entryCount)
+                return;
+
+            // The whole batch is handed to the kernel with one call
+            __atomic_store_n(m_pSqTail, tail, __ATOMIC_RELEASE);
+            while(entryCount)
+            {
+                int result = static_cast<int>(syscall(__NR_io_uring_enter, m_ringFd, entryCount, 0, 0, nullptr, 0));
+                if(result < 0)
+                {
+                    if(errno == EINTR || errno == EAGAIN)
+                        continue;
+                    BLIT_ERROR("Async IO: io_uring submission failed with error %d", errno)
+                    break;
+                }
+                entryCount -= static_cast<uint32_t>(result);
+            }
+            if(!entryCount)
+                return;
+
+            // The kernel did not take the last entries of the batch, so they are taken back from the queue. Nothing would
+            // submit the waiting reads once the reads in flight are done, so they fail as well. The caller calls them back
+            __atomic_store_n(m_pSqTail, tail - entryCount, __ATOMIC_RELEASE);
+            for(size_t i = m_batchSlots.GetSize() - entryCount; i < m_batchSlots.GetSize(); ++i)
+            {
+                uint32_t slot = m_batchSlots[i];
+                failedReads.PushBack(m_slots[slot]);
+                m_freeSlots.PushBack(slot);
+            }
+            for(size_t i = m_nextWaitingRead; i < m_waitingReads.GetSize(); ++i)
+                failedReads.PushBack(m_waitingReads[i]);
+            m_waitingReads.Downsize(0);
+            m_nextWaitingRead = 0;
+        }
+
+        void AsyncIO::CompletionLoop()
+        {
+            io_uring_cqe* pCqes = reinterpret_cast<io_uring_cqe*>(m_pCqes);
+            while(1)
+            {
+                uint32_t head = *m_pCqHead;
+                uint32_t tail = __atomic_load_n(m_pCqTail, __ATOMIC_ACQUIRE);
+                if(head == tail)
+                {
+                    syscall(__NR_io_uring_enter, m_ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                    continue;
+                }
+
+                io_uring_cqe completion = pCqes[head & m_cqMask];
+                __atomic_store_n(m_pCqHead, head + 1, __ATOMIC_RELEASE);
+                if(completion.user_data == BLIT_ASYNC_IO_WAKE_ENTRY)
+                    return;
+
+                // A read that came back short, or one of the pieces of a large read, continues from where it stopped,
+                // unless it reached the end of the file. Otherwise the slot goes back to the queue before the callback, 
+                // so that the next waiting read starts right away
+                AsyncReadRequest request;
+                int64_t result = completion.res;
+                uint8_t bDone = 1;
+                BlitCL::DynamicArray<AsyncReadRequest> failedReads;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    uint32_t slot = static_cast<uint32_t>(completion.user_data);
+                    request = m_slots[slot];
+                    if(result > 0)
+                    {
+                        m_slotBytesRead[slot] += static_cast<size_t>(result);
+                        uint64_t position = request.offset + m_slotBytesRead[slot];
+                        bDone = m_slotBytesRead[slot] >= request.size || position >= request.pFile->GetSize();
+                    }
+                    if(result >= 0)
+                        result = static_cast<int64_t>(m_slotBytesRead[slot]);
+
+                    if(bDone)
+                        m_freeSlots.PushBack(slot);
+                    else
+                        m_continuedSlots.PushBack(slot);
+                    SubmitWaitingReads(failedReads);
+                }
+
+                if(bDone)
+                    CompleteRead(request, result);
+                for(size_t i = 0; i < failedReads.GetSize(); ++i)
+                    CompleteRead(failedReads[i], -1);
+            }
+        }
+
+    #else
+
+        uint8_t AsyncIO::InitKernelQueue(uint32_t queueDepth)
+        {
+            return 0;
+        }
+
+        void AsyncIO::ReleaseKernelQueue() {}
+
+        void AsyncIO::QueueSlotRead(uint32_t slot, uint32_t tail) {}
+
+        void AsyncIO::SubmitWaitingReads(BlitCL::DynamicArray<AsyncReadRequest>& failedReads) {}
+
+        void AsyncIO::CompletionLoop() {}
+
+    #endif
 }
\ No newline at end of file
@@ -2,6 +2,19 @@
 
 #include "Core/blitzenContainerLibrary.h"
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Direct (unbuffered) reads need their offset, size and buffer to be multiples of this
+#define BLIT_ASYNC_IO_DIRECT_ALIGNMENT          4096
+
+// Reads that are in flight at the same time. Submitting more queues them until earlier reads complete
+#define BLIT_ASYNC_IO_QUEUE_DEPTH               256
+
+// Threads that do the reads when the kernel queue is not available
+#define BLIT_ASYNC_IO_FALLBACK_THREAD_COUNT     4
+
 namespace BlitzenPlatform
 {
     enum class FileModes : uint8_t
@@ -28,6 +41,21 @@ namespace BlitzenPlatform
     // Determines if filepath exists
     uint8_t FilepathExists(const char* path);
 
+    // Gives the time the file was last written to, in seconds. Returns 0 if the file does not exist
+    uint8_t GetFileWriteTime(const char* path, uint64_t& writeTime);
+
+    // Same as the above, with the size of the file in bytes
+    uint8_t GetFileInfo(const char* path, uint64_t& size, uint64_t& writeTime);
+
+    // Creates the directory and every directory above it that does not exist yet
+    uint8_t CreateDirectories(const char* path);
+
+    // Called with the path of each file that is found in a directory
+    typedef void(*DirectoryFileCallback)(const char* path, void* pUserData);
+
+    // Calls back for every file in the directory and its subdirectories. Returns 0 if the directory cannot be opened
+    uint8_t ListDirectoryFiles(const char* path, DirectoryFileCallback callback, void* pUserData);
+
     // Read a single line from a file and saves it into a line buffer, return 1/true if successful
     uint8_t FilesystemReadLine(FileHandle& handle, size_t maxLength, char** lineBuffer, size_t* pLength);
     uint8_t FilesystemWriteLine(FileHandle& handle, const char* text);
@@ -42,4 +70,172 @@ namespace BlitzenPlatform
     // Does the same as the above but takes uses a (terrible)RAII wrapper instead of the linear allocator, so it should be prefered
     uint8_t FilesystemReadAllBytes(FileHandle& handle, BlitCL::StoragePointer<uint8_t, BlitzenCore::AllocationType::String>& bytes, 
     size_t* byteCount);
+
+
+
+    // How a mapped file is going to be read, passed to the OS so that it can read ahead
+    enum class MappedFileAccess : uint8_t
+    {
+        // Read once from start to end, pages behind the reader can be dropped early
+        Sequential = 0,
+        // The whole file is needed soon, reading starts before the first access
+        WillNeed = 1,
+        // No hint
+        Random = 2
+    };
+
+    // Read-only view of a whole file. The OS pages it in from its cache on access, so it is not copied and processes that map
+    // the same file share its memory. The view is unmapped when the file is closed
+    class MappedFile
+    {
+    public:
+
+        uint8_t Open(const char* path, MappedFileAccess access = MappedFileAccess::Sequential);
+
+        void Close();
+
+        inline const uint8_t* Data() { return reinterpret_cast<const uint8_t*>(m_pData); }
+        inline size_t GetSize() { return m_size; }
+
+        ~MappedFile();
+
+    private:
+
+        void* m_pData = nullptr;
+        size_t m_size = 0;
+
+        // Windows keeps the view alive through the mapping handle
+        void* m_pMapping = nullptr;
+    };
+
+    // A file opened for asynchronous reads. Direct files bypass the OS cache, so their reads need to be aligned
+    class AsyncFile
+    {
+    public:
+
+        uint8_t Open(const char* path, uint8_t bDirect = 0);
+
+        void Close();
+
+        inline size_t GetSize() { return m_size; }
+        inline uint8_t IsDirect() { return m_bDirect; }
+
+        ~AsyncFile();
+
+    public:
+
+        // File descriptor on Linux, HANDLE on Windows
+        intptr_t handle = -1;
+
+    private:
+
+        size_t m_size = 0;
+        uint8_t m_bDirect = 0;
+    };
+
+    // Called once per read, on one of the IO threads. Reads at the end of a file can return fewer bytes than were asked for
+    typedef void(*AsyncReadCallback)(void* pUserData, uint8_t bSuccess, size_t bytesRead);
+
+    // The buffer can be any memory that stays valid until the callback, including persistently mapped staging buffers
+    struct AsyncReadRequest
+    {
+        AsyncFile* pFile;
+        uint64_t offset;
+        size_t size;
+        void* pBuffer;
+
+        AsyncReadCallback callback;
+        void* pUserData;
+    };
+
+    /*-------------------------------------------------------------------------------------------------
+        Keeps many file reads in flight at once. On Linux the reads go through an io_uring queue that
+        one system call submits a whole batch to. Elsewhere, or when the kernel does not support it,
+        a few threads take the reads from a queue and do them one by one
+    ---------------------------------------------------------------------------------------------------*/
+    class AsyncIO
+    {
+    public:
+
+        uint8_t Init(uint32_t queueDepth = BLIT_ASYNC_IO_QUEUE_DEPTH);
+
+        // Queues the reads and submits as many of them as the queue has room for. Returns 0 if one of them is invalid,
+        // in which case none of them are queued
+        uint8_t SubmitReads(const AsyncReadRequest* pRequests, uint32_t requestCount);
+
+        // Reads that were submitted and whose callbacks have not returned
+        uint32_t GetPendingCount();
+
+        // Blocks until every submitted read has called back
+        void WaitAll();
+
+        // Waits for the submitted reads and stops the IO threads
+        void Shutdown();
+
+        inline uint8_t UsesKernelQueue() { return m_ringFd >= 0; }
+
+        ~AsyncIO();
+
+    private:
+
+        // Fills the free queue entries with the reads that continue and the waiting reads, and submits them in one call. Needs the mutex.
+        // If the kernel does not take them, they and the rest of the waiting reads are added to the failed reads, for the caller 
+        // to call back without the mutex
+        void SubmitWaitingReads(BlitCL::DynamicArray<AsyncReadRequest>& failedReads);
+
+        // Writes the queue entry for the part of the slot's read that is left
+        void QueueSlotRead(uint32_t slot, uint32_t tail);
+
+        void CompletionLoop();
+
+        void WorkerLoop();
+
+        void CompleteRead(const AsyncReadRequest& request, int64_t result);
+
+        uint8_t InitKernelQueue(uint32_t queueDepth);
+
+        void ReleaseKernelQueue();
+
+        std::mutex m_mutex;
+        std::condition_variable m_signal;
+        std::condition_variable m_idleSignal;
+
+        // Reads that have not been given to the kernel or the threads yet
+        BlitCL::DynamicArray<AsyncReadRequest> m_waitingReads;
+        size_t m_nextWaitingRead = 0;
+        uint32_t m_pendingCount = 0;
+        uint8_t m_bShutdown = 0;
+        uint8_t m_bInitialized = 0;
+
+        std::thread m_threads[BLIT_ASYNC_IO_FALLBACK_THREAD_COUNT];
+        uint32_t m_threadCount = 0;
+
+        // io_uring state. The in flight reads are kept in slots, the slot index is the user data of their queue entry
+        int32_t m_ringFd = -1;
+        void* m_pSubmissionRing = nullptr;
+        size_t m_submissionRingSize = 0;
+        void* m_pCompletionRing = nullptr;
+        size_t m_completionRingSize = 0;
+        void* m_pSubmissionEntries = nullptr;
+        size_t m_submissionEntriesSize = 0;
+        uint32_t* m_pSqHead = nullptr;
+        uint32_t* m_pSqTail = nullptr;
+        uint32_t* m_pSqArray = nullptr;
+        uint32_t m_sqMask = 0;
+        uint32_t* m_pCqHead = nullptr;
+        uint32_t* m_pCqTail = nullptr;
+        void* m_pCqes = nullptr;
+        uint32_t m_cqMask = 0;
+        uint32_t m_queueDepth = 0;
+
+        BlitCL::DynamicArray<AsyncReadRequest> m_slots;
+        BlitCL::DynamicArray<uint32_t> m_freeSlots;
+
+        // Bytes that each slot's read has done. Large reads are split and short reads continue, in the slots in the continued array
+        BlitCL::DynamicArray<size_t> m_slotBytesRead;
+        BlitCL::DynamicArray<uint32_t> m_continuedSlots;
+
+        // The slots of the entries that the last submission wrote, in queue order
+        BlitCL::DynamicArray<uint32_t> m_batchSlots;
+    };
 }
\ No newline at end of file
@@ -13,6 +13,8 @@
 // Need this for memchr and strchr
 #include <cstring>
 
+// Memory, console output and time do not need a window, they are in platformCore.cpp
+
 namespace BlitzenPlatform
 {
     /*----------------
@@ -40,9 +42,6 @@ namespace BlitzenPlatform
 
         inline PlatformState s_pPlatformState;
 
-        inline double clockFrequency;
-        inline LARGE_INTEGER startTime;
-
         LRESULT CALLBACK Win32ProcessMessage(HWND winWindow, uint32_t msg, WPARAM w_param, LPARAM l_param);
 
         size_t GetPlatformMemoryRequirements()
@@ -130,12 +129,6 @@ namespace BlitzenPlatform
             int32_t show = shouldActivate ? SW_SHOW : SW_SHOWNOACTIVATE;
             ShowWindow(s_pPlatformState.winWindow, show);
 
-            // Clock setup, similar thing to glfwGetTime
-            LARGE_INTEGER frequency;
-            QueryPerformanceFrequency(&frequency);
-            clockFrequency = 1.0 / static_cast<double>(frequency.QuadPart);// The quad part is just a 64 bit integer
-            QueryPerformanceCounter(&startTime);
-
             return 1;
         }
 
@@ -165,67 +158,6 @@ namespace BlitzenPlatform
             return 1;
         }
 
-        void* PlatformMalloc(size_t size, uint8_t aligned)
-        {
-            // temporary
-            return malloc(size);
-        }
-
-        void PlatformFree(void* pBlock, uint8_t aligned)
-        {
-            // temporary
-            free(pBlock);
-        }
-
-        void* PlatformMemZero(void* pBlock, size_t size)
-        {
-            return memset(pBlock, 0, size);
-        }
-
-        void* PlatformMemCopy(void* pDst, void* pSrc, size_t size)
-        {
-            return memcpy(pDst, pSrc, size);
-        }
-
-        void* PlatformMemSet(void* pDst, int32_t value, size_t size)
-        {
-            return memset(pDst, value, size);
-        }
-
-        void PlatformConsoleWrite(const char* message, uint8_t color)
-        {
-            HANDLE consoleHandle = GetStdHandle(STD_OUTPUT_HANDLE);
-            static uint8_t levels[6] = {64, 4, 6, 2, 1, 8};
-            SetConsoleTextAttribute(consoleHandle, levels[color]);
-            OutputDebugStringA(message);
-            uint64_t length = strlen(message);
-            LPDWORD numberWritten = 0;
-            WriteConsoleA(GetStdHandle(STD_OUTPUT_HANDLE), message, static_cast<DWORD>(length), numberWritten, 0);
-        }
-
-        void PlatformConsoleError(const char* message, uint8_t color)
-        {
-            HANDLE consoleHandle = GetStdHandle(STD_ERROR_HANDLE);
-            static uint8_t levels[6] = {64, 4, 6, 2, 1, 8};
-            SetConsoleTextAttribute(consoleHandle, levels[color]);
-            OutputDebugStringA(message);
-            uint64_t length = strlen(message);
-            LPDWORD numberWritten = 0;
-            WriteConsoleA(GetStdHandle(STD_ERROR_HANDLE), message, static_cast<DWORD>(length), numberWritten, 0);
-        }
-
-        double PlatformGetAbsoluteTime()
-        {
-            LARGE_INTEGER nowTime;
-            QueryPerformanceCounter(&nowTime);
-            return static_cast<double>(nowTime.QuadPart) * clockFrequency;
-        }
-
-        void PlatformSleep(uint64_t ms)
-        {
-            Sleep(static_cast<DWORD>(ms));
-        }
-
         uint8_t CreateVulkanSurface(VkInstance& instance, VkSurfaceKHR& surface, VkAllocationCallbacks* pAllocator)
         {
             VkWin32SurfaceCreateInfoKHR info = {VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR};
@@ -673,42 +605,6 @@ namespace BlitzenPlatform
             return 1;
         }
 
-        void* PlatformMalloc(size_t size, uint8_t aligned)
-        {
-            return malloc(size);
-        }
-
-        void PlatformFree(void* pBlock, uint8_t aligned)
-        {
-            free(pBlock);
-        }
-
-        void* PlatformMemZero(void* pBlock, size_t size)
-        {
-            return memset(pBlock, 0, size);
-        }
-        void* PlatformMemCopy(void* pDst, void* pSrc, size_t size)
-        {
-            return memcpy(pDst, pSrc, size);
-        }
-        void* PlatformMemSet(void* pDst, int32_t value, size_t size)
-        {
-            return memset(pDst, value, size);
-        }
-
-        void PlatformConsoleWrite(const char* message, uint8_t color)
-        {
-            // FATAL,ERROR,WARN,INFO,DEBUG,TRACE
-            const char* colorStrings[] = { "0;41", "1;31", "1;33", "1;32", "1;34", "1;30" };
-            printf("\033[%sm%s\033[0m", colorStrings[color], message);
-        }
-        void PlatformConsoleError(const char* message, uint8_t color)
-        {
-            // FATAL,ERROR,WARN,INFO,DEBUG,TRACE
-            const char* colorStrings[] = { "0;41", "1;31", "1;33", "1;32", "1;34", "1;30" };
-            printf("\033[%sm%s\033[0m", colorStrings[color], message);
-        }
-
         uint8_t CreateVulkanSurface(VkInstance& instance, VkSurfaceKHR& surface, VkAllocationCallbacks* pAllocator)
         {
             VkXcbSurfaceCreateInfoKHR info{};
@@ -722,30 +618,6 @@ namespace BlitzenPlatform
             return 1;
         }
 
-        double PlatformGetAbsoluteTime() 
-        {
-            struct timespec now;
-            clock_gettime(CLOCK_MONOTONIC, &now);
-            return now.tv_sec + now.tv_nsec * 0.000000001;
-        }
-
-        void platform_sleep(uint64_t ms) 
-        {
-            #if _POSIX_C_SOURCE >= 199309L
-                struct timespec ts;
-                ts.tv_sec = ms / 1000;
-                ts.tv_nsec = (ms % 1000) * 1000 * 1000;
-                nanosleep(&ts, 0);
-            #else
-                if (ms >= 1000) 
-                {
-                    sleep(ms / 1000);
-                }
-                usleep((ms % 1000) * 1000);
-            #endif
-        }
-
-
         BlitzenCore::BlitKey TranslateKeycode(uint32_t x_keycode)
         {
             switch (x_keycode)
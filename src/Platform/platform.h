@@ -23,4 +23,7 @@ namespace BlitzenPlatform
     double PlatformGetAbsoluteTime();
 
     void PlatformSleep(uint64_t ms);
+
+    // Gives the resident set size of the process and the highest it has been, in bytes. Returns 0 if they could not be read
+    uint8_t PlatformGetMemoryUsage(size_t& residentBytes, size_t& peakResidentBytes);
 }
\ No newline at end of file
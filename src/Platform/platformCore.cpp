@@ -0,0 +1,207 @@
+/*
+    The platform code that does not need a window: memory, console output, time and process memory usage.
+    Kept apart from platform.cpp, so that the offline tools (BlitzenCook) link it without the window, surface and graphics API code
+*/
+
+#include "platform.h"
+#include "Core/blitMemory.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+#if _MSC_VER
+    #include <windows.h>
+    #include <psapi.h>
+#elif defined(linux)
+    #include <time.h>
+    #include <unistd.h>
+#endif
+
+namespace BlitzenPlatform
+{
+    /*----------------
+        WINDOWS   !
+    -----------------*/
+
+    #if _MSC_VER
+
+        void* PlatformMalloc(size_t size, uint8_t aligned)
+        {
+            // temporary
+            return malloc(size);
+        }
+
+        void PlatformFree(void* pBlock, uint8_t aligned)
+        {
+            // temporary
+            free(pBlock);
+        }
+
+        void* PlatformMemZero(void* pBlock, size_t size)
+        {
+            return memset(pBlock, 0, size);
+        }
+
+        void* PlatformMemCopy(void* pDst, void* pSrc, size_t size)
+        {
+            return memcpy(pDst, pSrc, size);
+        }
+
+        void* PlatformMemSet(void* pDst, int32_t value, size_t size)
+        {
+            return memset(pDst, value, size);
+        }
+
+        void PlatformConsoleWrite(const char* message, uint8_t color)
+        {
+            HANDLE consoleHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+            static uint8_t levels[6] = {64, 4, 6, 2, 1, 8};
+            SetConsoleTextAttribute(consoleHandle, levels[color]);
+            OutputDebugStringA(message);
+            uint64_t length = strlen(message);
+            LPDWORD numberWritten = 0;
+            WriteConsoleA(GetStdHandle(STD_OUTPUT_HANDLE), message, static_cast<DWORD>(length), numberWritten, 0);
+        }
+
+        void PlatformConsoleError(const char* message, uint8_t color)
+        {
+            HANDLE consoleHandle = GetStdHandle(STD_ERROR_HANDLE);
+            static uint8_t levels[6] = {64, 4, 6, 2, 1, 8};
+            SetConsoleTextAttribute(consoleHandle, levels[color]);
+            OutputDebugStringA(message);
+            uint64_t length = strlen(message);
+            LPDWORD numberWritten = 0;
+            WriteConsoleA(GetStdHandle(STD_ERROR_HANDLE), message, static_cast<DWORD>(length), numberWritten, 0);
+        }
+
+        // Similar thing to glfwGetTime. The counter frequency is fixed at boot, so it is only queried once
+        static double QueryClockFrequency()
+        {
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+            return 1.0 / static_cast<double>(frequency.QuadPart);// The quad part is just a 64 bit integer
+        }
+
+        double PlatformGetAbsoluteTime()
+        {
+            static const double clockFrequency = QueryClockFrequency();
+            LARGE_INTEGER nowTime;
+            QueryPerformanceCounter(&nowTime);
+            return static_cast<double>(nowTime.QuadPart) * clockFrequency;
+        }
+
+        void PlatformSleep(uint64_t ms)
+        {
+            Sleep(static_cast<DWORD>(ms));
+        }
+
+        uint8_t PlatformGetMemoryUsage(size_t& residentBytes, size_t& peakResidentBytes)
+        {
+            PROCESS_MEMORY_COUNTERS counters{};
+            if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+                return 0;
+
+            residentBytes = counters.WorkingSetSize;
+            peakResidentBytes = counters.PeakWorkingSetSize;
+            return 1;
+        }
+    #endif
+
+
+            /*--------------
+                LINUX  ! 
+            ---------------*/
+
+
+
+    #ifdef linux
+
+        void* PlatformMalloc(size_t size, uint8_t aligned)
+        {
+            return malloc(size);
+        }
+
+        void PlatformFree(void* pBlock, uint8_t aligned)
+        {
+            free(pBlock);
+        }
+
+        void* PlatformMemZero(void* pBlock, size_t size)
+        {
+            return memset(pBlock, 0, size);
+        }
+        void* PlatformMemCopy(void* pDst, void* pSrc, size_t size)
+        {
+            return memcpy(pDst, pSrc, size);
+        }
+        void* PlatformMemSet(void* pDst, int32_t value, size_t size)
+        {
+            return memset(pDst, value, size);
+        }
+
+        void PlatformConsoleWrite(const char* message, uint8_t color)
+        {
+            // FATAL,ERROR,WARN,INFO,DEBUG,TRACE
+            const char* colorStrings[] = { "0;41", "1;31", "1;33", "1;32", "1;34", "1;30" };
+            printf("\033[%sm%s\033[0m", colorStrings[color], message);
+        }
+        void PlatformConsoleError(const char* message, uint8_t color)
+        {
+            // FATAL,ERROR,WARN,INFO,DEBUG,TRACE
+            const char* colorStrings[] = { "0;41", "1;31", "1;33", "1;32", "1;34", "1;30" };
+            printf("\033[%sm%s\033[0m", colorStrings[color], message);
+        }
+
+        double PlatformGetAbsoluteTime() 
+        {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            return now.tv_sec + now.tv_nsec * 0.000000001;
+        }
+
+        void PlatformSleep(uint64_t ms) 
+        {
+            #if _POSIX_C_SOURCE >= 199309L
+                struct timespec ts;
+                ts.tv_sec = ms / 1000;
+                ts.tv_nsec = (ms % 1000) * 1000 * 1000;
+                nanosleep(&ts, 0);
+            #else
+                if (ms >= 1000) 
+                {
+                    sleep(ms / 1000);
+                }
+                usleep((ms % 1000) * 1000);
+            #endif
+        }
+
+        uint8_t PlatformGetMemoryUsage(size_t& residentBytes, size_t& peakResidentBytes)
+        {
+            // VmRSS is the current resident set and VmHWM its high water mark, both in kB
+            FILE* pStatus = fopen("/proc/self/status", "r");
+            if(!pStatus)
+                return 0;
+
+            uint8_t found = 0;
+            char line[256];
+            while(fgets(line, sizeof(line), pStatus))
+            {
+                unsigned long kilobytes = 0;
+                if(sscanf(line, "VmRSS: %lu kB", &kilobytes) == 1)
+                {
+                    residentBytes = kilobytes * 1024;
+                    found |= 1;
+                }
+                else if(sscanf(line, "VmHWM: %lu kB", &kilobytes) == 1)
+                {
+                    peakResidentBytes = kilobytes * 1024;
+                    found |= 2;
+                }
+            }
+            fclose(pStatus);
+
+            return found == 3;
+        }
+    #endif
+}
@@ -81,9 +81,36 @@ namespace BlitzenEngine
         Max = 2
     };
 
+    // A DDS file whose headers have been read. Its image data can then be read straight to where it is uploaded from
+    struct DDSTextureProbe
+    {
+        const char* filepath = nullptr;
+
+        DDS_HEADER header = {};
+        DDS_HEADER_DXT10 header10 = {};
+        unsigned int format = 0;
+
+        // Where the image data starts in the file and its exact size, with every mip level
+        size_t imageOffset = 0;
+        size_t imageSize = 0;
+
+        // Set by the renderer that uploaded the texture
+        uint8_t bLoaded = 0;
+    };
+
+    // Reads only the headers of the probe's file and works out the format and size of its image data
+    uint8_t ProbeDDSImage(DDSTextureProbe& probe, RendererToLoadDDS chosenRenderer);
+
+    // Reads the image data of a probed file to memory of at least its image size, which can be a mapped staging buffer
+    uint8_t ReadDDSImageData(const DDSTextureProbe& probe, void* pData);
+
     uint8_t LoadDDSImage(const char* filepath, DDS_HEADER& header, DDS_HEADER_DXT10& header10, 
     unsigned int& vulkanImageFormat, RendererToLoadDDS chosenRenderer, void* pData);
 
+    // Same as LoadDDSImage for a file that has already been read to memory. Gives where the image data starts in the file instead of copying it
+    uint8_t ParseDDSImage(const uint8_t* pFileData, size_t fileSize, DDS_HEADER& header, DDS_HEADER_DXT10& header10, 
+    unsigned int& vulkanImageFormat, RendererToLoadDDS chosenRenderer, size_t& imageOffset, size_t& imageSize);
+
     size_t GetDDSImageSizeBC(unsigned int width, unsigned int height, unsigned int levels, unsigned int blockSize);
 
     size_t GetDDSBlockSize(DDS_HEADER& header, DDS_HEADER_DXT10& header10);
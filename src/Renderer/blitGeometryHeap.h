@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Renderer/blitRenderingResources.h"
+
+// Free blocks are binned by the highest bit of their size (first level), then split in this many linear steps (second level)
+#define BLIT_GEOMETRY_HEAP_SL_LOG2              4
+#define BLIT_GEOMETRY_HEAP_SL_COUNT             (1 << BLIT_GEOMETRY_HEAP_SL_LOG2)
+#define BLIT_GEOMETRY_HEAP_FL_COUNT             (32 - BLIT_GEOMETRY_HEAP_SL_LOG2 + 1)
+
+// Links between blocks that point nowhere, and the owner of blocks that are not moved by compaction
+#define BLIT_GEOMETRY_HEAP_NULL_BLOCK           UINT32_MAX
+#define BLIT_GEOMETRY_HEAP_NO_OWNER             UINT32_MAX
+
+namespace BlitzenEngine
+{
+    // An allocation that was moved by compaction. The renderer buffer needs the same copy, and the owner's offsets need to be moved with it
+    struct GeometryMove
+    {
+        uint32_t owner;
+        BufferMoveRange range;
+    };
+
+    struct GeometryHeapStats
+    {
+        uint32_t capacity = 0;
+        uint32_t usedElements = 0;
+        uint32_t allocationCount = 0;
+        uint32_t freeBlockCount = 0;
+        uint32_t largestFreeBlock = 0;
+
+        // 0 when all the free space is one block, close to 1 when it is scattered in small blocks
+        inline float GetFragmentation() {
+            uint32_t freeElements = capacity - usedElements;
+            return freeElements ? 1.f - static_cast<float>(largestFreeBlock) / static_cast<float>(freeElements) : 0.f;
+        }
+    };
+
+    /*-------------------------------------------------------------------------------------------------
+        Two level segregated fit allocator over the elements of a renderer buffer that is created once.
+        Allocation and free are O(1): free blocks are found through two bitmaps and merged with their
+        physical neighbours when freed. Handles stay valid when compaction moves the data they point to,
+        so the offsets are always asked for with GetOffset instead of being kept
+    ---------------------------------------------------------------------------------------------------*/
+    class GeometryHeap
+    {
+    public:
+
+        // Every allocation is freed, the whole buffer becomes one free block
+        void Init(uint32_t capacity);
+
+        // The owner is given back with each move, so that whoever uses the elements can follow them. Pinned allocations are never moved.
+        // Empty allocations succeed with an invalid handle. Returns 0 if there is no free block big enough
+        uint8_t Allocate(uint32_t elementCount, uint32_t owner, BlitCL::SlotHandle& handle, uint8_t bPinned = 0);
+
+        void Free(BlitCL::SlotHandle handle);
+
+        // First element of the allocation. Invalid handles (empty allocations) start at 0
+        uint32_t GetOffset(BlitCL::SlotHandle handle);
+
+        // Moves allocations from the end of the heap to free blocks before them, until the element budget is spent.
+        // The moves are added to the array. The space they left is only freed by the next call,
+        // so that it is not written to before the renderer has copied from it
+        void Compact(uint32_t elementBudget, BlitCL::DynamicArray<GeometryMove>& moves);
+
+        GeometryHeapStats GetStats();
+
+    private:
+
+        struct Block
+        {
+            uint32_t offset;
+            uint32_t size;
+
+            uint32_t prevPhysical;
+            uint32_t nextPhysical;
+            uint32_t prevFree;
+            uint32_t nextFree;
+
+            uint32_t generation;
+            uint32_t owner;
+            uint8_t bFree;
+            uint8_t bPinned;
+
+            // The compaction pass that moved the block last. It is not moved twice in one pass
+            uint32_t compactionPass;
+        };
+
+        uint32_t CreateBlock();
+        void ReleaseBlock(uint32_t block);
+
+        void InsertFreeBlock(uint32_t block);
+        void RemoveFreeBlock(uint32_t block);
+
+        // Frees a block and merges it with its free neighbours
+        void FreeBlock(uint32_t block);
+
+        // A free block of at least the size, or BLIT_GEOMETRY_HEAP_NULL_BLOCK
+        uint32_t FindFreeBlock(uint32_t elementCount);
+
+        // A free block that fits the size and starts before the limit, so that moving to it brings an allocation closer to the front
+        uint32_t FindFitBelow(uint32_t size, uint32_t limit);
+
+        BlitCL::DynamicArray<Block> m_blocks;
+        BlitCL::DynamicArray<uint32_t> m_unusedBlocks;
+
+        uint32_t m_firstLevelBitmap = 0;
+        uint32_t m_secondLevelBitmaps[BLIT_GEOMETRY_HEAP_FL_COUNT] = {};
+        uint32_t m_freeLists[BLIT_GEOMETRY_HEAP_FL_COUNT][BLIT_GEOMETRY_HEAP_SL_COUNT];
+
+        uint32_t m_firstBlock = BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+        uint32_t m_lastBlock = BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+
+        uint32_t m_capacity = 0;
+        uint32_t m_usedElements = 0;
+        uint32_t m_allocationCount = 0;
+        uint32_t m_freeBlockCount = 0;
+
+        // Blocks that compaction moved allocations away from, freed by the next compaction
+        BlitCL::DynamicArray<uint32_t> m_retiredBlocks;
+        uint32_t m_compactionPass = 0;
+    };
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Renderer/blitRenderingResources.h"
+
+// Passes that spread the texels at the edge of each frame into the empty texels around them, so that filtering and
+// the smaller mip levels do not pull in the background color
+#define BLIT_IMPOSTOR_DILATION_PASSES   4
+
+namespace BlitzenEngine
+{
+    // Renders the indexed triangles from the center of every cell of the octahedral grid (BLIT_IMPOSTOR_GRID),
+    // with an orthographic projection over the bounding sphere. Bakes the colors, with the coverage in alpha,
+    // and the normals, in the space of each frame, to two DDS files. The indices are relative to the vertices.
+    // Colors are read from the albedo source with stb_image, and are the default gray without it
+    uint8_t BakeImpostorAtlases(const Vertex* pVertices, const uint32_t* pIndices, size_t indexCount, const BlitML::vec3& center,
+    float radius, const char* albedoSourcePath, const char* colorPath, const char* normalPath);
+}
@@ -7,14 +7,32 @@
 // The rendering resources are passed to the renderers to set up their global buffers
 #include "Renderer/blitRenderingResources.h"
 
+// Scenes that are streamed in are committed to the renderers by the rendering system
+#include "Renderer/blitSceneStreaming.h"
+
+// Streamed geometry is placed in the renderers' buffers through the geometry heaps
+#include "Renderer/blitGeometryHeap.h"
+
 // The camera file is needed as it is passed on some functions for the renderers to access its values
 #include "Game/blitCamera.h"
 
-// Max draw calls allowed, if render objects go above this, the application will fail
-#define BLITZEN_MAX_DRAW_OBJECTS    5'000'000
+// Meshlets are only generated when the cluster rendering path is built (BLIT_VK_MESH_EXT) and the device supports mesh shaders
+#define BLITZEN_CLUSTER_RENDERING   BLITZEN_VULKAN_MESH_SHADER
+
+// If more than 1 / this of an array's elements change in a frame, the whole array is uploaded as a single range
+#define BLITZEN_FULL_UPLOAD_DIVISOR             4
 
-// Cluster rendering is not yet implemented, but I really wish I can try it out soon
-#define BLITZEN_CLUSTER_RENDERING   0
+// Two dirty runs that are separated by this many clean elements or less are uploaded as one range, to keep the copy region count down
+#define BLITZEN_DIRTY_RUN_MERGE_GAP             8
+
+// A geometry heap is compacted when its largest free block is less than (1 - this) of its free space.
+// Each heap moves about this many elements per frame, so that compaction is spread over several frames
+#define BLITZEN_GEOMETRY_COMPACTION_THRESHOLD   0.25f
+#define BLITZEN_GEOMETRY_COMPACTION_BUDGET      262'144
+
+// The mesh shading benchmark draws this many frames with each path before it starts timing, and then times this many
+#define BLIT_MESH_SHADING_BENCHMARK_WARMUP_FRAMES   128
+#define BLIT_MESH_SHADING_BENCHMARK_FRAMES          1024
 
 namespace BlitzenEngine
 {
@@ -27,6 +45,91 @@ namespace BlitzenEngine
         MaxRenderers = 3
     };
 
+    // Tracks the elements of a resource array that changed since the last frame, with one bit for each element.
+    // The dirty elements are coalesced into the ranges that the renderers copy to their buffers
+    class DirtyRangeTracker
+    {
+    public:
+
+        // Makes space for more elements. The bits of the new elements are clear
+        void Resize(uint32_t elementCount);
+
+        // Elements that are marked more than once in a frame are only counted once
+        void MarkDirty(uint32_t element);
+
+        // Builds the ranges and clears the dirty bits. If too many elements are dirty, a single range for the whole array is given instead
+        void BuildRanges(uint32_t elementCount);
+
+        inline BufferUpdateRange* GetRanges() { return m_ranges.Data(); }
+        inline uint32_t GetRangeCount() { return static_cast<uint32_t>(m_ranges.GetSize()); }
+
+    private:
+
+        BlitCL::DynamicArray<uint32_t> m_dirtyWords;
+        uint32_t m_dirtyCount = 0;
+
+        // Limit the search when the ranges are built
+        uint32_t m_firstDirtyWord = 0;
+        uint32_t m_lastDirtyWord = 0;
+
+        BlitCL::DynamicArray<BufferUpdateRange> m_ranges;
+    };
+
+    // Hands out runs of elements of a renderer buffer that cannot grow after setup. Freed runs are merged with their neighbours,
+    // so that the space of an unloaded scene can be given to a bigger one later
+    class ElementRangeAllocator
+    {
+    public:
+
+        // The elements before the first one are used by what the renderers were given at setup
+        void Init(uint32_t firstElement, uint32_t capacity);
+
+        // Returns the first element of the run, or BLIT_STREAMING_UNUSED_INDEX if no free run is big enough
+        uint32_t Allocate(uint32_t elementCount);
+
+        void Free(uint32_t firstElement, uint32_t elementCount);
+
+        inline uint32_t GetFreeCount() { return m_freeCount; }
+
+    private:
+
+        // Sorted by first element, neighbouring runs are always merged
+        BlitCL::DynamicArray<BufferUpdateRange> m_freeRanges;
+        uint32_t m_freeCount = 0;
+    };
+
+    // The elements that were written to a renderer buffer this frame, packed one range after the other. 
+    // They are kept until the frame has been recorded, since the resources do not hold the geometry after setup
+    template<typename T>
+    class FrameAppendBuffer
+    {
+    public:
+
+        inline void Append(uint32_t firstElement, T* pElements, uint32_t count)
+        {
+            if(!count)
+                return;
+            m_elements.AddBlockAtBack(pElements, count);
+
+            // A run that continues the previous one is copied with it
+            if(m_ranges.GetSize() && m_ranges.Back().firstElement + m_ranges.Back().elementCount == firstElement)
+                m_ranges.Back().elementCount += count;
+            else
+                m_ranges.PushBack({firstElement, count});
+        }
+
+        inline void Clear() { m_elements.Downsize(0); m_ranges.Downsize(0); }
+
+        inline T* GetData() { return m_elements.Data(); }
+        inline BufferUpdateRange* GetRanges() { return m_ranges.Data(); }
+        inline uint32_t GetRangeCount() { return static_cast<uint32_t>(m_ranges.GetSize()); }
+
+    private:
+
+        BlitCL::DynamicArray<T> m_elements;
+        BlitCL::DynamicArray<BufferUpdateRange> m_ranges;
+    };
+
     class RenderingSystem
     {
     public:
@@ -51,6 +154,11 @@ namespace BlitzenEngine
         inline uint8_t GiveTextureToVulkan(BlitzenEngine::DDS_HEADER& header, BlitzenEngine::DDS_HEADER_DXT10& header10,
         void* pData, const char* filepath) { return vulkan.UploadDDSTexture(header, header10, pData, filepath); }
 
+        // Same as the above for a set of textures that share their staging memory. Every texture is probed before any is read
+        inline uint8_t GiveTexturesToVulkan(BlitzenEngine::DDSTextureProbe* pTextures, uint32_t textureCount) {
+            return vulkan.UploadDDSTextures(pTextures, textureCount); 
+        }
+
         // Same as the above
         inline uint8_t GiveTextureToOpengl(BlitzenEngine::DDS_HEADER& header, BlitzenEngine::DDS_HEADER_DXT10& header10,
         const char* filepath) { return opengl.UploadTexture(header, header10, filepath); }
@@ -60,6 +168,48 @@ namespace BlitzenEngine
 
         void DrawFrame(Camera& camera, uint32_t drawCount);
 
+        // Changes a transform of the loaded scene. The renderer uploads it before it culls the next frame
+        void UpdateTransform(uint32_t transformId, const MeshTransform& transform);
+
+        // Same as the above, for a continuous range of transforms
+        void UpdateTransforms(uint32_t firstTransform, uint32_t transformCount, const MeshTransform* pTransforms);
+
+        // Adds a game object with one of the loaded meshes after the renderers have been set up. 
+        // It gets its own transform and mesh instance, and a render object for each surface of the mesh. 
+        // Returns an invalid handle if the renderers' buffers have no space left
+        BlitCL::SlotHandle AddGameObject(uint32_t meshIndex, const MeshTransform& transform);
+
+        // Removes a game object and its render objects. The freed transform is given to the next game object that is added
+        uint8_t RemoveGameObject(BlitCL::SlotHandle handle);
+
+        // Queues a gltf file to be loaded on the streaming workers. Needs to be called before the renderers are set up, 
+        // so that they leave space for the streamed scene. The scene fills in as its chunks are committed by DrawFrame
+        void StreamScene(const char* path);
+
+        // Makes the renderers leave space for scenes that are streamed in after setup. Needs to be called before setup
+        inline void RequestStreaming() { m_bStreamingRequested = 1; }
+
+        // Queues a gltf file after setup, with an offset for its nodes. Streaming needs to have been requested.
+        // The scene can be unloaded with the returned pointer
+        StreamedScene* StreamSceneAt(const char* path, const BlitML::vec3& offset);
+
+        // Removes everything that the scene added and frees its parts of the renderers' buffers. The scene is not valid after this
+        void UnloadStreamedScene(StreamedScene* pScene);
+
+        // Stops streaming the scenes that are not done. Chunks that have been committed stay in the scene
+        inline void CancelStreaming() { m_streamer.Cancel(); }
+
+        // The GPU time of the last frame that was read back in seconds, or 0 if the active renderer cannot measure it
+        inline float GetGpuFrameTime() { 
+            return activeRenderer == ActiveRenderer::Vulkan && bVk ? static_cast<float>(vulkan.GetLastGpuFrameTime() * 0.001) : 0.f; 
+        }
+
+        // Returns 1 while any of the streamed scenes has chunks that were not committed
+        inline uint8_t IsStreaming() { return m_streamer.IsActive(); }
+
+        // Logs how full and how fragmented each geometry heap is
+        void LogGeometryOccupancy();
+
         // Pointless feature that doesn't work
         uint8_t SetActiveAPI(ActiveRenderer newActiveAPI);
         void ClearCurrentActiveRenderer();
@@ -79,6 +229,73 @@ namespace BlitzenEngine
 
         ActiveRenderer activeRenderer = ActiveRenderer::MaxRenderers;
         uint8_t CheckActiveAPI();
+
+        // Swaps two render objects and points the instance object entries of both to their new places
+        void SwapRenderObjects(uint32_t first, uint32_t second);
+
+        // Takes a render object out of its mesh instance's range and the renders array, keeping the opaque objects before the post pass objects
+        void RemoveRenderObject(uint32_t objectId);
+
+        // Builds the update ranges of every tracked array for the active renderer
+        void BuildUpdateRanges();
+
+        // Commits finished chunks of the streamed scenes until the frame's time or upload budget is spent. Returns 1 if any were committed
+        uint8_t CommitStreamedChunks();
+
+        // Gives the scene its material range and texture slots
+        void CommitStreamedScene(StreamedChunk* pChunk);
+
+        // Appends the mesh's geometry and surfaces and adds a game object for each node that uses it
+        void CommitStreamedMesh(StreamedChunk* pChunk);
+
+        void CommitStreamedTexture(StreamedChunk* pChunk);
+
+        // Moves streamed geometry to the front of the fragmented heaps and follows it with the surfaces and render objects.
+        // Called before anything is committed in the frame, so that only geometry that the renderer already holds is moved
+        void CompactGeometry();
+
+        // The arrays of the resources are updated in place, so that they always match what the renderers hold
+        RenderingResources* m_pResources = nullptr;
+
+        DirtyRangeTracker m_transformUpdates;
+        DirtyRangeTracker m_renderObjectUpdates;
+        DirtyRangeTracker m_meshInstanceUpdates;
+        DirtyRangeTracker m_instanceObjectUpdates;
+
+        // Transforms (and the mesh instances with the same index) of removed game objects
+        BlitCL::DynamicArray<uint32_t> m_freeTransforms;
+
+        SceneStreamer m_streamer;
+        uint8_t m_bStreamingRequested = 0;
+
+        // The renderers' geometry buffers. What they were given at setup is pinned at the front
+        GeometryHeap m_vertexHeap;
+        GeometryHeap m_indexHeap;
+        GeometryHeap m_meshletHeap;
+        GeometryHeap m_meshletDataHeap;
+        GeometryHeap m_surfaceHeap;
+
+        // The copies that compaction asks of the renderer this frame, and the meshes whose surfaces need to be uploaded again
+        BlitCL::DynamicArray<GeometryMove> m_geometryMoves;
+        BlitCL::DynamicArray<BufferMoveRange> m_vertexMoves;
+        BlitCL::DynamicArray<BufferMoveRange> m_indexMoves;
+        BlitCL::DynamicArray<BufferMoveRange> m_meshletMoves;
+        BlitCL::DynamicArray<uint32_t> m_compactedMeshes;
+
+        // The space in the other buffers after what they were given at setup
+        ElementRangeAllocator m_materialRanges;
+        ElementRangeAllocator m_instanceObjectRanges;
+
+        // Meshes of unloaded scenes, reused by the next meshes that are committed
+        BlitCL::DynamicArray<uint32_t> m_freeMeshes;
+
+        // What the streamed chunks committed this frame add to the renderer's buffers
+        FrameAppendBuffer<Vertex> m_vertexAppends;
+        FrameAppendBuffer<uint32_t> m_indexAppends;
+        FrameAppendBuffer<Meshlet> m_meshletAppends;
+        FrameAppendBuffer<uint32_t> m_meshletDataAppends;
+        FrameAppendBuffer<PrimitiveSurface> m_surfaceAppends;
+        FrameAppendBuffer<Material> m_materialAppends;
     
     public:
 
@@ -87,6 +304,8 @@ namespace BlitzenEngine
         uint8_t debugPyramidActive = 0;
         uint8_t occlusionCullingOn = 1;
         uint8_t lodEnabled = 1;
+        uint8_t instancingEnabled = 0;
+        uint8_t meshShadingEnabled = 0;
 
     private:
         // Leaky singleton
@@ -106,4 +325,55 @@ namespace BlitzenEngine
     inline void ChangeLodEnabledState()  { 
         RenderingSystem::GetRenderingSystem()->lodEnabled  = !RenderingSystem::GetRenderingSystem()->lodEnabled; 
     }
+    inline void ChangeInstancingEnabledState() {
+        RenderingSystem::GetRenderingSystem()->instancingEnabled = !RenderingSystem::GetRenderingSystem()->instancingEnabled;
+    }
+    inline void ChangeMeshShadingEnabledState() {
+        RenderingSystem::GetRenderingSystem()->meshShadingEnabled = !RenderingSystem::GetRenderingSystem()->meshShadingEnabled;
+    }
+
+    // Draws the same view with the vertex shader path and then the mesh shading path, and logs the average GPU frame time of each.
+    // The camera is held where it was when the benchmark started and the LOD bias controller should be off, so both paths draw the same frames.
+    // Built with BLITZEN_MESH_SHADING_BENCHMARK (the CMake option of the same name)
+    class MeshShadingBenchmark
+    {
+    public:
+
+        // Saves the camera and starts with the vertex shader path
+        void Init(RenderingSystem* pRenderer, Camera& camera, uint32_t warmupFrames = BLIT_MESH_SHADING_BENCHMARK_WARMUP_FRAMES, 
+        uint32_t timedFrames = BLIT_MESH_SHADING_BENCHMARK_FRAMES);
+
+        // Puts the camera back and moves to the next phase when the current one has drawn its frames. 
+        // Called before the camera is updated. Returns 0 once the results have been logged
+        uint8_t Update(RenderingSystem* pRenderer, Camera& camera);
+
+    private:
+
+        enum class Phase : uint8_t
+        {
+            Streaming, 
+            Warmup, 
+            Timed, 
+            Drain, 
+            Done
+        };
+
+        void LogResults(RenderingSystem* pRenderer);
+
+        Phase m_phase = Phase::Done;
+        uint8_t m_bMeshShading = 0;
+        uint8_t m_bMeshShadingSupported = 0;
+
+        uint32_t m_warmupFrames = BLIT_MESH_SHADING_BENCHMARK_WARMUP_FRAMES;
+        uint32_t m_timedFrames = BLIT_MESH_SHADING_BENCHMARK_FRAMES;
+        uint32_t m_phaseFrame = 0;
+
+        // The GPU time totals of each path when its timed frames started
+        double m_startTime[2] = {};
+        uint64_t m_startFrameCount[2] = {};
+
+        BlitML::vec3 m_position;
+        float m_yawRotation = 0.f;
+        float m_pitchRotation = 0.f;
+    };
 }
\ No newline at end of file
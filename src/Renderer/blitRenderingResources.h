@@ -3,17 +3,92 @@
 #include "BlitzenMathLibrary/blitML.h"
 #include "Core/blitzenContainerLibrary.h"
 #include "Game/blitObject.h" // I probably do not want to include this here
+#include "Game/blitCamera.h"
+#include "Platform/filesystem.h"
+
+// I had to fold and use the STL for gltf texture paths
+#include <string>
+#include <mutex>
+#include <atomic>
+
+// Declared here so that the gltf helpers below can be shared with the scene streamer, without exposing all of cgltf
+struct cgltf_data;
+struct cgltf_primitive;
+struct cgltf_material;
+struct cgltf_node;
+struct cgltf_options;
+
+// Baked textures and cooked scenes are written under this directory, at the path of their source file
+#define BLIT_ASSET_CACHE_DIRECTORY  "Assets/Cache/"
 
 #define BLIT_MAX_TEXTURE_COUNT      5000
 #define BLIT_TEXTURE_NAME_MAX_SIZE  512
+#define BLIT_TEXTURE_CHUNK_SIZE     64
+
+// Returned by the texture slot allocator when every slot is taken
+#define BLIT_TEXTURE_SLOT_NONE      UINT32_MAX
+
+// Returned by the surface cache when no surface was loaded with a key
+#define BLIT_SURFACE_CACHE_MISS     UINT32_MAX
 
 #define BLIT_MAX_MATERIAL_COUNT     10000
+#define BLIT_MATERIAL_CHUNK_SIZE    256
+
+// Fragments of materials with this flag are discarded under half alpha, even in the opaque pass. Needs to match MATERIAL_ALPHA_TEST
+#define BLIT_MATERIAL_ALPHA_TEST    1
 
 #define BLIT_MAX_MESH_LOD           8
+
+// Objects only move to a coarser LOD once its projected error is this fraction under the LOD target, 
+// and only move back once it is this fraction over it. Needs to match LOD_HYSTERESIS in CullingShaderData.glsl
+#define BLIT_LOD_HYSTERESIS         0.1f
+
+// Defaults of the LOD chain that LoadPrimitiveSurface builds, see LodChainSettings
+#define BLIT_LOD_TARGET_RATIO           0.65f
+#define BLIT_LOD_MAX_ERROR              1e-1f
+#define BLIT_LOD_MIN_REDUCTION          0.95f
+#define BLIT_LOD_MIN_TRIANGLES          8
+#define BLIT_LOD_SLOPPY_FALLBACK        1
+#define BLIT_LOD_FIRST_SLOPPY_LEVEL     BLIT_MAX_MESH_LOD
+#define BLIT_LOD_SLOPPY_MAX_ERROR       0.5f
+
+// When this is 1, the loaders that support it give each surface a billboard as its last LOD. It is picked once this fraction of
+// the surface radius is under the LOD target. The atlas holds a grid of frames, needs to match IMPOSTOR_GRID in the vertex shader
+#define BLIT_LOD_IMPOSTOR               0
+#define BLIT_IMPOSTOR_ERROR             0.05f
+#define BLIT_IMPOSTOR_GRID              8
+#define BLIT_IMPOSTOR_FRAME_SIZE        32
+
+// Meshlet size limits, need to match the outputs of the mesh shader
+#define BLIT_MESHLET_MAX_VERTICES       64
+#define BLIT_MESHLET_MAX_TRIANGLES      124
+
+// When this is 1, the meshlets of a surface form a hierarchy instead of one set for each LOD (see GenerateClusterHierarchy).
+// Each group of neighbouring clusters is simplified to about half of its triangles, and is left as a root if it keeps more than
+// the minimum reduction
+#define BLIT_LOD_CLUSTER_HIERARCHY      1
+#define BLIT_CLUSTER_GROUP_SIZE         4
+#define BLIT_CLUSTER_GROUP_RATIO        0.5f
+#define BLIT_CLUSTER_MIN_REDUCTION      0.85f
 #define BLIT_MAX_MESH_COUNT         100'000
 
+// Max draw calls allowed, if render objects go above this, the application will fail
+#define BLITZEN_MAX_DRAW_OBJECTS    5'000'000
+
+// The triangles of each LOD are reordered after the vertex cache pass, so that front faces are drawn before the faces behind them.
+// The threshold is how much worse the vertex cache may get for it (1.05 allows 5% more cache misses)
+#define BLIT_MESH_OVERDRAW_OPTIMIZATION     1
+#define BLIT_MESH_OVERDRAW_THRESHOLD        1.05f
+
+// The gltf and obj loaders log the quality of each surface that they build, and the average of each file
+#define BLIT_MESH_QUALITY_REPORT            1
+
 #define BLIT_MAX_OBJECTS            5'000'000
 
+// Space left in the renderers' object buffers for render objects and mesh instances that are added after setup
+#define BLIT_RUNTIME_RENDER_OBJECT_HEADROOM     65'536
+#define BLIT_RUNTIME_MESH_INSTANCE_HEADROOM     16'384
+
 namespace BlitzenEngine
 {
     struct TextureStats
@@ -55,6 +130,17 @@ namespace BlitzenEngine
     	uint32_t dataOffset; // Index into meshlet data
     	uint8_t vertexCount;
     	uint8_t triangleCount;
+
+        // The error and sphere of the group of clusters that this one was simplified from. 0 for the clusters of the full surface
+        float error;
+        BlitML::vec3 lodCenter;
+        float lodRadius;
+
+        // The error and sphere of the group that replaced this cluster with simpler ones. Siblings share them, and FLT_MAX marks the 
+        // roots of the hierarchy. A cluster is drawn when its own error is under the LOD target and this one is not
+        BlitML::vec3 parentCenter;
+        float parentRadius;
+        float parentError;
     };
 
     // Passed to the GPU as a unified storage buffer. Part of Material stats
@@ -74,10 +160,17 @@ namespace BlitzenEngine
 
         // TODO: I need to try removing this, it's a waster of space
         uint32_t materialId;
+
+        // BLIT_MATERIAL_* bits. Uses the padding after the fields above
+        uint32_t flags = 0;
     };
 
-    struct MeshLod
+    struct alignas(16) MeshLod
     {
+        // Bounding sphere of the vertices that this level uses. LOD selection projects the error from the distance to it
+        BlitML::vec3 center;
+        float radius;
+
         // The amount of indices that have to be iterated over after the first index, in order to draw the surface with this lod
         uint32_t indexCount;
         // The index of the first element in the index buffer for this mesh lod
@@ -106,6 +199,43 @@ namespace BlitzenEngine
         uint32_t materialId;
 
         uint8_t postPass = 0;
+
+        // Set when the last LOD is a billboard, see AddSurfaceImpostor. Its 4 corners start at the impostor vertex, 
+        // relative to the vertex offset, and it is drawn with the impostor material instead of the one above
+        uint8_t bImpostor = 0;
+        uint32_t impostorVertex = 0;
+        uint32_t impostorMaterialId = 0;
+    };
+
+    // How LoadPrimitiveSurface builds the LOD chain of a surface. Each level aims for the target ratio of the indices of the level 
+    // before it. The attribute aware simplifier is used while it keeps the error under its bound. Once it stalls, or from the 
+    // first sloppy level on, meshopt_simplifySloppy builds the remaining levels, since it can merge vertices across the topology
+    struct LodChainSettings
+    {
+        float targetRatio = BLIT_LOD_TARGET_RATIO;
+
+        // Relative to the extent of the surface, like the errors that meshoptimizer gives
+        float maxError = BLIT_LOD_MAX_ERROR;
+
+        // How much each component of the normal counts against the positions
+        float normalWeights[3] = {1.f, 1.f, 1.f};
+
+        // A level that keeps more than this fraction of the indices of the level before it is dropped, and the chain ends
+        float minReduction = BLIT_LOD_MIN_REDUCTION;
+
+        // The chain ends once a level has fewer triangles than this
+        uint32_t minTriangleCount = BLIT_LOD_MIN_TRIANGLES;
+
+        uint8_t bSloppyFallback = BLIT_LOD_SLOPPY_FALLBACK;
+        uint8_t firstSloppyLevel = BLIT_LOD_FIRST_SLOPPY_LEVEL;
+        float sloppyMaxError = BLIT_LOD_SLOPPY_MAX_ERROR;
+
+        // Every LOD of a surface with meshlets points to the same cluster hierarchy, the task shader picks the clusters to draw
+        uint8_t bClusterHierarchy = BLIT_LOD_CLUSTER_HIERARCHY;
+
+        // Read by the loaders, which call AddSurfaceImpostor after the surface is built
+        uint8_t bImpostor = BLIT_LOD_IMPOSTOR;
+        float impostorError = BLIT_IMPOSTOR_ERROR;
     };
 
     struct Mesh
@@ -122,6 +252,21 @@ namespace BlitzenEngine
         BlitML::quat orientation;
     };
 
+    // A run of consecutive elements of a resource array that changed since the last frame. Renderers copy each run to their buffer as one region
+    struct BufferUpdateRange
+    {
+        uint32_t firstElement;
+        uint32_t elementCount;
+    };
+
+    // A run of elements that is moved inside a renderer buffer, when the allocations of the buffer are compacted
+    struct BufferMoveRange
+    {
+        uint32_t srcElement;
+        uint32_t dstElement;
+        uint32_t elementCount;
+    };
+
     // Accesses per draw data. A single draw has a unique transform and surface combination
     struct RenderObject
     {
@@ -129,26 +274,199 @@ namespace BlitzenEngine
         uint32_t surfaceId;
     };
 
+    // Every render object with the same transform belongs to one mesh instance (one game object or one gltf node).
+    // Its bounding sphere encloses the spheres of all its surfaces, so they can be culled together before they are tested one by one
+    struct alignas(16) MeshInstance
+    {
+        BlitML::vec3 center;
+        float radius;
+
+        uint32_t transformId;
+
+        // The render objects of the instance are listed in the instance object array, opaque and post pass objects in separate ranges
+        uint32_t firstOpaqueObject;
+        uint32_t opaqueObjectCount;
+        uint32_t firstPostPassObject;
+        uint32_t postPassObjectCount;
+    };
+
+    // The element count of each renderer buffer that can grow after setup
+    struct BufferCapacities
+    {
+        uint32_t renderObjects = 0;
+        uint32_t meshInstances = 0;
+        uint32_t instanceObjects = 0;
+
+        uint32_t vertices = 0;
+        uint32_t indices = 0;
+        uint32_t meshlets = 0;
+        uint32_t meshletData = 0;
+        uint32_t surfaces = 0;
+        uint32_t materials = 0;
+        uint32_t textures = 0;
+    };
+
+    // How well the first LOD of a surface uses the vertex cache and how much it overdraws, before and after its indices were optimized
+    struct MeshQualityStats
+    {
+        // Vertices transformed per triangle, with a 16 entry cache. 0.5 is the best that a regular mesh can get
+        float acmrBefore;
+        float acmrAfter;
+
+        // Vertices transformed per vertex of the surface. 1 is best
+        float atvrBefore;
+        float atvrAfter;
+
+        // Pixels shaded per pixel covered, from a few directions. 1 is best
+        float overdrawBefore;
+        float overdrawAfter;
+
+        uint32_t triangleCount;
+        uint32_t padding;
+    };
+
+    // The arrays that new surfaces and their geometry are written to. Usually the ones in the rendering resources,
+    // but the scene streamer gives each mesh its own on a worker thread, and moves them over when the mesh is committed
+    struct GeometryTarget
+    {
+        BlitCL::DynamicArray<Vertex>& vertices;
+        BlitCL::DynamicArray<uint32_t>& indices;
+        BlitCL::DynamicArray<Meshlet>& meshlets;
+        BlitCL::DynamicArray<uint32_t>& meshletData;
+        BlitCL::DynamicArray<PrimitiveSurface>& surfaces;
+
+        // Meshlets are only needed by the cluster rendering path
+        uint8_t buildMeshlets;
+
+        // When set, the quality of each new surface is measured and added here, one entry per surface
+        BlitCL::DynamicArray<MeshQualityStats>* pQuality = nullptr;
+
+        // The default settings are used when this is null
+        const LodChainSettings* pLodSettings = nullptr;
+    };
+
+    // Hands out single texture tags after setup. The free tags form a lock free stack, so that they can be taken and given back 
+    // from any thread. The head keeps a counter next to the tag, so that a tag that was taken and given back between 
+    // reading the head and exchanging it is noticed
+    class TextureSlotAllocator
+    {
+    public:
+
+        // The tags before the first one are used by the textures that the renderers were given at setup. Not thread safe
+        void Init(uint32_t firstSlot, uint32_t capacity);
+
+        // Returns BLIT_TEXTURE_SLOT_NONE if every slot is taken
+        uint32_t Allocate();
+
+        void Free(uint32_t slot);
+
+        inline uint32_t GetFreeCount() { return m_freeCount.load(std::memory_order_relaxed); }
+
+    private:
+
+        std::atomic<uint64_t> m_head{BLIT_TEXTURE_SLOT_NONE};
+        std::atomic<uint32_t> m_nextFree[BLIT_MAX_TEXTURE_COUNT];
+        std::atomic<uint32_t> m_freeCount{0};
+    };
+
+    // How many gltf primitives were not processed again, because an earlier primitive had the same streams
+    struct SurfaceDedupStats
+    {
+        uint32_t primitiveCount = 0;
+
+        // Same vertices, indices and material. The primitive uses the earlier surface
+        uint32_t sharedSurfaceCount = 0;
+
+        // Same vertices and indices with a different material. The primitive gets a new surface that points to the earlier geometry
+        uint32_t sharedGeometryCount = 0;
+
+        // The geometry that the shared primitives would have added
+        size_t savedVertexCount = 0;
+        size_t savedIndexCount = 0;
+        size_t savedMeshletCount = 0;
+    };
+
+    struct SurfaceCacheEntry
+    {
+        // 0 marks an empty entry
+        uint64_t key;
+        uint32_t surfaceId;
+
+        // Surface entries match only the same geometry and material. Geometry entries use their own surface as geometry id
+        uint32_t geometryId;
+        uint64_t materialKey;
+
+        // Geometry entries keep a copy of the streams they were hashed from, so that a colliding key is never shared
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        size_t firstVertex;
+        size_t firstIndex;
+    };
+
+    // Finds the first surface that was loaded with the same content. Open addressing with linear probing, grows to stay at most half full.
+    // The key only picks where to look, every candidate is compared exactly before it is returned
+    class SurfaceCache
+    {
+    public:
+
+        // Returns BLIT_SURFACE_CACHE_MISS if no surface was loaded with this geometry and material
+        uint32_t Find(uint64_t key, uint32_t geometryId, uint64_t materialKey);
+
+        // Returns BLIT_SURFACE_CACHE_MISS if no surface was loaded from the same vertices and indices
+        uint32_t Find(uint64_t key, BlitCL::DynamicArray<Vertex>& vertices, BlitCL::DynamicArray<uint32_t>& indices);
+
+        // Called after Find missed, the cache does not check for the same content again
+        void Insert(uint64_t key, uint32_t surfaceId, uint32_t geometryId, uint64_t materialKey);
+
+        // Copies the streams, they need to be the unprocessed ones that Find will be given
+        void Insert(uint64_t key, uint32_t surfaceId, BlitCL::DynamicArray<Vertex>& vertices, BlitCL::DynamicArray<uint32_t>& indices);
+
+        void Clear();
+
+        inline size_t GetMemorySize() 
+        { 
+            return m_entries.GetSize() * sizeof(SurfaceCacheEntry) + m_sourceVertices.GetSize() * sizeof(Vertex) + 
+            m_sourceIndices.GetSize() * sizeof(uint32_t); 
+        }
+
+    private:
+
+        void Place(SurfaceCacheEntry entry);
+
+        BlitCL::DynamicArray<SurfaceCacheEntry> m_entries;
+        size_t m_count = 0;
+
+        BlitCL::DynamicArray<Vertex> m_sourceVertices;
+        BlitCL::DynamicArray<uint32_t> m_sourceIndices;
+    };
+
     // This struct holds every loaded resource that will be used for rendering all game objects
     struct RenderingResources
     {
-        TextureStats textures[BLIT_MAX_TEXTURE_COUNT];
+        // Textures and materials grow with the scene, up to the max count. Their elements do not move, so the tables can point to them
+        BlitCL::ChunkedArray<TextureStats, BLIT_TEXTURE_CHUNK_SIZE> textures;
         BlitCL::PointerTable<TextureStats> textureTable;
-        size_t textureCount = 0;
 
-        Material materials[BLIT_MAX_MATERIAL_COUNT];
+        BlitCL::ChunkedArray<Material, BLIT_MATERIAL_CHUNK_SIZE> materials;
         BlitCL::PointerTable<Material> materialTable;
-        size_t materialCount = 0;
 
-        // Arrays that hold all necessary geometry data
+        // Arrays that hold all necessary geometry data. Only needed until the renderers upload them, see ReleaseUploadedGeometry
         BlitCL::DynamicArray<Vertex> vertices;
         BlitCL::DynamicArray<uint32_t> indices;
         BlitCL::DynamicArray<Meshlet> meshlets;
         BlitCL::DynamicArray<uint32_t> meshletData;
 
-        // The data of every mesh allowed is in this fixed size array and the currentMeshIndex holds the current amount of loaded meshes
-        Mesh meshes[BLIT_MAX_MESH_COUNT];
-        size_t meshCount = 0;
+        // Set to 0 once the geometry arrays above have been released. No more geometry can be loaded after that
+        uint8_t geometryResident = 1;
+
+        // Every loaded mesh, up to BLIT_MAX_MESH_COUNT
+        BlitCL::DynamicArray<Mesh> meshes;
+
+        // The surfaces that gltf scenes loaded, by the hash of their vertex, index and material streams, and by the hash of 
+        // their vertex and index streams alone. Only used while the geometry arrays are resident
+        SurfaceCache surfaceCache;
+        SurfaceCache geometryCache;
+        SurfaceDedupStats surfaceDedup;
 
         // Each render object has a different transform held by this array 
         BlitCL::DynamicArray<MeshTransform> transforms;
@@ -157,12 +475,37 @@ namespace BlitzenEngine
         BlitCL::DynamicArray<BlitzenEngine::PrimitiveSurface> surfaces;
 
         // TODO: This is not a rendering resource, it should not be part of this struct
-        GameObject objects[BLIT_MAX_OBJECTS];
-        uint32_t objectCount;
+        BlitCL::SlotMap<GameObject> objects;
+
+        // All render objects are located here. The dense array is what the renderers upload, handles stay valid when objects move.
+        // They are partitioned so that every opaque object comes before every post pass (transparent) object
+        BlitCL::SlotMap<RenderObject> renders;
+
+        // The amount of render objects in the opaque range at the start of the renders array
+        uint32_t opaqueRenderObjectCount = 0;
+
+        // One mesh instance for each transform. Built by BuildMeshInstances after every scene has been loaded
+        BlitCL::DynamicArray<MeshInstance> meshInstances;
+        // Render object indices, grouped by mesh instance. Opaque objects come first, like in the renders array
+        BlitCL::DynamicArray<uint32_t> instanceObjects;
+
+        // The amount of geometry that the renderers were given at setup. Geometry that is streamed in later is placed after it,
+        // since the arrays above are released by then
+        uint32_t gpuVertexCount = 0;
+        uint32_t gpuIndexCount = 0;
+        uint32_t gpuMeshletCount = 0;
+        uint32_t gpuMeshletDataCount = 0;
+
+        // The sizes that the renderers give to their buffers. Set before the renderers are set up, 
+        // so that objects can be added and scenes can be streamed in at runtime
+        BufferCapacities capacities;
 
-        // All render objects are located here
-        RenderObject renders[BLIT_MAX_OBJECTS];
-        uint32_t renderObjectCount;        
+        // The LOD chain of the surfaces that are loaded at setup
+        LodChainSettings lodSettings;
+
+        // The texture tags after the ones given at setup. Vulkan gives the tags of unloaded textures back 
+        // once the frames in flight are done with them
+        TextureSlotAllocator textureSlots;
     };
 
     uint8_t LoadRenderingResourceSystem(RenderingResources* pResources);
@@ -185,19 +528,74 @@ namespace BlitzenEngine
     uint8_t LoadMeshFromObj(RenderingResources* pResources, const char* filename);
 
     // Generates meshlet for a mesh or surface loaded using meshOptimizer library and converts it to the renderer's format
-    size_t GenerateClusters(RenderingResources* pResources, 
+    size_t GenerateClusters(GeometryTarget& target, 
     BlitCL::DynamicArray<Vertex>& vertices, 
     BlitCL::DynamicArray<uint32_t>& indices);
 
+    // Builds the meshlets of the full surface and groups neighbouring ones, level after level. Each group is simplified with the 
+    // vertices that it shares with other groups locked, and split into new meshlets, which record the error and sphere of the group.
+    // The meshlets that it was built from record them as their parent's. Returns the amount of meshlets added to the target
+    size_t GenerateClusterHierarchy(GeometryTarget& target, 
+    BlitCL::DynamicArray<Vertex>& vertices, 
+    BlitCL::DynamicArray<uint32_t>& indices, 
+    BlitCL::DynamicArray<BlitML::vec3>& normals, const LodChainSettings& settings);
+
     // Takes the vertices and indices loaded for a mesh primitive from a file and converts the data to the renderer's format
     void LoadPrimitiveSurface(RenderingResources* pResources, 
     BlitCL::DynamicArray<Vertex>& vertices, 
+    BlitCL::DynamicArray<uint32_t>& indices, 
+    BlitCL::DynamicArray<MeshQualityStats>* pQuality = nullptr);
+
+    // Same as above, but writes the surface and its geometry to the target's arrays. Does not touch any shared state, 
+    // so it can run on a worker thread
+    void LoadPrimitiveSurface(GeometryTarget& target, 
+    BlitCL::DynamicArray<Vertex>& vertices, 
     BlitCL::DynamicArray<uint32_t>& indices);
 
 
+    // Renders the surface from a grid of directions around it to an octahedral atlas of colors and normals, and adds a billboard
+    // that shows the nearest frame as its last LOD. The colors come from the source image, or from the default gray when it is null.
+    // The atlases are cached by the content of the surface. Needs the geometry arrays, so only the loaders at setup call it.
+    // Returns 0 and leaves the surface as it was if there is no room for the LOD, the textures or the material
+    uint8_t AddSurfaceImpostor(RenderingResources* pResources, uint32_t surfaceId, const char* albedoSourcePath);
+
+
+    // Averages the quality of the surfaces, weighted by their triangle counts, and adds up the triangles
+    void SumMeshQuality(const MeshQualityStats* pStats, size_t count, MeshQualityStats& total);
+
+    // Logs the quality of each surface, if BLIT_MESH_QUALITY_REPORT is 1, and their average
+    void LogMeshQuality(const char* name, BlitCL::DynamicArray<MeshQualityStats>& quality);
+
+    // Frees the CPU copies of the vertices, indices and meshlets, once every renderer has uploaded them.
+    // The surfaces are kept, their bounding spheres and LOD tables are still used by CPU culling and runtime objects.
+    // Returns the amount of bytes that were released
+    size_t ReleaseUploadedGeometry(RenderingResources* pResources);
+
+
     // Placeholder to load some default resources while testing the systems
     void LoadTestGeometry(RenderingResources* pResources);
 
+    // Adds a render object while keeping opaque objects before post pass objects. 
+    // If the surface is opaque and there are post pass objects already, the first post pass object is moved to the back
+    BlitCL::SlotHandle AddRenderObject(RenderingResources* pResources, uint32_t transformId, uint32_t surfaceId);
+
+
+    // Reorders the transforms by the Morton code of their position and the render objects by their transform, inside the opaque 
+    // and post pass ranges. Culling then reads the transforms and surfaces of nearby objects together. 
+    // Transform ids of game objects and render objects are remapped, so it needs to run before the mesh instances are built
+    void SortRenderObjectsSpatially(RenderingResources* pResources);
+
+    // Groups the render objects by transform into mesh instances and gives each instance a bounding sphere for all of its surfaces.
+    // Needs to be called after all render objects have been added, since the instance object ranges depend on the final renders array
+    void BuildMeshInstances(RenderingResources* pResources);
+
+    // Gives the mesh instance a model space bounding sphere that encloses the spheres of all the surfaces in its ranges
+    void ComputeMeshInstanceBounds(RenderingResources* pResources, MeshInstance& instance);
+
+    // CPU reference of SelectLod in the culling shaders, for tests and tools that need to know which LOD an object is drawn with.
+    // Gives the coarsest LOD whose error, projected from the distance to its bounding sphere, is under the LOD target of the view. 
+    // The LOD of the previous frame widens the target of the LODs that are not coarser than it and narrows the rest by BLIT_LOD_HYSTERESIS
+    uint8_t SelectSurfaceLod(PrimitiveSurface& surface, MeshTransform& transform, CameraViewData& viewData, uint8_t previousLod);
 
     // This function is used to load a default scene
     void CreateTestGameObjects(RenderingResources* pResources, uint32_t drawCount);
@@ -211,4 +609,50 @@ namespace BlitzenEngine
     // This function uses the cgltf library to load a .glb or .gltf scene
     // The repository can be found on https://github.com/jkuhlmann/cgltf
     uint8_t LoadGltfScene(RenderingResources* pResources, const char* path, uint8_t loadForVulkan, uint8_t loadForGL);
+
+    // Gives cgltf read-only mappings of the .gltf, .glb and .bin files instead of copies of them. Can be shared by threads that parse
+    // different files, and needs to outlive the cgltf_data of the options that it was set on
+    class GltfFileMapper
+    {
+    public:
+
+        // Points the file callbacks of the options to this
+        void SetCallbacks(cgltf_options& options);
+
+        // Maps at least size bytes of the file, the whole file if size is 0. Returns nullptr if it cannot be mapped
+        const void* Map(const char* path, size_t& size);
+
+        void Unmap(const void* pData);
+
+        ~GltfFileMapper();
+
+    private:
+
+        std::mutex m_mutex;
+        BlitCL::DynamicArray<BlitzenPlatform::MappedFile*> m_files;
+    };
+
+    // Builds the .dds path of each texture in the gltf, relative to the gltf file
+    void GetGltfTexturePaths(const char* path, cgltf_data* pData, BlitCL::DynamicArray<std::string>& texturePaths);
+
+    // Converts a gltf material. Texture tags are the gltf texture index plus the first texture, or the no texture tag when unused
+    void ConvertGltfMaterial(cgltf_data* pData, const cgltf_material& gltfMaterial, uint32_t firstTexture, uint32_t noTextureTag, 
+    Material& material);
+
+    // Unpacks the vertices and indices of a gltf primitive. Returns 0 if the primitive is not made of indexed triangles
+    uint8_t LoadGltfPrimitive(const cgltf_primitive& primitive, BlitCL::DynamicArray<Vertex>& vertices, 
+    BlitCL::DynamicArray<uint32_t>& indices);
+
+    // Builds a surface for each triangle primitive of the gltf mesh, with its LODs and meshlets. The material of each surface is 
+    // the gltf material index, or the no material index. Does not touch any shared state, so it can run on a worker thread
+    void LoadGltfMesh(cgltf_data* pData, uint32_t meshIndex, uint32_t noMaterialIndex, GeometryTarget& target);
+
+    // Hashes the bytes, starting from the hash of what was hashed before them. Used for content hashes, not for security
+    uint64_t HashBytes(const uint8_t* pData, size_t size, uint64_t hash);
+
+    // Where the processed version of a source file goes in the asset cache. The extension replaces the source's
+    std::string GetAssetCachePath(const char* sourcePath, const char* extension);
+
+    // Decomposes the world matrix of a gltf node to the engine's transform
+    MeshTransform GetGltfNodeTransform(const cgltf_node* pNode);
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "Renderer/blitRenderingResources.h"
+
+// Cooked scenes are written to the asset cache with these extensions. The manifest lists the files that the scene was cooked from
+#define BLIT_COOKED_SCENE_EXTENSION             ".bscene"
+#define BLIT_COOKED_MANIFEST_EXTENSION          ".bdeps"
+
+#define BLIT_COOKED_SCENE_MAGIC                 0x4E435342 // "BSCN"
+
+// Raised whenever the cooked layout or the processing of the meshes changes, so that older cooked scenes are cooked again
+#define BLIT_COOKED_SCENE_VERSION               6
+
+#define BLIT_COOK_MAX_PATH_LENGTH               512
+
+// Most scenes that the cooker processes at the same time. Each one also bakes its textures on several threads
+#define BLIT_COOK_MAX_THREADS                   8
+
+namespace BlitzenEngine
+{
+    // Starts the cooked file. The sizes of the structs are checked, so that a file is not read by a build with a different layout
+    struct CookedSceneHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+
+        uint32_t vertexSize;
+        uint32_t meshletSize;
+        uint32_t surfaceSize;
+        uint32_t qualitySize;
+        uint32_t bMeshlets;
+        uint32_t padding;
+
+        // Also written to the manifest. A cooked file is only used with the manifest that was written with it
+        uint64_t contentHash;
+    };
+
+    // Where the arrays of one gltf mesh are in the file, one after the other. The quality of each surface follows the surfaces.
+    // The offsets of the surfaces and meshlets are relative to these arrays, like in a streamed mesh chunk
+    struct CookedMeshEntry
+    {
+        uint64_t offset;
+
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t meshletCount;
+        uint32_t meshletDataCount;
+        uint32_t surfaceCount;
+        uint32_t padding;
+    };
+
+    // Ends the cooked file. The mesh table is written after the meshes, so that they can be written as soon as they are built
+    struct CookedSceneFooter
+    {
+        uint64_t tableOffset;
+        uint32_t meshCount;
+        uint32_t magic;
+    };
+
+    // A file that the scene was cooked from, with the size and write time that it had then
+    struct CookDependency
+    {
+        char path[BLIT_COOK_MAX_PATH_LENGTH];
+
+        uint64_t size;
+        uint64_t writeTime;
+        uint64_t hash;
+    };
+
+    // What cooking one scene did, for the cooker to print
+    struct CookStats
+    {
+        // 0 when the cooked scene was already up to date
+        uint8_t bCooked = 0;
+        uint8_t bFailed = 0;
+
+        double seconds = 0.0;
+
+        size_t sourceBytes = 0;
+        size_t cookedBytes = 0;
+
+        uint32_t meshCount = 0;
+        uint32_t surfaceCount = 0;
+        uint32_t textureCount = 0;
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        size_t meshletCount = 0;
+
+        // Average of the surfaces of the scene, read from the cooked file if it was already up to date
+        MeshQualityStats quality{};
+    };
+
+    // The gltf file and the buffers that it points to, with their current size and write time. Embedded buffers are part of the gltf
+    void GetGltfDependencies(const char* path, cgltf_data* pData, BlitCL::DynamicArray<CookDependency>& dependencies);
+
+    // Hashes the contents of the file. Returns 0 if it cannot be read
+    uint8_t HashFileContents(const char* path, uint64_t& hash);
+
+    // Combines the hashes of the dependencies with the cooked version, so that a change to either gives a different hash
+    uint64_t GetCookContentHash(BlitCL::DynamicArray<CookDependency>& dependencies, uint8_t bMeshlets);
+
+    uint8_t ReadCookManifest(const char* path, uint64_t& contentHash, BlitCL::DynamicArray<CookDependency>& dependencies);
+
+    uint8_t WriteCookManifest(const char* path, uint64_t contentHash, BlitCL::DynamicArray<CookDependency>& dependencies);
+
+    // Read-only view of a cooked scene. Its meshes are copied out of the mapped file instead of being processed again
+    class CookedSceneFile
+    {
+    public:
+
+        // Opens the cooked file of the gltf if none of the files in its manifest changed since it was cooked. Only the size and
+        // write time of each file is checked, the cooker compares their contents. Files without meshlets are not used when they are needed
+        uint8_t Open(const char* gltfPath, uint8_t bMeshlets);
+
+        // Adds the surfaces and geometry of the mesh to the target, with their offsets moved past what the target holds.
+        // Meshlets are left out when the target does not build them
+        uint8_t ReadMesh(uint32_t meshIndex, GeometryTarget& target);
+
+        inline uint32_t GetMeshCount() { return m_meshCount; }
+
+        // Averages the quality that was recorded for the surfaces of every mesh
+        void SumQuality(MeshQualityStats& total);
+
+    private:
+
+        BlitzenPlatform::MappedFile m_file;
+
+        const CookedMeshEntry* m_pMeshes = nullptr;
+        uint32_t m_meshCount = 0;
+    };
+
+    // Cooks the meshes of the gltf to its cooked file, and bakes its textures. Nothing is cooked if the content hashes of the files
+    // in its manifest have not changed, unless forced. Runs on any thread, scenes can be cooked in parallel
+    uint8_t CookGltfScene(const char* path, uint8_t bMeshlets, uint8_t bForce, CookStats& stats);
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include "Renderer/blitRenderingResources.h"
+#include "Renderer/blitDDSTextures.h"
+#include "Renderer/blitSceneCook.h"
+#include "Platform/filesystem.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// The most worker threads that parse, process and read the files of streamed scenes. Fewer are used on machines with fewer cores
+#define BLIT_STREAMING_MAX_WORKER_COUNT         4
+
+// Finished chunks are committed by the main thread until one of these budgets is spent. At least one chunk is committed every frame
+#define BLIT_STREAMING_COMMIT_TIME_BUDGET       0.002 // seconds
+#define BLIT_STREAMING_COMMIT_BYTE_BUDGET       (32 * 1024 * 1024)
+
+// Texture files that are open and being read at the same time, across every scene. Parsing waits for earlier reads past this
+#define BLIT_STREAMING_MAX_TEXTURE_READS        512
+
+// Space left in the renderers' buffers for the scenes that are streamed in after setup
+#define BLIT_STREAMING_VERTEX_HEADROOM          4'194'304
+#define BLIT_STREAMING_INDEX_HEADROOM           16'777'216
+#define BLIT_STREAMING_MESHLET_HEADROOM         262'144
+#define BLIT_STREAMING_MESHLET_DATA_HEADROOM    8'388'608
+#define BLIT_STREAMING_SURFACE_HEADROOM         16'384
+#define BLIT_STREAMING_MATERIAL_HEADROOM        4'096
+#define BLIT_STREAMING_TEXTURE_HEADROOM         1'024
+#define BLIT_STREAMING_RENDER_OBJECT_HEADROOM   262'144
+#define BLIT_STREAMING_MESH_INSTANCE_HEADROOM   65'536
+
+// Texture tags and material indices of streamed chunks are relative to their file. This marks the ones that are not used
+#define BLIT_STREAMING_UNUSED_INDEX             UINT32_MAX
+
+namespace BlitzenEngine
+{
+    enum class StreamedChunkType : uint8_t
+    {
+        // The materials and the texture count of a file. Committed before any other chunk of the file
+        Scene = 0,
+        // A mesh with its surfaces and geometry, and the transforms of the nodes that use it
+        Mesh = 1,
+        // The image data of one texture
+        Texture = 2
+    };
+
+    // The parts of the renderers' buffers that a committed mesh was given, so that they can be freed when its scene is unloaded
+    struct StreamedMeshAllocation
+    {
+        uint32_t meshIndex;
+
+        // Allocations of the renderers' geometry heaps. Their offsets change when the heaps are compacted
+        BlitCL::SlotHandle vertices;
+        BlitCL::SlotHandle indices;
+        BlitCL::SlotHandle meshlets;
+        BlitCL::SlotHandle meshletData;
+        BlitCL::SlotHandle surfaces;
+    };
+
+    // A gltf file that is being streamed. Shared by the jobs of the file
+    struct StreamedScene
+    {
+        std::string path;
+
+        // Added to the position of every node of the file, so that the same file can be placed more than once (world partition cells)
+        BlitML::vec3 offset = BlitML::vec3(0.f);
+
+        // Freed by the last job of the file
+        cgltf_data* pData = nullptr;
+        BlitCL::DynamicArray<std::string>* pTexturePaths = nullptr;
+
+        // Set when the file has an up to date cooked scene. Its meshes are copied from it instead of being processed
+        CookedSceneFile* pCooked = nullptr;
+        std::atomic<uint32_t> pendingJobs{0};
+
+        // Stored by the thread of the last job after it has freed the data above. The main thread only frees the scene after this,
+        // since the job count reaches zero before that thread is done with the scene
+        std::atomic<uint8_t> bDataReleased{0};
+
+        // Set when the scene is cancelled. Its jobs are skipped and its chunks are dropped
+        std::atomic<uint8_t> bCancelled{0};
+
+        // Chunks of the scene that have not been released. The scene is only freed once they are gone
+        std::atomic<uint32_t> liveChunks{0};
+
+        // Set by the main thread when the scene chunk is committed. The materials of the file start here, 
+        // and each texture of the file gets its own tag from the texture slots
+        uint32_t firstMaterial = 0;
+        uint32_t materialCount = 0;
+        BlitCL::DynamicArray<uint32_t> textureTags;
+
+        // The mesh and texture chunks that the main thread is still waiting for
+        uint32_t uncommittedChunks = 0;
+        uint8_t bSceneCommitted = 0;
+        uint8_t bFinished = 0;
+
+        // What the committed chunks added, so that the scene can be unloaded. Only touched by the main thread
+        BlitCL::DynamicArray<StreamedMeshAllocation> meshAllocations;
+        BlitCL::DynamicArray<BlitCL::SlotHandle> gameObjects;
+        size_t committedBytes = 0;
+
+        // Set when the scene is released. It is freed once none of its jobs or chunks are left
+        uint8_t bReleased = 0;
+    };
+
+    // The result of a job, waiting for the main thread to commit it to the resources and the renderers
+    struct StreamedChunk
+    {
+        StreamedChunkType type;
+        StreamedScene* pScene;
+
+        // Failed chunks are still committed, so that the progress counts add up, but they add nothing
+        uint8_t bFailed = 0;
+
+        // Scene chunk. The texture tags of the materials are relative to the file
+        BlitCL::DynamicArray<Material> materials;
+        uint32_t textureCount = 0;
+        uint32_t chunkCount = 0;
+
+        // Mesh chunk. The offsets of the surfaces and meshlets are relative to the chunk's arrays and the surfaces' materials to the file
+        BlitCL::DynamicArray<Vertex> vertices;
+        BlitCL::DynamicArray<uint32_t> indices;
+        BlitCL::DynamicArray<Meshlet> meshlets;
+        BlitCL::DynamicArray<uint32_t> meshletData;
+        BlitCL::DynamicArray<PrimitiveSurface> surfaces;
+        BlitCL::DynamicArray<MeshTransform> transforms;
+
+        // Texture chunk
+        uint32_t textureIndex = 0;
+        DDS_HEADER header;
+        DDS_HEADER_DXT10 header10;
+        unsigned int format = 0;
+        BlitCL::DynamicArray<uint8_t> textureData;
+
+        // The amount of bytes that committing the chunk sends to the GPU
+        size_t GetUploadSize();
+    };
+
+    // Loads gltf scenes on worker threads. The main thread takes the finished chunks and commits them a few at a time,
+    // so rendering does not wait for the whole scene
+    class SceneStreamer
+    {
+    public:
+
+        // Queues a gltf file, with an offset for the positions of its nodes. The workers are started with the first one.
+        // The scene stays valid until it is released
+        StreamedScene* QueueScene(const char* path, uint8_t buildMeshlets, uint8_t loadTextures, 
+        const BlitML::vec3& offset = BlitML::vec3(0.f));
+
+        // Returns the oldest finished chunk without taking it, or nullptr if there are none
+        StreamedChunk* PeekFinishedChunk();
+
+        // Takes the chunk that was returned by PeekFinishedChunk
+        void PopFinishedChunk();
+
+        // Frees a chunk that has been committed
+        void ReleaseChunk(StreamedChunk* pChunk);
+
+        // Cancels every scene that is being streamed. Jobs that are running finish, but their chunks are dropped
+        void Cancel();
+
+        // Same as the above for a single scene
+        void CancelScene(StreamedScene* pScene);
+
+        // Cancels the scene if it is not done, and frees it once its jobs and chunks are gone. 
+        // Whatever it added to the resources needs to be removed by the caller first
+        void ReleaseScene(StreamedScene* pScene);
+
+        // Stops the workers and frees everything that was not committed
+        void Shutdown();
+
+        // Called when a chunk is committed, counts the finished scenes
+        void OnChunkCommitted(StreamedChunk* pChunk);
+
+        inline uint8_t IsActive() { return m_finishedSceneCount < m_sceneCount; }
+        inline uint8_t WasRequested() { return m_sceneCount > 0; }
+
+        inline uint32_t GetCommittedChunkCount() { return m_committedChunkCount; }
+        inline uint32_t GetKnownChunkCount() { return m_knownChunkCount; }
+        inline uint32_t GetFinishedSceneCount() { return m_finishedSceneCount; }
+        inline uint32_t GetSceneCount() { return m_sceneCount; }
+
+        ~SceneStreamer();
+
+    private:
+
+        enum class JobType : uint8_t
+        {
+            Parse = 0,
+            Mesh = 1
+        };
+
+        struct StreamingJob
+        {
+            JobType type;
+            StreamedScene* pScene;
+            uint32_t index;
+        };
+
+        void WorkerLoop();
+
+        // A texture file that the IO threads are reading into its chunk
+        struct TextureRead
+        {
+            SceneStreamer* pStreamer;
+            StreamedChunk* pChunk;
+            BlitzenPlatform::AsyncFile file;
+        };
+
+        // Parses the file and produces the scene chunk, then queues a job for each mesh and submits the reads of the textures
+        void ParseScene(StreamedScene* pScene);
+
+        // Processes the primitives of a mesh to surfaces, LODs and meshlets
+        void BuildMesh(StreamedScene* pScene, uint32_t meshIndex);
+
+        // Submits the reads of the scene's DDS files in batches. Each read counts as a job of the scene until it calls back
+        void ReadTextures(StreamedScene* pScene, uint32_t textureCount);
+
+        // Called on an IO thread when a texture file has been read. Moves the image data to the front of the buffer and finishes the chunk
+        static void OnTextureRead(void* pUserData, uint8_t bSuccess, size_t bytesRead);
+
+        // The gltf data is freed when the last job of its file is done
+        void FinishJob(StreamedScene* pScene);
+
+        void PushFinishedChunk(StreamedChunk* pChunk);
+
+        StreamedChunk* CreateChunk(StreamedChunkType type, StreamedScene* pScene);
+
+        // Frees the released scenes that nothing points to anymore
+        void CollectReleasedScenes();
+
+        std::thread m_workers[BLIT_STREAMING_MAX_WORKER_COUNT];
+        uint32_t m_workerCount = 0;
+
+        std::mutex m_jobMutex;
+        std::condition_variable m_jobSignal;
+        BlitCL::DynamicArray<StreamingJob> m_jobs;
+        size_t m_nextJob = 0;
+        uint8_t m_bShutdown = 0;
+
+        // The gltf files and buffers of every scene are mapped through this, they are unmapped when the scene's data is freed
+        GltfFileMapper m_gltfFiles;
+
+        BlitzenPlatform::AsyncIO m_io;
+        std::mutex m_textureReadMutex;
+        std::condition_variable m_textureReadSignal;
+        uint32_t m_textureReadCount = 0;
+
+        std::mutex m_finishedMutex;
+        BlitCL::DynamicArray<StreamedChunk*> m_finishedChunks;
+        size_t m_nextFinishedChunk = 0;
+
+        // Only touched by the main thread
+        BlitCL::DynamicArray<StreamedScene*> m_scenes;
+        uint32_t m_sceneCount = 0;
+        uint32_t m_finishedSceneCount = 0;
+        uint32_t m_committedChunkCount = 0;
+        uint32_t m_knownChunkCount = 0;
+
+        // Given to every scene, they are set by the first queued scene
+        uint8_t m_bBuildMeshlets = 0;
+        uint8_t m_bLoadTextures = 0;
+    };
+}
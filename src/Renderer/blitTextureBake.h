@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Renderer/blitDDSTextures.h"
+
+#include <string>
+
+// Most threads that encode the blocks of one texture
+#define BLIT_TEXTURE_BAKE_MAX_THREADS           16
+
+// Color textures are encoded to BC7 when this is 1, and to BC1 (opaque) or BC3 (with alpha) otherwise. BC7 is slower to bake
+#define BLIT_TEXTURE_BAKE_COLOR_BC7             1
+
+namespace BlitzenEngine
+{
+    // What the channels of a source image hold. It decides how the mip levels are filtered and which block format is used
+    enum class TextureBakeUsage : uint8_t
+    {
+        // RGB color with optional alpha. Mip levels are filtered in linear space
+        Color = 0,
+
+        // Tangent space normals. Mip levels are renormalized and only x and y are kept (BC5), the shaders rebuild z
+        Normal = 1
+    };
+
+    enum class TextureBakeFormat : uint8_t
+    {
+        BC1 = 0,
+        BC3 = 1,
+        BC5 = 2,
+        BC7 = 3
+    };
+
+    // Where the baked DDS file of a source image goes in the asset cache (BLIT_ASSET_CACHE_DIRECTORY)
+    std::string GetBakedTexturePath(const char* sourcePath);
+
+    // Decodes the source image with stb_image, builds its mip chain, encodes every level on a few threads and writes the DDS file
+    uint8_t BakeTexture(const char* sourcePath, const char* ddsPath, TextureBakeUsage usage);
+
+    // Same as above for RGBA8 pixels that are already in memory, like the atlases that the impostor baker renders
+    uint8_t BakeTexturePixels(const uint8_t* pSource, uint32_t width, uint32_t height, const char* ddsPath, TextureBakeUsage usage);
+
+    // Gives the cached DDS file of a source image. It is baked first if it is missing or older than the source
+    uint8_t GetOrBakeTexture(const char* sourcePath, TextureBakeUsage usage, std::string& ddsPath);
+}
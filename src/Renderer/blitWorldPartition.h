@@ -0,0 +1,141 @@
+#pragma once
+
+#include "Renderer/blitRenderer.h"
+
+// Default partition settings. The unload distance is larger than the load distance,
+// so that a camera moving back and forth on a cell border does not load and unload the cell every frame
+#define BLIT_WORLD_CELL_SIZE                    250.f
+#define BLIT_WORLD_LOAD_DISTANCE                400.f
+#define BLIT_WORLD_UNLOAD_DISTANCE              550.f
+#define BLIT_WORLD_MEMORY_BUDGET                (1024ull * 1024 * 1024)
+
+// Cells that are being streamed at the same time. More are only queued once these are done, nearest first
+#define BLIT_WORLD_MAX_LOADING_CELLS            4
+
+// The flythrough benchmark crosses a square grid of copies of one scene
+#define BLIT_WORLD_BENCHMARK_SCENE              "Assets/Scenes/CityLow/scene.gltf"
+#define BLIT_WORLD_BENCHMARK_GRID_SIZE          8
+#define BLIT_WORLD_BENCHMARK_CAMERA_SPEED       60.f
+#define BLIT_WORLD_BENCHMARK_CAMERA_HEIGHT      100.f
+#define BLIT_WORLD_BENCHMARK_HITCH_TIME         (1.0 / 30.0)
+
+namespace BlitzenEngine
+{
+    enum class WorldCellState : uint8_t
+    {
+        Unloaded = 0,
+        Loading = 1,
+        Resident = 2
+    };
+
+    // A square of the world grid. It is filled by a gltf file that is placed at the cell's corner
+    struct WorldCell
+    {
+        std::string path;
+        int32_t x;
+        int32_t z;
+        BlitML::vec3 origin;
+
+        WorldCellState state = WorldCellState::Unloaded;
+        StreamedScene* pScene = nullptr;
+
+        // Measured the last time the cell was loaded, to predict what loading it again will cost
+        size_t lastResidentBytes = 0;
+    };
+
+    struct WorldPartitionStats
+    {
+        uint32_t loadingCells = 0;
+        uint32_t residentCells = 0;
+
+        uint32_t loadCount = 0;
+        uint32_t unloadCount = 0;
+        uint32_t budgetEvictionCount = 0;
+
+        // The bytes that the loading and resident cells have sent to the GPU
+        size_t residentBytes = 0;
+        size_t peakResidentBytes = 0;
+    };
+
+    // Splits the world in a grid of cells that are streamed in as the camera gets close to them and unloaded as it moves away.
+    // Each cell's meshes, surfaces, materials, textures and render objects are its own,
+    // so that unloading a cell gives its parts of the renderers' buffers to the next cells
+    class WorldPartition
+    {
+    public:
+
+        // Needs to be called before the renderers are set up, so that they leave space for the cells
+        void Init(RenderingSystem* pRenderer, float cellSize = BLIT_WORLD_CELL_SIZE, float loadDistance = BLIT_WORLD_LOAD_DISTANCE,
+        float unloadDistance = BLIT_WORLD_UNLOAD_DISTANCE, size_t memoryBudget = BLIT_WORLD_MEMORY_BUDGET);
+
+        void AddCell(const char* path, int32_t x, int32_t z);
+
+        // Loads the cells that the camera came close to and unloads the ones it moved away from. Called once per frame,
+        // after the renderers have been set up
+        void Update(const BlitML::vec3& cameraPosition);
+
+        // Unloads every cell. Needs to be called before the renderers are shut down
+        void Clear();
+
+        inline WorldPartitionStats& GetStats() { return m_stats; }
+        inline float GetCellSize() { return m_cellSize; }
+
+        ~WorldPartition();
+
+    private:
+
+        void LoadCell(WorldCell* pCell);
+
+        void UnloadCell(WorldCell* pCell);
+
+        // Distance on the ground plane from the camera to the closest point of the cell
+        float GetCellDistance(WorldCell* pCell, const BlitML::vec3& cameraPosition);
+
+        // What loading the cell is expected to cost. Cells that were never loaded are expected to cost as much as the average cell
+        size_t EstimateCellBytes(WorldCell* pCell);
+
+        RenderingSystem* m_pRenderer = nullptr;
+
+        // The cells are not moved when more are added, the streamer's scenes point to their paths
+        BlitCL::DynamicArray<WorldCell*> m_cells;
+
+        float m_cellSize = BLIT_WORLD_CELL_SIZE;
+        float m_loadDistance = BLIT_WORLD_LOAD_DISTANCE;
+        float m_unloadDistance = BLIT_WORLD_UNLOAD_DISTANCE;
+        size_t m_memoryBudget = BLIT_WORLD_MEMORY_BUDGET;
+
+        // Running total of the measured cell sizes, for the estimate of cells that were never loaded
+        size_t m_measuredBytes = 0;
+        uint32_t m_measuredCellCount = 0;
+
+        WorldPartitionStats m_stats;
+    };
+
+    // Flies the camera in a straight line over a grid of copies of one scene, to measure how well streaming keeps up.
+    // Built with BLITZEN_WORLD_PARTITION_BENCHMARK (the CMake option of the same name)
+    class WorldFlythroughBenchmark
+    {
+    public:
+
+        // Fills the partition with the grid
+        void Init(WorldPartition& partition, const char* scenePath, uint32_t gridSize = BLIT_WORLD_BENCHMARK_GRID_SIZE,
+        float cameraSpeed = BLIT_WORLD_BENCHMARK_CAMERA_SPEED);
+
+        // Moves the camera and records the frame. Returns 0 once the camera has crossed the grid and the results have been logged
+        uint8_t Update(Camera& camera, WorldPartition& partition, double deltaTime);
+
+    private:
+
+        void LogResults(WorldPartition& partition);
+
+        BlitML::vec3 m_start;
+        BlitML::vec3 m_end;
+        float m_cameraSpeed = BLIT_WORLD_BENCHMARK_CAMERA_SPEED;
+        float m_travelled = 0.f;
+
+        uint32_t m_frameCount = 0;
+        uint32_t m_hitchCount = 0;
+        double m_frameTimeSum = 0.0;
+        double m_worstFrameTime = 0.0;
+    };
+}
@@ -2,42 +2,36 @@
 #include "Core/blitzenContainerLibrary.h"
 #include "Platform/filesystem.h"
 
-#include "Renderer/blitRenderer.h"
-#include "BlitzenVulkan/vulkanRenderer.h"
+// The cooker is built without the renderers, it only reads the headers to bake textures
+#ifndef BLITZEN_COOK
+	#include "Renderer/blitRenderer.h"
+	#include "BlitzenVulkan/vulkanRenderer.h"
+#endif
+
+#include <cstring>
 
 namespace BlitzenEngine
 {
-    uint8_t LoadDDSImage(const char* filepath, DDS_HEADER& header, DDS_HEADER_DXT10& header10, 
-	unsigned int& vulkanImageFormat, RendererToLoadDDS chosenRenderer, void* pData)
+    // Checks that the headers describe a 2D block compressed image that the renderer can use, and gives the size of its data
+    static uint8_t ValidateDDSHeader(DDS_HEADER& header, DDS_HEADER_DXT10& header10, unsigned int& vulkanImageFormat, 
+    RendererToLoadDDS chosenRenderer, size_t& imageSize)
     {
-		BlitzenPlatform::FileHandle handle;
-		if(!handle.Open(filepath, BlitzenPlatform::FileModes::Read, 1))
-			return 0;
-
-		FILE* file = reinterpret_cast<FILE*>(handle.pHandle);
-
-	    unsigned int magic = 0;
-
-	    if (fread(&magic, sizeof(magic), 1, file) != 1 || magic != FourCC("DDS "))
-		    return 0;
-
-	    if (fread(&header, sizeof(header), 1, file) != 1)
-		    return 0;
-
-	    if (header.ddspf.dwFourCC == FourCC("DX10") && fread(&header10, sizeof(header10), 1, file) != 1)
-		    return 0;
-
 	    if (header.dwSize != sizeof(header) || header.ddspf.dwSize != sizeof(header.ddspf))
 		    return 0;
 
 	    if (header.dwCaps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME))
 		    return 0;
 
+		// The mip count is optional, files without it hold a single level
+		if (!header.dwMipMapCount)
+			header.dwMipMapCount = 1;
+
 	    if (header.ddspf.dwFourCC == FourCC("DX10") && header10.resourceDimension != DDS_DIMENSION_TEXTURE2D)
 		    return 0;
 
 		switch (chosenRenderer)
 		{
+			#ifndef BLITZEN_COOK
 			case RendererToLoadDDS::Vulkan:
 			{
 				vulkanImageFormat = (unsigned int)BlitzenVulkan::GetDDSVulkanFormat(header, header10);
@@ -48,33 +42,16 @@ namespace BlitzenEngine
 				unsigned int blockSize =
 					(vulkanImageFormat == VK_FORMAT_BC1_RGBA_UNORM_BLOCK || vulkanImageFormat == VK_FORMAT_BC4_SNORM_BLOCK
 						|| vulkanImageFormat == VK_FORMAT_BC4_UNORM_BLOCK) ? 8 : 16;
-				size_t imageSize = GetDDSImageSizeBC(header.dwWidth, header.dwHeight, header.dwMipMapCount, blockSize);
-
-				size_t readSize = fread(pData, 1, imageSize, file);
-
-				if (!pData)
-					return 0;
-
-				if (readSize != imageSize)
-					return 0;
-
+				imageSize = GetDDSImageSizeBC(header.dwWidth, header.dwHeight, header.dwMipMapCount, blockSize);
 				return 1;
 			}
+			#endif
 
 			case RendererToLoadDDS::Opengl:
 			{
 				size_t blockSize = GetDDSBlockSize(header, header10);
-				size_t imageSize = GetDDSImageSizeBC(header.dwWidth, header.dwHeight, header.dwMipMapCount, 
+				imageSize = GetDDSImageSizeBC(header.dwWidth, header.dwHeight, header.dwMipMapCount, 
 				static_cast<unsigned int>(blockSize));
-
-				size_t readSize = fread(pData, 1, imageSize, file);
-
-				if (!pData)
-					return 0;
-
-				if (readSize != imageSize)
-					return 0;
-
 				return 1;
 			}
 
@@ -83,6 +60,101 @@ namespace BlitzenEngine
 		}
     }
 
+    uint8_t LoadDDSImage(const char* filepath, DDS_HEADER& header, DDS_HEADER_DXT10& header10, 
+	unsigned int& vulkanImageFormat, RendererToLoadDDS chosenRenderer, void* pData)
+    {
+		if (!pData)
+			return 0;
+
+		// The image data is copied straight from the mapped file, without going through a stdio buffer first
+		BlitzenPlatform::MappedFile file;
+		if (!file.Open(filepath, BlitzenPlatform::MappedFileAccess::Sequential))
+			return 0;
+
+		size_t imageOffset = 0;
+		size_t imageSize = 0;
+		if (!ParseDDSImage(file.Data(), file.GetSize(), header, header10, vulkanImageFormat, chosenRenderer, imageOffset, imageSize))
+			return 0;
+
+		memcpy(pData, file.Data() + imageOffset, imageSize);
+		return 1;
+    }
+
+	uint8_t ProbeDDSImage(DDSTextureProbe& probe, RendererToLoadDDS chosenRenderer)
+	{
+		BlitzenPlatform::FileHandle handle;
+		if (!handle.Open(probe.filepath, BlitzenPlatform::FileModes::Read, 1))
+			return 0;
+
+		FILE* file = reinterpret_cast<FILE*>(handle.pHandle);
+
+		unsigned int magic = 0;
+		if (fread(&magic, sizeof(magic), 1, file) != 1 || magic != FourCC("DDS "))
+			return 0;
+
+		if (fread(&probe.header, sizeof(probe.header), 1, file) != 1)
+			return 0;
+
+		if (probe.header.ddspf.dwFourCC == FourCC("DX10") && fread(&probe.header10, sizeof(probe.header10), 1, file) != 1)
+			return 0;
+
+		if (!ValidateDDSHeader(probe.header, probe.header10, probe.format, chosenRenderer, probe.imageSize))
+			return 0;
+
+		// Files that are cut short are caught here, before any memory is set aside for them
+		probe.imageOffset = static_cast<size_t>(ftell(file));
+		fseek(file, 0, SEEK_END);
+		long fileSize = ftell(file);
+		if (fileSize < 0 || static_cast<size_t>(fileSize) - probe.imageOffset < probe.imageSize)
+			return 0;
+
+		return 1;
+	}
+
+	uint8_t ReadDDSImageData(const DDSTextureProbe& probe, void* pData)
+	{
+		BlitzenPlatform::FileHandle handle;
+		if (!pData || !handle.Open(probe.filepath, BlitzenPlatform::FileModes::Read, 1))
+			return 0;
+
+		FILE* file = reinterpret_cast<FILE*>(handle.pHandle);
+		if (fseek(file, static_cast<long>(probe.imageOffset), SEEK_SET) != 0)
+			return 0;
+
+		return fread(pData, 1, probe.imageSize, file) == probe.imageSize;
+	}
+
+	uint8_t ParseDDSImage(const uint8_t* pFileData, size_t fileSize, DDS_HEADER& header, DDS_HEADER_DXT10& header10, 
+	unsigned int& vulkanImageFormat, RendererToLoadDDS chosenRenderer, size_t& imageOffset, size_t& imageSize)
+	{
+		unsigned int magic = 0;
+		size_t offset = sizeof(magic) + sizeof(header);
+		if (fileSize < offset)
+			return 0;
+
+		memcpy(&magic, pFileData, sizeof(magic));
+		if (magic != FourCC("DDS "))
+			return 0;
+		memcpy(&header, pFileData + sizeof(magic), sizeof(header));
+
+		if (header.ddspf.dwFourCC == FourCC("DX10"))
+		{
+			if (fileSize < offset + sizeof(header10))
+				return 0;
+			memcpy(&header10, pFileData + offset, sizeof(header10));
+			offset += sizeof(header10);
+		}
+
+		if (!ValidateDDSHeader(header, header10, vulkanImageFormat, chosenRenderer, imageSize))
+			return 0;
+
+		if (fileSize - offset < imageSize)
+			return 0;
+
+		imageOffset = offset;
+		return 1;
+	}
+
     size_t GetDDSImageSizeBC(unsigned int width, unsigned int height, unsigned int levels, unsigned int blockSize)
     {
 	    size_t result = 0;
@@ -128,6 +200,7 @@ namespace BlitzenEngine
 	    	}
 	    }
         
-	    return VK_FORMAT_UNDEFINED;
+		// Not a block compressed format that the renderers can use
+	    return 0;
 	}
 }
\ No newline at end of file
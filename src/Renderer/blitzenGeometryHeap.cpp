@@ -0,0 +1,449 @@
+#include "Renderer/blitGeometryHeap.h"
+
+#if _MSC_VER
+    #include <intrin.h>
+#endif
+
+namespace BlitzenEngine
+{
+    // Index of the highest set bit. The value cannot be 0
+    inline uint32_t FindLastSetBit(uint32_t value)
+    {
+        #if _MSC_VER
+            unsigned long index;
+            _BitScanReverse(&index, value);
+            return static_cast<uint32_t>(index);
+        #else
+            return 31 - static_cast<uint32_t>(__builtin_clz(value));
+        #endif
+    }
+
+    // Index of the lowest set bit. The value cannot be 0
+    inline uint32_t FindFirstSetBit(uint32_t value)
+    {
+        #if _MSC_VER
+            unsigned long index;
+            _BitScanForward(&index, value);
+            return static_cast<uint32_t>(index);
+        #else
+            return static_cast<uint32_t>(__builtin_ctz(value));
+        #endif
+    }
+
+    // The free list that a block of this size belongs to
+    inline void MapBlockSize(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+    {
+        if(size < BLIT_GEOMETRY_HEAP_SL_COUNT)
+        {
+            firstLevel = 0;
+            secondLevel = size;
+            return;
+        }
+
+        uint32_t highestBit = FindLastSetBit(size);
+        firstLevel = highestBit - BLIT_GEOMETRY_HEAP_SL_LOG2 + 1;
+        secondLevel = (size >> (highestBit - BLIT_GEOMETRY_HEAP_SL_LOG2)) ^ BLIT_GEOMETRY_HEAP_SL_COUNT;
+    }
+
+    void GeometryHeap::Init(uint32_t capacity)
+    {
+        m_blocks.Downsize(0);
+        m_unusedBlocks.Downsize(0);
+        m_retiredBlocks.Downsize(0);
+
+        m_firstLevelBitmap = 0;
+        for(uint32_t i = 0; i < BLIT_GEOMETRY_HEAP_FL_COUNT; ++i)
+        {
+            m_secondLevelBitmaps[i] = 0;
+            for(uint32_t j = 0; j < BLIT_GEOMETRY_HEAP_SL_COUNT; ++j)
+                m_freeLists[i][j] = BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+        }
+
+        m_capacity = capacity;
+        m_usedElements = 0;
+        m_allocationCount = 0;
+        m_freeBlockCount = 0;
+        m_firstBlock = BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+        m_lastBlock = BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+        if(!capacity)
+            return;
+
+        uint32_t block = CreateBlock();
+        m_blocks[block].offset = 0;
+        m_blocks[block].size = capacity;
+        m_firstBlock = block;
+        m_lastBlock = block;
+        InsertFreeBlock(block);
+    }
+
+    uint8_t GeometryHeap::Allocate(uint32_t elementCount, uint32_t owner, BlitCL::SlotHandle& handle, uint8_t bPinned /*=0*/)
+    {
+        handle = BlitCL::SlotHandle{};
+        if(!elementCount)
+            return 1;
+
+        uint32_t block = FindFreeBlock(elementCount);
+        if(block == BLIT_GEOMETRY_HEAP_NULL_BLOCK)
+            return 0;
+        RemoveFreeBlock(block);
+
+        // What the allocation does not use goes back to the free lists
+        if(m_blocks[block].size > elementCount)
+        {
+            uint32_t remainder = CreateBlock();
+            Block& used = m_blocks[block];
+            Block& rest = m_blocks[remainder];
+            rest.offset = used.offset + elementCount;
+            rest.size = used.size - elementCount;
+            rest.prevPhysical = block;
+            rest.nextPhysical = used.nextPhysical;
+            if(rest.nextPhysical != BLIT_GEOMETRY_HEAP_NULL_BLOCK)
+                m_blocks[rest.nextPhysical].prevPhysical = remainder;
+            else
+                m_lastBlock = remainder;
+            used.nextPhysical = remainder;
+            used.size = elementCount;
+            InsertFreeBlock(remainder);
+        }
+
+        Block& allocated = m_blocks[block];
+        allocated.bFree = 0;
+        allocated.bPinned = bPinned;
+        allocated.owner = owner;
+        allocated.compactionPass = 0;
+
+        m_usedElements += elementCount;
+        m_allocationCount++;
+
+        handle.index = block;
+        handle.generation = allocated.generation;
+        return 1;
+    }
+
+    void GeometryHeap::Free(BlitCL::SlotHandle handle)
+    {
+        if(handle.index >= m_blocks.GetSize() || m_blocks[handle.index].generation != handle.generation || m_blocks[handle.index].bFree)
+            return;
+
+        m_usedElements -= m_blocks[handle.index].size;
+        m_allocationCount--;
+        FreeBlock(handle.index);
+    }
+
+    uint32_t GeometryHeap::GetOffset(BlitCL::SlotHandle handle)
+    {
+        if(handle.index >= m_blocks.GetSize() || m_blocks[handle.index].generation != handle.generation || m_blocks[handle.index].bFree)
+            return 0;
+        return m_blocks[handle.index].offset;
+    }
+
+    void GeometryHeap::Compact(uint32_t elementBudget, BlitCL::DynamicArray<GeometryMove>& moves)
+    {
+        // The renderer has recorded the copies out of these blocks by now
+        for(size_t i = 0; i < m_retiredBlocks.GetSize(); ++i)
+        {
+            m_usedElements -= m_blocks[m_retiredBlocks[i]].size;
+            FreeBlock(m_retiredBlocks[i]);
+        }
+        m_retiredBlocks.Downsize(0);
+
+        if(!elementBudget)
+            return;
+        m_compactionPass++;
+
+        // Allocations are taken from the end of the heap to a free block before them that fits them.
+        // The first one is moved even if it is bigger than the budget, so that big allocations are not stuck
+        uint32_t movedElements = 0;
+        uint32_t block = m_lastBlock;
+        while(block != BLIT_GEOMETRY_HEAP_NULL_BLOCK && movedElements < elementBudget)
+        {
+            Block& candidate = m_blocks[block];
+            uint32_t target = BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+            if(!candidate.bFree && !candidate.bPinned && candidate.compactionPass != m_compactionPass &&
+            (!movedElements || candidate.size <= elementBudget - movedElements))
+                target = FindFitBelow(candidate.size, candidate.offset);
+
+            if(target == BLIT_GEOMETRY_HEAP_NULL_BLOCK)
+            {
+                block = candidate.prevPhysical;
+                continue;
+            }
+
+            // The old place is held by a retired block, the allocation keeps its block (and handle) in the new place
+            uint32_t retired = CreateBlock();
+            RemoveFreeBlock(target);
+            Block& moved = m_blocks[block];
+            Block& destination = m_blocks[target];
+            Block& old = m_blocks[retired];
+
+            old.offset = moved.offset;
+            old.size = moved.size;
+            old.prevPhysical = moved.prevPhysical;
+            old.nextPhysical = moved.nextPhysical;
+            old.bFree = 0;
+            old.bPinned = 1;
+            old.owner = BLIT_GEOMETRY_HEAP_NO_OWNER;
+            if(old.prevPhysical != BLIT_GEOMETRY_HEAP_NULL_BLOCK)
+                m_blocks[old.prevPhysical].nextPhysical = retired;
+            else
+                m_firstBlock = retired;
+            if(old.nextPhysical != BLIT_GEOMETRY_HEAP_NULL_BLOCK)
+                m_blocks[old.nextPhysical].prevPhysical = retired;
+            else
+                m_lastBlock = retired;
+
+            GeometryMove move;
+            move.owner = moved.owner;
+            move.range = {moved.offset, destination.offset, moved.size};
+            moves.PushBack(move);
+
+            moved.offset = destination.offset;
+            moved.prevPhysical = destination.prevPhysical;
+            if(moved.prevPhysical != BLIT_GEOMETRY_HEAP_NULL_BLOCK)
+                m_blocks[moved.prevPhysical].nextPhysical = block;
+            else
+                m_firstBlock = block;
+            if(destination.size == moved.size)
+            {
+                moved.nextPhysical = destination.nextPhysical;
+                if(moved.nextPhysical != BLIT_GEOMETRY_HEAP_NULL_BLOCK)
+                    m_blocks[moved.nextPhysical].prevPhysical = block;
+                else
+                    m_lastBlock = block;
+                ReleaseBlock(target);
+            }
+            else
+            {
+                destination.offset += moved.size;
+                destination.size -= moved.size;
+                destination.prevPhysical = block;
+                moved.nextPhysical = target;
+                InsertFreeBlock(target);
+            }
+            moved.compactionPass = m_compactionPass;
+
+            // Both copies are held until the next pass frees the old one
+            m_usedElements += moved.size;
+            m_retiredBlocks.PushBack(retired);
+            movedElements += moved.size;
+
+            block = m_blocks[retired].prevPhysical;
+        }
+    }
+
+    GeometryHeapStats GeometryHeap::GetStats()
+    {
+        GeometryHeapStats stats;
+        stats.capacity = m_capacity;
+        stats.usedElements = m_usedElements;
+        stats.allocationCount = m_allocationCount;
+        stats.freeBlockCount = m_freeBlockCount;
+
+        // The largest free block is in the highest list that is not empty
+        if(m_firstLevelBitmap)
+        {
+            uint32_t firstLevel = FindLastSetBit(m_firstLevelBitmap);
+            uint32_t secondLevel = FindLastSetBit(m_secondLevelBitmaps[firstLevel]);
+            for(uint32_t block = m_freeLists[firstLevel][secondLevel]; block != BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+            block = m_blocks[block].nextFree)
+                stats.largestFreeBlock = BlitML::Max(stats.largestFreeBlock, m_blocks[block].size);
+        }
+
+        return stats;
+    }
+
+    uint32_t GeometryHeap::CreateBlock()
+    {
+        uint32_t block;
+        if(m_unusedBlocks.GetSize())
+        {
+            block = m_unusedBlocks.Back();
+            m_unusedBlocks.Downsize(m_unusedBlocks.GetSize() - 1);
+        }
+        else
+        {
+            block = static_cast<uint32_t>(m_blocks.GetSize());
+            m_blocks.PushBack(Block{});
+        }
+
+        // The generation is kept, so that handles to the block's previous allocations stay invalid
+        Block& newBlock = m_blocks[block];
+        newBlock.offset = 0;
+        newBlock.size = 0;
+        newBlock.prevPhysical = BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+        newBlock.nextPhysical = BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+        newBlock.prevFree = BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+        newBlock.nextFree = BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+        newBlock.owner = BLIT_GEOMETRY_HEAP_NO_OWNER;
+        newBlock.bFree = 1;
+        newBlock.bPinned = 0;
+        newBlock.compactionPass = 0;
+        return block;
+    }
+
+    void GeometryHeap::ReleaseBlock(uint32_t block)
+    {
+        m_blocks[block].bFree = 1;
+        m_blocks[block].generation++;
+        m_unusedBlocks.PushBack(block);
+    }
+
+    void GeometryHeap::InsertFreeBlock(uint32_t block)
+    {
+        Block& freeBlock = m_blocks[block];
+        freeBlock.bFree = 1;
+
+        uint32_t firstLevel;
+        uint32_t secondLevel;
+        MapBlockSize(freeBlock.size, firstLevel, secondLevel);
+
+        uint32_t head = m_freeLists[firstLevel][secondLevel];
+        freeBlock.prevFree = BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+        freeBlock.nextFree = head;
+        if(head != BLIT_GEOMETRY_HEAP_NULL_BLOCK)
+            m_blocks[head].prevFree = block;
+        m_freeLists[firstLevel][secondLevel] = block;
+
+        m_firstLevelBitmap |= 1u << firstLevel;
+        m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+        m_freeBlockCount++;
+    }
+
+    void GeometryHeap::RemoveFreeBlock(uint32_t block)
+    {
+        Block& freeBlock = m_blocks[block];
+
+        uint32_t firstLevel;
+        uint32_t secondLevel;
+        MapBlockSize(freeBlock.size, firstLevel, secondLevel);
+
+        if(freeBlock.prevFree != BLIT_GEOMETRY_HEAP_NULL_BLOCK)
+            m_blocks[freeBlock.prevFree].nextFree = freeBlock.nextFree;
+        else
+            m_freeLists[firstLevel][secondLevel] = freeBlock.nextFree;
+        if(freeBlock.nextFree != BLIT_GEOMETRY_HEAP_NULL_BLOCK)
+            m_blocks[freeBlock.nextFree].prevFree = freeBlock.prevFree;
+
+        if(m_freeLists[firstLevel][secondLevel] == BLIT_GEOMETRY_HEAP_NULL_BLOCK)
+        {
+            m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+            if(!m_secondLevelBitmaps[firstLevel])
+                m_firstLevelBitmap &= ~(1u << firstLevel);
+        }
+
+        freeBlock.prevFree = BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+        freeBlock.nextFree = BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+        freeBlock.bFree = 0;
+        m_freeBlockCount--;
+    }
+
+    void GeometryHeap::FreeBlock(uint32_t block)
+    {
+        // Handles to the allocation are not valid after this
+        m_blocks[block].generation++;
+
+        uint32_t prev = m_blocks[block].prevPhysical;
+        if(prev != BLIT_GEOMETRY_HEAP_NULL_BLOCK && m_blocks[prev].bFree)
+        {
+            RemoveFreeBlock(prev);
+            m_blocks[prev].size += m_blocks[block].size;
+            m_blocks[prev].nextPhysical = m_blocks[block].nextPhysical;
+            if(m_blocks[prev].nextPhysical != BLIT_GEOMETRY_HEAP_NULL_BLOCK)
+                m_blocks[m_blocks[prev].nextPhysical].prevPhysical = prev;
+            else
+                m_lastBlock = prev;
+            ReleaseBlock(block);
+            block = prev;
+        }
+
+        uint32_t next = m_blocks[block].nextPhysical;
+        if(next != BLIT_GEOMETRY_HEAP_NULL_BLOCK && m_blocks[next].bFree)
+        {
+            RemoveFreeBlock(next);
+            m_blocks[block].size += m_blocks[next].size;
+            m_blocks[block].nextPhysical = m_blocks[next].nextPhysical;
+            if(m_blocks[block].nextPhysical != BLIT_GEOMETRY_HEAP_NULL_BLOCK)
+                m_blocks[m_blocks[block].nextPhysical].prevPhysical = block;
+            else
+                m_lastBlock = block;
+            ReleaseBlock(next);
+        }
+
+        InsertFreeBlock(block);
+    }
+
+    uint32_t GeometryHeap::FindFreeBlock(uint32_t elementCount)
+    {
+        // The size is rounded up to the next second level step, so that any block of the list that is found fits
+        uint32_t searchSize = elementCount;
+        if(elementCount >= BLIT_GEOMETRY_HEAP_SL_COUNT)
+        {
+            uint32_t roundUp = (1u << (FindLastSetBit(elementCount) - BLIT_GEOMETRY_HEAP_SL_LOG2)) - 1;
+            searchSize = elementCount > UINT32_MAX - roundUp ? UINT32_MAX : elementCount + roundUp;
+        }
+
+        uint32_t firstLevel;
+        uint32_t secondLevel;
+        MapBlockSize(searchSize, firstLevel, secondLevel);
+
+        // Bigger lists of the same first level are checked first, then the smallest first level above it
+        uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+        if(!secondLevelMap)
+        {
+            uint32_t firstLevelMap = firstLevel + 1 < BLIT_GEOMETRY_HEAP_FL_COUNT ? m_firstLevelBitmap & (~0u << (firstLevel + 1)) : 0;
+            if(firstLevelMap)
+            {
+                firstLevel = FindFirstSetBit(firstLevelMap);
+                secondLevelMap = m_secondLevelBitmaps[firstLevel];
+            }
+        }
+        if(secondLevelMap)
+            return m_freeLists[firstLevel][secondLevel = FindFirstSetBit(secondLevelMap)];
+
+        // When the heap is nearly full, the list of the exact size can still hold a block that fits
+        MapBlockSize(elementCount, firstLevel, secondLevel);
+        for(uint32_t block = m_freeLists[firstLevel][secondLevel]; block != BLIT_GEOMETRY_HEAP_NULL_BLOCK; 
+        block = m_blocks[block].nextFree)
+        {
+            if(m_blocks[block].size >= elementCount)
+                return block;
+        }
+        return BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+    }
+
+    uint32_t GeometryHeap::FindFitBelow(uint32_t size, uint32_t limit)
+    {
+        // The lists that can only hold blocks that fit are searched from the smallest, like allocations
+        uint32_t searchSize = size;
+        if(size >= BLIT_GEOMETRY_HEAP_SL_COUNT)
+        {
+            uint32_t roundUp = (1u << (FindLastSetBit(size) - BLIT_GEOMETRY_HEAP_SL_LOG2)) - 1;
+            searchSize = size > UINT32_MAX - roundUp ? UINT32_MAX : size + roundUp;
+        }
+        uint32_t firstLevel;
+        uint32_t secondLevel;
+        MapBlockSize(searchSize, firstLevel, secondLevel);
+
+        uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+        while(1)
+        {
+            while(secondLevelMap)
+            {
+                secondLevel = FindFirstSetBit(secondLevelMap);
+                secondLevelMap &= secondLevelMap - 1;
+                for(uint32_t block = m_freeLists[firstLevel][secondLevel]; block != BLIT_GEOMETRY_HEAP_NULL_BLOCK; 
+                block = m_blocks[block].nextFree)
+                {
+                    if(m_blocks[block].offset < limit)
+                        return block;
+                }
+            }
+
+            uint32_t firstLevelMap = firstLevel + 1 < BLIT_GEOMETRY_HEAP_FL_COUNT ? m_firstLevelBitmap & (~0u << (firstLevel + 1)) : 0;
+            if(!firstLevelMap)
+                return BLIT_GEOMETRY_HEAP_NULL_BLOCK;
+            firstLevel = FindFirstSetBit(firstLevelMap);
+            secondLevelMap = m_secondLevelBitmaps[firstLevel];
+        }
+    }
+}
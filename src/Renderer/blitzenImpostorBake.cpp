@@ -0,0 +1,256 @@
+#include "Renderer/blitImpostorBake.h"
+#include "Renderer/blitTextureBake.h"
+#include "Core/blitLogger.h"
+#include "Core/blitzenContainerLibrary.h"
+#include "BlitzenMathLibrary/blitML.h"
+
+// The implementation is compiled in blitzenRenderingResources.cpp
+#include "VendorCode/stb_image.h"
+
+#include "Meshoptimizer/meshoptimizer.h"
+
+#include <cmath>
+
+// Depth of the texels that no triangle covered
+#define BLIT_IMPOSTOR_EMPTY_DEPTH   -1e30f
+
+namespace BlitzenEngine
+{
+    static float SignNotZero(float x) { return x >= 0.f ? 1.f : -1.f; }
+
+    // The center of the cell on the octahedral map, folded back to the sphere. Needs to match OctahedralDecode in the vertex shader
+    static BlitML::vec3 GetImpostorFrameDirection(uint32_t cellX, uint32_t cellY)
+    {
+        float x = (float(cellX) + 0.5f) / BLIT_IMPOSTOR_GRID * 2.f - 1.f;
+        float z = (float(cellY) + 0.5f) / BLIT_IMPOSTOR_GRID * 2.f - 1.f;
+        float y = 1.f - fabsf(x) - fabsf(z);
+        if(y < 0.f)
+        {
+            float foldedX = (1.f - fabsf(z)) * SignNotZero(x);
+            z = (1.f - fabsf(x)) * SignNotZero(z);
+            x = foldedX;
+        }
+        return BlitML::GetNormalized(BlitML::vec3(x, y, z));
+    }
+
+    // The frame looks at the surface from the direction. Needs to match GetImpostorAxes in the vertex shader
+    static void GetImpostorFrameAxes(const BlitML::vec3& direction, BlitML::vec3& right, BlitML::vec3& up)
+    {
+        BlitML::vec3 reference = fabsf(direction.y) > 0.999f ? BlitML::vec3(0.f, 0.f, 1.f) : BlitML::vec3(0.f, 1.f, 0.f);
+        right = BlitML::GetNormalized(BlitML::Cross(reference, direction));
+        up = BlitML::Cross(direction, right);
+    }
+
+    static int32_t ClampTexel(float value, int32_t size)
+    {
+        int32_t texel = static_cast<int32_t>(floorf(value));
+        return texel < 0 ? 0 : texel >= size ? size - 1 : texel;
+    }
+
+    static BlitML::vec3 UnpackNormal(const Vertex& vertex)
+    {
+        return BlitML::vec3(vertex.normalX / 127.f - 1.f, vertex.normalY / 127.f - 1.f, vertex.normalZ / 127.f - 1.f);
+    }
+
+    static uint8_t PackUnorm8(float value)
+    {
+        value = value < -1.f ? -1.f : value > 1.f ? 1.f : value;
+        return static_cast<uint8_t>((value * 0.5f + 0.5f) * 255.f + 0.5f);
+    }
+
+    // Empty texels next to covered ones take the average of their covered neighbours in the same frame. Their alpha stays 0
+    static void DilateImpostorFrames(BlitCL::DynamicArray<uint8_t>& colors, BlitCL::DynamicArray<uint8_t>& normals,
+    BlitCL::DynamicArray<uint8_t>& filled, uint32_t atlasSize)
+    {
+        const uint32_t frameSize = BLIT_IMPOSTOR_FRAME_SIZE;
+        BlitCL::DynamicArray<uint8_t> filledBefore(filled);
+        for(uint32_t y = 0; y < atlasSize; ++y)
+        {
+            for(uint32_t x = 0; x < atlasSize; ++x)
+            {
+                size_t texel = size_t(y) * atlasSize + x;
+                if(filledBefore[texel])
+                    continue;
+
+                uint32_t sums[6] = {};
+                uint32_t count = 0;
+                for(int32_t dy = -1; dy <= 1; ++dy)
+                {
+                    for(int32_t dx = -1; dx <= 1; ++dx)
+                    {
+                        int32_t nx = int32_t(x) + dx;
+                        int32_t ny = int32_t(y) + dy;
+                        if(nx < 0 || ny < 0 || nx >= int32_t(atlasSize) || ny >= int32_t(atlasSize) ||
+                        uint32_t(nx) / frameSize != x / frameSize || uint32_t(ny) / frameSize != y / frameSize)
+                            continue;
+
+                        size_t neighbour = size_t(ny) * atlasSize + uint32_t(nx);
+                        if(!filledBefore[neighbour])
+                            continue;
+                        for(uint32_t c = 0; c < 3; ++c)
+                        {
+                            sums[c] += colors[neighbour * 4 + c];
+                            sums[3 + c] += normals[neighbour * 4 + c];
+                        }
+                        ++count;
+                    }
+                }
+                if(!count)
+                    continue;
+
+                for(uint32_t c = 0; c < 3; ++c)
+                {
+                    colors[texel * 4 + c] = static_cast<uint8_t>(sums[c] / count);
+                    normals[texel * 4 + c] = static_cast<uint8_t>(sums[3 + c] / count);
+                }
+                filled[texel] = 1;
+            }
+        }
+    }
+
+    uint8_t BakeImpostorAtlases(const Vertex* pVertices, const uint32_t* pIndices, size_t indexCount, const BlitML::vec3& center,
+    float radius, const char* albedoSourcePath, const char* colorPath, const char* normalPath)
+    {
+        if(radius <= 0.f || indexCount < 3)
+            return 0;
+
+        const uint32_t frameSize = BLIT_IMPOSTOR_FRAME_SIZE;
+        const uint32_t atlasSize = BLIT_IMPOSTOR_GRID * frameSize;
+        size_t texelCount = size_t(atlasSize) * atlasSize;
+
+        int albedoWidth = 0;
+        int albedoHeight = 0;
+        int channels = 0;
+        stbi_uc* pAlbedo = albedoSourcePath ? stbi_load(albedoSourcePath, &albedoWidth, &albedoHeight, &channels, 4) : nullptr;
+        if(albedoSourcePath && !pAlbedo)
+            BLIT_WARN("Failed to decode impostor albedo: %s (%s), the impostor will be gray", albedoSourcePath, stbi_failure_reason())
+
+        // Empty texels are transparent, with the gray that the fragment shader uses without a texture and a normal facing the view
+        BlitCL::DynamicArray<uint8_t> colors(texelCount * 4);
+        BlitCL::DynamicArray<uint8_t> normals(texelCount * 4);
+        BlitCL::DynamicArray<float> depths(texelCount);
+        for(size_t i = 0; i < texelCount; ++i)
+        {
+            colors[i * 4 + 0] = colors[i * 4 + 1] = colors[i * 4 + 2] = 128;
+            colors[i * 4 + 3] = 0;
+            normals[i * 4 + 0] = normals[i * 4 + 1] = 128;
+            normals[i * 4 + 2] = normals[i * 4 + 3] = 255;
+            depths[i] = BLIT_IMPOSTOR_EMPTY_DEPTH;
+        }
+
+        // The bounding sphere fills each frame
+        float toFrame = 0.5f * frameSize / radius;
+        float frameCenter = 0.5f * frameSize;
+
+        for(uint32_t cellY = 0; cellY < BLIT_IMPOSTOR_GRID; ++cellY)
+        {
+            for(uint32_t cellX = 0; cellX < BLIT_IMPOSTOR_GRID; ++cellX)
+            {
+                BlitML::vec3 direction = GetImpostorFrameDirection(cellX, cellY);
+                BlitML::vec3 right;
+                BlitML::vec3 up;
+                GetImpostorFrameAxes(direction, right, up);
+
+                uint32_t originX = cellX * frameSize;
+                uint32_t originY = cellY * frameSize;
+
+                for(size_t t = 0; t + 2 < indexCount; t += 3)
+                {
+                    const Vertex* pTriangle[3] = {&pVertices[pIndices[t]], &pVertices[pIndices[t + 1]], &pVertices[pIndices[t + 2]]};
+
+                    // Frame texels with y going down, and the distance towards the view as depth
+                    float sx[3], sy[3], sz[3];
+                    for(uint32_t k = 0; k < 3; ++k)
+                    {
+                        BlitML::vec3 offset = pTriangle[k]->position - center;
+                        sx[k] = frameCenter + BlitML::Dot(offset, right) * toFrame;
+                        sy[k] = frameCenter - BlitML::Dot(offset, up) * toFrame;
+                        sz[k] = BlitML::Dot(offset, direction);
+                    }
+
+                    float area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sy[1] - sy[0]) * (sx[2] - sx[0]);
+                    if(fabsf(area) < 1e-8f)
+                        continue;
+
+                    int32_t minX = ClampTexel(BlitML::Min(sx[0], BlitML::Min(sx[1], sx[2])), int32_t(frameSize));
+                    int32_t minY = ClampTexel(BlitML::Min(sy[0], BlitML::Min(sy[1], sy[2])), int32_t(frameSize));
+                    int32_t maxX = ClampTexel(BlitML::Max(sx[0], BlitML::Max(sx[1], sx[2])), int32_t(frameSize));
+                    int32_t maxY = ClampTexel(BlitML::Max(sy[0], BlitML::Max(sy[1], sy[2])), int32_t(frameSize));
+
+                    // Texel centers are tested against the edges, dividing by the area makes the test work for both windings
+                    for(int32_t y = minY; y <= maxY; ++y)
+                    {
+                        for(int32_t x = minX; x <= maxX; ++x)
+                        {
+                            float px = float(x) + 0.5f;
+                            float py = float(y) + 0.5f;
+                            float w0 = ((sx[2] - sx[1]) * (py - sy[1]) - (sy[2] - sy[1]) * (px - sx[1])) / area;
+                            float w1 = ((sx[0] - sx[2]) * (py - sy[2]) - (sy[0] - sy[2]) * (px - sx[2])) / area;
+                            float w2 = 1.f - w0 - w1;
+                            if(w0 < 0.f || w1 < 0.f || w2 < 0.f)
+                                continue;
+
+                            size_t texel = size_t(originY + y) * atlasSize + originX + x;
+                            float depth = w0 * sz[0] + w1 * sz[1] + w2 * sz[2];
+                            if(depth <= depths[texel])
+                                continue;
+                            depths[texel] = depth;
+
+                            // The normal is stored in the space of the frame, so the billboard can rotate it with its own axes
+                            BlitML::vec3 normal = UnpackNormal(*pTriangle[0]) * w0 + UnpackNormal(*pTriangle[1]) * w1 +
+                            UnpackNormal(*pTriangle[2]) * w2;
+                            BlitML::vec3 local(BlitML::Dot(normal, right), BlitML::Dot(normal, up),
+                            BlitML::Max(BlitML::Dot(normal, direction), 0.f));
+                            float length = BlitML::Length(local);
+                            local = length > 1e-6f ? local / length : BlitML::vec3(0.f, 0.f, 1.f);
+                            normals[texel * 4 + 0] = PackUnorm8(local.x);
+                            normals[texel * 4 + 1] = PackUnorm8(local.y);
+                            normals[texel * 4 + 2] = PackUnorm8(local.z);
+
+                            if(pAlbedo)
+                            {
+                                float u = 0.f;
+                                float v = 0.f;
+                                float weights[3] = {w0, w1, w2};
+                                for(uint32_t k = 0; k < 3; ++k)
+                                {
+                                    u += meshopt_dequantizeHalf(pTriangle[k]->uvX) * weights[k];
+                                    v += meshopt_dequantizeHalf(pTriangle[k]->uvY) * weights[k];
+                                }
+                                u -= floorf(u);
+                                v -= floorf(v);
+                                int32_t tx = ClampTexel(u * albedoWidth, albedoWidth);
+                                int32_t ty = ClampTexel(v * albedoHeight, albedoHeight);
+                                const stbi_uc* pTexel = pAlbedo + (size_t(ty) * albedoWidth + tx) * 4;
+                                for(uint32_t c = 0; c < 4; ++c)
+                                    colors[texel * 4 + c] = pTexel[c];
+                            }
+                            else
+                            {
+                                colors[texel * 4 + 0] = colors[texel * 4 + 1] = colors[texel * 4 + 2] = 128;
+                                colors[texel * 4 + 3] = 255;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        if(pAlbedo)
+            stbi_image_free(pAlbedo);
+
+        BlitCL::DynamicArray<uint8_t> filled(texelCount);
+        for(size_t i = 0; i < texelCount; ++i)
+            filled[i] = depths[i] != BLIT_IMPOSTOR_EMPTY_DEPTH;
+        for(uint32_t i = 0; i < BLIT_IMPOSTOR_DILATION_PASSES; ++i)
+            DilateImpostorFrames(colors, normals, filled, atlasSize);
+
+        if(!BakeTexturePixels(colors.Data(), atlasSize, atlasSize, colorPath, TextureBakeUsage::Color) ||
+        !BakeTexturePixels(normals.Data(), atlasSize, atlasSize, normalPath, TextureBakeUsage::Normal))
+            return 0;
+
+        BLIT_INFO("Baked impostor atlases %s and %s (%u frames of %ux%u)", colorPath, normalPath,
+        BLIT_IMPOSTOR_GRID * BLIT_IMPOSTOR_GRID, frameSize, frameSize)
+        return 1;
+    }
+}
@@ -98,6 +98,66 @@ namespace BlitzenEngine
             return 0;
         }
 
+        // Runtime changes write to the resources' arrays and are tracked so that only the changed parts are uploaded
+        m_pResources = pResources;
+        m_transformUpdates.Resize(static_cast<uint32_t>(pResources->transforms.GetSize()));
+        m_renderObjectUpdates.Resize(static_cast<uint32_t>(pResources->renders.GetSize()));
+        m_meshInstanceUpdates.Resize(static_cast<uint32_t>(pResources->meshInstances.GetSize()));
+        m_instanceObjectUpdates.Resize(static_cast<uint32_t>(pResources->instanceObjects.GetSize()));
+
+        // The renderers create their buffers with space for objects that are added at runtime and for the scenes that are being streamed
+        uint8_t bStreaming = m_bStreamingRequested;
+        BufferCapacities& capacities = pResources->capacities;
+
+        uint32_t renderObjectCount = static_cast<uint32_t>(pResources->renders.GetSize());
+        uint32_t renderObjectCapacity = renderObjectCount + BLIT_RUNTIME_RENDER_OBJECT_HEADROOM + 
+        (bStreaming ? BLIT_STREAMING_RENDER_OBJECT_HEADROOM : 0);
+        capacities.renderObjects = renderObjectCapacity > BLITZEN_MAX_DRAW_OBJECTS ? 
+        BlitML::Max(renderObjectCount, static_cast<uint32_t>(BLITZEN_MAX_DRAW_OBJECTS)) : renderObjectCapacity;
+        capacities.meshInstances = static_cast<uint32_t>(pResources->meshInstances.GetSize()) + BLIT_RUNTIME_MESH_INSTANCE_HEADROOM + 
+        (bStreaming ? BLIT_STREAMING_MESH_INSTANCE_HEADROOM : 0);
+        capacities.instanceObjects = static_cast<uint32_t>(pResources->instanceObjects.GetSize()) + BLIT_RUNTIME_RENDER_OBJECT_HEADROOM + 
+        (bStreaming ? BLIT_STREAMING_RENDER_OBJECT_HEADROOM : 0);
+
+        capacities.vertices = static_cast<uint32_t>(pResources->vertices.GetSize()) + (bStreaming ? BLIT_STREAMING_VERTEX_HEADROOM : 0);
+        capacities.indices = static_cast<uint32_t>(pResources->indices.GetSize()) + (bStreaming ? BLIT_STREAMING_INDEX_HEADROOM : 0);
+        capacities.meshlets = static_cast<uint32_t>(pResources->meshlets.GetSize()) + (bStreaming ? BLIT_STREAMING_MESHLET_HEADROOM : 0);
+        capacities.meshletData = static_cast<uint32_t>(pResources->meshletData.GetSize()) + 
+        (bStreaming ? BLIT_STREAMING_MESHLET_DATA_HEADROOM : 0);
+        capacities.surfaces = static_cast<uint32_t>(pResources->surfaces.GetSize()) + (bStreaming ? BLIT_STREAMING_SURFACE_HEADROOM : 0);
+
+        uint32_t materialCount = static_cast<uint32_t>(pResources->materials.GetSize());
+        uint32_t materialCapacity = materialCount + (bStreaming ? BLIT_STREAMING_MATERIAL_HEADROOM : 0);
+        capacities.materials = materialCapacity > BLIT_MAX_MATERIAL_COUNT ? 
+        BlitML::Max(materialCount, static_cast<uint32_t>(BLIT_MAX_MATERIAL_COUNT)) : materialCapacity;
+        uint32_t textureCount = static_cast<uint32_t>(pResources->textures.GetSize());
+        uint32_t textureCapacity = textureCount + (bStreaming ? BLIT_STREAMING_TEXTURE_HEADROOM : 0);
+        capacities.textures = textureCapacity > BLIT_MAX_TEXTURE_COUNT ? 
+        BlitML::Max(textureCount, static_cast<uint32_t>(BLIT_MAX_TEXTURE_COUNT)) : textureCapacity;
+
+        // Streamed geometry is placed after what the renderers are given now, the arrays themselves are released below
+        pResources->gpuVertexCount = static_cast<uint32_t>(pResources->vertices.GetSize());
+        pResources->gpuIndexCount = static_cast<uint32_t>(pResources->indices.GetSize());
+        pResources->gpuMeshletCount = static_cast<uint32_t>(pResources->meshlets.GetSize());
+        pResources->gpuMeshletDataCount = static_cast<uint32_t>(pResources->meshletData.GetSize());
+
+        // What comes after is handed out to streamed scenes and runtime objects, and given back when they are removed.
+        // The geometry given at setup is pinned, its offsets are baked in the surfaces and meshlets
+        GeometryHeap* geometryHeaps[5] = {&m_vertexHeap, &m_indexHeap, &m_meshletHeap, &m_meshletDataHeap, &m_surfaceHeap};
+        uint32_t geometryCapacities[5] = {capacities.vertices, capacities.indices, capacities.meshlets, capacities.meshletData, 
+        capacities.surfaces};
+        uint32_t setupGeometryCounts[5] = {pResources->gpuVertexCount, pResources->gpuIndexCount, pResources->gpuMeshletCount, 
+        pResources->gpuMeshletDataCount, static_cast<uint32_t>(pResources->surfaces.GetSize())};
+        for(uint32_t i = 0; i < BLIT_ARRAY_SIZE(geometryHeaps); ++i)
+        {
+            BlitCL::SlotHandle setupGeometry;
+            geometryHeaps[i]->Init(geometryCapacities[i]);
+            geometryHeaps[i]->Allocate(setupGeometryCounts[i], BLIT_GEOMETRY_HEAP_NO_OWNER, setupGeometry, 1);
+        }
+        m_materialRanges.Init(materialCount, capacities.materials);
+        pResources->textureSlots.Init(textureCount, capacities.textures);
+        m_instanceObjectRanges.Init(static_cast<uint32_t>(pResources->instanceObjects.GetSize()), capacities.instanceObjects);
+
         uint8_t isThereRendererOnStandby = 0;
 
         if(bVk)
@@ -126,6 +186,24 @@ namespace BlitzenEngine
         }
         #endif
 
+        // Every renderer has its own copy of the geometry now, so the CPU one can go
+        if(isThereRendererOnStandby)
+        {
+            size_t residentBytes = 0;
+            size_t peakResidentBytes = 0;
+            uint8_t bMemoryUsage = BlitzenPlatform::PlatformGetMemoryUsage(residentBytes, peakResidentBytes);
+
+            size_t releasedBytes = ReleaseUploadedGeometry(pResources);
+            BLIT_INFO("Released %.1f MB of CPU geometry after upload", releasedBytes / (1024.0 * 1024.0))
+
+            size_t steadyResidentBytes = 0;
+            if(bMemoryUsage && BlitzenPlatform::PlatformGetMemoryUsage(steadyResidentBytes, peakResidentBytes))
+            {
+                BLIT_INFO("Host memory: %.1f MB peak, %.1f MB before release, %.1f MB steady state", 
+                peakResidentBytes / (1024.0 * 1024.0), residentBytes / (1024.0 * 1024.0), steadyResidentBytes / (1024.0 * 1024.0))
+            }
+        }
+
         return isThereRendererOnStandby;
     }
 
@@ -138,15 +216,69 @@ namespace BlitzenEngine
             return;
         }
 
+        // Streamed scenes fill in a few chunks at a time. Only Vulkan receives them for now.
+        // The geometry of unloaded scenes leaves holes that are compacted first
+        if(activeRenderer == ActiveRenderer::Vulkan && m_bStreamingRequested)
+            CompactGeometry();
+        if(activeRenderer == ActiveRenderer::Vulkan && CommitStreamedChunks())
+            drawCount = static_cast<uint32_t>(m_pResources->renders.GetSize());
+
+        // The changes since the last frame are turned to ranges for the active renderer. Only Vulkan uploads them for now
+        BuildUpdateRanges();
+
         // Call draw frame for the active renderer
         switch(activeRenderer)
         {
             case ActiveRenderer::Vulkan:
             {
-                BlitzenVulkan::DrawContext vkContext{ &camera, drawCount, occlusionCullingOn, lodEnabled };
+                BlitzenVulkan::DrawContext vkContext{ &camera, drawCount, occlusionCullingOn, lodEnabled, instancingEnabled, meshShadingEnabled };
+
+                vkContext.opaqueObjectCount = m_pResources->opaqueRenderObjectCount;
+                vkContext.meshInstanceCount = static_cast<uint32_t>(m_pResources->meshInstances.GetSize());
+
+                // Gives the parts of the scene that changed since the last frame
+                vkContext.transformUpdate = {m_pResources->transforms.Data(), m_transformUpdates.GetRanges(), 
+                m_transformUpdates.GetRangeCount()};
+                vkContext.renderObjectUpdate = {m_pResources->renders.Data(), m_renderObjectUpdates.GetRanges(), 
+                m_renderObjectUpdates.GetRangeCount()};
+                vkContext.meshInstanceUpdate = {m_pResources->meshInstances.Data(), m_meshInstanceUpdates.GetRanges(), 
+                m_meshInstanceUpdates.GetRangeCount()};
+                vkContext.instanceObjectUpdate = {m_pResources->instanceObjects.Data(), m_instanceObjectUpdates.GetRanges(), 
+                m_instanceObjectUpdates.GetRangeCount()};
+
+                // Gives the geometry and materials of the chunks that were committed this frame, packed since the resources do not keep them
+                vkContext.surfaceCount = static_cast<uint32_t>(m_pResources->surfaces.GetSize());
+                vkContext.vertexUpdate = {m_vertexAppends.GetData(), m_vertexAppends.GetRanges(), m_vertexAppends.GetRangeCount(), 1};
+                vkContext.indexUpdate = {m_indexAppends.GetData(), m_indexAppends.GetRanges(), m_indexAppends.GetRangeCount(), 1};
+                vkContext.meshletUpdate = {m_meshletAppends.GetData(), m_meshletAppends.GetRanges(), m_meshletAppends.GetRangeCount(), 1};
+                vkContext.meshletDataUpdate = {m_meshletDataAppends.GetData(), m_meshletDataAppends.GetRanges(), 
+                m_meshletDataAppends.GetRangeCount(), 1};
+                vkContext.surfaceUpdate = {m_surfaceAppends.GetData(), m_surfaceAppends.GetRanges(), m_surfaceAppends.GetRangeCount(), 1};
+                vkContext.materialUpdate = {m_materialAppends.GetData(), m_materialAppends.GetRanges(), 
+                m_materialAppends.GetRangeCount(), 1};
+
+                // Compacted geometry is copied inside the buffers before the new geometry is uploaded
+                vkContext.vertexUpdate.pMoves = m_vertexMoves.Data();
+                vkContext.vertexUpdate.moveCount = static_cast<uint32_t>(m_vertexMoves.GetSize());
+                vkContext.indexUpdate.pMoves = m_indexMoves.Data();
+                vkContext.indexUpdate.moveCount = static_cast<uint32_t>(m_indexMoves.GetSize());
+                vkContext.meshletUpdate.pMoves = m_meshletMoves.Data();
+                vkContext.meshletUpdate.moveCount = static_cast<uint32_t>(m_meshletMoves.GetSize());
+
                 // Let Vulkan do its thing
                 vulkan.DrawFrame(vkContext);
 
+                // Vulkan has copied the appended elements to its upload buffer
+                m_vertexAppends.Clear();
+                m_indexAppends.Clear();
+                m_meshletAppends.Clear();
+                m_meshletDataAppends.Clear();
+                m_surfaceAppends.Clear();
+                m_materialAppends.Clear();
+                m_vertexMoves.Downsize(0);
+                m_indexMoves.Downsize(0);
+                m_meshletMoves.Downsize(0);
+
                 break;
             }
             case ActiveRenderer::Opengl:
@@ -162,9 +294,785 @@ namespace BlitzenEngine
         }
     }
 
+    void RenderingSystem::UpdateTransform(uint32_t transformId, const MeshTransform& transform)
+    {
+        BLIT_ASSERT(m_pResources && transformId < m_pResources->transforms.GetSize())
+
+        m_pResources->transforms[transformId] = transform;
+        m_transformUpdates.MarkDirty(transformId);
+    }
+
+    void RenderingSystem::UpdateTransforms(uint32_t firstTransform, uint32_t transformCount, const MeshTransform* pTransforms)
+    {
+        BLIT_ASSERT(m_pResources && firstTransform + transformCount <= m_pResources->transforms.GetSize())
+
+        for(uint32_t i = 0; i < transformCount; ++i)
+        {
+            m_pResources->transforms[firstTransform + i] = pTransforms[i];
+            m_transformUpdates.MarkDirty(firstTransform + i);
+        }
+    }
+
+    BlitCL::SlotHandle RenderingSystem::AddGameObject(uint32_t meshIndex, const MeshTransform& transform)
+    {
+        BLIT_ASSERT(m_pResources && meshIndex < m_pResources->meshes.GetSize())
+        RenderingResources* pResources = m_pResources;
+        Mesh& mesh = pResources->meshes[meshIndex];
+
+        // The renderers' buffers were created with a fixed amount of space for new objects
+        uint32_t firstInstanceObject = BLIT_STREAMING_UNUSED_INDEX;
+        if(pResources->renders.GetSize() + mesh.surfaceCount > pResources->capacities.renderObjects || 
+        (!m_freeTransforms.GetSize() && pResources->transforms.GetSize() >= pResources->capacities.meshInstances) || 
+        (firstInstanceObject = m_instanceObjectRanges.Allocate(mesh.surfaceCount)) == BLIT_STREAMING_UNUSED_INDEX)
+        {
+            BLIT_WARN("No space left for runtime objects, game object not added")
+            return BlitCL::SlotHandle{};
+        }
+
+        // The transform of a removed game object is reused if there is one. Its mesh instance has the same index
+        uint32_t transformId;
+        if(m_freeTransforms.GetSize())
+        {
+            transformId = m_freeTransforms.Back();
+            m_freeTransforms.Downsize(m_freeTransforms.GetSize() - 1);
+            pResources->transforms[transformId] = transform;
+        }
+        else
+        {
+            transformId = static_cast<uint32_t>(pResources->transforms.GetSize());
+            pResources->transforms.PushBack(transform);
+            pResources->meshInstances.PushBack(MeshInstance{});
+            m_transformUpdates.Resize(transformId + 1);
+            m_meshInstanceUpdates.Resize(transformId + 1);
+        }
+        m_transformUpdates.MarkDirty(transformId);
+        m_meshInstanceUpdates.MarkDirty(transformId);
+
+        // The instance's ranges are placed in a run of the instance object array, the opaque range first
+        uint32_t opaqueCount = 0;
+        for(uint32_t i = 0; i < mesh.surfaceCount; ++i)
+            opaqueCount += !pResources->surfaces[mesh.firstSurface + i].postPass;
+
+        MeshInstance& instance = pResources->meshInstances[transformId];
+        instance.transformId = transformId;
+        instance.firstOpaqueObject = firstInstanceObject;
+        instance.opaqueObjectCount = 0;
+        instance.firstPostPassObject = instance.firstOpaqueObject + opaqueCount;
+        instance.postPassObjectCount = 0;
+        pResources->instanceObjects.Resize(BlitML::Max(static_cast<uint32_t>(pResources->instanceObjects.GetSize()), 
+        firstInstanceObject + mesh.surfaceCount));
+        m_instanceObjectUpdates.Resize(static_cast<uint32_t>(pResources->instanceObjects.GetSize()));
+
+        for(uint32_t i = 0; i < mesh.surfaceCount; ++i)
+        {
+            uint32_t surfaceId = mesh.firstSurface + i;
+            RenderObject newObject;
+            newObject.transformId = transformId;
+            newObject.surfaceId = surfaceId;
+
+            pResources->renders.Insert(newObject);
+            uint32_t objectId = static_cast<uint32_t>(pResources->renders.GetSize() - 1);
+            m_renderObjectUpdates.Resize(objectId + 1);
+            m_renderObjectUpdates.MarkDirty(objectId);
+
+            uint32_t instanceObjectSlot;
+            if(pResources->surfaces[surfaceId].postPass)
+            {
+                instanceObjectSlot = instance.firstPostPassObject + instance.postPassObjectCount++;
+            }
+            // Opaque objects take the place of the first post pass object, which is moved to the back
+            else
+            {
+                SwapRenderObjects(pResources->opaqueRenderObjectCount, objectId);
+                objectId = pResources->opaqueRenderObjectCount++;
+                instanceObjectSlot = instance.firstOpaqueObject + instance.opaqueObjectCount++;
+            }
+
+            pResources->instanceObjects[instanceObjectSlot] = objectId;
+            m_instanceObjectUpdates.MarkDirty(instanceObjectSlot);
+        }
+
+        ComputeMeshInstanceBounds(pResources, instance);
+
+        GameObject newGameObject;
+        newGameObject.meshIndex = meshIndex;
+        newGameObject.transformIndex = transformId;
+        return pResources->objects.Insert(newGameObject);
+    }
+
+    uint8_t RenderingSystem::RemoveGameObject(BlitCL::SlotHandle handle)
+    {
+        GameObject* pObject = m_pResources ? m_pResources->objects.Get(handle) : nullptr;
+        if(!pObject)
+        {
+            BLIT_WARN("Invalid game object handle, nothing removed")
+            return 0;
+        }
+        uint32_t transformId = pObject->transformIndex;
+
+        // Every render object of the game object is in its mesh instance's ranges, they are removed from the back
+        MeshInstance& instance = m_pResources->meshInstances[transformId];
+        m_instanceObjectRanges.Free(instance.firstOpaqueObject, instance.opaqueObjectCount);
+        m_instanceObjectRanges.Free(instance.firstPostPassObject, instance.postPassObjectCount);
+        while(instance.opaqueObjectCount)
+            RemoveRenderObject(m_pResources->instanceObjects[instance.firstOpaqueObject + instance.opaqueObjectCount - 1]);
+        while(instance.postPassObjectCount)
+            RemoveRenderObject(m_pResources->instanceObjects[instance.firstPostPassObject + instance.postPassObjectCount - 1]);
+
+        // The empty instance stays in the array and is skipped by culling, until its transform is reused
+        instance.radius = 0.f;
+        m_meshInstanceUpdates.MarkDirty(transformId);
+        m_freeTransforms.PushBack(transformId);
+
+        m_pResources->objects.Remove(handle);
+        return 1;
+    }
+
+    void RenderingSystem::SwapRenderObjects(uint32_t first, uint32_t second)
+    {
+        if(first == second)
+            return;
+
+        RenderingResources* pResources = m_pResources;
+
+        // Finds the instance object entries of both objects before anything is written, in case they belong to the same instance
+        uint32_t slots[2] = {UINT32_MAX, UINT32_MAX};
+        uint32_t objects[2] = {first, second};
+        for(uint32_t i = 0; i < 2; ++i)
+        {
+            MeshInstance& instance = pResources->meshInstances[pResources->renders[objects[i]].transformId];
+            uint8_t bOpaque = objects[i] < pResources->opaqueRenderObjectCount;
+            uint32_t firstSlot = bOpaque ? instance.firstOpaqueObject : instance.firstPostPassObject;
+            uint32_t slotCount = bOpaque ? instance.opaqueObjectCount : instance.postPassObjectCount;
+            for(uint32_t j = firstSlot; j < firstSlot + slotCount; ++j)
+            {
+                if(pResources->instanceObjects[j] == objects[i])
+                {
+                    slots[i] = j;
+                    break;
+                }
+            }
+        }
+
+        // An object that is being removed or added is not in an instance range, so it might not be found
+        for(uint32_t i = 0; i < 2; ++i)
+        {
+            if(slots[i] == UINT32_MAX)
+                continue;
+            pResources->instanceObjects[slots[i]] = objects[1 - i];
+            m_instanceObjectUpdates.MarkDirty(slots[i]);
+        }
+
+        // The renderer also clears the visibility bit and LOD history of the marked objects, which it keeps by index
+        pResources->renders.SwapDense(first, second);
+        m_renderObjectUpdates.MarkDirty(first);
+        m_renderObjectUpdates.MarkDirty(second);
+    }
+
+    void RenderingSystem::RemoveRenderObject(uint32_t objectId)
+    {
+        RenderingResources* pResources = m_pResources;
+        MeshInstance& instance = pResources->meshInstances[pResources->renders[objectId].transformId];
+        uint8_t bOpaque = objectId < pResources->opaqueRenderObjectCount;
+
+        // The last entry of the instance's range takes the place of the removed object's entry
+        uint32_t& firstSlot = bOpaque ? instance.firstOpaqueObject : instance.firstPostPassObject;
+        uint32_t& slotCount = bOpaque ? instance.opaqueObjectCount : instance.postPassObjectCount;
+        for(uint32_t j = firstSlot; j < firstSlot + slotCount; ++j)
+        {
+            if(pResources->instanceObjects[j] == objectId)
+            {
+                pResources->instanceObjects[j] = pResources->instanceObjects[firstSlot + slotCount - 1];
+                m_instanceObjectUpdates.MarkDirty(j);
+                slotCount--;
+                break;
+            }
+        }
+        m_meshInstanceUpdates.MarkDirty(pResources->renders[objectId].transformId);
+
+        // Opaque objects are moved to the end of the opaque range, and the last post pass object takes their place there
+        uint32_t last = static_cast<uint32_t>(pResources->renders.GetSize() - 1);
+        if(bOpaque)
+        {
+            uint32_t lastOpaque = pResources->opaqueRenderObjectCount - 1;
+            SwapRenderObjects(objectId, lastOpaque);
+            SwapRenderObjects(lastOpaque, last);
+            pResources->opaqueRenderObjectCount--;
+        }
+        else
+        {
+            SwapRenderObjects(objectId, last);
+        }
+
+        // The removed object is last, so nothing else moves
+        pResources->renders.Remove(pResources->renders.GetHandle(last));
+    }
+
+    void RenderingSystem::BuildUpdateRanges()
+    {
+        if(!m_pResources)
+            return;
+
+        m_transformUpdates.BuildRanges(static_cast<uint32_t>(m_pResources->transforms.GetSize()));
+        m_renderObjectUpdates.BuildRanges(static_cast<uint32_t>(m_pResources->renders.GetSize()));
+        m_meshInstanceUpdates.BuildRanges(static_cast<uint32_t>(m_pResources->meshInstances.GetSize()));
+        m_instanceObjectUpdates.BuildRanges(static_cast<uint32_t>(m_pResources->instanceObjects.GetSize()));
+    }
+
+    void DirtyRangeTracker::Resize(uint32_t elementCount)
+    {
+        size_t wordCount = (elementCount + 31) / 32;
+        if(wordCount <= m_dirtyWords.GetSize())
+            return;
+
+        size_t previousCount = m_dirtyWords.GetSize();
+        m_dirtyWords.Resize(wordCount);
+        for(size_t i = previousCount; i < wordCount; ++i)
+            m_dirtyWords[i] = 0;
+    }
+
+    void DirtyRangeTracker::MarkDirty(uint32_t element)
+    {
+        uint32_t wordIndex = element / 32;
+        uint32_t bit = 1u << (element % 32);
+
+        if(m_dirtyWords[wordIndex] & bit)
+            return;
+
+        if(m_dirtyCount == 0)
+        {
+            m_firstDirtyWord = wordIndex;
+            m_lastDirtyWord = wordIndex;
+        }
+        else
+        {
+            m_firstDirtyWord = wordIndex < m_firstDirtyWord ? wordIndex : m_firstDirtyWord;
+            m_lastDirtyWord = BlitML::Max(m_lastDirtyWord, wordIndex);
+        }
+
+        m_dirtyWords[wordIndex] |= bit;
+        ++m_dirtyCount;
+    }
+
+    void DirtyRangeTracker::BuildRanges(uint32_t elementCount)
+    {
+        m_ranges.Downsize(0);
+        if(m_dirtyCount == 0)
+            return;
+
+        // With this many changes, one copy of the whole array is cheaper than finding and copying every run
+        if(m_dirtyCount > elementCount / BLITZEN_FULL_UPLOAD_DIVISOR)
+        {
+            m_ranges.PushBack({0, elementCount});
+        }
+        else
+        {
+            for(uint32_t wordIndex = m_firstDirtyWord; wordIndex <= m_lastDirtyWord; ++wordIndex)
+            {
+                uint32_t word = m_dirtyWords[wordIndex];
+                if(word == 0)
+                    continue;
+
+                for(uint32_t bit = 0; bit < 32; ++bit)
+                {
+                    if(!(word & (1u << bit)))
+                        continue;
+
+                    // Elements past the end were removed after they were marked
+                    uint32_t element = wordIndex * 32 + bit;
+                    if(element >= elementCount)
+                        break;
+
+                    // Extends the last range if the element is close enough to it. The clean elements in between are uploaded as well,
+                    // which is fine since the resource arrays always hold what the GPU should have
+                    if(m_ranges.GetSize())
+                    {
+                        BufferUpdateRange& last = m_ranges.Back();
+                        uint32_t lastEnd = last.firstElement + last.elementCount;
+                        if(element - lastEnd <= BLITZEN_DIRTY_RUN_MERGE_GAP)
+                        {
+                            last.elementCount = element - last.firstElement + 1;
+                            continue;
+                        }
+                    }
+
+                    m_ranges.PushBack({element, 1});
+                }
+            }
+        }
+
+        // The dirty words are cleared, the renderer copies the ranges this frame
+        for(uint32_t wordIndex = m_firstDirtyWord; wordIndex <= m_lastDirtyWord; ++wordIndex)
+            m_dirtyWords[wordIndex] = 0;
+        m_dirtyCount = 0;
+    }
+
+    static uint8_t OnSceneStreamingCancel(BlitzenCore::BlitEventType type, void* pSender, void* pListener, 
+    BlitzenCore::EventContext data)
+    {
+        RenderingSystem::GetRenderingSystem()->CancelStreaming();
+        return 1;
+    }
+
+    void RenderingSystem::StreamScene(const char* path)
+    {
+        BLIT_ASSERT_MESSAGE(!m_pResources, "Scenes need to be queued before the renderers are set up")
+
+        RequestStreaming();
+        StreamSceneAt(path, BlitML::vec3(0.f));
+    }
+
+    StreamedScene* RenderingSystem::StreamSceneAt(const char* path, const BlitML::vec3& offset)
+    {
+        BLIT_ASSERT_MESSAGE(m_bStreamingRequested, "The renderers need to leave space for streamed scenes")
+
+        if(!m_streamer.WasRequested())
+            BlitzenCore::RegisterEvent(BlitzenCore::BlitEventType::SceneStreamingCancel, nullptr, OnSceneStreamingCancel);
+
+        // Meshlets are only needed by the cluster rendering path, and only Vulkan receives streamed textures
+        #if BLITZEN_CLUSTER_RENDERING
+            uint8_t buildMeshlets = bVk ? vulkan.GetStats().meshShaderSupport : 0;
+        #else
+            uint8_t buildMeshlets = 0;
+        #endif
+        return m_streamer.QueueScene(path, buildMeshlets, bVk, offset);
+    }
+
+    void RenderingSystem::UnloadStreamedScene(StreamedScene* pScene)
+    {
+        RenderingResources* pResources = m_pResources;
+
+        // Chunks that were not committed yet are dropped
+        m_streamer.CancelScene(pScene);
+
+        for(size_t i = 0; i < pScene->gameObjects.GetSize(); ++i)
+            RemoveGameObject(pScene->gameObjects[i]);
+
+        // Nothing points to the meshes anymore, their space is given to the next scenes
+        for(size_t i = 0; i < pScene->meshAllocations.GetSize(); ++i)
+        {
+            StreamedMeshAllocation& allocation = pScene->meshAllocations[i];
+            m_vertexHeap.Free(allocation.vertices);
+            m_indexHeap.Free(allocation.indices);
+            m_meshletHeap.Free(allocation.meshlets);
+            m_meshletDataHeap.Free(allocation.meshletData);
+            m_surfaceHeap.Free(allocation.surfaces);
+
+            pResources->meshes[allocation.meshIndex].surfaceCount = 0;
+            m_freeMeshes.PushBack(allocation.meshIndex);
+        }
+
+        // Vulkan gives the texture tags back once the frames in flight are done with them
+        m_materialRanges.Free(pScene->firstMaterial, pScene->materialCount);
+        uint32_t textureCount = static_cast<uint32_t>(pScene->textureTags.GetSize());
+        if(bVk)
+            vulkan.ReleaseStreamedTextures(pScene->textureTags.Data(), textureCount);
+        else
+        {
+            for(uint32_t i = 0; i < textureCount; ++i)
+                pResources->textureSlots.Free(pScene->textureTags[i]);
+        }
+
+        m_streamer.ReleaseScene(pScene);
+    }
+
+    uint8_t RenderingSystem::CommitStreamedChunks()
+    {
+        // Chunks of unloaded scenes are dropped by peeking, so this runs even when nothing is being streamed
+        if(!m_pResources || !m_streamer.WasRequested())
+            return 0;
+
+        double startTime = BlitzenPlatform::PlatformGetAbsoluteTime();
+        size_t committedBytes = 0;
+        uint32_t committedCount = 0;
+        while(StreamedChunk* pChunk = m_streamer.PeekFinishedChunk())
+        {
+            // At least one chunk is committed every frame, even if it is bigger than the budget, so that streaming always moves forward
+            size_t uploadSize = pChunk->GetUploadSize();
+            if(committedCount && (committedBytes + uploadSize > BLIT_STREAMING_COMMIT_BYTE_BUDGET || 
+            BlitzenPlatform::PlatformGetAbsoluteTime() - startTime > BLIT_STREAMING_COMMIT_TIME_BUDGET))
+                break;
+            m_streamer.PopFinishedChunk();
+
+            if(!pChunk->bFailed)
+            {
+                switch(pChunk->type)
+                {
+                    case StreamedChunkType::Scene:
+                        CommitStreamedScene(pChunk);
+                        break;
+                    case StreamedChunkType::Mesh:
+                        CommitStreamedMesh(pChunk);
+                        break;
+                    case StreamedChunkType::Texture:
+                        CommitStreamedTexture(pChunk);
+                        break;
+                }
+            }
+
+            pChunk->pScene->committedBytes += uploadSize;
+            m_streamer.OnChunkCommitted(pChunk);
+            m_streamer.ReleaseChunk(pChunk);
+            committedBytes += uploadSize;
+            committedCount++;
+        }
+
+        if(!committedCount)
+            return 0;
+
+        BlitzenCore::EventContext context{};
+        context.data.ui32[0] = m_streamer.GetCommittedChunkCount();
+        context.data.ui32[1] = m_streamer.GetKnownChunkCount();
+        context.data.ui32[2] = m_streamer.GetFinishedSceneCount();
+        context.data.ui32[3] = m_streamer.GetSceneCount();
+        BlitzenCore::FireEvent(BlitzenCore::BlitEventType::SceneStreamingProgress, nullptr, context);
+
+        return 1;
+    }
+
+    void RenderingSystem::CommitStreamedScene(StreamedChunk* pChunk)
+    {
+        RenderingResources* pResources = m_pResources;
+        StreamedScene* pScene = pChunk->pScene;
+
+        // Each texture takes a free slot, they do not need to be next to each other. 
+        // If there is no space for a texture, the materials that use it get the first texture
+        pScene->textureTags.Resize(pChunk->textureCount);
+        for(uint32_t i = 0; i < pChunk->textureCount; ++i)
+        {
+            uint32_t tag = pResources->textureSlots.Allocate();
+            if(tag == BLIT_TEXTURE_SLOT_NONE)
+            {
+                BLIT_WARN("Texture capacity reached while streaming: %s", pScene->path.c_str())
+                pScene->textureTags.Downsize(i);
+                break;
+            }
+            pScene->textureTags[i] = tag;
+
+            // The slot is reserved now, the image is given to it when its chunk is committed
+            if(pResources->textures.GetSize() <= tag)
+                pResources->textures.Resize(tag + 1);
+            TextureStats texture{};
+            texture.textureTag = tag;
+            pResources->textures[tag] = texture;
+        }
+
+        // Same as the above for materials, the surfaces use the first material when there is no space
+        uint32_t materialCount = static_cast<uint32_t>(pChunk->materials.GetSize());
+        uint32_t firstMaterial = m_materialRanges.Allocate(materialCount);
+        if(firstMaterial == BLIT_STREAMING_UNUSED_INDEX)
+        {
+            BLIT_WARN("Material capacity reached while streaming: %s", pScene->path.c_str())
+            return;
+        }
+        pScene->firstMaterial = firstMaterial;
+        pScene->materialCount = materialCount;
+
+        if(pResources->materials.GetSize() < firstMaterial + materialCount)
+            pResources->materials.Resize(firstMaterial + materialCount);
+        for(uint32_t i = 0; i < materialCount; ++i)
+        {
+            Material& material = pChunk->materials[i];
+            uint32_t* tags[4] = {&material.albedoTag, &material.normalTag, &material.specularTag, &material.emissiveTag};
+            for(uint32_t* pTag : tags)
+                *pTag = *pTag < pScene->textureTags.GetSize() ? pScene->textureTags[*pTag] : 0;
+            material.materialId = firstMaterial + i;
+
+            pResources->materials[material.materialId] = material;
+            m_materialAppends.Append(material.materialId, &material, 1);
+        }
+    }
+
+    void RenderingSystem::CommitStreamedMesh(StreamedChunk* pChunk)
+    {
+        RenderingResources* pResources = m_pResources;
+        StreamedScene* pScene = pChunk->pScene;
+
+        uint32_t vertexCount = static_cast<uint32_t>(pChunk->vertices.GetSize());
+        uint32_t indexCount = static_cast<uint32_t>(pChunk->indices.GetSize());
+        uint32_t meshletCount = static_cast<uint32_t>(pChunk->meshlets.GetSize());
+        uint32_t meshletDataCount = static_cast<uint32_t>(pChunk->meshletData.GetSize());
+        uint32_t surfaceCount = static_cast<uint32_t>(pChunk->surfaces.GetSize());
+        if(!surfaceCount)
+            return;
+
+        // The mesh owns its allocations, so that compaction can find the surfaces that point to them
+        StreamedMeshAllocation allocation;
+        allocation.meshIndex = m_freeMeshes.GetSize() ? m_freeMeshes.Back() : static_cast<uint32_t>(pResources->meshes.GetSize());
+
+        // The renderers' buffers cannot grow after setup. What was allocated before a failure is given back.
+        // Meshlet data is never moved, the meshlets that point to it are only held by the renderer
+        if(allocation.meshIndex >= BLIT_MAX_MESH_COUNT || 
+        !m_vertexHeap.Allocate(vertexCount, allocation.meshIndex, allocation.vertices) || 
+        !m_indexHeap.Allocate(indexCount, allocation.meshIndex, allocation.indices) || 
+        !m_meshletHeap.Allocate(meshletCount, allocation.meshIndex, allocation.meshlets) || 
+        !m_meshletDataHeap.Allocate(meshletDataCount, allocation.meshIndex, allocation.meshletData, 1) || 
+        !m_surfaceHeap.Allocate(surfaceCount, allocation.meshIndex, allocation.surfaces))
+        {
+            m_vertexHeap.Free(allocation.vertices);
+            m_indexHeap.Free(allocation.indices);
+            m_meshletHeap.Free(allocation.meshlets);
+            m_meshletDataHeap.Free(allocation.meshletData);
+            m_surfaceHeap.Free(allocation.surfaces);
+
+            BLIT_WARN("Geometry capacity reached while streaming: %s, mesh not added", pScene->path.c_str())
+            return;
+        }
+        uint32_t firstVertex = m_vertexHeap.GetOffset(allocation.vertices);
+        uint32_t firstIndex = m_indexHeap.GetOffset(allocation.indices);
+        uint32_t firstMeshlet = m_meshletHeap.GetOffset(allocation.meshlets);
+        uint32_t firstMeshletData = m_meshletDataHeap.GetOffset(allocation.meshletData);
+        uint32_t firstSurface = m_surfaceHeap.GetOffset(allocation.surfaces);
+
+        // The chunk's offsets start at 0, they are moved to the allocations
+        for(uint32_t i = 0; i < meshletCount; ++i)
+            pChunk->meshlets[i].dataOffset += firstMeshletData;
+
+        if(pResources->surfaces.GetSize() < firstSurface + surfaceCount)
+            pResources->surfaces.Resize(firstSurface + surfaceCount);
+        for(uint32_t i = 0; i < surfaceCount; ++i)
+        {
+            PrimitiveSurface& surface = pChunk->surfaces[i];
+            surface.vertexOffset += firstVertex;
+            for(uint8_t j = 0; j < surface.lodCount; ++j)
+            {
+                surface.meshLod[j].firstIndex += firstIndex;
+                surface.meshLod[j].firstMeshlet += firstMeshlet;
+            }
+            surface.materialId = surface.materialId < pScene->materialCount ? pScene->firstMaterial + surface.materialId : 0;
+
+            pResources->surfaces[firstSurface + i] = surface;
+        }
+
+        m_vertexAppends.Append(firstVertex, pChunk->vertices.Data(), vertexCount);
+        m_indexAppends.Append(firstIndex, pChunk->indices.Data(), indexCount);
+        m_meshletAppends.Append(firstMeshlet, pChunk->meshlets.Data(), meshletCount);
+        m_meshletDataAppends.Append(firstMeshletData, pChunk->meshletData.Data(), meshletDataCount);
+        m_surfaceAppends.Append(firstSurface, pChunk->surfaces.Data(), surfaceCount);
+
+        Mesh newMesh;
+        newMesh.firstSurface = firstSurface;
+        newMesh.surfaceCount = surfaceCount;
+        if(m_freeMeshes.GetSize())
+        {
+            m_freeMeshes.Downsize(m_freeMeshes.GetSize() - 1);
+            pResources->meshes[allocation.meshIndex] = newMesh;
+        }
+        else
+            pResources->meshes.PushBack(newMesh);
+        pScene->meshAllocations.PushBack(allocation);
+
+        // Each node that uses the mesh becomes a game object. Once one does not fit, none of the others will
+        for(size_t i = 0; i < pChunk->transforms.GetSize(); ++i)
+        {
+            BlitCL::SlotHandle handle = AddGameObject(allocation.meshIndex, pChunk->transforms[i]);
+            if(!pResources->objects.IsValid(handle))
+                break;
+            pScene->gameObjects.PushBack(handle);
+        }
+    }
+
+    void RenderingSystem::CommitStreamedTexture(StreamedChunk* pChunk)
+    {
+        StreamedScene* pScene = pChunk->pScene;
+        if(!bVk || pChunk->textureIndex >= pScene->textureTags.GetSize())
+            return;
+
+        uint32_t textureTag = pScene->textureTags[pChunk->textureIndex];
+        if(vulkan.UploadStreamedTexture(textureTag, pChunk->header, pChunk->format, pChunk->textureData.Data(), 
+        pChunk->textureData.GetSize()))
+        {
+            TextureStats& texture = m_pResources->textures[textureTag];
+            texture.textureWidth = pChunk->header.dwWidth;
+            texture.textureHeight = pChunk->header.dwHeight;
+        }
+    }
+
+    void RenderingSystem::CompactGeometry()
+    {
+        RenderingResources* pResources = m_pResources;
+        if(!pResources)
+            return;
+
+        // The surfaces are compacted last, so that the offsets that the other heaps moved are copied with them.
+        // Meshlet data is left out, the meshlets that point to it are not kept by the engine
+        GeometryHeap* heaps[4] = {&m_vertexHeap, &m_indexHeap, &m_meshletHeap, &m_surfaceHeap};
+        BlitCL::DynamicArray<BufferMoveRange>* pMoveRanges[3] = {&m_vertexMoves, &m_indexMoves, &m_meshletMoves};
+        m_compactedMeshes.Downsize(0);
+        for(uint32_t i = 0; i < BLIT_ARRAY_SIZE(heaps); ++i)
+        {
+            // Compact is called even when nothing needs to move, it frees the space that the last moves left
+            uint32_t budget = heaps[i]->GetStats().GetFragmentation() > BLITZEN_GEOMETRY_COMPACTION_THRESHOLD ? 
+            BLITZEN_GEOMETRY_COMPACTION_BUDGET : 0;
+            m_geometryMoves.Downsize(0);
+            heaps[i]->Compact(budget, m_geometryMoves);
+
+            for(size_t j = 0; j < m_geometryMoves.GetSize(); ++j)
+            {
+                GeometryMove& move = m_geometryMoves[j];
+                Mesh& mesh = pResources->meshes[move.owner];
+                BufferMoveRange& range = move.range;
+
+                // Surfaces are not copied by the renderer, every moved mesh uploads its surfaces again below
+                if(heaps[i] == &m_surfaceHeap)
+                {
+                    for(uint32_t k = 0; k < range.elementCount; ++k)
+                        pResources->surfaces[range.dstElement + k] = pResources->surfaces[range.srcElement + k];
+                    mesh.firstSurface = range.dstElement;
+                }
+                else
+                    pMoveRanges[i]->PushBack(range);
+
+                for(uint32_t k = mesh.firstSurface; k < mesh.firstSurface + mesh.surfaceCount; ++k)
+                {
+                    PrimitiveSurface& surface = pResources->surfaces[k];
+                    if(heaps[i] == &m_vertexHeap)
+                        surface.vertexOffset = surface.vertexOffset - range.srcElement + range.dstElement;
+                    for(uint8_t lod = 0; lod < surface.lodCount; ++lod)
+                    {
+                        if(heaps[i] == &m_indexHeap)
+                            surface.meshLod[lod].firstIndex = surface.meshLod[lod].firstIndex - range.srcElement + range.dstElement;
+                        else if(heaps[i] == &m_meshletHeap)
+                            surface.meshLod[lod].firstMeshlet = surface.meshLod[lod].firstMeshlet - range.srcElement + range.dstElement;
+                    }
+                }
+
+                uint8_t bListed = 0;
+                for(size_t k = 0; k < m_compactedMeshes.GetSize() && !bListed; ++k)
+                    bListed = m_compactedMeshes[k] == move.owner;
+                if(!bListed)
+                    m_compactedMeshes.PushBack(move.owner);
+            }
+
+            // The render objects of moved surfaces point to their new place
+            if(heaps[i] == &m_surfaceHeap && m_geometryMoves.GetSize())
+            {
+                for(size_t r = 0; r < pResources->renders.GetSize(); ++r)
+                {
+                    RenderObject& render = pResources->renders[r];
+                    for(size_t j = 0; j < m_geometryMoves.GetSize(); ++j)
+                    {
+                        BufferMoveRange& range = m_geometryMoves[j].range;
+                        if(render.surfaceId >= range.srcElement && render.surfaceId < range.srcElement + range.elementCount)
+                        {
+                            render.surfaceId = render.surfaceId - range.srcElement + range.dstElement;
+                            m_renderObjectUpdates.MarkDirty(static_cast<uint32_t>(r));
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        for(size_t i = 0; i < m_compactedMeshes.GetSize(); ++i)
+        {
+            Mesh& mesh = pResources->meshes[m_compactedMeshes[i]];
+            m_surfaceAppends.Append(mesh.firstSurface, &pResources->surfaces[mesh.firstSurface], mesh.surfaceCount);
+        }
+    }
+
+    void RenderingSystem::LogGeometryOccupancy()
+    {
+        const char* names[5] = {"Vertex", "Index", "Meshlet", "Meshlet data", "Surface"};
+        GeometryHeap* heaps[5] = {&m_vertexHeap, &m_indexHeap, &m_meshletHeap, &m_meshletDataHeap, &m_surfaceHeap};
+        for(uint32_t i = 0; i < BLIT_ARRAY_SIZE(heaps); ++i)
+        {
+            GeometryHeapStats stats = heaps[i]->GetStats();
+            BLIT_INFO("%s heap: %u / %u elements used (%.1f%%), %u allocations, %u free blocks, largest free block %u, fragmentation %.2f", 
+            names[i], stats.usedElements, stats.capacity, 
+            stats.capacity ? 100.0 * static_cast<double>(stats.usedElements) / static_cast<double>(stats.capacity) : 0.0, 
+            stats.allocationCount, stats.freeBlockCount, stats.largestFreeBlock, stats.GetFragmentation())
+        }
+    }
+
+    void ElementRangeAllocator::Init(uint32_t firstElement, uint32_t capacity)
+    {
+        m_freeRanges.Downsize(0);
+        m_freeCount = capacity > firstElement ? capacity - firstElement : 0;
+        if(m_freeCount)
+            m_freeRanges.PushBack({firstElement, m_freeCount});
+    }
+
+    uint32_t ElementRangeAllocator::Allocate(uint32_t elementCount)
+    {
+        // Empty runs can start anywhere, nothing is written to them
+        if(!elementCount)
+            return 0;
+
+        // The smallest run that fits keeps the big ones for big requests
+        size_t best = m_freeRanges.GetSize();
+        for(size_t i = 0; i < m_freeRanges.GetSize(); ++i)
+        {
+            if(m_freeRanges[i].elementCount >= elementCount && 
+            (best == m_freeRanges.GetSize() || m_freeRanges[i].elementCount < m_freeRanges[best].elementCount))
+                best = i;
+        }
+        if(best == m_freeRanges.GetSize())
+            return BLIT_STREAMING_UNUSED_INDEX;
+
+        BufferUpdateRange& range = m_freeRanges[best];
+        uint32_t firstElement = range.firstElement;
+        range.firstElement += elementCount;
+        range.elementCount -= elementCount;
+        m_freeCount -= elementCount;
+
+        if(!range.elementCount)
+        {
+            for(size_t i = best; i + 1 < m_freeRanges.GetSize(); ++i)
+                m_freeRanges[i] = m_freeRanges[i + 1];
+            m_freeRanges.Downsize(m_freeRanges.GetSize() - 1);
+        }
+
+        return firstElement;
+    }
+
+    void ElementRangeAllocator::Free(uint32_t firstElement, uint32_t elementCount)
+    {
+        if(!elementCount)
+            return;
+        m_freeCount += elementCount;
+
+        // Finds the first free run after the freed one
+        size_t next = 0;
+        while(next < m_freeRanges.GetSize() && m_freeRanges[next].firstElement < firstElement)
+            ++next;
+
+        uint8_t bMergePrevious = next > 0 && m_freeRanges[next - 1].firstElement + m_freeRanges[next - 1].elementCount == firstElement;
+        uint8_t bMergeNext = next < m_freeRanges.GetSize() && firstElement + elementCount == m_freeRanges[next].firstElement;
+        if(bMergePrevious && bMergeNext)
+        {
+            m_freeRanges[next - 1].elementCount += elementCount + m_freeRanges[next].elementCount;
+            for(size_t i = next; i + 1 < m_freeRanges.GetSize(); ++i)
+                m_freeRanges[i] = m_freeRanges[i + 1];
+            m_freeRanges.Downsize(m_freeRanges.GetSize() - 1);
+        }
+        else if(bMergePrevious)
+        {
+            m_freeRanges[next - 1].elementCount += elementCount;
+        }
+        else if(bMergeNext)
+        {
+            m_freeRanges[next].firstElement = firstElement;
+            m_freeRanges[next].elementCount += elementCount;
+        }
+        else
+        {
+            m_freeRanges.PushBack({0, 0});
+            for(size_t i = m_freeRanges.GetSize() - 1; i > next; --i)
+                m_freeRanges[i] = m_freeRanges[i - 1];
+            m_freeRanges[next] = {firstElement, elementCount};
+        }
+    }
+
     void RenderingSystem::ShutdownRenderers()
     {
         RenderingSystem* pSystem = GET_RENDERER()
+
+        // The workers are stopped before the renderers, nothing is committed after this
+        m_streamer.Shutdown();
+        if(m_bStreamingRequested && m_pResources)
+            LogGeometryOccupancy();
+
         if(bVk)
             vulkan.Shutdown();
 
@@ -173,4 +1081,122 @@ namespace BlitzenEngine
                 opengl.Shutdown();
         #endif
     }
+
+    void MeshShadingBenchmark::Init(RenderingSystem* pRenderer, Camera& camera, uint32_t warmupFrames, uint32_t timedFrames)
+    {
+        m_position = camera.viewData.position;
+        m_yawRotation = camera.transformData.yawRotation;
+        m_pitchRotation = camera.transformData.pitchRotation;
+        m_warmupFrames = warmupFrames;
+        m_timedFrames = timedFrames;
+
+        if(!pRenderer->IsVulkanAvailable() || !pRenderer->GetVulkan().GetStats().timestampSupport)
+        {
+            BLIT_ERROR("The mesh shading benchmark needs Vulkan with timestamp queries, nothing will be timed")
+            m_phase = Phase::Done;
+            return;
+        }
+
+        // Without the mesh shading path only the vertex shader path is timed, the results say why
+        m_bMeshShadingSupported = BLITZEN_VULKAN_MESH_SHADER && pRenderer->GetVulkan().GetStats().meshShaderSupport;
+        if(!m_bMeshShadingSupported)
+            BLIT_WARN("Mesh shaders are not available (built without BLIT_VK_MESH_EXT or not supported), only the vertex shader path is timed")
+
+        m_bMeshShading = 0;
+        pRenderer->meshShadingEnabled = 0;
+        m_phase = Phase::Streaming;
+        m_phaseFrame = 0;
+        BLIT_INFO("Mesh shading benchmark: %u warmup and %u timed frames for each path", m_warmupFrames, m_timedFrames)
+    }
+
+    uint8_t MeshShadingBenchmark::Update(RenderingSystem* pRenderer, Camera& camera)
+    {
+        if(m_phase == Phase::Done)
+            return 0;
+
+        // Input is ignored, the camera goes back to where it started every frame and UpdateCamera rebuilds its matrices
+        camera.viewData.position = m_position;
+        camera.transformData.yawRotation = m_yawRotation;
+        camera.transformData.pitchRotation = m_pitchRotation;
+        RotateCamera(camera, 0.f, 0.f, 0.f);
+        camera.transformData.velocity = BlitML::vec3(0.f);
+        camera.transformData.cameraDirty = 1;
+
+        // Both paths should see the whole scene, so nothing is timed until the streamed scenes are in
+        if(m_phase == Phase::Streaming)
+        {
+            if(!pRenderer->IsStreaming())
+            {
+                m_phase = Phase::Warmup;
+                m_phaseFrame = 0;
+            }
+            return 1;
+        }
+
+        pRenderer->meshShadingEnabled = m_bMeshShading;
+        ++m_phaseFrame;
+        switch(m_phase)
+        {
+            case Phase::Warmup:
+            {
+                if(m_phaseFrame < m_warmupFrames)
+                    break;
+
+                // Frames are only counted when their timestamps are read, so the frames in flight of the warmup end up in the timed average
+                pRenderer->GetVulkan().GetGpuFrameTimeTotal(m_bMeshShading, m_startTime[m_bMeshShading], 
+                m_startFrameCount[m_bMeshShading]);
+                m_phase = Phase::Timed;
+                m_phaseFrame = 0;
+                break;
+            }
+            case Phase::Timed:
+            {
+                if(m_phaseFrame < m_timedFrames)
+                    break;
+
+                if(!m_bMeshShading && m_bMeshShadingSupported)
+                {
+                    m_bMeshShading = 1;
+                    m_phase = Phase::Warmup;
+                }
+                else
+                    m_phase = Phase::Drain;
+                m_phaseFrame = 0;
+                break;
+            }
+            // Waits for the timestamps of the last frames in flight
+            case Phase::Drain:
+            {
+                if(m_phaseFrame <= BLITZEN_VULKAN_MAX_FRAMES_IN_FLIGHT)
+                    break;
+
+                LogResults(pRenderer);
+                m_phase = Phase::Done;
+                return 0;
+            }
+            default:
+                break;
+        }
+        return 1;
+    }
+
+    void MeshShadingBenchmark::LogResults(RenderingSystem* pRenderer)
+    {
+        const char* pathNames[2] = {"vertex shader", "mesh shading"};
+        double averages[2] = {};
+        for(uint8_t i = 0; i < 1 + m_bMeshShadingSupported; ++i)
+        {
+            double totalTime;
+            uint64_t frameCount;
+            pRenderer->GetVulkan().GetGpuFrameTimeTotal(i, totalTime, frameCount);
+            frameCount -= m_startFrameCount[i];
+            averages[i] = frameCount ? (totalTime - m_startTime[i]) / double(frameCount) : 0.0;
+            BLIT_INFO("Mesh shading benchmark, %s path: %f ms average GPU frame time over %llu frames", pathNames[i], averages[i], 
+            static_cast<unsigned long long>(frameCount))
+        }
+
+        if(m_bMeshShadingSupported && averages[0] > 0.0 && averages[1] > 0.0)
+            BLIT_INFO("Mesh shading benchmark: the mesh shading path takes %f times the GPU time of the vertex shader path", 
+            averages[1] / averages[0])
+    }
 }
\ No newline at end of file
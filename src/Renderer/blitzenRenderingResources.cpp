@@ -1,5 +1,11 @@
 #include "blitRenderingResources.h"
-#include "blitRenderer.h"
+#include "blitTextureBake.h"
+#include "blitImpostorBake.h"
+
+// The cooker is built without the renderers, the code that hands resources to them is left out
+#ifndef BLITZEN_COOK
+    #include "blitRenderer.h"
+#endif
 
 // Single file .png and .jpeg image loader, to be used for textures
 // https://github.com/nothings/stb
@@ -31,6 +37,7 @@
 
 // I have that this is temporary and that I can do my own string formating
 #include <string>
+#include <cstring>
 
 namespace BlitzenEngine
 {
@@ -49,24 +56,180 @@ namespace BlitzenEngine
         Texture specific functions
     ----------------------------------*/
 
+    void TextureSlotAllocator::Init(uint32_t firstSlot, uint32_t capacity)
+    {
+        // Only the slots up to the max texture count are handed out, the descriptor table has no space after them
+        capacity = capacity < BLIT_MAX_TEXTURE_COUNT ? capacity : BLIT_MAX_TEXTURE_COUNT;
+        for(uint32_t slot = firstSlot; slot < capacity; ++slot)
+            m_nextFree[slot].store(slot + 1 < capacity ? slot + 1 : BLIT_TEXTURE_SLOT_NONE, std::memory_order_relaxed);
+
+        m_freeCount.store(capacity > firstSlot ? capacity - firstSlot : 0, std::memory_order_relaxed);
+        m_head.store(capacity > firstSlot ? firstSlot : BLIT_TEXTURE_SLOT_NONE, std::memory_order_release);
+    }
+
+    uint32_t TextureSlotAllocator::Allocate()
+    {
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        for(;;)
+        {
+            uint32_t slot = static_cast<uint32_t>(head);
+            if(slot == BLIT_TEXTURE_SLOT_NONE)
+                return BLIT_TEXTURE_SLOT_NONE;
+
+            uint64_t next = (((head >> 32) + 1) << 32) | m_nextFree[slot].load(std::memory_order_relaxed);
+            if(m_head.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                m_freeCount.fetch_sub(1, std::memory_order_relaxed);
+                return slot;
+            }
+        }
+    }
+
+    void TextureSlotAllocator::Free(uint32_t slot)
+    {
+        if(slot >= BLIT_MAX_TEXTURE_COUNT)
+            return;
+
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        uint64_t next;
+        do
+        {
+            m_nextFree[slot].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            next = (((head >> 32) + 1) << 32) | slot;
+        } while(!m_head.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+        m_freeCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint32_t SurfaceCache::Find(uint64_t key, uint32_t geometryId, uint64_t materialKey)
+    {
+        if(!m_entries.GetSize())
+            return BLIT_SURFACE_CACHE_MISS;
+
+        key = key ? key : 1;
+        size_t mask = m_entries.GetSize() - 1;
+        for(size_t i = key & mask; m_entries[i].key; i = (i + 1) & mask)
+        {
+            SurfaceCacheEntry& entry = m_entries[i];
+            if(entry.key == key && entry.geometryId == geometryId && entry.materialKey == materialKey)
+                return entry.surfaceId;
+        }
+        return BLIT_SURFACE_CACHE_MISS;
+    }
+
+    uint32_t SurfaceCache::Find(uint64_t key, BlitCL::DynamicArray<Vertex>& vertices, BlitCL::DynamicArray<uint32_t>& indices)
+    {
+        if(!m_entries.GetSize())
+            return BLIT_SURFACE_CACHE_MISS;
+
+        key = key ? key : 1;
+        size_t mask = m_entries.GetSize() - 1;
+        for(size_t i = key & mask; m_entries[i].key; i = (i + 1) & mask)
+        {
+            SurfaceCacheEntry& entry = m_entries[i];
+            if(entry.key != key || entry.vertexCount != vertices.GetSize() || entry.indexCount != indices.GetSize())
+                continue;
+
+            // Same hash and counts can still be different streams, keep probing if they are
+            if(!memcmp(m_sourceVertices.Data() + entry.firstVertex, vertices.Data(), vertices.GetSize() * sizeof(Vertex)) && 
+            !memcmp(m_sourceIndices.Data() + entry.firstIndex, indices.Data(), indices.GetSize() * sizeof(uint32_t)))
+                return entry.surfaceId;
+        }
+        return BLIT_SURFACE_CACHE_MISS;
+    }
+
+    void SurfaceCache::Insert(uint64_t key, uint32_t surfaceId, uint32_t geometryId, uint64_t materialKey)
+    {
+        SurfaceCacheEntry entry{};
+        entry.key = key ? key : 1;
+        entry.surfaceId = surfaceId;
+        entry.geometryId = geometryId;
+        entry.materialKey = materialKey;
+        Place(entry);
+    }
+
+    void SurfaceCache::Insert(uint64_t key, uint32_t surfaceId, BlitCL::DynamicArray<Vertex>& vertices, BlitCL::DynamicArray<uint32_t>& indices)
+    {
+        SurfaceCacheEntry entry{};
+        entry.key = key ? key : 1;
+        entry.surfaceId = surfaceId;
+        entry.geometryId = surfaceId;
+        entry.vertexCount = static_cast<uint32_t>(vertices.GetSize());
+        entry.indexCount = static_cast<uint32_t>(indices.GetSize());
+        entry.firstVertex = m_sourceVertices.GetSize();
+        entry.firstIndex = m_sourceIndices.GetSize();
+        m_sourceVertices.AddBlockAtBack(vertices.Data(), vertices.GetSize());
+        m_sourceIndices.AddBlockAtBack(indices.Data(), indices.GetSize());
+        Place(entry);
+    }
+
+    void SurfaceCache::Place(SurfaceCacheEntry entry)
+    {
+        // The capacity stays a power of 2, so that the probe can wrap with a mask
+        if((m_count + 1) * 2 > m_entries.GetSize())
+        {
+            BlitCL::DynamicArray<SurfaceCacheEntry> oldEntries(m_entries);
+            m_entries.Resize(m_entries.GetSize() ? m_entries.GetSize() * 2 : 256);
+            m_entries.Fill(SurfaceCacheEntry{});
+            m_count = 0;
+            for(size_t i = 0; i < oldEntries.GetSize(); ++i)
+            {
+                if(oldEntries[i].key)
+                    Place(oldEntries[i]);
+            }
+        }
+
+        size_t mask = m_entries.GetSize() - 1;
+        size_t i = entry.key & mask;
+        while(m_entries[i].key)
+            i = (i + 1) & mask;
+        m_entries[i] = entry;
+        ++m_count;
+    }
+
+    void SurfaceCache::Clear()
+    {
+        m_entries.ReleaseMemory();
+        m_sourceVertices.ReleaseMemory();
+        m_sourceIndices.ReleaseMemory();
+        m_count = 0;
+    }
+
     uint8_t LoadTextureFromFile(RenderingResources* pResources, const char* filename, const char* texName, 
     uint8_t loadForVulkan, uint8_t loadForGL)
     {
         // Don't go over the texture limit, might want to throw a warning here
-        if(pResources->textureCount >= BLIT_MAX_TEXTURE_COUNT)
+        if(pResources->textures.GetSize() >= BLIT_MAX_TEXTURE_COUNT)
             return 0;
 
-        RenderingSystem* pRenderer = RenderingSystem::GetRenderingSystem();
-
         DDS_HEADER header = {};
         DDS_HEADER_DXT10 header10 = {};
 
-        // The data from the file will be written to this and passed to Vulkan
-        TextureStats& texture = pResources->textures[pResources->textureCount];
+        // The data from the file will be written to this and passed to Vulkan. It is added to the texture array if it loads
+        TextureStats texture{};
 
         // Create a placeholder image format
         unsigned int imageFormat = 0;
 
+        // The renderers only load DDS files, other images are baked to one in the asset cache first
+        std::string ddsPath = filename;
+        std::string::size_type dot = ddsPath.find_last_of('.');
+        if(dot == std::string::npos || ddsPath.compare(dot, std::string::npos, ".dds"))
+        {
+            if(!GetOrBakeTexture(filename, TextureBakeUsage::Color, ddsPath))
+            {
+                BLIT_INFO("Texture from file: %s could not be baked", filename)
+                return 0;
+            }
+            filename = ddsPath.c_str();
+        }
+
+        // The cooker has no renderers, the texture is only baked
+        #ifdef BLITZEN_COOK
+            return 0;
+        #else
+
+        RenderingSystem* pRenderer = RenderingSystem::GetRenderingSystem();
+
         uint8_t load = 0;
         // Add the texture to the vulkan renderer if a pointer for it was passed
         if(pRenderer->IsVulkanAvailable())
@@ -75,9 +238,9 @@ namespace BlitzenEngine
             {
                 texture.textureWidth = header.dwWidth;
                 texture.textureHeight = header.dwHeight;
-                texture.textureTag = static_cast<uint32_t>(pResources->textureCount);
+                texture.textureTag = static_cast<uint32_t>(pResources->textures.GetSize());
 
-                pResources->textureCount++;
+                pResources->textures.PushBack(texture);
                 load = 1;
             }
             else
@@ -86,6 +249,8 @@ namespace BlitzenEngine
             }
         }
         return load;
+
+        #endif
     }
     
 
@@ -102,20 +267,30 @@ namespace BlitzenEngine
     void DefineMaterial(RenderingResources* pResources, BlitML::vec4& diffuseColor, float shininess, const char* diffuseMapName, 
     const char* specularMapName, const char* materialName)
     {
-        Material& current = pResources->materials[pResources->materialCount];
+        if(pResources->materials.GetSize() >= BLIT_MAX_MATERIAL_COUNT)
+        {
+            BLIT_ERROR("Max material count: ( %i ) reached!", BLIT_MAX_MATERIAL_COUNT)
+            return;
+        }
+
+        pResources->materials.Resize(pResources->materials.GetSize() + 1);
+        Material& current = pResources->materials.Back();
 
         current.diffuseColor = diffuseColor;
         current.shininess = shininess;
 
-        current.albedoTag = pResources->textureTable.Get(diffuseMapName, &pResources->textures[0])->textureTag;
-        current.normalTag = pResources->textureTable.Get(specularMapName, &pResources->textures[0])->textureTag;
+        // Materials that are defined before any texture is loaded fall back to the first texture slot
+        TextureStats* pDefaultTexture = pResources->textures.GetSize() ? &pResources->textures[0] : nullptr;
+        TextureStats* pAlbedo = pResources->textureTable.Get(diffuseMapName, pDefaultTexture);
+        TextureStats* pNormal = pResources->textureTable.Get(specularMapName, pDefaultTexture);
+        current.albedoTag = pAlbedo ? pAlbedo->textureTag : 0;
+        current.normalTag = pNormal ? pNormal->textureTag : 0;
         current.specularTag = 0;
         current.emissiveTag = 0;
 
-        current.materialId = static_cast<uint32_t>(pResources->materialCount);
+        current.materialId = static_cast<uint32_t>(pResources->materials.GetSize() - 1);
 
         pResources->materialTable.Set(materialName, &current);
-        pResources->materialCount++;
     }
 
     void LoadTestMaterials(RenderingResources* pResources, uint8_t loadForVulkan, uint8_t loadForGL)
@@ -131,7 +306,7 @@ namespace BlitzenEngine
     uint8_t LoadMeshFromObj(RenderingResources* pResources, const char* filename)
     {
         // The function should return if the engine will go over the max allowed mesh assets
-        if(pResources->meshCount > BLIT_MAX_MESH_COUNT)
+        if(pResources->meshes.GetSize() >= BLIT_MAX_MESH_COUNT)
         {
             BLIT_ERROR("Max mesh count: ( %i ) reached!", BLIT_MAX_MESH_COUNT)
             BLIT_INFO("If more objects are needed, increase the BLIT_MAX_MESH_COUNT macro before starting the loop")
@@ -140,8 +315,8 @@ namespace BlitzenEngine
 
         BLIT_INFO("Loading obj model form file: %s", filename)
 
-        // Get the current mesh and give it the size surface array as its first surface index
-        Mesh& currentMesh = pResources->meshes[pResources->meshCount];
+        // The new mesh is given the size surface array as its first surface index, and is added once its surface is loaded
+        Mesh currentMesh;
         currentMesh.firstSurface = static_cast<uint32_t>(pResources->surfaces.GetSize());
 
         ObjFile file;
@@ -191,20 +366,70 @@ namespace BlitzenEngine
 		meshopt_remapIndexBuffer(indices.Data(), 0, indexCount, remap.Data());
 
         BLIT_INFO("Creating surface")
-        LoadPrimitiveSurface(pResources, vertices, indices);
+        BlitCL::DynamicArray<MeshQualityStats> quality;
+        LoadPrimitiveSurface(pResources, vertices, indices, &quality);
+        LogMeshQuality(filename, quality);
+
+        // Obj files have no materials, the impostor is gray like the surface without a texture
+        if(pResources->lodSettings.bImpostor)
+            AddSurfaceImpostor(pResources, static_cast<uint32_t>(pResources->surfaces.GetSize() - 1), nullptr);
 
         currentMesh.surfaceCount++;// Increment the surface count
-        ++(pResources->meshCount);// Increment the mesh count
+        pResources->meshes.PushBack(currentMesh);
 
         return 1;
     }
 
+    // Adds the data and the record of one meshlet built by meshoptimizer. The hierarchy fields say that it is always drawn
+    static void AppendMeshlet(GeometryTarget& target, BlitCL::DynamicArray<Vertex>& vertices, 
+    unsigned int* pMeshletVertices, unsigned char* pMeshletTriangles, size_t vertexCount, size_t triangleCount)
+    {
+        meshopt_optimizeMeshlet(pMeshletVertices, pMeshletTriangles, triangleCount, vertexCount);
+
+        size_t dataOffset = target.meshletData.GetSize();
+        for(size_t i = 0; i < vertexCount; ++i)
+        {
+            target.meshletData.PushBack(pMeshletVertices[i]);
+        }
+
+        // Each triangle is packed in one integer, with its 3 local vertex indices in the 3 low bytes. This is how the mesh shader reads them
+        for(size_t i = 0; i < triangleCount; ++i)
+        {
+            unsigned char* triangle = &pMeshletTriangles[i * 3];
+            target.meshletData.PushBack((uint32_t(triangle[0]) << 16) | (uint32_t(triangle[1]) << 8) | uint32_t(triangle[2]));
+        }
+
+        meshopt_Bounds bounds = meshopt_computeMeshletBounds(pMeshletVertices, pMeshletTriangles, triangleCount, 
+        &vertices[0].position.x, vertices.GetSize(), sizeof(Vertex));
+
+        Meshlet m = {};
+        m.dataOffset = static_cast<uint32_t>(dataOffset);
+        m.triangleCount = static_cast<uint8_t>(triangleCount);
+        m.vertexCount = static_cast<uint8_t>(vertexCount);
+
+        m.center = BlitML::vec3(bounds.center[0], bounds.center[1], bounds.center[2]);
+        m.radius = bounds.radius;
+        m.cone_axis[0] = bounds.cone_axis_s8[0];
+        m.cone_axis[1] = bounds.cone_axis_s8[1];
+        m.cone_axis[2] = bounds.cone_axis_s8[2];
+        m.cone_cutoff = bounds.cone_cutoff_s8; 
+
+        m.error = 0.f;
+        m.lodCenter = m.center;
+        m.lodRadius = m.radius;
+        m.parentCenter = m.center;
+        m.parentRadius = m.radius;
+        m.parentError = FLT_MAX;
+
+        target.meshlets.PushBack(m);
+    }
+
     // The code for this function is taken from Arseny's niagara streams. It uses his meshoptimizer library which I am not that familiar with
-    size_t GenerateClusters(RenderingResources* pResources, BlitCL::DynamicArray<Vertex>& vertices, 
+    size_t GenerateClusters(GeometryTarget& target, BlitCL::DynamicArray<Vertex>& vertices, 
     BlitCL::DynamicArray<uint32_t>& indices)
     {
-        const size_t maxVertices = 64;
-        const size_t maxTriangles = 124;
+        const size_t maxVertices = BLIT_MESHLET_MAX_VERTICES;
+        const size_t maxTriangles = BLIT_MESHLET_MAX_TRIANGLES;
         const float coneWeight = 0.25f;
 
         BlitCL::DynamicArray<meshopt_Meshlet> akMeshlets(meshopt_buildMeshletsBound(indices.GetSize(), maxVertices, maxTriangles));
@@ -220,60 +445,358 @@ namespace BlitzenEngine
         for(size_t i = 0; i < akMeshlets.GetSize(); ++i)
         {
             meshopt_Meshlet& meshlet = akMeshlets[i];
+            AppendMeshlet(target, vertices, &meshletVertices[meshlet.vertex_offset], &meshletTriangles[meshlet.triangle_offset], 
+            meshlet.vertex_count, meshlet.triangle_count);
+        }
+
+        return akMeshlets.GetSize();
+    }
+
+    // A cluster of the hierarchy while it is built. Its triangles are in one index array shared by all clusters
+    struct HierarchyCluster
+    {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+
+        float error;
+        BlitML::vec3 lodCenter;
+        float lodRadius;
 
-            meshopt_optimizeMeshlet(&meshletVertices[meshlet.vertex_offset], &meshletTriangles[meshlet.triangle_offset], 
-            meshlet.triangle_count, meshlet.vertex_count);
+        float parentError;
+        BlitML::vec3 parentCenter;
+        float parentRadius;
+    };
+
+    // Gives the smallest sphere around both spheres
+    static void MergeSphere(BlitML::vec3& center, float& radius, const BlitML::vec3& otherCenter, float otherRadius)
+    {
+        float distance = BlitML::Distance(center, otherCenter);
+        if(distance + otherRadius <= radius)
+            return;
+        if(distance + radius <= otherRadius)
+        {
+            center = otherCenter;
+            radius = otherRadius;
+            return;
+        }
+
+        float mergedRadius = (distance + radius + otherRadius) * 0.5f;
+        center = center + (otherCenter - center) * ((mergedRadius - radius) / distance);
+        radius = mergedRadius;
+    }
+
+    // Splits the indices to meshlets and adds them to the clusters, with the error and sphere of the group they were built from
+    static void SplitHierarchyClusters(BlitCL::DynamicArray<Vertex>& vertices, const uint32_t* pIndices, size_t indexCount, 
+    float error, const BlitML::vec3& center, float radius, 
+    BlitCL::DynamicArray<HierarchyCluster>& clusters, BlitCL::DynamicArray<uint32_t>& clusterIndices, 
+    BlitCL::DynamicArray<uint32_t>& newClusters)
+    {
+        const size_t maxVertices = BLIT_MESHLET_MAX_VERTICES;
+        const size_t maxTriangles = BLIT_MESHLET_MAX_TRIANGLES;
+
+        BlitCL::DynamicArray<meshopt_Meshlet> akMeshlets(meshopt_buildMeshletsBound(indexCount, maxVertices, maxTriangles));
+        BlitCL::DynamicArray<unsigned int> meshletVertices(akMeshlets.GetSize() * maxVertices);
+        BlitCL::DynamicArray<unsigned char> meshletTriangles(akMeshlets.GetSize() * maxTriangles * 3);
+
+        akMeshlets.Downsize(meshopt_buildMeshlets(akMeshlets.Data(), meshletVertices.Data(), meshletTriangles.Data(), pIndices, indexCount, 
+        &vertices[0].position.x, vertices.GetSize(), sizeof(Vertex), maxVertices, maxTriangles, 0.f));
+
+        for(size_t i = 0; i < akMeshlets.GetSize(); ++i)
+        {
+            meshopt_Meshlet& meshlet = akMeshlets[i];
 
-            size_t dataOffset = pResources->meshletData.GetSize();
-            for(unsigned int i = 0; i < meshlet.vertex_count; ++i)
+            HierarchyCluster cluster{};
+            cluster.firstIndex = static_cast<uint32_t>(clusterIndices.GetSize());
+            cluster.indexCount = meshlet.triangle_count * 3;
+            for(unsigned int j = 0; j < meshlet.triangle_count * 3; ++j)
+                clusterIndices.PushBack(meshletVertices[meshlet.vertex_offset + meshletTriangles[meshlet.triangle_offset + j]]);
+
+            // The clusters of the full surface have no error, their sphere only needs to be inside the sphere of their group
+            if(error == 0.f)
+            {
+                meshopt_Bounds bounds = meshopt_computeClusterBounds(&clusterIndices[cluster.firstIndex], cluster.indexCount, 
+                &vertices[0].position.x, vertices.GetSize(), sizeof(Vertex));
+                cluster.lodCenter = BlitML::vec3(bounds.center[0], bounds.center[1], bounds.center[2]);
+                cluster.lodRadius = bounds.radius;
+            }
+            else
             {
-                pResources->meshletData.PushBack(meshletVertices[meshlet.vertex_offset + i]);
+                cluster.lodCenter = center;
+                cluster.lodRadius = radius;
             }
+            cluster.error = error;
+            cluster.parentError = FLT_MAX;
+            cluster.parentCenter = cluster.lodCenter;
+            cluster.parentRadius = cluster.lodRadius;
 
-            unsigned int* indexGroups = reinterpret_cast<unsigned int*>(&meshletTriangles[0] + meshlet.triangle_offset);
-            unsigned int indexGroupCount = (meshlet.triangle_count * 3 + 3);
+            newClusters.PushBack(static_cast<uint32_t>(clusters.GetSize()));
+            clusters.PushBack(cluster);
+        }
+    }
 
-            for(unsigned int i = 0; i < indexGroupCount; ++i)
+    size_t GenerateClusterHierarchy(GeometryTarget& target, 
+    BlitCL::DynamicArray<Vertex>& vertices, 
+    BlitCL::DynamicArray<uint32_t>& indices, 
+    BlitCL::DynamicArray<BlitML::vec3>& normals, const LodChainSettings& settings)
+    {
+        BlitCL::DynamicArray<HierarchyCluster> clusters;
+        BlitCL::DynamicArray<uint32_t> clusterIndices;
+
+        // The clusters of the current level, which are grouped and simplified to the clusters of the next one
+        BlitCL::DynamicArray<uint32_t> pending;
+        BlitCL::DynamicArray<uint32_t> nextPending;
+        SplitHierarchyClusters(vertices, indices.Data(), indices.GetSize(), 0.f, BlitML::vec3(0.f), 0.f, clusters, clusterIndices, pending);
+
+        // Vertices on the border of clusters that stopped simplifying stay locked for every level after that, so that no cracks open
+        BlitCL::DynamicArray<uint8_t> rootLock(vertices.GetSize(), 0);
+        BlitCL::DynamicArray<uint8_t> vertexLock(vertices.GetSize());
+        BlitCL::DynamicArray<uint32_t> vertexGroup(vertices.GetSize());
+
+        BlitCL::DynamicArray<BlitML::vec3> centers;
+        BlitCL::DynamicArray<uint32_t> remap;
+        BlitCL::DynamicArray<uint32_t> order;
+        BlitCL::DynamicArray<uint32_t> groupIndices;
+        BlitCL::DynamicArray<uint32_t> simplified;
+
+        while(pending.GetSize() > 1)
+        {
+            // Neighbouring clusters are grouped by sorting their centers along a space filling curve
+            centers.Resize(pending.GetSize());
+            centers.Downsize(pending.GetSize());
+            remap.Resize(pending.GetSize());
+            remap.Downsize(pending.GetSize());
+            order.Resize(pending.GetSize());
+            order.Downsize(pending.GetSize());
+            for(size_t i = 0; i < pending.GetSize(); ++i)
+                centers[i] = clusters[pending[i]].lodCenter;
+            meshopt_spatialSortRemap(remap.Data(), &centers[0].x, centers.GetSize(), sizeof(BlitML::vec3));
+            for(size_t i = 0; i < pending.GetSize(); ++i)
+                order[remap[i]] = pending[i];
+
+            size_t groupCount = (order.GetSize() + BLIT_CLUSTER_GROUP_SIZE - 1) / BLIT_CLUSTER_GROUP_SIZE;
+
+            // Vertices used by more than one group are on a group border and are locked
+            BlitzenCore::BlitMemCopy(vertexLock.Data(), rootLock.Data(), vertexLock.GetSize());
+            vertexGroup.Fill(UINT32_MAX);
+            for(size_t i = 0; i < order.GetSize(); ++i)
             {
-                pResources->meshletData.PushBack(indexGroups[size_t(i)]);
+                uint32_t group = static_cast<uint32_t>(i / BLIT_CLUSTER_GROUP_SIZE);
+                HierarchyCluster& cluster = clusters[order[i]];
+                for(uint32_t j = 0; j < cluster.indexCount; ++j)
+                {
+                    uint32_t vertex = clusterIndices[cluster.firstIndex + j];
+                    if(vertexGroup[vertex] == UINT32_MAX)
+                        vertexGroup[vertex] = group;
+                    else if(vertexGroup[vertex] != group)
+                        vertexLock[vertex] = 1;
+                }
             }
 
-            meshopt_Bounds bounds = meshopt_computeMeshletBounds(&meshletVertices[meshlet.vertex_offset], 
-            &meshletTriangles[meshlet.triangle_offset], meshlet.triangle_count, &vertices[0].position.x, vertices.GetSize(), sizeof(Vertex));
+            nextPending.Clear();
+            for(size_t group = 0; group < groupCount; ++group)
+            {
+                size_t first = group * BLIT_CLUSTER_GROUP_SIZE;
+                size_t last = first + BLIT_CLUSTER_GROUP_SIZE < order.GetSize() ? first + BLIT_CLUSTER_GROUP_SIZE : order.GetSize();
+
+                groupIndices.Clear();
+                for(size_t i = first; i < last; ++i)
+                {
+                    HierarchyCluster& cluster = clusters[order[i]];
+                    groupIndices.AddBlockAtBack(&clusterIndices[cluster.firstIndex], cluster.indexCount);
+                }
 
-            Meshlet m = {};
-            m.dataOffset = static_cast<uint32_t>(dataOffset);
-            m.triangleCount = meshlet.triangle_count;
-            m.vertexCount = meshlet.vertex_count;
+                simplified.Resize(groupIndices.GetSize());
+                size_t targetSize = static_cast<size_t>(double(groupIndices.GetSize()) * BLIT_CLUSTER_GROUP_RATIO / 3) * 3;
 
-            m.center = BlitML::vec3(bounds.center[0], bounds.center[1], bounds.center[2]);
-            m.radius = bounds.radius;
-            m.cone_axis[0] = bounds.cone_axis_s8[0];
-		    m.cone_axis[1] = bounds.cone_axis_s8[1];
-		    m.cone_axis[2] = bounds.cone_axis_s8[2];
-		    m.cone_cutoff = bounds.cone_cutoff_s8; 
+                // The error is absolute, so that groups of different sizes can be compared. The group only touches a few of the vertices
+                float simplifyError = 0.f;
+                size_t simplifiedSize = meshopt_simplifyWithAttributes(simplified.Data(), groupIndices.Data(), groupIndices.GetSize(), 
+                &vertices[0].position.x, vertices.GetSize(), sizeof(Vertex), &normals[0].x, sizeof(BlitML::vec3), 
+                settings.normalWeights, 3, vertexLock.Data(), targetSize, FLT_MAX, 
+                meshopt_SimplifySparse | meshopt_SimplifyErrorAbsolute, &simplifyError);
 
-            pResources->meshlets.PushBack(m);
+                // The clusters of a group that cannot be reduced enough are roots of the hierarchy
+                if(simplifiedSize == 0 || simplifiedSize >= size_t(double(groupIndices.GetSize()) * BLIT_CLUSTER_MIN_REDUCTION))
+                {
+                    for(size_t i = 0; i < groupIndices.GetSize(); ++i)
+                        rootLock[groupIndices[i]] = 1;
+                    continue;
+                }
+
+                // The group error includes the errors of the clusters below it and its sphere contains their spheres,
+                // so the projected error only grows toward the roots and the selected cut has no holes or overlaps
+                float groupError = 0.f;
+                BlitML::vec3 groupCenter = clusters[order[first]].lodCenter;
+                float groupRadius = clusters[order[first]].lodRadius;
+                for(size_t i = first; i < last; ++i)
+                {
+                    HierarchyCluster& cluster = clusters[order[i]];
+                    groupError = BlitML::Max(groupError, cluster.error);
+                    MergeSphere(groupCenter, groupRadius, cluster.lodCenter, cluster.lodRadius);
+                }
+                groupError += simplifyError;
+
+                for(size_t i = first; i < last; ++i)
+                {
+                    HierarchyCluster& cluster = clusters[order[i]];
+                    cluster.parentError = groupError;
+                    cluster.parentCenter = groupCenter;
+                    cluster.parentRadius = groupRadius;
+                }
+
+                simplified.Downsize(simplifiedSize);
+                SplitHierarchyClusters(vertices, simplified.Data(), simplified.GetSize(), groupError, groupCenter, groupRadius, 
+                clusters, clusterIndices, nextPending);
+            }
+
+            pending.Clear();
+            if(nextPending.GetSize())
+                pending.AddBlockAtBack(nextPending.Data(), nextPending.GetSize());
         }
 
-        return akMeshlets.GetSize();
+        // Every cluster becomes one meshlet, with the local vertex list rebuilt from its triangles
+        BlitCL::DynamicArray<unsigned int> localVertices(BLIT_MESHLET_MAX_VERTICES);
+        BlitCL::DynamicArray<unsigned char> localTriangles(BLIT_MESHLET_MAX_TRIANGLES * 3);
+        vertexGroup.Fill(UINT32_MAX);
+        for(size_t i = 0; i < clusters.GetSize(); ++i)
+        {
+            HierarchyCluster& cluster = clusters[i];
+
+            size_t vertexCount = 0;
+            for(uint32_t j = 0; j < cluster.indexCount; ++j)
+            {
+                uint32_t vertex = clusterIndices[cluster.firstIndex + j];
+                if(vertexGroup[vertex] == UINT32_MAX)
+                {
+                    vertexGroup[vertex] = static_cast<uint32_t>(vertexCount);
+                    localVertices[vertexCount++] = vertex;
+                }
+                localTriangles[j] = static_cast<unsigned char>(vertexGroup[vertex]);
+            }
+            for(size_t j = 0; j < vertexCount; ++j)
+                vertexGroup[localVertices[j]] = UINT32_MAX;
+
+            AppendMeshlet(target, vertices, localVertices.Data(), localTriangles.Data(), vertexCount, cluster.indexCount / 3);
+
+            // The simplifier gave absolute errors, in the units of the surface like the errors of the discrete levels
+            Meshlet& meshlet = target.meshlets.Back();
+            meshlet.error = cluster.error;
+            meshlet.lodCenter = cluster.lodCenter;
+            meshlet.lodRadius = cluster.lodRadius;
+            meshlet.parentError = cluster.parentError;
+            meshlet.parentCenter = cluster.parentCenter;
+            meshlet.parentRadius = cluster.parentRadius;
+        }
+
+        return clusters.GetSize();
     }
 
     void LoadPrimitiveSurface(RenderingResources* pResources, 
     BlitCL::DynamicArray<Vertex>& vertices, 
+    BlitCL::DynamicArray<uint32_t>& indices, 
+    BlitCL::DynamicArray<MeshQualityStats>* pQuality)
+    {
+        // The offsets of new surfaces would be wrong if the arrays were released
+        BLIT_ASSERT_MESSAGE(pResources->geometryResident, "Geometry cannot be loaded after it has been released")
+
+        // Meshlets are only needed by the cluster rendering path
+        #if BLITZEN_CLUSTER_RENDERING && !defined(BLITZEN_COOK)
+            uint8_t buildMeshlets = RenderingSystem::GetRenderingSystem()->GetVulkan().GetStats().meshShaderSupport;
+        #else
+            uint8_t buildMeshlets = 0;
+        #endif
+
+        GeometryTarget target{pResources->vertices, pResources->indices, pResources->meshlets, pResources->meshletData, 
+        pResources->surfaces, buildMeshlets, pQuality, &pResources->lodSettings};
+        LoadPrimitiveSurface(target, vertices, indices);
+    }
+
+    static void MeasureMeshQuality(BlitCL::DynamicArray<Vertex>& vertices, BlitCL::DynamicArray<uint32_t>& indices, 
+    float& acmr, float& atvr, float& overdraw)
+    {
+        if(!indices.GetSize())
+        {
+            acmr = atvr = overdraw = 0.f;
+            return;
+        }
+
+        meshopt_VertexCacheStatistics cache = meshopt_analyzeVertexCache(indices.Data(), indices.GetSize(), vertices.GetSize(), 16, 0, 0);
+        meshopt_OverdrawStatistics overdrawStats = meshopt_analyzeOverdraw(indices.Data(), indices.GetSize(), 
+        &vertices[0].position.x, vertices.GetSize(), sizeof(Vertex));
+
+        acmr = cache.acmr;
+        atvr = cache.atvr;
+        overdraw = overdrawStats.overdraw;
+    }
+
+    // Reorders the triangles of the indices, which should already be optimized for the vertex cache
+    static void OptimizeOverdraw(BlitCL::DynamicArray<Vertex>& vertices, BlitCL::DynamicArray<uint32_t>& indices)
+    {
+        #if BLIT_MESH_OVERDRAW_OPTIMIZATION
+            meshopt_optimizeOverdraw(indices.Data(), indices.Data(), indices.GetSize(), &vertices[0].position.x, vertices.GetSize(), 
+            sizeof(Vertex), BLIT_MESH_OVERDRAW_THRESHOLD);
+        #endif
+    }
+
+    // Gives the LOD a bounding sphere around the vertices that its indices use. Simplified levels drop vertices, 
+    // so their spheres can be smaller than the sphere of the surface. The used array is only scratch memory, one element per vertex
+    static void ComputeLodBounds(BlitCL::DynamicArray<Vertex>& vertices, BlitCL::DynamicArray<uint32_t>& indices, 
+    BlitCL::DynamicArray<uint8_t>& used, MeshLod& lod)
+    {
+        BlitzenCore::BlitZeroMemory(used.Data(), used.GetSize());
+
+        BlitML::vec3 center(0.f);
+        size_t usedCount = 0;
+        for(size_t i = 0; i < indices.GetSize(); ++i)
+        {
+            uint32_t index = indices[i];
+            if(used[index])
+                continue;
+            used[index] = 1;
+            center = center + vertices[index].position;
+            ++usedCount;
+        }
+        center = usedCount ? center / static_cast<float>(usedCount) : center;
+
+        float radius = 0;
+        for(size_t i = 0; i < vertices.GetSize(); ++i)
+        {
+            if(used[i])
+                radius = BlitML::Max(radius, BlitML::Distance(center, vertices[i].position));
+        }
+
+        lod.center = center;
+        lod.radius = radius;
+    }
+
+    void LoadPrimitiveSurface(GeometryTarget& target, 
+    BlitCL::DynamicArray<Vertex>& vertices, 
     BlitCL::DynamicArray<uint32_t>& indices)
     {
+        // Measured on the indices as they were loaded, before any of the passes below
+        MeshQualityStats quality{};
+        if(target.pQuality)
+            MeasureMeshQuality(vertices, indices, quality.acmrBefore, quality.atvrBefore, quality.overdrawBefore);
+
         // This is an algorithm from Arseny Kapoulkine that improves the way vertices are distributed for a mesh
         meshopt_optimizeVertexCache(indices.Data(), indices.Data(), indices.GetSize(), vertices.GetSize());
+        OptimizeOverdraw(vertices, indices);
 	    meshopt_optimizeVertexFetch(vertices.Data(), indices.Data(), indices.GetSize(), vertices.Data(), 
         vertices.GetSize(), sizeof(Vertex));
 
+        if(target.pQuality)
+        {
+            MeasureMeshQuality(vertices, indices, quality.acmrAfter, quality.atvrAfter, quality.overdrawAfter);
+            quality.triangleCount = static_cast<uint32_t>(indices.GetSize() / 3);
+            target.pQuality->PushBack(quality);
+        }
+
         // Create the new surface that will be added and initialize its vertex offset
         PrimitiveSurface newSurface;
-        newSurface.vertexOffset = static_cast<uint32_t>(pResources->vertices.GetSize());
+        newSurface.vertexOffset = static_cast<uint32_t>(target.vertices.GetSize());
 
         // Since the vertices will be global for all shaders and objects, new elements will be added to the one vertex array
-        pResources->vertices.AddBlockAtBack(vertices.Data(), vertices.GetSize());
+        target.vertices.AddBlockAtBack(vertices.Data(), vertices.GetSize());
 
         // Create the normal array to be used with the meshoptimizer function for lod generation
         BlitCL::DynamicArray<BlitML::vec3> normals(vertices.GetSize());
@@ -289,12 +812,25 @@ namespace BlitzenEngine
         // Lod error will be passed as a pointer every time the meshopt lod genration function is called, to save the next error
         float lodError = 0.f;
 
-	    float normalWeights[3] = {1.f, 1.f, 1.f};
+        const LodChainSettings defaultSettings;
+        const LodChainSettings& settings = target.pLodSettings ? *target.pLodSettings : defaultSettings;
 
-        // Pass the original loaded indices of the surface to the new lod indices
+        // Set once the attribute aware simplifier stalls. Every level after that is built by the sloppy simplifier
+        uint8_t bSloppy = 0;
+
+        // Pass the original loaded indices of the surface to the new lod indices. The next level is simplified to the scratch array, 
+        // so that the sloppy simplifier can start from the same indices if the other one stalls
         BlitCL::DynamicArray<uint32_t> lodIndices(indices);
+        BlitCL::DynamicArray<uint32_t> nextIndices(indices.GetSize());
+
+        BlitCL::DynamicArray<uint8_t> usedVertices(vertices.GetSize());
 
-        uint8_t buildMeshlets = RenderingSystem::GetRenderingSystem()->GetVulkan().GetStats().meshShaderSupport;
+        // The cluster hierarchy replaces the meshlets of the discrete levels. The task shader selects its clusters by their own error,
+        // so every level points to all of them and the discrete levels are only used by the vertex shader path
+        uint8_t bHierarchy = target.buildMeshlets && settings.bClusterHierarchy;
+        uint32_t hierarchyFirstMeshlet = static_cast<uint32_t>(target.meshlets.GetSize());
+        uint32_t hierarchyMeshletCount = bHierarchy ? 
+            static_cast<uint32_t>(GenerateClusterHierarchy(target, vertices, indices, normals, settings)) : 0;
 
         while(newSurface.lodCount < BLIT_MAX_MESH_LOD)
         {
@@ -302,51 +838,74 @@ namespace BlitzenEngine
             MeshLod& lod = newSurface.meshLod[newSurface.lodCount++];
 
             // Save the indices that will be used for the current lod level
-            lod.firstIndex = static_cast<uint32_t>(pResources->indices.GetSize());
+            lod.firstIndex = static_cast<uint32_t>(target.indices.GetSize());
             lod.indexCount = static_cast<uint32_t>(lodIndices.GetSize());
 
-            // Save the meshlets that will be used for the current lod level
-            lod.firstMeshlet = static_cast<uint32_t>(pResources->meshlets.GetSize());
-            lod.meshletCount = buildMeshlets ? static_cast<uint32_t>(GenerateClusters(pResources, vertices, indices)) : 0;
+            // Save the meshlets that will be used for the current lod level. They are built from the indices of this level
+            if(bHierarchy)
+            {
+                lod.firstMeshlet = hierarchyFirstMeshlet;
+                lod.meshletCount = hierarchyMeshletCount;
+            }
+            else
+            {
+                lod.firstMeshlet = static_cast<uint32_t>(target.meshlets.GetSize());
+                lod.meshletCount = target.buildMeshlets ? static_cast<uint32_t>(GenerateClusters(target, vertices, lodIndices)) : 0;
+            }
 
             // Add the new indices that were loaded for this lod level to the global index buffer
-            pResources->indices.AddBlockAtBack(lodIndices.Data(), lodIndices.GetSize());
+            target.indices.AddBlockAtBack(lodIndices.Data(), lodIndices.GetSize());
 
-            // Save the current lod error
+            // Save the current lod error and the sphere that it is projected from
             lod.error = lodError * lodScale;
+            ComputeLodBounds(vertices, lodIndices, usedVertices, lod);
 
             if(newSurface.lodCount < BLIT_MAX_MESH_LOD)
             {
-                // Specify the next target index count (simplify by 65% each time)
-                size_t nextIndicesTarget = static_cast<size_t>((double(lodIndices.GetSize()) * 0.65) / 3) * 3;
+                // Specify the next target index count, a fraction of the current one
+                size_t nextIndicesTarget = static_cast<size_t>((double(lodIndices.GetSize()) * settings.targetRatio) / 3) * 3;
+                if(nextIndicesTarget < size_t(settings.minTriangleCount) * 3)
+                    break;
 
-                const float maxError = 1e-1f;// Parameter for meshopt_simplifyWithAttributes
+                // Levels that are too close to the last one are not kept
+                size_t minReducedSize = size_t(double(lodIndices.GetSize()) * settings.minReduction);
 
                 // The next error will be saved here to check if the actual lod error should be updated
                 float nextError = 0;
+                size_t nextIndicesSize = 0;
 
-                // Generate the indices
-                size_t nextIndicesSize = meshopt_simplifyWithAttributes(lodIndices.Data(), lodIndices.Data(), 
-                lodIndices.GetSize(), &vertices[0].position.x, 
-                vertices.GetSize(), sizeof(Vertex), &normals[0].x, sizeof(BlitML::vec3), 
-                normalWeights, 3, nullptr, nextIndicesTarget, maxError, 0, &nextError);
+                bSloppy = bSloppy || (settings.bSloppyFallback && newSurface.lodCount >= settings.firstSloppyLevel);
+                if(!bSloppy)
+                {
+                    nextIndicesSize = meshopt_simplifyWithAttributes(nextIndices.Data(), lodIndices.Data(), 
+                    lodIndices.GetSize(), &vertices[0].position.x, 
+                    vertices.GetSize(), sizeof(Vertex), &normals[0].x, sizeof(BlitML::vec3), 
+                    settings.normalWeights, 3, nullptr, nextIndicesTarget, settings.maxError, 0, &nextError);
+
+                    // Reached the error bounds. The sloppy simplifier ignores the topology, so it can still reduce the mesh
+                    if(nextIndicesSize == 0 || nextIndicesSize >= minReducedSize)
+                        bSloppy = settings.bSloppyFallback;
+                }
+                if(bSloppy)
+                {
+                    nextIndicesSize = meshopt_simplifySloppy(nextIndices.Data(), lodIndices.Data(), lodIndices.GetSize(), 
+                    &vertices[0].position.x, vertices.GetSize(), sizeof(Vertex), nextIndicesTarget, settings.sloppyMaxError, &nextError);
+                }
 
                 // If the next lod size surpasses the previous than this function has failed
                 BLIT_ASSERT(nextIndicesSize <= lodIndices.GetSize())
 
-                // Reached the error bounds
-                if(nextIndicesSize == lodIndices.GetSize() || nextIndicesSize == 0)
+                // Reached the error bounds, or the level is too close to the last one
+                if(nextIndicesSize == 0 || nextIndicesSize >= minReducedSize)
                     break;
 
-                // while I could keep this LOD, it's too close to the last one (and it can't go below that due to constant error bound above)
-			    if (nextIndicesSize >= size_t(double(lodIndices.GetSize()) * 0.95))
-				    break;
-
                 // Downsize the indices to the next indices size
                 lodIndices.Downsize(nextIndicesSize);
+                BlitzenCore::BlitMemCopy(lodIndices.Data(), nextIndices.Data(), nextIndicesSize * sizeof(uint32_t));
  
                 // Optimize the new vertex cache that was generated
                 meshopt_optimizeVertexCache(lodIndices.Data(), lodIndices.Data(), lodIndices.GetSize(), vertices.GetSize());
+                OptimizeOverdraw(vertices, lodIndices);
 
                 // since it starts from next lod accumulate the error
                 lodError = BlitML::Max(lodError, nextError);
@@ -377,10 +936,181 @@ namespace BlitzenEngine
         newSurface.materialId = 0;
 
         // Add the resources to the global surface array so that it is added to the GPU buffer
-        pResources->surfaces.PushBack(newSurface);
+        target.surfaces.PushBack(newSurface);
+    }
+
+
+
+    uint8_t AddSurfaceImpostor(RenderingResources* pResources, uint32_t surfaceId, const char* albedoSourcePath)
+    {
+        BLIT_ASSERT_MESSAGE(pResources->geometryResident, "Impostors cannot be added after the geometry has been released")
+
+        PrimitiveSurface& surface = pResources->surfaces[surfaceId];
+        if(surface.bImpostor || !surface.lodCount || surface.lodCount >= BLIT_MAX_MESH_LOD)
+            return 0;
+        if(pResources->materials.GetSize() >= BLIT_MAX_MATERIAL_COUNT || pResources->textures.GetSize() + 2 > BLIT_MAX_TEXTURE_COUNT)
+            return 0;
+
+        // Every level uses the vertices of the first one
+        MeshLod& firstLod = surface.meshLod[0];
+        uint32_t vertexCount = 0;
+        for(uint32_t i = 0; i < firstLod.indexCount; ++i)
+            vertexCount = BlitML::Max(vertexCount, pResources->indices[firstLod.firstIndex + i] + 1);
+        const Vertex* pVertices = &pResources->vertices[surface.vertexOffset];
+
+        // The frames are small, so the first level with a few triangles for each of their texels is rendered instead of the full surface
+        const uint32_t bakeTriangleCount = BLIT_IMPOSTOR_FRAME_SIZE * BLIT_IMPOSTOR_FRAME_SIZE * 4;
+        uint8_t bakeLod = 0;
+        while(bakeLod + 1 < surface.lodCount && surface.meshLod[bakeLod].indexCount / 3 > bakeTriangleCount)
+            ++bakeLod;
+
+        // The atlases are cached by the layout of the grid, the geometry and the albedo
+        uint32_t layout[2] = {BLIT_IMPOSTOR_GRID, BLIT_IMPOSTOR_FRAME_SIZE};
+        uint64_t hash = HashBytes(reinterpret_cast<const uint8_t*>(layout), sizeof(layout), 0);
+        hash = HashBytes(reinterpret_cast<const uint8_t*>(pVertices), vertexCount * sizeof(Vertex), hash);
+        hash = HashBytes(reinterpret_cast<const uint8_t*>(&pResources->indices[firstLod.firstIndex]), 
+        firstLod.indexCount * sizeof(uint32_t), hash);
+        if(albedoSourcePath)
+            hash = HashBytes(reinterpret_cast<const uint8_t*>(albedoSourcePath), strlen(albedoSourcePath), hash);
+
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+        std::string directory = std::string(BLIT_ASSET_CACHE_DIRECTORY) + "Impostors";
+        std::string colorPath = directory + "/" + name + "_color.dds";
+        std::string normalPath = directory + "/" + name + "_normal.dds";
+        if(!BlitzenPlatform::FilepathExists(colorPath.c_str()) || !BlitzenPlatform::FilepathExists(normalPath.c_str()))
+        {
+            MeshLod& bake = surface.meshLod[bakeLod];
+            if(!BlitzenPlatform::CreateDirectories(directory.c_str()) || 
+            !BakeImpostorAtlases(pVertices, &pResources->indices[bake.firstIndex], bake.indexCount, surface.center, surface.radius, 
+            albedoSourcePath, colorPath.c_str(), normalPath.c_str()))
+            {
+                BLIT_WARN("Failed to bake the impostor of surface %u", surfaceId)
+                return 0;
+            }
+        }
+
+        // Without the normal atlas the billboard is lit by the direction of its frame
+        if(!LoadTextureFromFile(pResources, colorPath.c_str(), name, 1, 0))
+            return 0;
+        uint32_t colorTag = pResources->textures.Back().textureTag;
+        uint32_t normalTag = LoadTextureFromFile(pResources, normalPath.c_str(), name, 1, 0) ? pResources->textures.Back().textureTag : 0;
+
+        pResources->materials.Resize(pResources->materials.GetSize() + 1);
+        Material& material = pResources->materials.Back();
+        material.diffuseColor = BlitML::vec4(1.f);
+        material.shininess = 0.f;
+        material.albedoTag = colorTag;
+        material.normalTag = normalTag;
+        material.specularTag = 0;
+        material.emissiveTag = 0;
+        material.materialId = static_cast<uint32_t>(pResources->materials.GetSize() - 1);
+        material.flags = BLIT_MATERIAL_ALPHA_TEST;
+
+        // The corners of the billboard. The vertex shader places them around the center, facing the nearest frame
+        uint32_t firstCorner = static_cast<uint32_t>(pResources->vertices.GetSize());
+        for(uint32_t i = 0; i < 4; ++i)
+        {
+            Vertex corner{};
+            corner.position = BlitML::vec3(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, 0.f);
+            pResources->vertices.PushBack(corner);
+        }
+
+        MeshLod& lastLod = surface.meshLod[surface.lodCount - 1];
+        MeshLod& impostor = surface.meshLod[surface.lodCount];
+        impostor.center = surface.center;
+        impostor.radius = surface.radius;
+        impostor.firstIndex = static_cast<uint32_t>(pResources->indices.GetSize());
+        impostor.indexCount = 6;
+        impostor.error = BlitML::Max(lastLod.error, surface.radius * pResources->lodSettings.impostorError);
+
+        // The mesh shader has no billboards, it keeps drawing the meshlets of the last level
+        impostor.firstMeshlet = lastLod.firstMeshlet;
+        impostor.meshletCount = lastLod.meshletCount;
+
+        uint32_t impostorVertex = firstCorner - surface.vertexOffset;
+        uint32_t quad[6] = {0, 1, 2, 2, 1, 3};
+        for(uint32_t i = 0; i < 6; ++i)
+            pResources->indices.PushBack(impostorVertex + quad[i]);
+
+        surface.lodCount++;
+        surface.bImpostor = 1;
+        surface.impostorVertex = impostorVertex;
+        surface.impostorMaterialId = material.materialId;
+        return 1;
+    }
+
+    void SumMeshQuality(const MeshQualityStats* pStats, size_t count, MeshQualityStats& total)
+    {
+        // The averages are weighted sums until every surface has been added
+        double sums[6] = {};
+        double triangleCount = 0;
+        for(size_t i = 0; i < count; ++i)
+        {
+            const MeshQualityStats& stats = pStats[i];
+            double weight = stats.triangleCount;
+            sums[0] += stats.acmrBefore * weight;
+            sums[1] += stats.acmrAfter * weight;
+            sums[2] += stats.atvrBefore * weight;
+            sums[3] += stats.atvrAfter * weight;
+            sums[4] += stats.overdrawBefore * weight;
+            sums[5] += stats.overdrawAfter * weight;
+            triangleCount += weight;
+        }
+
+        total = {};
+        if(triangleCount == 0)
+            return;
+        total.acmrBefore = static_cast<float>(sums[0] / triangleCount);
+        total.acmrAfter = static_cast<float>(sums[1] / triangleCount);
+        total.atvrBefore = static_cast<float>(sums[2] / triangleCount);
+        total.atvrAfter = static_cast<float>(sums[3] / triangleCount);
+        total.overdrawBefore = static_cast<float>(sums[4] / triangleCount);
+        total.overdrawAfter = static_cast<float>(sums[5] / triangleCount);
+        total.triangleCount = static_cast<uint32_t>(triangleCount);
+    }
+
+    void LogMeshQuality(const char* name, BlitCL::DynamicArray<MeshQualityStats>& quality)
+    {
+        #if BLIT_MESH_QUALITY_REPORT
+            for(size_t i = 0; i < quality.GetSize(); ++i)
+            {
+                MeshQualityStats& stats = quality[i];
+                BLIT_INFO("Surface %u of %s, %u triangles: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, overdraw %.3f -> %.3f", 
+                static_cast<uint32_t>(i), name, stats.triangleCount, stats.acmrBefore, stats.acmrAfter, stats.atvrBefore, stats.atvrAfter, 
+                stats.overdrawBefore, stats.overdrawAfter)
+            }
+        #endif
+
+        MeshQualityStats total;
+        SumMeshQuality(quality.Data(), quality.GetSize(), total);
+        BLIT_INFO("Mesh quality of %s, %u triangles: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, overdraw %.3f -> %.3f", name, 
+        total.triangleCount, total.acmrBefore, total.acmrAfter, total.atvrBefore, total.atvrAfter, total.overdrawBefore, total.overdrawAfter)
     }
 
+    size_t ReleaseUploadedGeometry(RenderingResources* pResources)
+    {
+        if(!pResources->geometryResident)
+            return 0;
+
+        size_t releasedBytes = pResources->vertices.GetSize() * sizeof(Vertex) + 
+        pResources->indices.GetSize() * sizeof(uint32_t) + 
+        pResources->meshlets.GetSize() * sizeof(Meshlet) + 
+        pResources->meshletData.GetSize() * sizeof(uint32_t);
 
+        pResources->vertices.ReleaseMemory();
+        pResources->indices.ReleaseMemory();
+        pResources->meshlets.ReleaseMemory();
+        pResources->meshletData.ReleaseMemory();
+
+        // The cached surfaces cannot be shared without the geometry arrays, since no more gltf scenes can be loaded at setup
+        releasedBytes += pResources->surfaceCache.GetMemorySize() + pResources->geometryCache.GetMemorySize();
+        pResources->surfaceCache.Clear();
+        pResources->geometryCache.Clear();
+
+        pResources->geometryResident = 0;
+        return releasedBytes;
+    }
 
     void LoadTestGeometry(RenderingResources* pResources)
     {
@@ -393,10 +1123,10 @@ namespace BlitzenEngine
 
     void CreateTestGameObjects(RenderingResources* pResources, uint32_t drawCount)
     {
-        pResources->objectCount = drawCount;// Normally the draw count differs from the game object count, but the engine is really simple at the moment
-        pResources->transforms.Resize(pResources->objectCount);// Every object has a different transform
+        uint32_t objectCount = drawCount;// Normally the draw count differs from the game object count, but the engine is really simple at the moment
+        pResources->transforms.Resize(objectCount);// Every object has a different transform
         // Hardcode a large amount of male model mesh
-        for(size_t i = 0; i < pResources->objectCount / 10; ++i)
+        for(size_t i = 0; i < objectCount / 10; ++i)
         {
             BlitzenEngine::MeshTransform& transform = pResources->transforms[i];
 
@@ -415,13 +1145,14 @@ namespace BlitzenEngine
             BlitML::quat orientation = BlitML::QuatFromAngleAxis(axis, angle, 0);
             transform.orientation = orientation;
 
-            GameObject& currentObject = pResources->objects[i];
-
+            // Transform index is the same as the object index
+            GameObject currentObject;
             currentObject.meshIndex = 3;// Hardcode the bunny mesh for each object in this loop
-            currentObject.transformIndex = static_cast<uint32_t>(i);// Transform index is the same as the object index
+            currentObject.transformIndex = static_cast<uint32_t>(i);
+            pResources->objects.Insert(currentObject);
         }
         // Hardcode a large amount of objects with the high polygon kitten mesh and random transforms
-        for (size_t i = pResources->objectCount / 10; i < pResources->objectCount / 8; ++i)
+        for (size_t i = objectCount / 10; i < objectCount / 8; ++i)
         {
             BlitzenEngine::MeshTransform& transform = pResources->transforms[i];
 
@@ -440,13 +1171,14 @@ namespace BlitzenEngine
             BlitML::quat orientation = BlitML::QuatFromAngleAxis(axis, angle, 0);
             transform.orientation = orientation;
 
-            GameObject& currentObject = pResources->objects[i];
-
+            // Transform index is the same as the object index
+            GameObject currentObject;
             currentObject.meshIndex = 1;// Hardcode the kitten mesh for each object in this loop
-            currentObject.transformIndex = static_cast<uint32_t>(i);// Transform index is the same as the object index
+            currentObject.transformIndex = static_cast<uint32_t>(i);
+            pResources->objects.Insert(currentObject);
         }
         // Hardcode a large amount of stanford dragons
-        for (size_t i = pResources->objectCount / 8; i < pResources->objectCount / 6; ++i)
+        for (size_t i = objectCount / 8; i < objectCount / 6; ++i)
         {
             BlitzenEngine::MeshTransform& transform = pResources->transforms[i];
 
@@ -465,13 +1197,14 @@ namespace BlitzenEngine
             BlitML::quat orientation = BlitML::QuatFromAngleAxis(axis, angle, 0);
             transform.orientation = orientation;
 
-            GameObject& currentObject = pResources->objects[i];
-
+            // Transform index is the same as the object index
+            GameObject currentObject;
             currentObject.meshIndex = 0;// Hardcode the kitten mesh for each object in this loop
-            currentObject.transformIndex = static_cast<uint32_t>(i);// Transform index is the same as the object index
+            currentObject.transformIndex = static_cast<uint32_t>(i);
+            pResources->objects.Insert(currentObject);
         }
         // Hardcode a large amount of standford bunnies
-        for (size_t i = pResources->objectCount / 6; i < pResources->objectCount; ++i)
+        for (size_t i = objectCount / 6; i < objectCount; ++i)
         {
             BlitzenEngine::MeshTransform& transform = pResources->transforms[i];
 
@@ -490,30 +1223,200 @@ namespace BlitzenEngine
             BlitML::quat orientation = BlitML::QuatFromAngleAxis(axis, angle, 0);
             transform.orientation = orientation;
 
-            GameObject& currentObject = pResources->objects[i];
-
+            // Transform index is the same as the object index
+            GameObject currentObject;
             currentObject.meshIndex = 2;// Hardcode the kitten mesh for each object in this loop
-            currentObject.transformIndex = static_cast<uint32_t>(i);// Transform index is the same as the object index
+            currentObject.transformIndex = static_cast<uint32_t>(i);
+            pResources->objects.Insert(currentObject);
         }
 
         // Create all the render objects by getting the data from the game objects
-        for(size_t i = 0; i < pResources->objectCount; ++i)
+        for(size_t i = 0; i < pResources->objects.GetSize(); ++i)
         {
             // Get the mesh used by the current game object
             BlitzenEngine::Mesh& currentMesh = pResources->meshes[pResources->objects[i].meshIndex];
 
             for(size_t j = 0; j < currentMesh.surfaceCount; ++j)
             {
-                RenderObject& currentObject = pResources->renders[pResources->renderObjectCount];
-
                 // Get the surface Id for this render object by adding the current index to the first surface of the mesh
-                currentObject.surfaceId = currentMesh.firstSurface + static_cast<uint32_t>(j);
-                
-                currentObject.transformId = pResources->objects[i].transformIndex;
+                AddRenderObject(pResources, pResources->objects[i].transformIndex, currentMesh.firstSurface + static_cast<uint32_t>(j));
+            }
+        }
+    }
 
-                pResources->renderObjectCount++;
+    BlitCL::SlotHandle AddRenderObject(RenderingResources* pResources, uint32_t transformId, uint32_t surfaceId)
+    {
+        RenderObject newObject;
+        newObject.transformId = transformId;
+        newObject.surfaceId = surfaceId;
+
+        // Post pass objects stay at the back of the array, where they are inserted
+        BlitCL::SlotHandle handle = pResources->renders.Insert(newObject);
+
+        // Opaque objects take the place of the first post pass object, which is moved to the back (if there are any)
+        if(!pResources->surfaces[surfaceId].postPass)
+        {
+            pResources->renders.SwapDense(pResources->opaqueRenderObjectCount, pResources->renders.GetSize() - 1);
+            pResources->opaqueRenderObjectCount++;
+        }
+
+        return handle;
+    }
+
+    void SortRenderObjectsSpatially(RenderingResources* pResources)
+    {
+        size_t transformCount = pResources->transforms.GetSize();
+        size_t renderCount = pResources->renders.GetSize();
+        if(!transformCount)
+            return;
+
+        // Maps each old transform id to its place in Morton order. The position is the first member of the transform
+        BlitCL::DynamicArray<uint32_t> transformRemap(transformCount);
+        meshopt_spatialSortRemap(transformRemap.Data(), &pResources->transforms[0].pos.x, transformCount, sizeof(MeshTransform));
+
+        BlitCL::DynamicArray<MeshTransform> sortedTransforms(transformCount);
+        for(size_t i = 0; i < transformCount; ++i)
+            sortedTransforms[transformRemap[i]] = pResources->transforms[i];
+        BlitzenCore::BlitMemCopy(pResources->transforms.Data(), sortedTransforms.Data(), transformCount * sizeof(MeshTransform));
+
+        for(size_t i = 0; i < pResources->objects.GetSize(); ++i)
+            pResources->objects[i].transformIndex = transformRemap[pResources->objects[i].transformIndex];
+
+        // Counting sort of each range by the new transform ids. Objects of the same transform keep their order
+        BlitCL::DynamicArray<uint32_t> transformOffsets(transformCount + 1);
+        BlitCL::DynamicArray<uint32_t> renderRemap(renderCount);
+        uint32_t ranges[3] = {0, pResources->opaqueRenderObjectCount, static_cast<uint32_t>(renderCount)};
+        for(uint32_t range = 0; range < 2; ++range)
+        {
+            BlitzenCore::BlitMemSet(transformOffsets.Data(), 0, transformOffsets.GetSize() * sizeof(uint32_t));
+            for(uint32_t i = ranges[range]; i < ranges[range + 1]; ++i)
+            {
+                RenderObject& object = pResources->renders[i];
+                object.transformId = transformRemap[object.transformId];
+                transformOffsets[object.transformId + 1]++;
             }
+
+            transformOffsets[0] = ranges[range];
+            for(size_t i = 1; i <= transformCount; ++i)
+                transformOffsets[i] += transformOffsets[i - 1];
+
+            for(uint32_t i = ranges[range]; i < ranges[range + 1]; ++i)
+                renderRemap[i] = transformOffsets[pResources->renders[i].transformId]++;
+        }
+
+        pResources->renders.ReorderDense(renderRemap.Data());
+    }
+
+    void BuildMeshInstances(RenderingResources* pResources)
+    {
+        // Each transform is used by exactly one game object or gltf node, so it is also the id of the mesh instance
+        size_t instanceCount = pResources->transforms.GetSize();
+        pResources->meshInstances.Resize(instanceCount);
+        pResources->instanceObjects.Resize(pResources->renders.GetSize());
+        for(size_t i = 0; i < instanceCount; ++i)
+        {
+            MeshInstance& instance = pResources->meshInstances[i];
+            instance.transformId = static_cast<uint32_t>(i);
+            instance.opaqueObjectCount = 0;
+            instance.postPassObjectCount = 0;
+        }
+
+        // Counts the opaque and post pass objects of each instance
+        for(uint32_t i = 0; i < pResources->renders.GetSize(); ++i)
+        {
+            MeshInstance& instance = pResources->meshInstances[pResources->renders[i].transformId];
+            if(i < pResources->opaqueRenderObjectCount)
+                instance.opaqueObjectCount++;
+            else
+                instance.postPassObjectCount++;
+        }
+
+        // Gives each instance its ranges. The post pass ranges start after every opaque object, like in the renders array
+        uint32_t opaqueOffset = 0;
+        uint32_t postPassOffset = pResources->opaqueRenderObjectCount;
+        for(size_t i = 0; i < instanceCount; ++i)
+        {
+            MeshInstance& instance = pResources->meshInstances[i];
+            instance.firstOpaqueObject = opaqueOffset;
+            instance.firstPostPassObject = postPassOffset;
+            opaqueOffset += instance.opaqueObjectCount;
+            postPassOffset += instance.postPassObjectCount;
+
+            // The counts are rebuilt below, while the objects are written to the ranges
+            instance.opaqueObjectCount = 0;
+            instance.postPassObjectCount = 0;
+        }
+        for(uint32_t i = 0; i < pResources->renders.GetSize(); ++i)
+        {
+            MeshInstance& instance = pResources->meshInstances[pResources->renders[i].transformId];
+            if(i < pResources->opaqueRenderObjectCount)
+                pResources->instanceObjects[instance.firstOpaqueObject + instance.opaqueObjectCount++] = i;
+            else
+                pResources->instanceObjects[instance.firstPostPassObject + instance.postPassObjectCount++] = i;
+        }
+
+        for(size_t i = 0; i < instanceCount; ++i)
+            ComputeMeshInstanceBounds(pResources, pResources->meshInstances[i]);
+    }
+
+    void ComputeMeshInstanceBounds(RenderingResources* pResources, MeshInstance& instance)
+    {
+        // The instance bounding sphere is centered on the bounds of its surface spheres and its radius reaches the furthest one.
+        // It stays in model space like the surface spheres, so that the transform is applied the same way when culling
+        uint32_t objectCount = instance.opaqueObjectCount + instance.postPassObjectCount;
+        if(!objectCount)
+        {
+            instance.center = BlitML::vec3(0.f);
+            instance.radius = 0.f;
+            return;
+        }
+
+        BlitML::vec3 boundsMin(FLT_MAX);
+        BlitML::vec3 boundsMax(-FLT_MAX);
+        for(uint32_t j = 0; j < objectCount; ++j)
+        {
+            uint32_t objectId = j < instance.opaqueObjectCount ? pResources->instanceObjects[instance.firstOpaqueObject + j] :
+            pResources->instanceObjects[instance.firstPostPassObject + j - instance.opaqueObjectCount];
+            PrimitiveSurface& surface = pResources->surfaces[pResources->renders[objectId].surfaceId];
+
+            boundsMin = BlitML::vec3(BlitML::Min(boundsMin.x, surface.center.x - surface.radius),
+            BlitML::Min(boundsMin.y, surface.center.y - surface.radius), BlitML::Min(boundsMin.z, surface.center.z - surface.radius));
+            boundsMax = BlitML::vec3(BlitML::Max(boundsMax.x, surface.center.x + surface.radius),
+            BlitML::Max(boundsMax.y, surface.center.y + surface.radius), BlitML::Max(boundsMax.z, surface.center.z + surface.radius));
+        }
+        instance.center = (boundsMin + boundsMax) * 0.5f;
+
+        instance.radius = 0.f;
+        for(uint32_t j = 0; j < objectCount; ++j)
+        {
+            uint32_t objectId = j < instance.opaqueObjectCount ? pResources->instanceObjects[instance.firstOpaqueObject + j] :
+            pResources->instanceObjects[instance.firstPostPassObject + j - instance.opaqueObjectCount];
+            PrimitiveSurface& surface = pResources->surfaces[pResources->renders[objectId].surfaceId];
+            instance.radius = BlitML::Max(instance.radius, BlitML::Distance(instance.center, surface.center) + surface.radius);
+        }
+    }
+
+    uint8_t SelectSurfaceLod(PrimitiveSurface& surface, MeshTransform& transform, CameraViewData& viewData, uint8_t previousLod)
+    {
+        // Same order of operations as SelectLod in the culling shaders
+        BlitML::vec3 q(transform.orientation.x, transform.orientation.y, transform.orientation.z);
+        uint8_t lodIndex = 0;
+        for(uint8_t i = 1; i < surface.lodCount; ++i)
+        {
+            MeshLod& lod = surface.meshLod[i];
+
+            // Rotates the center with the transform's quaternion and moves it to view space
+            BlitML::vec3 rotated = lod.center + BlitML::Cross(q, BlitML::Cross(q, lod.center) + lod.center * transform.orientation.w) * 2.f;
+            BlitML::vec4 center = viewData.viewMatrix * BlitML::vec4(rotated * transform.scale + transform.pos, 1.f);
+
+            float distance = BlitML::Max(BlitML::Length(BlitML::ToVec3(center)) - lod.radius * transform.scale, viewData.zNear);
+            float projectedError = lod.error * transform.scale / distance;
+
+            float band = i > previousLod ? 1.f - BLIT_LOD_HYSTERESIS : 1.f + BLIT_LOD_HYSTERESIS;
+            if(projectedError < viewData.lodTarget * band)
+                lodIndex = i;
         }
+        return lodIndex;
     }
 
     // Calls some test functions to load a scene that tests the renderer's geometry rendering
@@ -521,19 +1424,134 @@ namespace BlitzenEngine
     {
         LoadTestTextures(pResources, loadForVulkan, loadForGL);
         LoadTestMaterials(pResources, loadForVulkan, loadForGL);
+
+        // Most of the objects are far away, they are drawn as billboards once their meshes get too small
+        pResources->lodSettings.bImpostor = 1;
         LoadTestGeometry(pResources);
         CreateTestGameObjects(pResources, drawCount);
     }
 
+    static cgltf_result GltfMappedFileRead(const cgltf_memory_options* pMemoryOptions, const cgltf_file_options* pFileOptions, 
+    const char* path, cgltf_size* pSize, void** ppData)
+    {
+        GltfFileMapper* pMapper = reinterpret_cast<GltfFileMapper*>(pFileOptions->user_data);
+        size_t size = pSize ? *pSize : 0;
+        const void* pView = pMapper->Map(path, size);
+        if(!pView)
+            return cgltf_result_io_error;
+
+        if(pSize)
+            *pSize = size;
+        // cgltf only reads the file and buffer data, the view is read-only
+        *ppData = const_cast<void*>(pView);
+        return cgltf_result_success;
+    }
+
+    static void GltfMappedFileRelease(const cgltf_memory_options* pMemoryOptions, const cgltf_file_options* pFileOptions, void* pData)
+    {
+        if(pData)
+            reinterpret_cast<GltfFileMapper*>(pFileOptions->user_data)->Unmap(pData);
+    }
+
+    void GltfFileMapper::SetCallbacks(cgltf_options& options)
+    {
+        options.file.read = GltfMappedFileRead;
+        options.file.release = GltfMappedFileRelease;
+        options.file.user_data = this;
+    }
+
+    const void* GltfFileMapper::Map(const char* path, size_t& size)
+    {
+        // Buffers and meshes are read right after the file is parsed, so the OS is asked to read all of it ahead
+        BlitzenPlatform::MappedFile* pFile = BlitzenCore::BlitConstructAlloc<BlitzenPlatform::MappedFile>(BlitzenCore::AllocationType::Scene);
+        if(!pFile->Open(path, BlitzenPlatform::MappedFileAccess::WillNeed) || pFile->GetSize() < size)
+        {
+            BlitzenCore::BlitDestroyAlloc(BlitzenCore::AllocationType::Scene, pFile);
+            return nullptr;
+        }
+        if(!size)
+            size = pFile->GetSize();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_files.PushBack(pFile);
+        return pFile->Data();
+    }
+
+    void GltfFileMapper::Unmap(const void* pData)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(size_t i = 0; i < m_files.GetSize(); ++i)
+        {
+            if(m_files[i]->Data() != pData)
+                continue;
+
+            BlitzenCore::BlitDestroyAlloc(BlitzenCore::AllocationType::Scene, m_files[i]);
+            m_files[i] = m_files.Back();
+            m_files.Downsize(m_files.GetSize() - 1);
+            return;
+        }
+    }
+
+    GltfFileMapper::~GltfFileMapper()
+    {
+        for(size_t i = 0; i < m_files.GetSize(); ++i)
+            BlitzenCore::BlitDestroyAlloc(BlitzenCore::AllocationType::Scene, m_files[i]);
+    }
+
+    // Hashes what the material looks like, with its textures given by their paths, so that copies of a material in different files match
+    static uint64_t HashGltfMaterial(cgltf_data* pData, const cgltf_material& gltfMaterial, 
+    BlitCL::DynamicArray<std::string>& texturePaths)
+    {
+        Material material{};
+        ConvertGltfMaterial(pData, gltfMaterial, 0, BLIT_TEXTURE_SLOT_NONE, material);
+
+        uint32_t alphaMode = static_cast<uint32_t>(gltfMaterial.alpha_mode);
+        uint64_t hash = HashBytes(reinterpret_cast<const uint8_t*>(&alphaMode), sizeof(alphaMode), 0);
+
+        uint32_t textureIndices[4] = {material.albedoTag, material.normalTag, material.specularTag, material.emissiveTag};
+        for(uint32_t i = 0; i < 4; ++i)
+        {
+            if(textureIndices[i] < texturePaths.GetSize())
+            {
+                const std::string& path = texturePaths[textureIndices[i]];
+                hash = HashBytes(reinterpret_cast<const uint8_t*>(path.c_str()), path.size(), hash);
+            }
+            else
+                hash = HashBytes(reinterpret_cast<const uint8_t*>(&textureIndices[i]), sizeof(uint32_t), hash);
+        }
+        return hash;
+    }
+
+    // Hashes the vertices and indices of a primitive, as they were unpacked from the gltf. Vertices are fully zeroed before they are
+    // unpacked, so their bytes can be hashed directly
+    static uint64_t HashPrimitiveStreams(BlitCL::DynamicArray<Vertex>& vertices, BlitCL::DynamicArray<uint32_t>& indices)
+    {
+        uint64_t hash = HashBytes(reinterpret_cast<const uint8_t*>(vertices.Data()), vertices.GetSize() * sizeof(Vertex), 0);
+        return HashBytes(reinterpret_cast<const uint8_t*>(indices.Data()), indices.GetSize() * sizeof(uint32_t), hash);
+    }
+
+    static void AddSavedGeometry(SurfaceDedupStats& stats, const PrimitiveSurface& surface, size_t vertexCount)
+    {
+        stats.savedVertexCount += vertexCount;
+        for(uint8_t i = 0; i < surface.lodCount; ++i)
+        {
+            stats.savedIndexCount += surface.meshLod[i].indexCount;
+            stats.savedMeshletCount += surface.meshLod[i].meshletCount;
+        }
+    }
+
     uint8_t LoadGltfScene(RenderingResources* pResources, const char* path, uint8_t loadForVulkan, uint8_t loadForGL)
     {
-        if(pResources->renderObjectCount >= BLITZEN_MAX_DRAW_OBJECTS)
+        if(pResources->renders.GetSize() >= BLITZEN_MAX_DRAW_OBJECTS)
         {
             BLIT_WARN("BLITZEN_MAX_DRAW_OBJECT already reached, no more geometry can be loaded. GLTF LOADING FAILED!")
             return 0;
         }
 
+        // Declared before the data, so that the files are unmapped after it is freed
+        GltfFileMapper fileMapper;
         cgltf_options options = {};
+        fileMapper.SetCallbacks(options);
 
         // Use a smart pointer so that the cgltf_data gets freed automatically whenever the function returns
         // Might be possible to just have this on the stack though, I don't know why I put it on the heap
@@ -563,85 +1581,47 @@ namespace BlitzenEngine
 
         BLIT_INFO("Loading GLTF scene from file: %s", path)
 
-        // Defining a lambda here for finding the accessor since it will probably not be used outside of this
-        auto findAccessor = [](const cgltf_primitive* prim,  cgltf_attribute_type type, cgltf_int index = 0){
-            for (size_t i = 0; i < prim->attributes_count; ++i)
-	        {
-		        const cgltf_attribute& attr = prim->attributes[i];
-		        if (attr.type == type && attr.index == index)
-			        return attr.data;
-	        }
-
-            // This might seem redundant but compilation fails if I do not do this
-            cgltf_accessor* scratch = nullptr;
-	        return scratch;
-        };
-
         // Before loading textures save the previous texture size, to use for indexing
-        size_t previousTextureSize = pResources->textureCount;
+        size_t previousTextureSize = pResources->textures.GetSize();
 
         BLIT_INFO("Loading textures")
 
-        // I had to fold and use the STL
         BlitCL::DynamicArray<std::string> texturePaths(pData->textures_count);
-        for (size_t i = 0; i < pData->textures_count; ++i)
-	    {
-		    cgltf_texture* texture = &(pData->textures[i]);
-		    if(!texture->image)
-                break;
-
-		    cgltf_image* image = texture->image;
-		    if(!image->uri)
-                break;
-
-		    std::string ipath = path;
-		    std::string::size_type pos = ipath.find_last_of('/');
-		    if (pos == std::string::npos)
-		    	ipath = "";
-		    else
-		    	ipath = ipath.substr(0, pos + 1);
-
-		    std::string uri = image->uri;
-		    uri.resize(cgltf_decode_uri(&uri[0]));
-		    std::string::size_type dot = uri.find_last_of('.');
+        GetGltfTexturePaths(path, pData, texturePaths);
 
-		    if (dot != std::string::npos)
-		    	uri.replace(dot, uri.size() - dot, ".dds");
-
-		    texturePaths[i] = ipath + uri;
-	    }
+        // Don't go over the texture limit, might want to throw a warning here
+        size_t loadedTextureCount = pResources->textures.GetSize();
+        size_t textureSpace = loadedTextureCount < BLIT_MAX_TEXTURE_COUNT ? BLIT_MAX_TEXTURE_COUNT - loadedTextureCount : 0;
+        size_t textureCount = texturePaths.GetSize() < textureSpace ? texturePaths.GetSize() : textureSpace;
 
-        RenderingSystem* pRenderer = RenderingSystem::GetRenderingSystem();
-        for(size_t i = 0; i < texturePaths.GetSize(); ++i)
+        // Vulkan reads the headers of every texture first, so that the staging memory of the whole scene is planned before any image data is read
+        BlitCL::DynamicArray<DDSTextureProbe> textureProbes(textureCount);
+        for(size_t i = 0; i < textureCount; ++i)
         {
-            // Don't go over the texture limit, might want to throw a warning here
-            if(pResources->textureCount >= BLIT_MAX_TEXTURE_COUNT)
-                break;
+            textureProbes[i] = DDSTextureProbe{};
+            textureProbes[i].filepath = texturePaths[i].c_str();
+        }
 
-            DDS_HEADER header = {};
-            DDS_HEADER_DXT10 header10 = {};
+        #ifndef BLITZEN_COOK
+        RenderingSystem* pRenderer = RenderingSystem::GetRenderingSystem();
+        if(pRenderer->IsVulkanAvailable() && textureCount)
+            pRenderer->GiveTexturesToVulkan(textureProbes.Data(), static_cast<uint32_t>(textureCount));
 
-            // The data from the file will be written to this and passed to Vulkan
-            TextureStats& texture = pResources->textures[pResources->textureCount];
+        for(size_t i = 0; i < textureCount; ++i)
+        {
+            DDSTextureProbe& probe = textureProbes[i];
 
-            // Create a placeholder image format
-            unsigned int imageFormat = 0;
+            // The data from the file will be written to this and passed to Vulkan. It is added to the texture array if it loads
+            TextureStats texture{};
 
             // Will be 1 if at least one of the renderers received the textures
-            uint8_t textureLoad = 0;
-
-            // Add the texture to the vulkan renderer if a pointer for it was passed
-            if(pRenderer->IsVulkanAvailable())
-            {
-                if(pRenderer->GiveTextureToVulkan(header, header10, texture.pTextureData, texturePaths[i].c_str()))
-                    textureLoad = 1;
-                else
-                    BLIT_INFO("GLTF texture from file: %s failed to load for Vulkan", texturePaths[i].c_str())
-            }
+            uint8_t textureLoad = probe.bLoaded;
+            if(pRenderer->IsVulkanAvailable() && !textureLoad)
+                BLIT_INFO("GLTF texture from file: %s failed to load for Vulkan", texturePaths[i].c_str())
 
             if(pRenderer->IsOpenglAvailable())
             {
-                if(pRenderer->GiveTextureToOpengl(header, header10, texturePaths[i].c_str()))
+                if(pRenderer->GiveTextureToOpengl(probe.header, probe.header10, texturePaths[i].c_str()))
                     textureLoad = 1;
                 else
                     BLIT_INFO("GLTF texture from file: %s failed to load for OpenGL", texturePaths[i].c_str())
@@ -650,53 +1630,50 @@ namespace BlitzenEngine
             // As long as the texture was uploaded to at least one of the renderers universal texture stats should be updated
             if(textureLoad)
             {
-                texture.textureWidth = header.dwWidth;
-                texture.textureHeight = header.dwHeight;
-                texture.textureTag = static_cast<uint32_t>(pResources->textureCount);
+                texture.textureWidth = probe.header.dwWidth;
+                texture.textureHeight = probe.header.dwHeight;
+                texture.textureTag = static_cast<uint32_t>(pResources->textures.GetSize());
 
-                pResources->textureCount++;
+                pResources->textures.PushBack(texture);
             }
         }
+        #endif
 
         BLIT_INFO("Loading materials")
 
         // Saves the previous material count
-        size_t previousMaterialCount = pResources->materialCount;
+        size_t previousMaterialCount = pResources->materials.GetSize();
         // Creates one BlitzenEngine::Material for each material in the gltf
         for (size_t i = 0; i < pData->materials_count; ++i)
         {
             cgltf_material& cgltf_mat = pData->materials[i];
 
-            Material& mat = pResources->materials[pResources->materialCount++];
-            mat.materialId = static_cast<uint32_t>(pResources->materialCount - 1);
-
-            mat.albedoTag = cgltf_mat.pbr_metallic_roughness.base_color_texture.texture ?
-            uint32_t(previousTextureSize + cgltf_texture_index(pData, cgltf_mat.pbr_metallic_roughness.base_color_texture.texture))
-            : cgltf_mat.pbr_specular_glossiness.diffuse_texture.texture ?
-            uint32_t(previousTextureSize + cgltf_texture_index(pData, cgltf_mat.pbr_specular_glossiness.diffuse_texture.texture))
-            : 0;
-
-            mat.normalTag =
-            cgltf_mat.normal_texture.texture ? 
-            uint32_t(previousTextureSize + cgltf_texture_index(pData, cgltf_mat.normal_texture.texture))
-            : 0;
-
-            mat.specularTag = 
-            cgltf_mat.pbr_specular_glossiness.specular_glossiness_texture.texture ? 
-            uint32_t(previousTextureSize + cgltf_texture_index(pData, cgltf_mat.pbr_specular_glossiness.specular_glossiness_texture.texture))
-            : 0;
-
-            mat.emissiveTag =
-            cgltf_mat.emissive_texture.texture ? 
-            uint32_t(previousTextureSize + cgltf_texture_index(pData, cgltf_mat.emissive_texture.texture))
-            : 0;
+            // Primitives of the materials past the limit use the first material
+            if(pResources->materials.GetSize() >= BLIT_MAX_MATERIAL_COUNT)
+            {
+                BLIT_WARN("Max material count: ( %i ) reached while loading gltf materials", BLIT_MAX_MATERIAL_COUNT)
+                break;
+            }
 
+            pResources->materials.Resize(pResources->materials.GetSize() + 1);
+            Material& mat = pResources->materials.Back();
+            ConvertGltfMaterial(pData, cgltf_mat, static_cast<uint32_t>(previousTextureSize), 0, mat);
+            mat.materialId = static_cast<uint32_t>(pResources->materials.GetSize() - 1);
         }
 
+        // Materials of different files that look the same have the same key, so that their primitives can share surfaces
+        BlitCL::DynamicArray<uint64_t> materialKeys(pData->materials_count);
+        for(size_t i = 0; i < pData->materials_count; ++i)
+            materialKeys[i] = HashGltfMaterial(pData, pData->materials[i], texturePaths);
+
         BLIT_INFO("Loading meshes and primitives")
 
-        // The surface indices is a list of the first surface of each mesh. Used to create the render object struct
-        BlitCL::DynamicArray<uint32_t> surfaceIndices(pData->meshes_count);
+        // The meshes of the gltf are added after the ones that were already loaded. Used to create the render object struct
+        uint32_t firstMesh = static_cast<uint32_t>(pResources->meshes.GetSize());
+        SurfaceDedupStats dedup;
+
+        // One entry for each surface that was built, shared surfaces were measured when they were first built
+        BlitCL::DynamicArray<MeshQualityStats> quality;
 
         for (size_t i = 0; i < pData->meshes_count; ++i)
 	    {
@@ -707,96 +1684,117 @@ namespace BlitzenEngine
             // It is important for the mesh struct and to save the data for later to create the render objects
             uint32_t firstSurface = static_cast<uint32_t>(pResources->surfaces.GetSize());
 
-            // Give the new mesh the surface that it owns and increment the mesh count
-            pResources->meshes[pResources->meshCount].firstSurface = firstSurface;
-            pResources->meshes[pResources->meshCount].surfaceCount = static_cast<uint32_t>(mesh.primitives_count);
-            pResources->meshCount++;
-
-            // Pass the first surface here so that it can be accessed by the nodes
-		    surfaceIndices[i] = firstSurface;
+            // Stays 1 while every primitive is a copy of an earlier surface, and the surfaces follow each other. 
+            // The mesh can then use them instead of its own copies
+            uint8_t bSharedRange = 1;
+            uint32_t sharedFirstSurface = BLIT_SURFACE_CACHE_MISS;
 
             for(size_t j = 0; j < mesh.primitives_count; ++j)
             {
                 const cgltf_primitive& prim = mesh.primitives[j];
-			    
+
                 // Skip primitives that are not triangles
-                if(prim.type != cgltf_primitive_type_triangles || !prim.indices)
+                BlitCL::DynamicArray<Vertex> vertices;
+                BlitCL::DynamicArray<uint32_t> indices;
+                if(!LoadGltfPrimitive(prim, vertices, indices))
                     continue;
 
-			    size_t vertexCount = prim.attributes[0].data->count;
-
-			    BlitCL::DynamicArray<Vertex> vertices(vertexCount);
-
-                // Will temporarily hold each aspect of the vertices (pos, tangent, normals, uvMaps) from the primitive
-			    BlitCL::DynamicArray<float> scratch(vertexCount * 4);
-
-			    if (const cgltf_accessor* pos = findAccessor(&prim, cgltf_attribute_type_position))
-			    {
-                    // No choice but to assert here, as some data might already have been loaded
-				    BLIT_ASSERT(cgltf_num_components(pos->type) == 3);
-
-				    cgltf_accessor_unpack_floats(pos, scratch.Data(), vertexCount * 3);
-				    for (size_t j = 0; j < vertexCount; ++j)
-				    {
-					    vertices[j].position = BlitML::vec3(scratch[j * 3 + 0], scratch[j * 3 + 1], scratch[j * 3 + 2]);
-				    }
-			    }
-
-			    if (const cgltf_accessor* nrm = cgltf_find_accessor(&prim, cgltf_attribute_type_normal, 0))
-			    {
-			    	BLIT_ASSERT(cgltf_num_components(nrm->type) == 3);
-
-			    	cgltf_accessor_unpack_floats(nrm, scratch.Data(), vertexCount * 3);
-			    	for (size_t j = 0; j < vertexCount; ++j)
-			    	{
-			    		vertices[j].normalX = static_cast<uint8_t>(scratch[j * 3 + 0] * 127.f + 127.5f);
-                        vertices[j].normalY = static_cast<uint8_t>(scratch[j * 3 + 1] * 127.f + 127.5f); 
-                        vertices[j].normalZ = static_cast<uint8_t>(scratch[j * 3 + 2] * 127.f + 127.5f);
-			    	}
-			    }
-
-                if(const cgltf_accessor* tang = findAccessor(&prim, cgltf_attribute_type_tangent))
+                // Get the material index and pass it to the surface if there is material index
+                uint32_t materialId = 0;
+                uint8_t postPass = 0;
+                uint64_t materialKey = 0;
+                if(prim.material)
                 {
-                    BLIT_ASSERT(cgltf_num_components(tang->type) == 4)
-
-                    cgltf_accessor_unpack_floats(tang, scratch.Data(), vertexCount * 4);
-                    for (size_t j = 0; j < vertexCount; ++j)
+                    size_t gltfMaterialIndex = cgltf_material_index(pData, prim.material);
+                    size_t materialIndex = previousMaterialCount + gltfMaterialIndex;
+                    postPass = prim.material->alpha_mode != cgltf_alpha_mode_opaque;
+                    if(materialIndex < pResources->materials.GetSize())
                     {
-                        vertices[j].tangentX = uint8_t(scratch[j * 4 + 0] * 127.f + 127.5f);
-                        vertices[j].tangentY = uint8_t(scratch[j * 4 + 1] * 127.f + 127.5f);
-                        vertices[j].tangentZ = uint8_t(scratch[j * 4 + 2] * 127.f + 127.5f);
-                        vertices[j].tangentW = uint8_t(scratch[j * 4 + 3] * 127.f + 127.5f);
+                        materialId = pResources->materials[materialIndex].materialId;
+                        materialKey = materialKeys[gltfMaterialIndex];
                     }
+                    else
+                        materialKey = postPass;
                 }
 
-			    if (const cgltf_accessor* tex = findAccessor(&prim, cgltf_attribute_type_texcoord))
-			    {
-				    BLIT_ASSERT(cgltf_num_components(tex->type) == 2);
-				    cgltf_accessor_unpack_floats(tex, scratch.Data(), vertexCount * 2);
-				    for (size_t j = 0; j < vertexCount; ++j)
-				    {
-					    vertices[j].uvX = meshopt_quantizeHalf(scratch[j * 2 + 0]);
-					    vertices[j].uvY = meshopt_quantizeHalf(scratch[j * 2 + 1]);
-				    }
-			    }
+                // The streams are hashed and looked up before the surface is built, since building it reorders them
+                uint64_t geometryKey = HashPrimitiveStreams(vertices, indices);
+                dedup.primitiveCount++;
 
-                BlitCL::DynamicArray<uint32_t> indices(prim.indices->count);
-			    cgltf_accessor_unpack_indices(prim.indices, indices.Data(), 4, indices.GetSize());
+                uint32_t geometryId = pResources->geometryCache.Find(geometryKey, vertices, indices);
+                uint64_t surfaceKey = HashBytes(reinterpret_cast<const uint8_t*>(&materialKey), sizeof(materialKey), geometryKey);
+                uint32_t surfaceId = geometryId != BLIT_SURFACE_CACHE_MISS ? 
+                    pResources->surfaceCache.Find(surfaceKey, geometryId, materialKey) : BLIT_SURFACE_CACHE_MISS;
+                if(surfaceId != BLIT_SURFACE_CACHE_MISS)
+                {
+                    if(sharedFirstSurface == BLIT_SURFACE_CACHE_MISS)
+                        sharedFirstSurface = surfaceId;
+                    bSharedRange = bSharedRange && surfaceId == sharedFirstSurface + 
+                    (pResources->surfaces.GetSize() - firstSurface);
 
-                LoadPrimitiveSurface(pResources, vertices, indices);
+                    // Copied in case the mesh needs its own range. Dropped again if the earlier surfaces can be used directly
+                    PrimitiveSurface surface = pResources->surfaces[surfaceId];
+                    pResources->surfaces.PushBack(surface);
 
-                // Get the material index and pass it to the surface if there is material index
-                if(prim.material)
+                    dedup.sharedSurfaceCount++;
+                    AddSavedGeometry(dedup, surface, vertices.GetSize());
+                    continue;
+                }
+                bSharedRange = 0;
+
+                if(geometryId != BLIT_SURFACE_CACHE_MISS)
                 {
-                    pResources->surfaces.Back().materialId = 
-                    pResources->materials[previousMaterialCount + cgltf_material_index(pData, prim.material)].materialId;
+                    // The new surface points to the vertices, indices and meshlets of the earlier one
+                    PrimitiveSurface surface = pResources->surfaces[geometryId];
+                    pResources->surfaces.PushBack(surface);
 
-                    if(prim.material->alpha_mode != cgltf_alpha_mode_opaque)
-                        pResources->surfaces.Back().postPass = 1;
+                    dedup.sharedGeometryCount++;
+                    AddSavedGeometry(dedup, surface, vertices.GetSize());
                 }
+                else
+                {
+                    // Inserted first, the build below reorders the streams
+                    geometryId = static_cast<uint32_t>(pResources->surfaces.GetSize());
+                    pResources->geometryCache.Insert(geometryKey, geometryId, vertices, indices);
+                    LoadPrimitiveSurface(pResources, vertices, indices, &quality);
+                }
+
+                PrimitiveSurface& surface = pResources->surfaces.Back();
+                surface.materialId = materialId;
+                surface.postPass = postPass;
+                pResources->surfaceCache.Insert(surfaceKey, static_cast<uint32_t>(pResources->surfaces.GetSize() - 1), 
+                geometryId, materialKey);
             }
+
+            // Give the new mesh the surfaces that it owns
+            BLIT_ASSERT_MESSAGE(pResources->meshes.GetSize() < BLIT_MAX_MESH_COUNT, "Max mesh count reached while loading gltf meshes")
+            Mesh newMesh;
+            newMesh.firstSurface = firstSurface;
+            newMesh.surfaceCount = static_cast<uint32_t>(pResources->surfaces.GetSize() - firstSurface);
+            if(bSharedRange && newMesh.surfaceCount)
+            {
+                pResources->surfaces.Downsize(firstSurface);
+                newMesh.firstSurface = sharedFirstSurface;
+            }
+            pResources->meshes.PushBack(newMesh);
         }
 
+        LogMeshQuality(path, quality);
+
+        pResources->surfaceDedup.primitiveCount += dedup.primitiveCount;
+        pResources->surfaceDedup.sharedSurfaceCount += dedup.sharedSurfaceCount;
+        pResources->surfaceDedup.sharedGeometryCount += dedup.sharedGeometryCount;
+        pResources->surfaceDedup.savedVertexCount += dedup.savedVertexCount;
+        pResources->surfaceDedup.savedIndexCount += dedup.savedIndexCount;
+        pResources->surfaceDedup.savedMeshletCount += dedup.savedMeshletCount;
+
+        BLIT_INFO("%u of %u primitives reused a loaded surface and %u reused loaded geometry. Skipped %zu vertices, %zu indices and %zu meshlets",
+        dedup.sharedSurfaceCount, dedup.primitiveCount, dedup.sharedGeometryCount, dedup.savedVertexCount, dedup.savedIndexCount, 
+        dedup.savedMeshletCount)
+        BLIT_INFO("Surface deduplication in all scenes: %u of %u primitives shared, %zu vertices and %zu indices skipped", 
+        pResources->surfaceDedup.sharedSurfaceCount + pResources->surfaceDedup.sharedGeometryCount, 
+        pResources->surfaceDedup.primitiveCount, pResources->surfaceDedup.savedVertexCount, pResources->surfaceDedup.savedIndexCount)
+
         BLIT_INFO("Loading scene nodes")
 
         for (size_t i = 0; i < pData->nodes_count; ++i)
@@ -804,40 +1802,22 @@ namespace BlitzenEngine
 		    const cgltf_node* node = &(pData->nodes[i]);
 		    if (node->mesh)
 		    {
-                // Gets the model matrix
-			    float matrix[16];
-			    cgltf_node_transform_world(node, matrix);
-
-                // Uses these float arrays to hold the decomposed matrix
-			    float translation[3];
-			    float rotation[4];
-			    float scale[3];
-
-                // Decomposes the model transform and tranlates the data to the engine's transform structure
-			    BlitML::decomposeTransform(translation, rotation, scale, matrix);
-                MeshTransform transform;
-				transform.pos = BlitML::vec3(translation[0], translation[1], translation[2]);
-				transform.scale = BlitML::Max(scale[0], BlitML::Max(scale[1], scale[2]));
-				transform.orientation = BlitML::quat(rotation[0], rotation[1], rotation[2], rotation[3]);
+                MeshTransform transform = GetGltfNodeTransform(node);
 
 			    // TODO: better warnings for non-uniform or negative scale
 
-                // Hold the offset of the first surface of the mesh and the transform id to give to the render objects
-			    uint32_t surfaceOffset = surfaceIndices[cgltf_mesh_index(pData, node->mesh)];
+                // Hold the mesh and the transform id to give to the render objects. Primitives that were skipped have no surface
+			    Mesh& mesh = pResources->meshes[firstMesh + cgltf_mesh_index(pData, node->mesh)];
                 uint32_t transformId = static_cast<uint32_t>(pResources->transforms.GetSize());
 
-			    for (unsigned int j = 0; j < node->mesh->primitives_count; ++j)
+			    for (uint32_t j = 0; j < mesh.surfaceCount; ++j)
 			    {
                     // If the gltf goes over BLITZEN_MAX_DRAW_OBJECTS after already loading resources, I have no choice but to assert
-                    BLIT_ASSERT_MESSAGE(pResources->renderObjectCount <= BLITZEN_MAX_DRAW_OBJECTS, "While Loading a GLTF, \
+                    BLIT_ASSERT_MESSAGE(pResources->renders.GetSize() <= BLITZEN_MAX_DRAW_OBJECTS, "While Loading a GLTF, \
                     additional geometry was loaded which surpassed the BLITZEN_MAX_DRAW_OBJECT limiter value")
 
-                    RenderObject& current = pResources->renders[pResources->renderObjectCount];
-                    current.surfaceId = surfaceOffset + j;
-                    current.transformId = transformId;
-                    
-                    // Increment the render object count
-                    pResources->renderObjectCount++;
+                    // Adds the render object to the opaque or the post pass range, depending on the surface
+                    AddRenderObject(pResources, transformId, mesh.firstSurface + j);
 			    }
 
                 pResources->transforms.PushBack(transform);
@@ -846,4 +1826,252 @@ namespace BlitzenEngine
 
         return 1;
     }
+
+    void GetGltfTexturePaths(const char* path, cgltf_data* pData, BlitCL::DynamicArray<std::string>& texturePaths)
+    {
+        for (size_t i = 0; i < pData->textures_count; ++i)
+	    {
+		    cgltf_texture* texture = &(pData->textures[i]);
+		    if(!texture->image)
+                break;
+
+		    cgltf_image* image = texture->image;
+		    if(!image->uri)
+                break;
+
+		    std::string ipath = path;
+		    std::string::size_type pos = ipath.find_last_of('/');
+		    if (pos == std::string::npos)
+		    	ipath = "";
+		    else
+		    	ipath = ipath.substr(0, pos + 1);
+
+		    std::string uri = image->uri;
+		    uri.resize(cgltf_decode_uri(&uri[0]));
+		    std::string sourcePath = ipath + uri;
+		    std::string::size_type dot = uri.find_last_of('.');
+
+		    if (dot != std::string::npos)
+		    	uri.replace(dot, uri.size() - dot, ".dds");
+
+		    texturePaths[i] = ipath + uri;
+
+            // DDS files next to the scene are used as they are. Otherwise the source image is baked to the asset cache,
+            // normal maps keep only their x and y
+            if(!BlitzenPlatform::FilepathExists(texturePaths[i].c_str()) && BlitzenPlatform::FilepathExists(sourcePath.c_str()))
+            {
+                TextureBakeUsage usage = TextureBakeUsage::Color;
+                for(size_t m = 0; m < pData->materials_count; ++m)
+                {
+                    if(pData->materials[m].normal_texture.texture == texture)
+                        usage = TextureBakeUsage::Normal;
+                }
+
+                std::string bakedPath;
+                if(GetOrBakeTexture(sourcePath.c_str(), usage, bakedPath))
+                    texturePaths[i] = bakedPath;
+            }
+	    }
+    }
+
+    void ConvertGltfMaterial(cgltf_data* pData, const cgltf_material& cgltf_mat, uint32_t firstTexture, uint32_t noTextureTag, 
+    Material& mat)
+    {
+        mat.albedoTag = cgltf_mat.pbr_metallic_roughness.base_color_texture.texture ?
+        uint32_t(firstTexture + cgltf_texture_index(pData, cgltf_mat.pbr_metallic_roughness.base_color_texture.texture))
+        : cgltf_mat.pbr_specular_glossiness.diffuse_texture.texture ?
+        uint32_t(firstTexture + cgltf_texture_index(pData, cgltf_mat.pbr_specular_glossiness.diffuse_texture.texture))
+        : noTextureTag;
+
+        mat.normalTag =
+        cgltf_mat.normal_texture.texture ? 
+        uint32_t(firstTexture + cgltf_texture_index(pData, cgltf_mat.normal_texture.texture))
+        : noTextureTag;
+
+        mat.specularTag = 
+        cgltf_mat.pbr_specular_glossiness.specular_glossiness_texture.texture ? 
+        uint32_t(firstTexture + cgltf_texture_index(pData, cgltf_mat.pbr_specular_glossiness.specular_glossiness_texture.texture))
+        : noTextureTag;
+
+        mat.emissiveTag =
+        cgltf_mat.emissive_texture.texture ? 
+        uint32_t(firstTexture + cgltf_texture_index(pData, cgltf_mat.emissive_texture.texture))
+        : noTextureTag;
+    }
+
+    uint8_t LoadGltfPrimitive(const cgltf_primitive& prim, BlitCL::DynamicArray<Vertex>& vertices, 
+    BlitCL::DynamicArray<uint32_t>& indices)
+    {
+        // Skip primitives that are not triangles
+        if(prim.type != cgltf_primitive_type_triangles || !prim.indices)
+            return 0;
+
+        // Defining a lambda here for finding the accessor since it will probably not be used outside of this
+        auto findAccessor = [](const cgltf_primitive* prim,  cgltf_attribute_type type, cgltf_int index = 0){
+            for (size_t i = 0; i < prim->attributes_count; ++i)
+	        {
+		        const cgltf_attribute& attr = prim->attributes[i];
+		        if (attr.type == type && attr.index == index)
+			        return attr.data;
+	        }
+
+            // This might seem redundant but compilation fails if I do not do this
+            cgltf_accessor* scratch = nullptr;
+	        return scratch;
+        };
+
+		size_t vertexCount = prim.attributes[0].data->count;
+
+		vertices.Resize(vertexCount);
+
+        // Attributes that the primitive does not have stay 0, and so does the padding, so that the vertices can be hashed as bytes
+        BlitzenCore::BlitMemSet(vertices.Data(), 0, vertexCount * sizeof(Vertex));
+
+        // Will temporarily hold each aspect of the vertices (pos, tangent, normals, uvMaps) from the primitive
+		BlitCL::DynamicArray<float> scratch(vertexCount * 4);
+
+		if (const cgltf_accessor* pos = findAccessor(&prim, cgltf_attribute_type_position))
+		{
+            // No choice but to assert here, as some data might already have been loaded
+			BLIT_ASSERT(cgltf_num_components(pos->type) == 3);
+
+			cgltf_accessor_unpack_floats(pos, scratch.Data(), vertexCount * 3);
+			for (size_t j = 0; j < vertexCount; ++j)
+			{
+				vertices[j].position = BlitML::vec3(scratch[j * 3 + 0], scratch[j * 3 + 1], scratch[j * 3 + 2]);
+			}
+		}
+
+		if (const cgltf_accessor* nrm = cgltf_find_accessor(&prim, cgltf_attribute_type_normal, 0))
+		{
+			BLIT_ASSERT(cgltf_num_components(nrm->type) == 3);
+
+			cgltf_accessor_unpack_floats(nrm, scratch.Data(), vertexCount * 3);
+			for (size_t j = 0; j < vertexCount; ++j)
+			{
+				vertices[j].normalX = static_cast<uint8_t>(scratch[j * 3 + 0] * 127.f + 127.5f);
+                vertices[j].normalY = static_cast<uint8_t>(scratch[j * 3 + 1] * 127.f + 127.5f); 
+                vertices[j].normalZ = static_cast<uint8_t>(scratch[j * 3 + 2] * 127.f + 127.5f);
+			}
+		}
+
+        if(const cgltf_accessor* tang = findAccessor(&prim, cgltf_attribute_type_tangent))
+        {
+            BLIT_ASSERT(cgltf_num_components(tang->type) == 4)
+
+            cgltf_accessor_unpack_floats(tang, scratch.Data(), vertexCount * 4);
+            for (size_t j = 0; j < vertexCount; ++j)
+            {
+                vertices[j].tangentX = uint8_t(scratch[j * 4 + 0] * 127.f + 127.5f);
+                vertices[j].tangentY = uint8_t(scratch[j * 4 + 1] * 127.f + 127.5f);
+                vertices[j].tangentZ = uint8_t(scratch[j * 4 + 2] * 127.f + 127.5f);
+                vertices[j].tangentW = uint8_t(scratch[j * 4 + 3] * 127.f + 127.5f);
+            }
+        }
+
+		if (const cgltf_accessor* tex = findAccessor(&prim, cgltf_attribute_type_texcoord))
+		{
+			BLIT_ASSERT(cgltf_num_components(tex->type) == 2);
+			cgltf_accessor_unpack_floats(tex, scratch.Data(), vertexCount * 2);
+			for (size_t j = 0; j < vertexCount; ++j)
+			{
+				vertices[j].uvX = meshopt_quantizeHalf(scratch[j * 2 + 0]);
+				vertices[j].uvY = meshopt_quantizeHalf(scratch[j * 2 + 1]);
+			}
+		}
+
+        indices.Resize(prim.indices->count);
+		cgltf_accessor_unpack_indices(prim.indices, indices.Data(), 4, indices.GetSize());
+
+        return 1;
+    }
+
+    MeshTransform GetGltfNodeTransform(const cgltf_node* node)
+    {
+        // Gets the model matrix
+		float matrix[16];
+		cgltf_node_transform_world(node, matrix);
+
+        // Uses these float arrays to hold the decomposed matrix
+		float translation[3];
+		float rotation[4];
+		float scale[3];
+
+        // Decomposes the model transform and tranlates the data to the engine's transform structure
+		BlitML::decomposeTransform(translation, rotation, scale, matrix);
+        MeshTransform transform;
+		transform.pos = BlitML::vec3(translation[0], translation[1], translation[2]);
+		transform.scale = BlitML::Max(scale[0], BlitML::Max(scale[1], scale[2]));
+		transform.orientation = BlitML::quat(rotation[0], rotation[1], rotation[2], rotation[3]);
+
+        return transform;
+    }
+
+    void LoadGltfMesh(cgltf_data* pData, uint32_t meshIndex, uint32_t noMaterialIndex, GeometryTarget& target)
+    {
+        const cgltf_mesh& mesh = pData->meshes[meshIndex];
+        for(size_t i = 0; i < mesh.primitives_count; ++i)
+        {
+            const cgltf_primitive& prim = mesh.primitives[i];
+
+            BlitCL::DynamicArray<Vertex> vertices;
+            BlitCL::DynamicArray<uint32_t> indices;
+            if(!LoadGltfPrimitive(prim, vertices, indices))
+                continue;
+
+            LoadPrimitiveSurface(target, vertices, indices);
+
+            PrimitiveSurface& surface = target.surfaces.Back();
+            surface.materialId = prim.material ? static_cast<uint32_t>(cgltf_material_index(pData, prim.material)) : noMaterialIndex;
+            if(prim.material && prim.material->alpha_mode != cgltf_alpha_mode_opaque)
+                surface.postPass = 1;
+        }
+    }
+
+    // Eight bytes at a time, each word is mixed in with a multiply and a rotate. The tail and the length are mixed in at the end
+    uint64_t HashBytes(const uint8_t* pData, size_t size, uint64_t hash)
+    {
+        size_t i = 0;
+        for(; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, pData + i, sizeof(word));
+            hash ^= word * 0x9E3779B97F4A7C15ull;
+            hash = ((hash << 31) | (hash >> 33)) * 0xC2B2AE3D27D4EB4Full;
+        }
+        for(; i < size; ++i)
+            hash = (hash ^ pData[i]) * 0x100000001B3ull;
+
+        hash ^= size;
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    std::string GetAssetCachePath(const char* sourcePath, const char* extension)
+    {
+        // The source path is kept under the cache, without the parts that would leave it
+        std::string path = BLIT_ASSET_CACHE_DIRECTORY;
+        for(const char* pChar = sourcePath; *pChar; ++pChar)
+        {
+            if(*pChar == '\\')
+                path += '/';
+            else if(*pChar == ':')
+                path += '_';
+            else if(*pChar == '.' && pChar[1] == '.')
+            {
+                path += "__";
+                ++pChar;
+            }
+            else
+                path += *pChar;
+        }
+
+        std::string::size_type dot = path.find_last_of('.');
+        std::string::size_type slash = path.find_last_of('/');
+        if(dot != std::string::npos && (slash == std::string::npos || dot > slash))
+            path.resize(dot);
+        return path + extension;
+    }
 }
\ No newline at end of file
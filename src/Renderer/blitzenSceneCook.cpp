@@ -0,0 +1,508 @@
+#include "Renderer/blitSceneCook.h"
+#include "Renderer/blitSceneStreaming.h"
+
+// The implementation is compiled in blitzenRenderingResources.cpp
+#include "Cgltf/cgltf.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cinttypes>
+#include <chrono>
+
+// Arrays in the cooked file start at this alignment, so that they can be read in place from the mapped file
+#define BLIT_COOKED_SCENE_ALIGNMENT             16
+
+namespace BlitzenEngine
+{
+    uint8_t HashFileContents(const char* path, uint64_t& hash)
+    {
+        uint64_t size;
+        uint64_t writeTime;
+        if(!BlitzenPlatform::GetFileInfo(path, size, writeTime))
+            return 0;
+
+        // Empty files cannot be mapped
+        if(!size)
+        {
+            hash = HashBytes(nullptr, 0, 0);
+            return 1;
+        }
+
+        BlitzenPlatform::MappedFile file;
+        if(!file.Open(path, BlitzenPlatform::MappedFileAccess::Sequential))
+            return 0;
+        hash = HashBytes(file.Data(), file.GetSize(), 0);
+        return 1;
+    }
+
+    static void SetDependency(CookDependency& dependency, const std::string& path)
+    {
+        dependency = {};
+        snprintf(dependency.path, sizeof(dependency.path), "%s", path.c_str());
+        BlitzenPlatform::GetFileInfo(dependency.path, dependency.size, dependency.writeTime);
+    }
+
+    void GetGltfDependencies(const char* path, cgltf_data* pData, BlitCL::DynamicArray<CookDependency>& dependencies)
+    {
+        dependencies.Resize(1);
+        SetDependency(dependencies[0], path);
+
+        std::string directory = path;
+        std::string::size_type slash = directory.find_last_of('/');
+        directory = slash == std::string::npos ? "" : directory.substr(0, slash + 1);
+
+        for(size_t i = 0; i < pData->buffers_count; ++i)
+        {
+            // Glb buffers have no uri and data uris are embedded, both are part of the gltf file
+            const char* uri = pData->buffers[i].uri;
+            if(!uri || !strncmp(uri, "data:", 5))
+                continue;
+
+            std::string bufferPath = uri;
+            bufferPath.resize(cgltf_decode_uri(&bufferPath[0]));
+
+            dependencies.Resize(dependencies.GetSize() + 1);
+            SetDependency(dependencies.Back(), directory + bufferPath);
+        }
+    }
+
+    uint64_t GetCookContentHash(BlitCL::DynamicArray<CookDependency>& dependencies, uint8_t bMeshlets)
+    {
+        uint64_t settings[2] = {BLIT_COOKED_SCENE_VERSION, bMeshlets};
+        uint64_t hash = HashBytes(reinterpret_cast<const uint8_t*>(settings), sizeof(settings), 0);
+
+        // Meshes are cooked with the default LOD chain, so changing its defaults cooks them again
+        LodChainSettings lod;
+        float lodSettings[11] = {lod.targetRatio, lod.maxError, lod.normalWeights[0], lod.normalWeights[1], lod.normalWeights[2], 
+        lod.minReduction, float(lod.minTriangleCount), float(lod.bSloppyFallback), float(lod.firstSloppyLevel), lod.sloppyMaxError, 
+        float(lod.bClusterHierarchy)};
+        hash = HashBytes(reinterpret_cast<const uint8_t*>(lodSettings), sizeof(lodSettings), hash);
+        for(size_t i = 0; i < dependencies.GetSize(); ++i)
+            hash = HashBytes(reinterpret_cast<const uint8_t*>(&dependencies[i].hash), sizeof(uint64_t), hash);
+        return hash;
+    }
+
+    // Text, one line for each file after the hash and the count: hash, size, write time and the path, which is last since it can have spaces
+    uint8_t ReadCookManifest(const char* path, uint64_t& contentHash, BlitCL::DynamicArray<CookDependency>& dependencies)
+    {
+        if(!BlitzenPlatform::FilepathExists(path))
+            return 0;
+
+        BlitzenPlatform::MappedFile file;
+        if(!file.Open(path, BlitzenPlatform::MappedFileAccess::Sequential))
+            return 0;
+        std::string text(reinterpret_cast<const char*>(file.Data()), file.GetSize());
+
+        uint32_t version = 0;
+        unsigned long long hash = 0;
+        uint32_t count = 0;
+        const char* pLine = text.c_str();
+        if(sscanf(pLine, "BlitzenCook %u hash %llx dependencies %u", &version, &hash, &count) != 3 ||
+        version != BLIT_COOKED_SCENE_VERSION)
+            return 0;
+        contentHash = hash;
+
+        dependencies.Resize(count);
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            pLine = strchr(pLine, '\n');
+            if(!pLine)
+                return 0;
+            ++pLine;
+
+            CookDependency& dependency = dependencies[i];
+            unsigned long long size = 0;
+            unsigned long long writeTime = 0;
+            int pathStart = 0;
+            if(sscanf(pLine, "%llx %llu %llu %n", &hash, &size, &writeTime, &pathStart) != 3 || !pathStart)
+                return 0;
+
+            const char* pPath = pLine + pathStart;
+            const char* pEnd = strchr(pPath, '\n');
+            size_t length = pEnd ? size_t(pEnd - pPath) : strlen(pPath);
+            if(length >= BLIT_COOK_MAX_PATH_LENGTH)
+                return 0;
+            memcpy(dependency.path, pPath, length);
+            dependency.path[length] = 0;
+            dependency.hash = hash;
+            dependency.size = size;
+            dependency.writeTime = writeTime;
+        }
+
+        return 1;
+    }
+
+    // Written next to the final file and renamed over it, so that a reader never sees half a file
+    static uint8_t ReplaceFile(const std::string& tempPath, const std::string& path)
+    {
+        remove(path.c_str());
+        return rename(tempPath.c_str(), path.c_str()) == 0;
+    }
+
+    uint8_t WriteCookManifest(const char* path, uint64_t contentHash, BlitCL::DynamicArray<CookDependency>& dependencies)
+    {
+        std::string text;
+        char line[BLIT_COOK_MAX_PATH_LENGTH + 128];
+        snprintf(line, sizeof(line), "BlitzenCook %u hash %016" PRIx64 " dependencies %u\n", BLIT_COOKED_SCENE_VERSION, contentHash,
+        static_cast<uint32_t>(dependencies.GetSize()));
+        text += line;
+        for(size_t i = 0; i < dependencies.GetSize(); ++i)
+        {
+            CookDependency& dependency = dependencies[i];
+            snprintf(line, sizeof(line), "%016" PRIx64 " %" PRIu64 " %" PRIu64 " %s\n", dependency.hash, dependency.size,
+            dependency.writeTime, dependency.path);
+            text += line;
+        }
+
+        std::string tempPath = std::string(path) + ".tmp";
+        {
+            BlitzenPlatform::FileHandle file;
+            size_t written = 0;
+            if(!file.Open(tempPath.c_str(), BlitzenPlatform::FileModes::Write, 1) ||
+            !BlitzenPlatform::FilesystemWrite(file, text.size(), text.c_str(), &written))
+                return 0;
+        }
+        return ReplaceFile(tempPath, path);
+    }
+
+    uint8_t CookedSceneFile::Open(const char* gltfPath, uint8_t bMeshlets)
+    {
+        std::string manifestPath = GetAssetCachePath(gltfPath, BLIT_COOKED_MANIFEST_EXTENSION);
+        std::string cookedPath = GetAssetCachePath(gltfPath, BLIT_COOKED_SCENE_EXTENSION);
+
+        uint64_t contentHash = 0;
+        BlitCL::DynamicArray<CookDependency> dependencies;
+        if(!ReadCookManifest(manifestPath.c_str(), contentHash, dependencies) || !BlitzenPlatform::FilepathExists(cookedPath.c_str()))
+            return 0;
+
+        // Any file that was written since the cook could have changed. It is left to the cooker to find out
+        for(size_t i = 0; i < dependencies.GetSize(); ++i)
+        {
+            uint64_t size = 0;
+            uint64_t writeTime = 0;
+            if(!BlitzenPlatform::GetFileInfo(dependencies[i].path, size, writeTime) ||
+            size != dependencies[i].size || writeTime != dependencies[i].writeTime)
+                return 0;
+        }
+
+        if(!m_file.Open(cookedPath.c_str(), BlitzenPlatform::MappedFileAccess::Random))
+            return 0;
+
+        size_t fileSize = m_file.GetSize();
+        if(fileSize < sizeof(CookedSceneHeader) + sizeof(CookedSceneFooter))
+        {
+            m_file.Close();
+            return 0;
+        }
+
+        const CookedSceneHeader* pHeader = reinterpret_cast<const CookedSceneHeader*>(m_file.Data());
+        const CookedSceneFooter* pFooter = reinterpret_cast<const CookedSceneFooter*>(m_file.Data() + fileSize - sizeof(CookedSceneFooter));
+        if(pHeader->magic != BLIT_COOKED_SCENE_MAGIC || pHeader->version != BLIT_COOKED_SCENE_VERSION ||
+        pHeader->vertexSize != sizeof(Vertex) || pHeader->meshletSize != sizeof(Meshlet) ||
+        pHeader->surfaceSize != sizeof(PrimitiveSurface) || pHeader->qualitySize != sizeof(MeshQualityStats) || 
+        pHeader->contentHash != contentHash ||
+        (bMeshlets && !pHeader->bMeshlets) || pFooter->magic != BLIT_COOKED_SCENE_MAGIC ||
+        pFooter->tableOffset + uint64_t(pFooter->meshCount) * sizeof(CookedMeshEntry) > fileSize - sizeof(CookedSceneFooter))
+        {
+            m_file.Close();
+            return 0;
+        }
+
+        m_pMeshes = reinterpret_cast<const CookedMeshEntry*>(m_file.Data() + pFooter->tableOffset);
+        m_meshCount = pFooter->meshCount;
+        return 1;
+    }
+
+    static size_t AlignCookedSize(size_t size)
+    {
+        return (size + BLIT_COOKED_SCENE_ALIGNMENT - 1) & ~size_t(BLIT_COOKED_SCENE_ALIGNMENT - 1);
+    }
+
+    static size_t GetCookedMeshSize(const CookedMeshEntry& entry)
+    {
+        return AlignCookedSize(entry.vertexCount * sizeof(Vertex)) + AlignCookedSize(entry.indexCount * sizeof(uint32_t)) +
+        AlignCookedSize(entry.meshletCount * sizeof(Meshlet)) + AlignCookedSize(entry.meshletDataCount * sizeof(uint32_t)) +
+        AlignCookedSize(entry.surfaceCount * sizeof(PrimitiveSurface)) + AlignCookedSize(entry.surfaceCount * sizeof(MeshQualityStats));
+    }
+
+    // The quality array is the last one of the mesh
+    static const MeshQualityStats* GetCookedMeshQuality(const uint8_t* pFileData, const CookedMeshEntry& entry)
+    {
+        return reinterpret_cast<const MeshQualityStats*>(pFileData + entry.offset + GetCookedMeshSize(entry) - 
+        AlignCookedSize(entry.surfaceCount * sizeof(MeshQualityStats)));
+    }
+
+    uint8_t CookedSceneFile::ReadMesh(uint32_t meshIndex, GeometryTarget& target)
+    {
+        if(meshIndex >= m_meshCount)
+            return 0;
+
+        const CookedMeshEntry& entry = m_pMeshes[meshIndex];
+        if(entry.offset + GetCookedMeshSize(entry) > size_t(reinterpret_cast<const uint8_t*>(m_pMeshes) - m_file.Data()))
+            return 0;
+
+        const uint8_t* pData = m_file.Data() + entry.offset;
+        Vertex* pVertices = reinterpret_cast<Vertex*>(const_cast<uint8_t*>(pData));
+        pData += AlignCookedSize(entry.vertexCount * sizeof(Vertex));
+        uint32_t* pIndices = reinterpret_cast<uint32_t*>(const_cast<uint8_t*>(pData));
+        pData += AlignCookedSize(entry.indexCount * sizeof(uint32_t));
+        Meshlet* pMeshlets = reinterpret_cast<Meshlet*>(const_cast<uint8_t*>(pData));
+        pData += AlignCookedSize(entry.meshletCount * sizeof(Meshlet));
+        uint32_t* pMeshletData = reinterpret_cast<uint32_t*>(const_cast<uint8_t*>(pData));
+        pData += AlignCookedSize(entry.meshletDataCount * sizeof(uint32_t));
+        const PrimitiveSurface* pSurfaces = reinterpret_cast<const PrimitiveSurface*>(pData);
+
+        // The cooked offsets are relative to the mesh's own arrays
+        uint32_t firstVertex = static_cast<uint32_t>(target.vertices.GetSize());
+        uint32_t firstIndex = static_cast<uint32_t>(target.indices.GetSize());
+        uint32_t firstMeshlet = static_cast<uint32_t>(target.meshlets.GetSize());
+        uint32_t firstMeshletData = static_cast<uint32_t>(target.meshletData.GetSize());
+
+        target.vertices.AddBlockAtBack(pVertices, entry.vertexCount);
+        target.indices.AddBlockAtBack(pIndices, entry.indexCount);
+        if(target.buildMeshlets)
+        {
+            target.meshlets.AddBlockAtBack(pMeshlets, entry.meshletCount);
+            for(size_t i = firstMeshlet; i < target.meshlets.GetSize(); ++i)
+                target.meshlets[i].dataOffset += firstMeshletData;
+            target.meshletData.AddBlockAtBack(pMeshletData, entry.meshletDataCount);
+        }
+
+        for(uint32_t i = 0; i < entry.surfaceCount; ++i)
+        {
+            PrimitiveSurface surface = pSurfaces[i];
+            surface.vertexOffset += firstVertex;
+            for(uint8_t j = 0; j < surface.lodCount; ++j)
+            {
+                MeshLod& lod = surface.meshLod[j];
+                lod.firstIndex += firstIndex;
+                lod.firstMeshlet = target.buildMeshlets ? lod.firstMeshlet + firstMeshlet : firstMeshlet;
+                lod.meshletCount = target.buildMeshlets ? lod.meshletCount : 0;
+            }
+            target.surfaces.PushBack(surface);
+        }
+
+        if(target.pQuality)
+            target.pQuality->AddBlockAtBack(const_cast<MeshQualityStats*>(GetCookedMeshQuality(m_file.Data(), entry)), entry.surfaceCount);
+
+        return 1;
+    }
+
+    void CookedSceneFile::SumQuality(MeshQualityStats& total)
+    {
+        BlitCL::DynamicArray<MeshQualityStats> quality;
+        size_t tableOffset = size_t(reinterpret_cast<const uint8_t*>(m_pMeshes) - m_file.Data());
+        for(uint32_t i = 0; i < m_meshCount; ++i)
+        {
+            const CookedMeshEntry& entry = m_pMeshes[i];
+            if(entry.offset + GetCookedMeshSize(entry) <= tableOffset)
+                quality.AddBlockAtBack(const_cast<MeshQualityStats*>(GetCookedMeshQuality(m_file.Data(), entry)), entry.surfaceCount);
+        }
+        SumMeshQuality(quality.Data(), quality.GetSize(), total);
+    }
+
+    // Each array starts at the cooked alignment, the space before it is filled with zeros
+    static uint8_t WriteCookedBlock(BlitzenPlatform::FileHandle& file, const void* pData, size_t size, uint64_t& offset)
+    {
+        static const uint8_t padding[BLIT_COOKED_SCENE_ALIGNMENT] = {};
+        size_t written = 0;
+        size_t paddingSize = AlignCookedSize(offset) - offset;
+        if(paddingSize && !BlitzenPlatform::FilesystemWrite(file, paddingSize, padding, &written))
+            return 0;
+        offset += paddingSize;
+
+        if(size && !BlitzenPlatform::FilesystemWrite(file, size, pData, &written))
+            return 0;
+        offset += size;
+        return 1;
+    }
+
+    // Builds each mesh and writes it right away, so only one mesh is held in memory at a time
+    static uint8_t WriteCookedScene(const char* cookedPath, cgltf_data* pData, uint8_t bMeshlets, uint64_t contentHash,
+    CookStats& stats)
+    {
+        std::string tempPath = std::string(cookedPath) + ".tmp";
+        uint64_t offset = 0;
+        BlitCL::DynamicArray<MeshQualityStats> sceneQuality;
+        {
+            BlitzenPlatform::FileHandle file;
+            if(!file.Open(tempPath.c_str(), BlitzenPlatform::FileModes::Write, 1))
+                return 0;
+
+            CookedSceneHeader header{};
+            header.magic = BLIT_COOKED_SCENE_MAGIC;
+            header.version = BLIT_COOKED_SCENE_VERSION;
+            header.vertexSize = sizeof(Vertex);
+            header.meshletSize = sizeof(Meshlet);
+            header.surfaceSize = sizeof(PrimitiveSurface);
+            header.qualitySize = sizeof(MeshQualityStats);
+            header.bMeshlets = bMeshlets;
+            header.contentHash = contentHash;
+            if(!WriteCookedBlock(file, &header, sizeof(header), offset))
+                return 0;
+
+            BlitCL::DynamicArray<CookedMeshEntry> entries(pData->meshes_count);
+            for(uint32_t i = 0; i < pData->meshes_count; ++i)
+            {
+                BlitCL::DynamicArray<Vertex> vertices;
+                BlitCL::DynamicArray<uint32_t> indices;
+                BlitCL::DynamicArray<Meshlet> meshlets;
+                BlitCL::DynamicArray<uint32_t> meshletData;
+                BlitCL::DynamicArray<PrimitiveSurface> surfaces;
+                BlitCL::DynamicArray<MeshQualityStats> quality;
+                GeometryTarget target{vertices, indices, meshlets, meshletData, surfaces, bMeshlets, &quality};
+                LoadGltfMesh(pData, i, BLIT_STREAMING_UNUSED_INDEX, target);
+
+                CookedMeshEntry& entry = entries[i];
+                entry = {};
+                entry.offset = AlignCookedSize(offset);
+                entry.vertexCount = static_cast<uint32_t>(vertices.GetSize());
+                entry.indexCount = static_cast<uint32_t>(indices.GetSize());
+                entry.meshletCount = static_cast<uint32_t>(meshlets.GetSize());
+                entry.meshletDataCount = static_cast<uint32_t>(meshletData.GetSize());
+                entry.surfaceCount = static_cast<uint32_t>(surfaces.GetSize());
+
+                if(!WriteCookedBlock(file, vertices.Data(), vertices.GetSize() * sizeof(Vertex), offset) ||
+                !WriteCookedBlock(file, indices.Data(), indices.GetSize() * sizeof(uint32_t), offset) ||
+                !WriteCookedBlock(file, meshlets.Data(), meshlets.GetSize() * sizeof(Meshlet), offset) ||
+                !WriteCookedBlock(file, meshletData.Data(), meshletData.GetSize() * sizeof(uint32_t), offset) ||
+                !WriteCookedBlock(file, surfaces.Data(), surfaces.GetSize() * sizeof(PrimitiveSurface), offset) ||
+                !WriteCookedBlock(file, quality.Data(), quality.GetSize() * sizeof(MeshQualityStats), offset))
+                    return 0;
+                sceneQuality.AddBlockAtBack(quality.Data(), quality.GetSize());
+
+                stats.surfaceCount += entry.surfaceCount;
+                stats.vertexCount += entry.vertexCount;
+                stats.indexCount += entry.indexCount;
+                stats.meshletCount += entry.meshletCount;
+            }
+
+            CookedSceneFooter footer{};
+            footer.meshCount = static_cast<uint32_t>(pData->meshes_count);
+            footer.magic = BLIT_COOKED_SCENE_MAGIC;
+            footer.tableOffset = AlignCookedSize(offset);
+            if(!WriteCookedBlock(file, entries.Data(), entries.GetSize() * sizeof(CookedMeshEntry), offset) ||
+            !WriteCookedBlock(file, &footer, sizeof(footer), offset))
+                return 0;
+        }
+
+        SumMeshQuality(sceneQuality.Data(), sceneQuality.GetSize(), stats.quality);
+        stats.meshCount = static_cast<uint32_t>(pData->meshes_count);
+        stats.cookedBytes = offset;
+        return ReplaceFile(tempPath, cookedPath);
+    }
+
+    static uint8_t CookParsedScene(const char* path, cgltf_data* pData, cgltf_options& options, uint8_t bMeshlets, uint8_t bForce,
+    CookStats& stats)
+    {
+        std::string cookedPath = GetAssetCachePath(path, BLIT_COOKED_SCENE_EXTENSION);
+        std::string manifestPath = GetAssetCachePath(path, BLIT_COOKED_MANIFEST_EXTENSION);
+
+        // Textures are baked whether the meshes are cooked again or not, each one is only baked when its source changed
+        stats.textureCount = static_cast<uint32_t>(pData->textures_count);
+        if(pData->textures_count)
+        {
+            BlitCL::DynamicArray<std::string> texturePaths(pData->textures_count);
+            GetGltfTexturePaths(path, pData, texturePaths);
+        }
+
+        BlitCL::DynamicArray<CookDependency> dependencies;
+        GetGltfDependencies(path, pData, dependencies);
+
+        // The hashes of the files that have not been written since the last cook are taken from its manifest
+        uint64_t previousHash = 0;
+        BlitCL::DynamicArray<CookDependency> previous;
+        uint8_t bPrevious = !bForce && BlitzenPlatform::FilepathExists(cookedPath.c_str()) &&
+        ReadCookManifest(manifestPath.c_str(), previousHash, previous);
+
+        uint8_t bWritten = !bPrevious || previous.GetSize() != dependencies.GetSize();
+        for(size_t i = 0; i < dependencies.GetSize(); ++i)
+        {
+            CookDependency& dependency = dependencies[i];
+            stats.sourceBytes += dependency.size;
+
+            uint8_t bKnown = 0;
+            for(size_t j = 0; bPrevious && j < previous.GetSize() && !bKnown; ++j)
+            {
+                if(!strcmp(previous[j].path, dependency.path) && previous[j].size == dependency.size &&
+                previous[j].writeTime == dependency.writeTime)
+                {
+                    dependency.hash = previous[j].hash;
+                    bKnown = 1;
+                }
+            }
+            bWritten = bWritten || !bKnown;
+
+            if(!bKnown && !HashFileContents(dependency.path, dependency.hash))
+            {
+                BLIT_ERROR("Failed to read dependency %s of scene %s", dependency.path, path)
+                return 0;
+            }
+        }
+
+        uint64_t contentHash = GetCookContentHash(dependencies, bMeshlets);
+        if(bPrevious && contentHash == previousHash)
+        {
+            // Files that were written without changing keep the cooked scene, the new write times let the engine use it again
+            if(bWritten && !WriteCookManifest(manifestPath.c_str(), contentHash, dependencies))
+                return 0;
+
+            uint64_t writeTime;
+            BlitzenPlatform::GetFileInfo(cookedPath.c_str(), stats.cookedBytes, writeTime);
+
+            CookedSceneFile cooked;
+            if(cooked.Open(path, bMeshlets))
+                cooked.SumQuality(stats.quality);
+            return 1;
+        }
+
+        if(cgltf_load_buffers(&options, pData, path) != cgltf_result_success || cgltf_validate(pData) != cgltf_result_success)
+        {
+            BLIT_ERROR("Failed to load gltf buffers: %s", path)
+            return 0;
+        }
+
+        std::string::size_type slash = cookedPath.find_last_of('/');
+        if(slash != std::string::npos && !BlitzenPlatform::CreateDirectories(cookedPath.substr(0, slash).c_str()))
+        {
+            BLIT_ERROR("Failed to create cache directory for: %s", cookedPath.c_str())
+            return 0;
+        }
+
+        // The manifest goes last, a cooked file without its manifest is never used
+        if(!WriteCookedScene(cookedPath.c_str(), pData, bMeshlets, contentHash, stats) ||
+        !WriteCookManifest(manifestPath.c_str(), contentHash, dependencies))
+        {
+            BLIT_ERROR("Failed to write cooked scene: %s", cookedPath.c_str())
+            return 0;
+        }
+
+        stats.bCooked = 1;
+        return 1;
+    }
+
+    uint8_t CookGltfScene(const char* path, uint8_t bMeshlets, uint8_t bForce, CookStats& stats)
+    {
+        // The platform clock is set up with the window, which the cooker does not have
+        auto startTime = std::chrono::steady_clock::now();
+
+        // Declared before the data, so that the files are unmapped after it is freed
+        GltfFileMapper fileMapper;
+        cgltf_options options = {};
+        fileMapper.SetCallbacks(options);
+
+        cgltf_data* pData = nullptr;
+        uint8_t bSuccess = cgltf_parse_file(&options, path, &pData) == cgltf_result_success;
+        if(bSuccess)
+            bSuccess = CookParsedScene(path, pData, options, bMeshlets, bForce, stats);
+        else
+            BLIT_ERROR("Failed to load gltf file: %s", path)
+
+        if(pData)
+            cgltf_free(pData);
+
+        stats.bFailed = !bSuccess;
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return bSuccess;
+    }
+}
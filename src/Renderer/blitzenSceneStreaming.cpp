@@ -0,0 +1,494 @@
+#include "blitSceneStreaming.h"
+#include "Platform/filesystem.h"
+
+// The implementation is compiled in blitzenRenderingResources.cpp
+#include "Cgltf/cgltf.h"
+
+#include <cstring>
+
+namespace BlitzenEngine
+{
+    size_t StreamedChunk::GetUploadSize()
+    {
+        switch(type)
+        {
+            case StreamedChunkType::Scene:
+                return materials.GetSize() * sizeof(Material);
+            case StreamedChunkType::Mesh:
+                return vertices.GetSize() * sizeof(Vertex) + indices.GetSize() * sizeof(uint32_t) +
+                meshlets.GetSize() * sizeof(Meshlet) + meshletData.GetSize() * sizeof(uint32_t) +
+                surfaces.GetSize() * sizeof(PrimitiveSurface);
+            case StreamedChunkType::Texture:
+                return textureData.GetSize();
+            default:
+                return 0;
+        }
+    }
+
+    StreamedScene* SceneStreamer::QueueScene(const char* path, uint8_t buildMeshlets, uint8_t loadTextures, const BlitML::vec3& offset)
+    {
+        // Starts the workers, leaving one core to the main thread
+        if(!m_workerCount)
+        {
+            m_bBuildMeshlets = buildMeshlets;
+            m_bLoadTextures = loadTextures;
+
+            uint32_t coreCount = std::thread::hardware_concurrency();
+            m_workerCount = coreCount > 1 ? coreCount - 1 : 1;
+            m_workerCount = m_workerCount > BLIT_STREAMING_MAX_WORKER_COUNT ? BLIT_STREAMING_MAX_WORKER_COUNT : m_workerCount;
+            for(uint32_t i = 0; i < m_workerCount; ++i)
+                m_workers[i] = std::thread(&SceneStreamer::WorkerLoop, this);
+
+            if(m_bLoadTextures)
+                m_io.Init();
+        }
+
+        // Scenes that are loaded and unloaded over and over (world partition cells) would otherwise pile up
+        CollectReleasedScenes();
+
+        StreamedScene* pScene = BlitzenCore::BlitConstructAlloc<StreamedScene>(BlitzenCore::AllocationType::Scene);
+        pScene->path = path;
+        pScene->offset = offset;
+        pScene->pendingJobs = 1;
+        m_scenes.PushBack(pScene);
+        m_sceneCount++;
+
+        // Only the scene chunk is known until the file is parsed
+        m_knownChunkCount++;
+
+        {
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            m_jobs.PushBack({JobType::Parse, pScene, 0});
+        }
+        m_jobSignal.notify_one();
+
+        BLIT_INFO("Streaming GLTF scene from file: %s", path)
+        return pScene;
+    }
+
+    StreamedChunk* SceneStreamer::PeekFinishedChunk()
+    {
+        while(1)
+        {
+            StreamedChunk* pChunk = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(m_finishedMutex);
+                if(m_nextFinishedChunk < m_finishedChunks.GetSize())
+                    pChunk = m_finishedChunks[m_nextFinishedChunk];
+            }
+
+            // The chunks of cancelled scenes are dropped here, so the caller never sees them
+            if(!pChunk || !pChunk->pScene->bCancelled.load())
+                return pChunk;
+
+            PopFinishedChunk();
+            ReleaseChunk(pChunk);
+        }
+    }
+
+    void SceneStreamer::PopFinishedChunk()
+    {
+        std::lock_guard<std::mutex> lock(m_finishedMutex);
+        m_nextFinishedChunk++;
+
+        // Once every chunk has been taken the array starts over, so it does not keep growing
+        if(m_nextFinishedChunk == m_finishedChunks.GetSize())
+        {
+            m_finishedChunks.Downsize(0);
+            m_nextFinishedChunk = 0;
+        }
+    }
+
+    StreamedChunk* SceneStreamer::CreateChunk(StreamedChunkType type, StreamedScene* pScene)
+    {
+        StreamedChunk* pChunk = BlitzenCore::BlitConstructAlloc<StreamedChunk>(BlitzenCore::AllocationType::Scene);
+        pChunk->type = type;
+        pChunk->pScene = pScene;
+        pScene->liveChunks.fetch_add(1);
+        return pChunk;
+    }
+
+    void SceneStreamer::ReleaseChunk(StreamedChunk* pChunk)
+    {
+        pChunk->pScene->liveChunks.fetch_sub(1);
+        BlitzenCore::BlitDestroyAlloc(BlitzenCore::AllocationType::Scene, pChunk);
+    }
+
+    void SceneStreamer::OnChunkCommitted(StreamedChunk* pChunk)
+    {
+        StreamedScene* pScene = pChunk->pScene;
+        m_committedChunkCount++;
+
+        if(pChunk->type == StreamedChunkType::Scene)
+        {
+            pScene->bSceneCommitted = 1;
+            pScene->uncommittedChunks += pChunk->chunkCount;
+            m_knownChunkCount += pChunk->chunkCount;
+        }
+        else
+        {
+            pScene->uncommittedChunks--;
+        }
+
+        if(pScene->bSceneCommitted && !pScene->uncommittedChunks && !pScene->bFinished)
+        {
+            pScene->bFinished = 1;
+            m_finishedSceneCount++;
+            BLIT_INFO("Finished streaming GLTF scene from file: %s", pScene->path.c_str())
+        }
+    }
+
+    void SceneStreamer::Cancel()
+    {
+        for(size_t i = 0; i < m_scenes.GetSize(); ++i)
+            CancelScene(m_scenes[i]);
+    }
+
+    void SceneStreamer::CancelScene(StreamedScene* pScene)
+    {
+        if(pScene->bFinished)
+            return;
+
+        // The workers skip the jobs of the scene that are still queued
+        pScene->bCancelled.store(1);
+        pScene->bFinished = 1;
+        m_finishedSceneCount++;
+        BLIT_INFO("Cancelled streaming GLTF scene from file: %s", pScene->path.c_str())
+    }
+
+    void SceneStreamer::ReleaseScene(StreamedScene* pScene)
+    {
+        CancelScene(pScene);
+        pScene->bReleased = 1;
+    }
+
+    void SceneStreamer::CollectReleasedScenes()
+    {
+        size_t i = 0;
+        while(i < m_scenes.GetSize())
+        {
+            StreamedScene* pScene = m_scenes[i];
+            if(!pScene->bReleased || !pScene->bDataReleased.load(std::memory_order_acquire) || pScene->liveChunks.load())
+            {
+                ++i;
+                continue;
+            }
+
+            // The order of the scenes does not matter, the last one takes the freed place
+            BlitzenCore::BlitDestroyAlloc(BlitzenCore::AllocationType::Scene, pScene);
+            m_scenes[i] = m_scenes.Back();
+            m_scenes.Downsize(m_scenes.GetSize() - 1);
+        }
+    }
+
+    void SceneStreamer::Shutdown()
+    {
+        if(m_workerCount)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_jobMutex);
+                m_bShutdown = 1;
+            }
+            m_jobSignal.notify_all();
+
+            for(uint32_t i = 0; i < m_workerCount; ++i)
+                m_workers[i].join();
+            m_workerCount = 0;
+        }
+
+        // The texture reads that are still in flight push their chunks before this returns
+        m_io.Shutdown();
+
+        // Nothing else touches the chunks and the scenes once the workers are gone
+        for(size_t i = m_nextFinishedChunk; i < m_finishedChunks.GetSize(); ++i)
+            ReleaseChunk(m_finishedChunks[i]);
+        m_finishedChunks.Downsize(0);
+        m_nextFinishedChunk = 0;
+
+        for(size_t i = 0; i < m_scenes.GetSize(); ++i)
+        {
+            StreamedScene* pScene = m_scenes[i];
+
+            // Scenes with jobs that never ran still hold their gltf data
+            if(pScene->pendingJobs.load())
+            {
+                if(pScene->pData)
+                    cgltf_free(pScene->pData);
+                if(pScene->pTexturePaths)
+                    BlitzenCore::BlitDestroyAlloc(BlitzenCore::AllocationType::Scene, pScene->pTexturePaths);
+                if(pScene->pCooked)
+                    BlitzenCore::BlitDestroyAlloc(BlitzenCore::AllocationType::Scene, pScene->pCooked);
+            }
+            BlitzenCore::BlitDestroyAlloc(BlitzenCore::AllocationType::Scene, pScene);
+        }
+        m_scenes.Downsize(0);
+        m_jobs.Downsize(0);
+        m_nextJob = 0;
+    }
+
+    SceneStreamer::~SceneStreamer()
+    {
+        Shutdown();
+    }
+
+    void SceneStreamer::WorkerLoop()
+    {
+        while(1)
+        {
+            StreamingJob job;
+            {
+                std::unique_lock<std::mutex> lock(m_jobMutex);
+                m_jobSignal.wait(lock, [this](){ return m_bShutdown || m_nextJob < m_jobs.GetSize(); });
+                if(m_bShutdown)
+                    return;
+
+                job = m_jobs[m_nextJob++];
+                if(m_nextJob == m_jobs.GetSize())
+                {
+                    m_jobs.Downsize(0);
+                    m_nextJob = 0;
+                }
+            }
+
+            if(job.pScene->bCancelled.load())
+            {
+                FinishJob(job.pScene);
+                continue;
+            }
+
+            switch(job.type)
+            {
+                case JobType::Parse:
+                    ParseScene(job.pScene);
+                    break;
+                case JobType::Mesh:
+                    BuildMesh(job.pScene, job.index);
+                    break;
+            }
+
+            FinishJob(job.pScene);
+        }
+    }
+
+    void SceneStreamer::ParseScene(StreamedScene* pScene)
+    {
+        StreamedChunk* pChunk = CreateChunk(StreamedChunkType::Scene, pScene);
+
+        cgltf_options options = {};
+        m_gltfFiles.SetCallbacks(options);
+        cgltf_data* pData = nullptr;
+        if(cgltf_parse_file(&options, pScene->path.c_str(), &pData) != cgltf_result_success)
+        {
+            BLIT_WARN("Failed to load gltf file: %s", pScene->path.c_str())
+            pChunk->bFailed = 1;
+            PushFinishedChunk(pChunk);
+            return;
+        }
+
+        // From here on the data is freed by the last job of the scene
+        pScene->pData = pData;
+
+        // Cooked scenes do not need the buffers, the nodes and materials are all that is read from the gltf
+        CookedSceneFile* pCooked = BlitzenCore::BlitConstructAlloc<CookedSceneFile>(BlitzenCore::AllocationType::Scene);
+        if(pCooked->Open(pScene->path.c_str(), m_bBuildMeshlets) && pCooked->GetMeshCount() == pData->meshes_count)
+        {
+            pScene->pCooked = pCooked;
+            BLIT_INFO("Using cooked scene for: %s", pScene->path.c_str())
+        }
+        else
+        {
+            BlitzenCore::BlitDestroyAlloc(BlitzenCore::AllocationType::Scene, pCooked);
+        }
+
+        if(!pScene->pCooked && (cgltf_load_buffers(&options, pData, pScene->path.c_str()) != cgltf_result_success ||
+        cgltf_validate(pData) != cgltf_result_success))
+        {
+            BLIT_WARN("Failed to load gltf buffers: %s", pScene->path.c_str())
+            pChunk->bFailed = 1;
+            PushFinishedChunk(pChunk);
+            return;
+        }
+
+        // Texture tags are relative to the file until the main thread gives the scene its texture slots
+        pChunk->materials.Resize(pData->materials_count);
+        for(size_t i = 0; i < pData->materials_count; ++i)
+            ConvertGltfMaterial(pData, pData->materials[i], 0, BLIT_STREAMING_UNUSED_INDEX, pChunk->materials[i]);
+
+        uint32_t meshCount = static_cast<uint32_t>(pData->meshes_count);
+        uint32_t textureCount = m_bLoadTextures ? static_cast<uint32_t>(pData->textures_count) : 0;
+        if(textureCount)
+        {
+            size_t pathCount = textureCount;
+            pScene->pTexturePaths = BlitzenCore::BlitConstructAlloc<BlitCL::DynamicArray<std::string>>(
+            BlitzenCore::AllocationType::Scene, pathCount);
+            GetGltfTexturePaths(pScene->path.c_str(), pData, *pScene->pTexturePaths);
+        }
+        pChunk->textureCount = textureCount;
+        pChunk->chunkCount = meshCount + textureCount;
+
+        // The scene chunk goes first, so that it is committed before the chunks that depend on it
+        PushFinishedChunk(pChunk);
+
+        // The parse job is still pending, so the data cannot be freed while the new jobs are queued
+        pScene->pendingJobs.fetch_add(meshCount + textureCount);
+        {
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            for(uint32_t i = 0; i < meshCount; ++i)
+                m_jobs.PushBack({JobType::Mesh, pScene, i});
+        }
+        m_jobSignal.notify_all();
+
+        if(textureCount)
+            ReadTextures(pScene, textureCount);
+    }
+
+    void SceneStreamer::BuildMesh(StreamedScene* pScene, uint32_t meshIndex)
+    {
+        StreamedChunk* pChunk = CreateChunk(StreamedChunkType::Mesh, pScene);
+
+        cgltf_data* pData = pScene->pData;
+        const cgltf_mesh& mesh = pData->meshes[meshIndex];
+
+        // The chunk's own arrays are the target, the offsets are rebased when the mesh is committed
+        GeometryTarget target{pChunk->vertices, pChunk->indices, pChunk->meshlets, pChunk->meshletData, pChunk->surfaces,
+        m_bBuildMeshlets};
+        if(!pScene->pCooked || !pScene->pCooked->ReadMesh(meshIndex, target))
+            LoadGltfMesh(pData, meshIndex, BLIT_STREAMING_UNUSED_INDEX, target);
+
+        // Every node that uses the mesh becomes a game object when the mesh is committed
+        for(size_t i = 0; i < pData->nodes_count; ++i)
+        {
+            const cgltf_node* pNode = &(pData->nodes[i]);
+            if(pNode->mesh != &mesh)
+                continue;
+
+            MeshTransform transform = GetGltfNodeTransform(pNode);
+            transform.pos = transform.pos + pScene->offset;
+            pChunk->transforms.PushBack(transform);
+        }
+
+        PushFinishedChunk(pChunk);
+    }
+
+    void SceneStreamer::ReadTextures(StreamedScene* pScene, uint32_t textureCount)
+    {
+        BlitCL::DynamicArray<BlitzenPlatform::AsyncReadRequest> requests;
+        uint32_t textureIndex = 0;
+        while(textureIndex < textureCount)
+        {
+            // Every open file holds a descriptor and a buffer of its size, so scenes that are parsed together share the limit
+            uint32_t batchSize = 0;
+            {
+                std::unique_lock<std::mutex> lock(m_textureReadMutex);
+                m_textureReadSignal.wait(lock, [this](){ return m_textureReadCount < BLIT_STREAMING_MAX_TEXTURE_READS; });
+                batchSize = BLIT_STREAMING_MAX_TEXTURE_READS - m_textureReadCount;
+                batchSize = batchSize > textureCount - textureIndex ? textureCount - textureIndex : batchSize;
+                m_textureReadCount += batchSize;
+            }
+
+            requests.Downsize(0);
+            for(uint32_t i = 0; i < batchSize; ++i, ++textureIndex)
+            {
+                TextureRead* pRead = BlitzenCore::BlitConstructAlloc<TextureRead>(BlitzenCore::AllocationType::Scene);
+                pRead->pStreamer = this;
+                pRead->pChunk = CreateChunk(StreamedChunkType::Texture, pScene);
+                pRead->pChunk->textureIndex = textureIndex;
+
+                // Files that cannot be read and cancelled scenes call back right away, so the counts still add up
+                const char* path = (*pScene->pTexturePaths)[textureIndex].c_str();
+                if(pScene->bCancelled.load() || !pRead->file.Open(path) || !pRead->file.GetSize())
+                {
+                    OnTextureRead(pRead, 0, 0);
+                    continue;
+                }
+
+                // The image is never bigger than its file, so the whole file is read and the headers are dropped afterwards
+                size_t fileSize = pRead->file.GetSize();
+                pRead->pChunk->textureData.Resize(fileSize);
+                requests.PushBack({&pRead->file, 0, fileSize, pRead->pChunk->textureData.Data(), OnTextureRead, pRead});
+            }
+
+            if(requests.GetSize() && !m_io.SubmitReads(requests.Data(), static_cast<uint32_t>(requests.GetSize())))
+            {
+                for(size_t i = 0; i < requests.GetSize(); ++i)
+                    OnTextureRead(requests[i].pUserData, 0, 0);
+            }
+        }
+    }
+
+    void SceneStreamer::OnTextureRead(void* pUserData, uint8_t bSuccess, size_t bytesRead)
+    {
+        TextureRead* pRead = reinterpret_cast<TextureRead*>(pUserData);
+        SceneStreamer* pStreamer = pRead->pStreamer;
+        StreamedChunk* pChunk = pRead->pChunk;
+        StreamedScene* pScene = pChunk->pScene;
+
+        pChunk->bFailed = 1;
+        if(bSuccess && bytesRead == pRead->file.GetSize() && !pScene->bCancelled.load())
+        {
+            pChunk->header = {};
+            pChunk->header10 = {};
+            size_t imageOffset = 0;
+            size_t imageSize = 0;
+            uint8_t* pFileData = pChunk->textureData.Data();
+            if(ParseDDSImage(pFileData, bytesRead, pChunk->header, pChunk->header10, pChunk->format, RendererToLoadDDS::Vulkan,
+            imageOffset, imageSize))
+            {
+                // Only the image data is uploaded, it is moved over the headers so that it does not need another buffer
+                memmove(pFileData, pFileData + imageOffset, imageSize);
+                pChunk->textureData.Downsize(imageSize);
+                pChunk->bFailed = 0;
+            }
+        }
+        pRead->file.Close();
+
+        if(pChunk->bFailed)
+        {
+            if(!pScene->bCancelled.load())
+                BLIT_WARN("GLTF texture from file: %s failed to stream", (*pScene->pTexturePaths)[pChunk->textureIndex].c_str())
+            pChunk->textureData.ReleaseMemory();
+        }
+
+        pStreamer->PushFinishedChunk(pChunk);
+        pStreamer->FinishJob(pScene);
+        BlitzenCore::BlitDestroyAlloc(BlitzenCore::AllocationType::Scene, pRead);
+
+        {
+            std::lock_guard<std::mutex> lock(pStreamer->m_textureReadMutex);
+            pStreamer->m_textureReadCount--;
+        }
+        pStreamer->m_textureReadSignal.notify_one();
+    }
+
+    void SceneStreamer::FinishJob(StreamedScene* pScene)
+    {
+        // Only the thread that finishes the last job sees the count reach zero
+        if(pScene->pendingJobs.fetch_sub(1) != 1)
+            return;
+
+        if(pScene->pData)
+        {
+            cgltf_free(pScene->pData);
+            pScene->pData = nullptr;
+        }
+        if(pScene->pTexturePaths)
+        {
+            BlitzenCore::BlitDestroyAlloc(BlitzenCore::AllocationType::Scene, pScene->pTexturePaths);
+            pScene->pTexturePaths = nullptr;
+        }
+        if(pScene->pCooked)
+        {
+            BlitzenCore::BlitDestroyAlloc(BlitzenCore::AllocationType::Scene, pScene->pCooked);
+            pScene->pCooked = nullptr;
+        }
+
+        // Nothing after this touches the scene
+        pScene->bDataReleased.store(1, std::memory_order_release);
+    }
+
+    void SceneStreamer::PushFinishedChunk(StreamedChunk* pChunk)
+    {
+        std::lock_guard<std::mutex> lock(m_finishedMutex);
+        m_finishedChunks.PushBack(pChunk);
+    }
+}
@@ -0,0 +1,733 @@
+#include "Renderer/blitTextureBake.h"
+#include "Renderer/blitRenderingResources.h"
+#include "Core/blitLogger.h"
+#include "Core/blitzenContainerLibrary.h"
+#include "Platform/filesystem.h"
+#include "BlitzenMathLibrary/blitML.h"
+
+// The implementation is compiled in blitzenRenderingResources.cpp
+#include "VendorCode/stb_image.h"
+
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <atomic>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #include <emmintrin.h>
+    #define BLIT_TEXTURE_BAKE_SSE
+#endif
+
+// DDS header flags that the baked files set. Copied from https://learn.microsoft.com/en-us/windows/win32/direct3ddds/dds-header
+#define BLIT_DDSD_REQUIRED          (0x1 | 0x2 | 0x4 | 0x1000)
+#define BLIT_DDSD_MIPMAPCOUNT       0x20000
+#define BLIT_DDSD_LINEARSIZE        0x80000
+#define BLIT_DDPF_FOURCC            0x4
+#define BLIT_DDSCAPS_COMPLEX        0x8
+#define BLIT_DDSCAPS_TEXTURE        0x1000
+#define BLIT_DDSCAPS_MIPMAP         0x400000
+
+namespace BlitzenEngine
+{
+    // One mip level of the image, in the baked file and in the 8 bit RGBA array that its blocks are read from
+    struct BakeLevel
+    {
+        uint32_t width;
+        uint32_t height;
+        size_t pixelOffset;
+
+        uint32_t blockRowCount;
+        uint32_t firstBlockRow;
+        size_t dataOffset;
+    };
+
+    // Shared by the threads that encode one texture. Each takes the next row of blocks until every level is done
+    struct BakeEncodeJob
+    {
+        const uint8_t* pPixels;
+        uint8_t* pData;
+        BakeLevel* pLevels;
+        uint32_t levelCount;
+        uint32_t blockRowCount;
+        TextureBakeFormat format;
+        std::atomic<uint32_t> nextBlockRow{0};
+    };
+
+    static uint32_t MinBake(uint32_t x, uint32_t y) { return x < y ? x : y; }
+    static float ClampBake(float x, float low, float high) { return x < low ? low : x > high ? high : x; }
+
+    static float SrgbToLinear(float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    static float LinearToSrgb(float value)
+    {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.f / 2.4f) - 0.055f;
+    }
+
+    static uint8_t ToUnorm8(float value)
+    {
+        value = value < 0.f ? 0.f : value > 1.f ? 1.f : value;
+        return static_cast<uint8_t>(value * 255.f + 0.5f);
+    }
+
+    // Averages each 2x2 quad of the source level. Levels with an odd size clamp to their last row or column
+    static void DownsampleLevel(const float* pSrc, uint32_t srcWidth, uint32_t srcHeight, float* pDst, uint32_t dstWidth, uint32_t dstHeight)
+    {
+        for(uint32_t y = 0; y < dstHeight; ++y)
+        {
+            const float* pRow0 = pSrc + size_t(MinBake(y * 2, srcHeight - 1)) * srcWidth * 4;
+            const float* pRow1 = pSrc + size_t(MinBake(y * 2 + 1, srcHeight - 1)) * srcWidth * 4;
+            float* pOut = pDst + size_t(y) * dstWidth * 4;
+            for(uint32_t x = 0; x < dstWidth; ++x)
+            {
+                uint32_t x0 = MinBake(x * 2, srcWidth - 1) * 4;
+                uint32_t x1 = MinBake(x * 2 + 1, srcWidth - 1) * 4;
+
+                // The four channels of a texel are filtered together
+                #ifdef BLIT_TEXTURE_BAKE_SSE
+                    __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(pRow0 + x0), _mm_loadu_ps(pRow0 + x1)),
+                    _mm_add_ps(_mm_loadu_ps(pRow1 + x0), _mm_loadu_ps(pRow1 + x1)));
+                    _mm_storeu_ps(pOut + x * 4, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+                #else
+                    for(uint32_t c = 0; c < 4; ++c)
+                        pOut[x * 4 + c] = (pRow0[x0 + c] + pRow0[x1 + c] + pRow1[x0 + c] + pRow1[x1 + c]) * 0.25f;
+                #endif
+            }
+        }
+    }
+
+    // Gives the 16 texels of a block. Blocks over the edge of small levels repeat the last row and column
+    static void ReadBlock(const uint8_t* pPixels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t (*pBlock)[4])
+    {
+        for(uint32_t y = 0; y < 4; ++y)
+        {
+            uint32_t py = MinBake(blockY * 4 + y, height - 1);
+            for(uint32_t x = 0; x < 4; ++x)
+            {
+                uint32_t px = MinBake(blockX * 4 + x, width - 1);
+                memcpy(pBlock[y * 4 + x], pPixels + (size_t(py) * width + px) * 4, 4);
+            }
+        }
+    }
+
+    static void WriteBits(uint8_t* pBlock, uint32_t& bitOffset, uint32_t value, uint32_t bitCount)
+    {
+        for(uint32_t i = 0; i < bitCount; ++i, ++bitOffset)
+        {
+            if((value >> i) & 1)
+                pBlock[bitOffset >> 3] |= static_cast<uint8_t>(1 << (bitOffset & 7));
+        }
+    }
+
+    // Principal axis of the block's colors, found with a few power iterations on their covariance
+    static void GetPrincipalAxis(const uint8_t (*pBlock)[4], uint32_t channelCount, float* pMean, float* pAxis)
+    {
+        for(uint32_t c = 0; c < channelCount; ++c)
+        {
+            pMean[c] = 0.f;
+            for(uint32_t i = 0; i < 16; ++i)
+                pMean[c] += pBlock[i][c];
+            pMean[c] /= 16.f;
+        }
+
+        float covariance[4][4] = {};
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            for(uint32_t a = 0; a < channelCount; ++a)
+            {
+                for(uint32_t b = 0; b < channelCount; ++b)
+                    covariance[a][b] += (pBlock[i][a] - pMean[a]) * (pBlock[i][b] - pMean[b]);
+            }
+        }
+
+        for(uint32_t c = 0; c < channelCount; ++c)
+            pAxis[c] = 1.f;
+        for(uint32_t iteration = 0; iteration < 8; ++iteration)
+        {
+            float next[4] = {};
+            float length = 0.f;
+            for(uint32_t a = 0; a < channelCount; ++a)
+            {
+                for(uint32_t b = 0; b < channelCount; ++b)
+                    next[a] += covariance[a][b] * pAxis[b];
+                length += next[a] * next[a];
+            }
+
+            // Flat blocks have no axis, any direction gives the same endpoints
+            if(length < 1e-8f)
+                return;
+            length = sqrtf(length);
+            for(uint32_t c = 0; c < channelCount; ++c)
+                pAxis[c] = next[c] / length;
+        }
+    }
+
+    // Gives the two ends of the block's colors along their principal axis
+    static void GetAxisEndpoints(const uint8_t (*pBlock)[4], uint32_t channelCount, float* pLow, float* pHigh)
+    {
+        float mean[4];
+        float axis[4];
+        GetPrincipalAxis(pBlock, channelCount, mean, axis);
+
+        float minProjection = 0.f;
+        float maxProjection = 0.f;
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            float projection = 0.f;
+            for(uint32_t c = 0; c < channelCount; ++c)
+                projection += (pBlock[i][c] - mean[c]) * axis[c];
+            minProjection = projection < minProjection ? projection : minProjection;
+            maxProjection = projection > maxProjection ? projection : maxProjection;
+        }
+
+        for(uint32_t c = 0; c < channelCount; ++c)
+        {
+            pLow[c] = ClampBake(mean[c] + axis[c] * minProjection, 0.f, 255.f);
+            pHigh[c] = ClampBake(mean[c] + axis[c] * maxProjection, 0.f, 255.f);
+        }
+    }
+
+    static uint16_t PackRgb565(const float* pColor)
+    {
+        uint32_t r = static_cast<uint32_t>(pColor[0] * 31.f / 255.f + 0.5f);
+        uint32_t g = static_cast<uint32_t>(pColor[1] * 63.f / 255.f + 0.5f);
+        uint32_t b = static_cast<uint32_t>(pColor[2] * 31.f / 255.f + 0.5f);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    static void UnpackRgb565(uint16_t color, int32_t* pColor)
+    {
+        int32_t r = (color >> 11) & 31;
+        int32_t g = (color >> 5) & 63;
+        int32_t b = color & 31;
+        pColor[0] = (r << 3) | (r >> 2);
+        pColor[1] = (g << 2) | (g >> 4);
+        pColor[2] = (b << 3) | (b >> 2);
+    }
+
+    // Picks the nearest of the four colors for each texel. Gives the packed indices and the squared error
+    static uint32_t GetBC1Indices(const uint8_t (*pBlock)[4], uint16_t color0, uint16_t color1, uint32_t& error)
+    {
+        int32_t palette[4][3];
+        UnpackRgb565(color0, palette[0]);
+        UnpackRgb565(color1, palette[1]);
+        for(uint32_t c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        uint32_t indices = 0;
+        error = 0;
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            uint32_t best = 0;
+            uint32_t bestDistance = UINT32_MAX;
+            for(uint32_t p = 0; p < 4; ++p)
+            {
+                uint32_t distance = 0;
+                for(uint32_t c = 0; c < 3; ++c)
+                {
+                    int32_t d = int32_t(pBlock[i][c]) - palette[p][c];
+                    distance += d * d;
+                }
+                if(distance < bestDistance)
+                {
+                    best = p;
+                    bestDistance = distance;
+                }
+            }
+            indices |= best << (i * 2);
+            error += bestDistance;
+        }
+        return indices;
+    }
+
+    // Endpoints are placed on the principal axis and refined once with least squares over the indices they gave.
+    // The first color is always the larger one, so the block is read with four colors (even when it is part of BC3)
+    static void EncodeBC1(const uint8_t (*pBlock)[4], uint8_t* pOut)
+    {
+        float low[4];
+        float high[4];
+        GetAxisEndpoints(pBlock, 3, low, high);
+
+        // Moves the ends in a little, the extreme texels are usually few
+        for(uint32_t c = 0; c < 3; ++c)
+        {
+            float inset = (high[c] - low[c]) / 16.f;
+            low[c] += inset;
+            high[c] -= inset;
+        }
+
+        uint16_t color0 = PackRgb565(high);
+        uint16_t color1 = PackRgb565(low);
+        uint32_t error;
+        uint32_t indices = GetBC1Indices(pBlock, color0, color1, error);
+
+        // Solves for the endpoints that fit the texels best with the weights that the indices give them
+        const float weights[4] = {1.f, 0.f, 2.f / 3.f, 1.f / 3.f};
+        float aa = 0.f, ab = 0.f, bb = 0.f;
+        float ax[3] = {}, bx[3] = {};
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            float a = weights[(indices >> (i * 2)) & 3];
+            float b = 1.f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for(uint32_t c = 0; c < 3; ++c)
+            {
+                ax[c] += a * pBlock[i][c];
+                bx[c] += b * pBlock[i][c];
+            }
+        }
+        float determinant = aa * bb - ab * ab;
+        if(fabsf(determinant) > 1e-6f)
+        {
+            float refined0[3];
+            float refined1[3];
+            for(uint32_t c = 0; c < 3; ++c)
+            {
+                refined0[c] = ClampBake((ax[c] * bb - bx[c] * ab) / determinant, 0.f, 255.f);
+                refined1[c] = ClampBake((bx[c] * aa - ax[c] * ab) / determinant, 0.f, 255.f);
+            }
+
+            uint16_t refinedColor0 = PackRgb565(refined0);
+            uint16_t refinedColor1 = PackRgb565(refined1);
+            if(refinedColor0 < refinedColor1)
+            {
+                uint16_t swap = refinedColor0;
+                refinedColor0 = refinedColor1;
+                refinedColor1 = swap;
+            }
+            uint32_t refinedError;
+            uint32_t refinedIndices = GetBC1Indices(pBlock, refinedColor0, refinedColor1, refinedError);
+            if(refinedColor0 != refinedColor1 && refinedError < error)
+            {
+                color0 = refinedColor0;
+                color1 = refinedColor1;
+                indices = refinedIndices;
+                error = refinedError;
+            }
+        }
+
+        // Equal endpoints would switch the block to three colors. Every texel takes the first one instead
+        if(color0 < color1)
+        {
+            uint16_t swap = color0;
+            color0 = color1;
+            color1 = swap;
+            indices = GetBC1Indices(pBlock, color0, color1, error);
+        }
+        if(color0 == color1)
+            indices = 0;
+
+        memcpy(pOut, &color0, 2);
+        memcpy(pOut + 2, &color1, 2);
+        memcpy(pOut + 4, &indices, 4);
+    }
+
+    // One channel with eight interpolated values between its smallest and largest texel (BC4, the alpha of BC3 and each channel of BC5)
+    static void EncodeBC4Channel(const uint8_t (*pBlock)[4], uint32_t channel, uint8_t* pOut)
+    {
+        uint8_t minValue = 255;
+        uint8_t maxValue = 0;
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            minValue = pBlock[i][channel] < minValue ? pBlock[i][channel] : minValue;
+            maxValue = pBlock[i][channel] > maxValue ? pBlock[i][channel] : maxValue;
+        }
+
+        memset(pOut, 0, 8);
+        pOut[0] = maxValue;
+        pOut[1] = minValue;
+        if(maxValue == minValue)
+            return;
+
+        int32_t palette[8];
+        palette[0] = maxValue;
+        palette[1] = minValue;
+        for(int32_t i = 1; i < 7; ++i)
+            palette[i + 1] = ((7 - i) * maxValue + i * minValue) / 7;
+
+        uint32_t bitOffset = 16;
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            uint32_t best = 0;
+            int32_t bestDistance = INT32_MAX;
+            for(uint32_t p = 0; p < 8; ++p)
+            {
+                int32_t distance = abs(int32_t(pBlock[i][channel]) - palette[p]);
+                if(distance < bestDistance)
+                {
+                    best = p;
+                    bestDistance = distance;
+                }
+            }
+            WriteBits(pOut, bitOffset, best, 3);
+        }
+    }
+
+    // Mode 6 only: one subset with RGBA endpoints of 7 bits and a shared bit each, and 16 interpolated colors.
+    // It covers most color and alpha blocks well, without the partition search of the other modes
+    static void EncodeBC7(const uint8_t (*pBlock)[4], uint8_t* pOut)
+    {
+        static const int32_t weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        float endpoints[2][4];
+        GetAxisEndpoints(pBlock, 4, endpoints[0], endpoints[1]);
+
+        // Each endpoint takes the shared bit that keeps it closest to the axis end
+        uint32_t quantized[2][4];
+        uint32_t pBits[2];
+        for(uint32_t e = 0; e < 2; ++e)
+        {
+            float bestError = 0.f;
+            for(uint32_t p = 0; p < 2; ++p)
+            {
+                uint32_t candidate[4];
+                float error = 0.f;
+                for(uint32_t c = 0; c < 4; ++c)
+                {
+                    float value = (endpoints[e][c] - float(p)) / 2.f + 0.5f;
+                    candidate[c] = static_cast<uint32_t>(ClampBake(value, 0.f, 127.f));
+                    float d = float((candidate[c] << 1) | p) - endpoints[e][c];
+                    error += d * d;
+                }
+                if(!p || error < bestError)
+                {
+                    bestError = error;
+                    pBits[e] = p;
+                    memcpy(quantized[e], candidate, sizeof(candidate));
+                }
+            }
+        }
+
+        int32_t palette[16][4];
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            for(uint32_t c = 0; c < 4; ++c)
+            {
+                int32_t e0 = int32_t((quantized[0][c] << 1) | pBits[0]);
+                int32_t e1 = int32_t((quantized[1][c] << 1) | pBits[1]);
+                palette[i][c] = ((64 - weights[i]) * e0 + weights[i] * e1 + 32) >> 6;
+            }
+        }
+
+        uint32_t indices[16];
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            uint32_t best = 0;
+            uint32_t bestDistance = UINT32_MAX;
+            for(uint32_t p = 0; p < 16; ++p)
+            {
+                uint32_t distance = 0;
+                for(uint32_t c = 0; c < 4; ++c)
+                {
+                    int32_t d = int32_t(pBlock[i][c]) - palette[p][c];
+                    distance += d * d;
+                }
+                if(distance < bestDistance)
+                {
+                    best = p;
+                    bestDistance = distance;
+                }
+            }
+            indices[i] = best;
+        }
+
+        // The first index is stored without its top bit, so the endpoints are swapped when it is set
+        if(indices[0] & 8)
+        {
+            for(uint32_t c = 0; c < 4; ++c)
+            {
+                uint32_t swap = quantized[0][c];
+                quantized[0][c] = quantized[1][c];
+                quantized[1][c] = swap;
+            }
+            uint32_t swap = pBits[0];
+            pBits[0] = pBits[1];
+            pBits[1] = swap;
+            for(uint32_t i = 0; i < 16; ++i)
+                indices[i] = 15 - indices[i];
+        }
+
+        memset(pOut, 0, 16);
+        uint32_t bitOffset = 0;
+        WriteBits(pOut, bitOffset, 1 << 6, 7);
+        for(uint32_t c = 0; c < 4; ++c)
+        {
+            WriteBits(pOut, bitOffset, quantized[0][c], 7);
+            WriteBits(pOut, bitOffset, quantized[1][c], 7);
+        }
+        WriteBits(pOut, bitOffset, pBits[0], 1);
+        WriteBits(pOut, bitOffset, pBits[1], 1);
+        for(uint32_t i = 0; i < 16; ++i)
+            WriteBits(pOut, bitOffset, indices[i], i ? 4 : 3);
+    }
+
+    static uint32_t GetBakeBlockSize(TextureBakeFormat format)
+    {
+        return format == TextureBakeFormat::BC1 ? 8 : 16;
+    }
+
+    static void EncodeBlock(const uint8_t (*pBlock)[4], TextureBakeFormat format, uint8_t* pOut)
+    {
+        switch(format)
+        {
+            case TextureBakeFormat::BC1:
+                EncodeBC1(pBlock, pOut);
+                break;
+            case TextureBakeFormat::BC3:
+                EncodeBC4Channel(pBlock, 3, pOut);
+                EncodeBC1(pBlock, pOut + 8);
+                break;
+            case TextureBakeFormat::BC5:
+                EncodeBC4Channel(pBlock, 0, pOut);
+                EncodeBC4Channel(pBlock, 1, pOut + 8);
+                break;
+            case TextureBakeFormat::BC7:
+                EncodeBC7(pBlock, pOut);
+                break;
+        }
+    }
+
+    static void EncodeBlockRows(BakeEncodeJob* pJob)
+    {
+        uint8_t block[16][4];
+        uint32_t blockSize = GetBakeBlockSize(pJob->format);
+        for(;;)
+        {
+            uint32_t row = pJob->nextBlockRow.fetch_add(1, std::memory_order_relaxed);
+            if(row >= pJob->blockRowCount)
+                return;
+
+            uint32_t levelIndex = 0;
+            while(levelIndex + 1 < pJob->levelCount && pJob->pLevels[levelIndex + 1].firstBlockRow <= row)
+                ++levelIndex;
+            BakeLevel& level = pJob->pLevels[levelIndex];
+
+            uint32_t blockY = row - level.firstBlockRow;
+            uint32_t blocksPerRow = (level.width + 3) / 4;
+            uint8_t* pOut = pJob->pData + level.dataOffset + size_t(blockY) * blocksPerRow * blockSize;
+            for(uint32_t blockX = 0; blockX < blocksPerRow; ++blockX)
+            {
+                ReadBlock(pJob->pPixels + level.pixelOffset, level.width, level.height, blockX, blockY, block);
+                EncodeBlock(block, pJob->format, pOut + size_t(blockX) * blockSize);
+            }
+        }
+    }
+
+    // Written next to the final file and renamed over it, so that a reader never sees half a file
+    static uint8_t WriteDDSFile(const char* ddsPath, uint32_t width, uint32_t height, uint32_t levelCount, TextureBakeFormat format,
+    const uint8_t* pData, size_t dataSize)
+    {
+        DDS_HEADER header{};
+        header.dwSize = sizeof(DDS_HEADER);
+        header.dwFlags = BLIT_DDSD_REQUIRED | BLIT_DDSD_MIPMAPCOUNT | BLIT_DDSD_LINEARSIZE;
+        header.dwHeight = height;
+        header.dwWidth = width;
+        header.dwPitchOrLinearSize = static_cast<unsigned int>(GetDDSImageSizeBC(width, height, 1, GetBakeBlockSize(format)));
+        header.dwMipMapCount = levelCount;
+        header.ddspf.dwSize = sizeof(DDS_PIXELFORMAT);
+        header.ddspf.dwFlags = BLIT_DDPF_FOURCC;
+        header.dwCaps = BLIT_DDSCAPS_TEXTURE | BLIT_DDSCAPS_MIPMAP | BLIT_DDSCAPS_COMPLEX;
+
+        DDS_HEADER_DXT10 header10{};
+        header10.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+        header10.arraySize = 1;
+        switch(format)
+        {
+            case TextureBakeFormat::BC1:
+                header.ddspf.dwFourCC = FourCC("DXT1");
+                break;
+            case TextureBakeFormat::BC3:
+                header.ddspf.dwFourCC = FourCC("DXT5");
+                break;
+            case TextureBakeFormat::BC5:
+                header.ddspf.dwFourCC = FourCC("DX10");
+                header10.dxgiFormat = DXGI_FORMAT_BC5_UNORM;
+                break;
+            case TextureBakeFormat::BC7:
+                header.ddspf.dwFourCC = FourCC("DX10");
+                header10.dxgiFormat = DXGI_FORMAT_BC7_UNORM;
+                break;
+        }
+
+        // Scenes that are cooked at the same time can bake the same texture, so each thread writes its own file
+        std::string tempPath = std::string(ddsPath) + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        {
+            BlitzenPlatform::FileHandle file;
+            if(!file.Open(tempPath.c_str(), BlitzenPlatform::FileModes::Write, 1))
+                return 0;
+
+            unsigned int magic = FourCC("DDS ");
+            size_t written = 0;
+            uint8_t bWritten = BlitzenPlatform::FilesystemWrite(file, sizeof(magic), &magic, &written) &&
+            BlitzenPlatform::FilesystemWrite(file, sizeof(header), &header, &written);
+            if(bWritten && header.ddspf.dwFourCC == FourCC("DX10"))
+                bWritten = BlitzenPlatform::FilesystemWrite(file, sizeof(header10), &header10, &written);
+            if(bWritten)
+                bWritten = BlitzenPlatform::FilesystemWrite(file, dataSize, pData, &written) && written == dataSize;
+            if(!bWritten)
+                return 0;
+        }
+
+        remove(ddsPath);
+        return rename(tempPath.c_str(), ddsPath) == 0;
+    }
+
+    std::string GetBakedTexturePath(const char* sourcePath)
+    {
+        return GetAssetCachePath(sourcePath, ".dds");
+    }
+
+    uint8_t BakeTexture(const char* sourcePath, const char* ddsPath, TextureBakeUsage usage)
+    {
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        stbi_uc* pSource = stbi_load(sourcePath, &width, &height, &channels, 4);
+        if(!pSource)
+        {
+            BLIT_ERROR("Failed to decode texture for baking: %s (%s)", sourcePath, stbi_failure_reason())
+            return 0;
+        }
+
+        uint8_t bBaked = BakeTexturePixels(pSource, uint32_t(width), uint32_t(height), ddsPath, usage);
+        stbi_image_free(pSource);
+        if(!bBaked)
+            return 0;
+
+        BLIT_INFO("Baked texture %s to %s (%ux%u)", sourcePath, ddsPath, uint32_t(width), uint32_t(height))
+        return 1;
+    }
+
+    uint8_t BakeTexturePixels(const uint8_t* pSource, uint32_t width, uint32_t height, const char* ddsPath, TextureBakeUsage usage)
+    {
+        // The format follows what the channels are used for. Alpha only counts if some texel is not opaque
+        uint8_t bAlpha = 0;
+        size_t texelCount = size_t(width) * size_t(height);
+        for(size_t i = 0; i < texelCount && !bAlpha; ++i)
+            bAlpha = pSource[i * 4 + 3] != 255;
+
+        TextureBakeFormat format;
+        if(usage == TextureBakeUsage::Normal)
+            format = TextureBakeFormat::BC5;
+        else if(BLIT_TEXTURE_BAKE_COLOR_BC7)
+            format = TextureBakeFormat::BC7;
+        else
+            format = bAlpha ? TextureBakeFormat::BC3 : TextureBakeFormat::BC1;
+
+        // Every level down to 1x1, with its place in the pixel array and in the file
+        uint32_t levelCount = 1;
+        while((uint32_t(width) >> levelCount) || (uint32_t(height) >> levelCount))
+            ++levelCount;
+        BlitCL::DynamicArray<BakeLevel> levels(levelCount);
+        size_t pixelCount = 0;
+        size_t dataSize = 0;
+        uint32_t blockRowCount = 0;
+        uint32_t blockSize = GetBakeBlockSize(format);
+        for(uint32_t i = 0; i < levelCount; ++i)
+        {
+            BakeLevel& level = levels[i];
+            level.width = BlitML::Max(uint32_t(width) >> i, 1u);
+            level.height = BlitML::Max(uint32_t(height) >> i, 1u);
+            level.pixelOffset = pixelCount * 4;
+            level.firstBlockRow = blockRowCount;
+            level.blockRowCount = (level.height + 3) / 4;
+            level.dataOffset = dataSize;
+
+            pixelCount += size_t(level.width) * level.height;
+            blockRowCount += level.blockRowCount;
+            dataSize += GetDDSImageSizeBC(level.width, level.height, 1, blockSize);
+        }
+
+        // The levels are filtered in floats, in linear space for colors and as vectors for normals
+        float toLinear[256];
+        for(uint32_t i = 0; i < 256; ++i)
+            toLinear[i] = usage == TextureBakeUsage::Normal ? float(i) / 255.f * 2.f - 1.f : SrgbToLinear(float(i) / 255.f);
+        BlitCL::DynamicArray<float> filtered(pixelCount * 4);
+        for(size_t i = 0; i < texelCount; ++i)
+        {
+            for(uint32_t c = 0; c < 3; ++c)
+                filtered[i * 4 + c] = toLinear[pSource[i * 4 + c]];
+            filtered[i * 4 + 3] = float(pSource[i * 4 + 3]) / 255.f;
+        }
+
+        for(uint32_t i = 1; i < levelCount; ++i)
+        {
+            DownsampleLevel(filtered.Data() + levels[i - 1].pixelOffset, levels[i - 1].width, levels[i - 1].height,
+            filtered.Data() + levels[i].pixelOffset, levels[i].width, levels[i].height);
+        }
+
+        BlitCL::DynamicArray<uint8_t> pixels(pixelCount * 4);
+        for(size_t i = 0; i < pixelCount; ++i)
+        {
+            float* pTexel = filtered.Data() + i * 4;
+            if(usage == TextureBakeUsage::Normal)
+            {
+                float length = sqrtf(pTexel[0] * pTexel[0] + pTexel[1] * pTexel[1] + pTexel[2] * pTexel[2]);
+                length = length > 1e-6f ? length : 1.f;
+                for(uint32_t c = 0; c < 3; ++c)
+                    pixels[i * 4 + c] = ToUnorm8(pTexel[c] / length * 0.5f + 0.5f);
+            }
+            else
+            {
+                for(uint32_t c = 0; c < 3; ++c)
+                    pixels[i * 4 + c] = ToUnorm8(LinearToSrgb(pTexel[c]));
+            }
+            pixels[i * 4 + 3] = ToUnorm8(pTexel[3]);
+        }
+
+        // Rows of blocks are handed out to the threads one at a time, the small levels at the end balance the load
+        BlitCL::DynamicArray<uint8_t> data(dataSize);
+        BakeEncodeJob job;
+        job.pPixels = pixels.Data();
+        job.pData = data.Data();
+        job.pLevels = levels.Data();
+        job.levelCount = levelCount;
+        job.blockRowCount = blockRowCount;
+        job.format = format;
+
+        uint32_t threadCount = BlitML::Max(std::thread::hardware_concurrency(), 1u);
+        threadCount = MinBake(MinBake(threadCount, uint32_t(BLIT_TEXTURE_BAKE_MAX_THREADS)), blockRowCount);
+        std::thread threads[BLIT_TEXTURE_BAKE_MAX_THREADS];
+        for(uint32_t i = 1; i < threadCount; ++i)
+            threads[i] = std::thread(EncodeBlockRows, &job);
+        EncodeBlockRows(&job);
+        for(uint32_t i = 1; i < threadCount; ++i)
+            threads[i].join();
+
+        if(!WriteDDSFile(ddsPath, width, height, levelCount, format, data.Data(), dataSize))
+        {
+            BLIT_ERROR("Failed to write baked texture: %s", ddsPath)
+            return 0;
+        }
+        return 1;
+    }
+
+    uint8_t GetOrBakeTexture(const char* sourcePath, TextureBakeUsage usage, std::string& ddsPath)
+    {
+        ddsPath = GetBakedTexturePath(sourcePath);
+
+        uint64_t sourceTime = 0;
+        uint64_t bakedTime = 0;
+        if(!BlitzenPlatform::GetFileWriteTime(sourcePath, sourceTime))
+            return 0;
+        if(BlitzenPlatform::GetFileWriteTime(ddsPath.c_str(), bakedTime) && bakedTime >= sourceTime)
+            return 1;
+
+        std::string::size_type slash = ddsPath.find_last_of('/');
+        if(slash != std::string::npos && !BlitzenPlatform::CreateDirectories(ddsPath.substr(0, slash).c_str()))
+        {
+            BLIT_ERROR("Failed to create texture cache directory for: %s", ddsPath.c_str())
+            return 0;
+        }
+
+        return BakeTexture(sourcePath, ddsPath.c_str(), usage);
+    }
+}
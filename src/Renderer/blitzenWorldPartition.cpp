@@ -0,0 +1,250 @@
+#include "Renderer/blitWorldPartition.h"
+#include "Platform/platform.h"
+
+namespace BlitzenEngine
+{
+    void WorldPartition::Init(RenderingSystem* pRenderer, float cellSize, float loadDistance, float unloadDistance, size_t memoryBudget)
+    {
+        BLIT_ASSERT_MESSAGE(unloadDistance > loadDistance, "Cells need to be unloaded further away than they are loaded")
+
+        m_pRenderer = pRenderer;
+        m_cellSize = cellSize;
+        m_loadDistance = loadDistance;
+        m_unloadDistance = unloadDistance;
+        m_memoryBudget = memoryBudget;
+
+        // The cells take their space in the renderers' buffers from the streaming headroom
+        m_pRenderer->RequestStreaming();
+    }
+
+    void WorldPartition::AddCell(const char* path, int32_t x, int32_t z)
+    {
+        WorldCell* pCell = BlitzenCore::BlitConstructAlloc<WorldCell>(BlitzenCore::AllocationType::Scene);
+        pCell->path = path;
+        pCell->x = x;
+        pCell->z = z;
+        pCell->origin = BlitML::vec3(static_cast<float>(x) * m_cellSize, 0.f, static_cast<float>(z) * m_cellSize);
+        m_cells.PushBack(pCell);
+    }
+
+    void WorldPartition::Update(const BlitML::vec3& cameraPosition)
+    {
+        // Cells that the camera moved away from are unloaded, whether they finished loading or not
+        for(size_t i = 0; i < m_cells.GetSize(); ++i)
+        {
+            WorldCell* pCell = m_cells[i];
+            if(pCell->state == WorldCellState::Unloaded)
+                continue;
+
+            if(GetCellDistance(pCell, cameraPosition) > m_unloadDistance)
+                UnloadCell(pCell);
+            else if(pCell->state == WorldCellState::Loading && pCell->pScene->bFinished)
+                pCell->state = WorldCellState::Resident;
+        }
+
+        m_stats.loadingCells = 0;
+        m_stats.residentCells = 0;
+        m_stats.residentBytes = 0;
+        for(size_t i = 0; i < m_cells.GetSize(); ++i)
+        {
+            WorldCell* pCell = m_cells[i];
+            if(pCell->state == WorldCellState::Loading)
+                m_stats.loadingCells++;
+            else if(pCell->state == WorldCellState::Resident)
+                m_stats.residentCells++;
+            if(pCell->pScene)
+                m_stats.residentBytes += pCell->pScene->committedBytes;
+        }
+
+        // The nearest cells in range are loaded first. Only a few are streamed at the same time,
+        // so that a fast camera does not queue cells that it will have passed before they are done
+        while(m_stats.loadingCells < BLIT_WORLD_MAX_LOADING_CELLS)
+        {
+            WorldCell* pNearest = nullptr;
+            float nearestDistance = m_loadDistance;
+            for(size_t i = 0; i < m_cells.GetSize(); ++i)
+            {
+                WorldCell* pCell = m_cells[i];
+                if(pCell->state != WorldCellState::Unloaded)
+                    continue;
+
+                float distance = GetCellDistance(pCell, cameraPosition);
+                if(distance <= nearestDistance)
+                {
+                    pNearest = pCell;
+                    nearestDistance = distance;
+                }
+            }
+            if(!pNearest)
+                break;
+
+            // Over the budget, cells further away than this one make room for it. If none are left, it waits
+            size_t estimate = EstimateCellBytes(pNearest);
+            while(m_stats.residentBytes + estimate > m_memoryBudget)
+            {
+                WorldCell* pFarthest = nullptr;
+                float farthestDistance = nearestDistance;
+                for(size_t i = 0; i < m_cells.GetSize(); ++i)
+                {
+                    WorldCell* pCell = m_cells[i];
+                    if(pCell->state == WorldCellState::Unloaded)
+                        continue;
+
+                    float distance = GetCellDistance(pCell, cameraPosition);
+                    if(distance > farthestDistance)
+                    {
+                        pFarthest = pCell;
+                        farthestDistance = distance;
+                    }
+                }
+                if(!pFarthest)
+                    break;
+
+                if(pFarthest->state == WorldCellState::Loading)
+                    m_stats.loadingCells--;
+                else
+                    m_stats.residentCells--;
+                m_stats.residentBytes -= pFarthest->pScene->committedBytes;
+                UnloadCell(pFarthest);
+                m_stats.budgetEvictionCount++;
+            }
+            if(m_stats.residentBytes + estimate > m_memoryBudget)
+                break;
+
+            LoadCell(pNearest);
+            m_stats.loadingCells++;
+            // Counted up front, so that the next cells of this frame see it
+            m_stats.residentBytes += estimate;
+        }
+
+        if(m_stats.residentBytes > m_stats.peakResidentBytes)
+            m_stats.peakResidentBytes = m_stats.residentBytes;
+    }
+
+    void WorldPartition::Clear()
+    {
+        for(size_t i = 0; i < m_cells.GetSize(); ++i)
+        {
+            if(m_cells[i]->state != WorldCellState::Unloaded)
+                UnloadCell(m_cells[i]);
+        }
+    }
+
+    void WorldPartition::LoadCell(WorldCell* pCell)
+    {
+        pCell->pScene = m_pRenderer->StreamSceneAt(pCell->path.c_str(), pCell->origin);
+        pCell->state = WorldCellState::Loading;
+        m_stats.loadCount++;
+    }
+
+    void WorldPartition::UnloadCell(WorldCell* pCell)
+    {
+        // Only cells that finished loading tell what the cell costs
+        if(pCell->state == WorldCellState::Resident)
+        {
+            pCell->lastResidentBytes = pCell->pScene->committedBytes;
+            m_measuredBytes += pCell->lastResidentBytes;
+            m_measuredCellCount++;
+        }
+
+        m_pRenderer->UnloadStreamedScene(pCell->pScene);
+        pCell->pScene = nullptr;
+        pCell->state = WorldCellState::Unloaded;
+        m_stats.unloadCount++;
+    }
+
+    float WorldPartition::GetCellDistance(WorldCell* pCell, const BlitML::vec3& cameraPosition)
+    {
+        float dx = BlitML::Max(BlitML::Max(pCell->origin.x - cameraPosition.x, cameraPosition.x - (pCell->origin.x + m_cellSize)), 0.f);
+        float dz = BlitML::Max(BlitML::Max(pCell->origin.z - cameraPosition.z, cameraPosition.z - (pCell->origin.z + m_cellSize)), 0.f);
+        return BlitML::Sqrt(dx * dx + dz * dz);
+    }
+
+    size_t WorldPartition::EstimateCellBytes(WorldCell* pCell)
+    {
+        if(pCell->lastResidentBytes)
+            return pCell->lastResidentBytes;
+
+        // The resident cells that are still loading are not counted, their size is not known yet
+        size_t bytes = m_measuredBytes;
+        uint32_t count = m_measuredCellCount;
+        for(size_t i = 0; i < m_cells.GetSize(); ++i)
+        {
+            if(m_cells[i]->state == WorldCellState::Resident)
+            {
+                bytes += m_cells[i]->pScene->committedBytes;
+                count++;
+            }
+        }
+        return count ? bytes / count : 0;
+    }
+
+    WorldPartition::~WorldPartition()
+    {
+        // The streamer frees the scenes when the renderers are shut down, so only the cells are freed here
+        for(size_t i = 0; i < m_cells.GetSize(); ++i)
+            BlitzenCore::BlitDestroyAlloc(BlitzenCore::AllocationType::Scene, m_cells[i]);
+    }
+
+
+
+    void WorldFlythroughBenchmark::Init(WorldPartition& partition, const char* scenePath, uint32_t gridSize, float cameraSpeed)
+    {
+        for(uint32_t z = 0; z < gridSize; ++z)
+        {
+            for(uint32_t x = 0; x < gridSize; ++x)
+                partition.AddCell(scenePath, static_cast<int32_t>(x), static_cast<int32_t>(z));
+        }
+
+        // The camera flies over the middle row, starting and ending a cell outside the grid
+        float cellSize = partition.GetCellSize();
+        float middle = static_cast<float>(gridSize) * cellSize * 0.5f;
+        m_start = BlitML::vec3(-cellSize, BLIT_WORLD_BENCHMARK_CAMERA_HEIGHT, middle);
+        m_end = BlitML::vec3(static_cast<float>(gridSize + 1) * cellSize, BLIT_WORLD_BENCHMARK_CAMERA_HEIGHT, middle);
+        m_cameraSpeed = cameraSpeed;
+
+        BLIT_INFO("World partition benchmark: %u x %u cells of %s", gridSize, gridSize, scenePath)
+    }
+
+    uint8_t WorldFlythroughBenchmark::Update(Camera& camera, WorldPartition& partition, double deltaTime)
+    {
+        // The first frame has no previous frame to time
+        if(m_frameCount)
+        {
+            m_frameTimeSum += deltaTime;
+            if(deltaTime > m_worstFrameTime)
+                m_worstFrameTime = deltaTime;
+            if(deltaTime > BLIT_WORLD_BENCHMARK_HITCH_TIME)
+                m_hitchCount++;
+        }
+        m_frameCount++;
+
+        float length = m_end.x - m_start.x;
+        if(m_travelled >= length)
+        {
+            LogResults(partition);
+            return 0;
+        }
+
+        // The camera is placed on the path and UpdateCamera rebuilds the view from it
+        camera.viewData.position = BlitML::vec3(m_start.x + m_travelled, m_start.y, m_start.z);
+        camera.transformData.cameraDirty = 1;
+        m_travelled += m_cameraSpeed * static_cast<float>(deltaTime);
+
+        return 1;
+    }
+
+    void WorldFlythroughBenchmark::LogResults(WorldPartition& partition)
+    {
+        WorldPartitionStats& stats = partition.GetStats();
+        uint32_t timedFrames = m_frameCount > 1 ? m_frameCount - 1 : 1;
+
+        BLIT_INFO("World partition benchmark finished after %u frames", m_frameCount)
+        BLIT_INFO("Frame time: average %f ms, worst %f ms, %u frames over %f ms", m_frameTimeSum / timedFrames * 1000.0,
+        m_worstFrameTime * 1000.0, m_hitchCount, BLIT_WORLD_BENCHMARK_HITCH_TIME * 1000.0)
+        BLIT_INFO("Cells: %u loads, %u unloads, %u evicted for the memory budget", stats.loadCount, stats.unloadCount,
+        stats.budgetEvictionCount)
+        BLIT_INFO("Streamed memory: %f MB resident, %f MB peak", static_cast<double>(stats.residentBytes) / (1024.0 * 1024.0),
+        static_cast<double>(stats.peakResidentBytes) / (1024.0 * 1024.0))
+    }
+}